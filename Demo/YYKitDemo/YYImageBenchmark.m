@@ -11,6 +11,8 @@
 #import <ImageIO/ImageIO.h>
 #import <MobileCoreServices/MobileCoreServices.h>
 #import "YYBPGCoder.h"
+#import <mach/mach.h>
+#import <libkern/OSAtomic.h>
 
 /*
  Enable this value and run in simulator, the image will write to desktop.
@@ -19,6 +21,102 @@
 #define ENABLE_OUTPUT 0
 #define IMAGE_OUTPUT_DIR @"/Users/ibireme/Desktop/image_out/"
 
+/// Returns the process's peak resident memory in bytes.
+static int64_t YYBenchmarkMemoryPeak() {
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    kern_return_t kr = task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count);
+    if (kr != KERN_SUCCESS) return -1;
+    return info.resident_size_max;
+}
+
+/// Generates pixels of a test pattern row by row, so the large image never exists as a whole bitmap.
+static size_t YYBenchmarkPatternGetBytes(void *info, void *buffer, size_t count) {
+    size_t *offset = info;
+    uint8_t *bytes = buffer;
+    for (size_t i = 0; i < count; i++) {
+        size_t pos = *offset + i;
+        size_t pixel = pos / 4, width = 4096;
+        size_t x = pixel % width, y = pixel / width;
+        switch (pos % 4) {
+            case 0: bytes[i] = x ^ y; break;
+            case 1: bytes[i] = (x * 3 + y) >> 2; break;
+            case 2: bytes[i] = y >> 4; break;
+            default: bytes[i] = 0xFF; break;
+        }
+    }
+    *offset += count;
+    return count;
+}
+
+static off_t YYBenchmarkPatternSkipForward(void *info, off_t count) {
+    size_t *offset = info;
+    *offset += count;
+    return count;
+}
+
+static void YYBenchmarkPatternRewind(void *info) {
+    size_t *offset = info;
+    *offset = 0;
+}
+
+
+/// A local stand-in for an image server, serves "yybench://image/<name>" with bundled image data and counts the fetches.
+@interface YYBenchmarkImageURLProtocol : NSURLProtocol
++ (NSUInteger)fetchCount;
++ (void)resetFetchCount;
+@end
+
+@implementation YYBenchmarkImageURLProtocol
+static int32_t YYBenchmarkImageFetchCount = 0;
+
++ (NSUInteger)fetchCount {
+    return (NSUInteger)OSAtomicAdd32(0, &YYBenchmarkImageFetchCount);
+}
+
++ (void)resetFetchCount {
+    OSAtomicAnd32(0, (uint32_t *)&YYBenchmarkImageFetchCount);
+}
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request {
+    return [request.URL.scheme isEqualToString:@"yybench"];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request {
+    return request;
+}
+
+- (void)startLoading {
+    OSAtomicIncrement32(&YYBenchmarkImageFetchCount);
+    [self performSelector:@selector(_respond) withObject:nil afterDelay:0.05]; // simulate the latency of network
+}
+
+- (void)_respond {
+    NSData *data = [NSData dataNamed:self.request.URL.lastPathComponent];
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.request.URL statusCode:data ? 200 : 404 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Content-Length" : @(data.length).stringValue}];
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    if (data) [self.client URLProtocol:self didLoadData:data];
+    [self.client URLProtocolDidFinishLoading:self];
+}
+
+- (void)stopLoading {
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(_respond) object:nil];
+}
+
+@end
+
+/// A session transport which loads "yybench://" URLs from the stand-in server (a custom session doesn't use the registered protocols).
+static YYWebImageSessionTransport *YYBenchmarkSessionTransport() {
+    static YYWebImageSessionTransport *transport;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+        configuration.HTTPMaximumConnectionsPerHost = 4;
+        configuration.protocolClasses = [@[[YYBenchmarkImageURLProtocol class]] arrayByAddingObjectsFromArray:configuration.protocolClasses];
+        transport = [[YYWebImageSessionTransport alloc] initWithSessionConfiguration:configuration];
+    });
+    return transport;
+}
 
 
 @implementation YYImageBenchmark {
@@ -40,6 +138,12 @@
     [self addCell:@"WebP Encode and Decode (Slow)" selector:@selector(runWebPBenchmark)];
     [self addCell:@"BPG Decode" selector:@selector(runBPGBenchmark)];
     [self addCell:@"Animated Image Decode" selector:@selector(runAnimatedImageBenchmark)];
+    [self addCell:@"Large Image Tile Decode" selector:@selector(runLargeImageBenchmark)];
+    [self addCell:@"Animated Image Buffer Pool" selector:@selector(runBufferPoolBenchmark)];
+    [self addCell:@"Web Image Request Coalescing" selector:@selector(runRequestCoalescingBenchmark)];
+    [self addCell:@"Web Image Scheduling (Scroll Trace)" selector:@selector(runRequestSchedulingBenchmark)];
+    [self addCell:@"Web Image Transport Throughput" selector:@selector(runTransportThroughputBenchmark)];
+    [self addCell:@"Image Cache Bitmap Tier" selector:@selector(runBitmapTierBenchmark)];
     
     [self.tableView reloadData];
 }
@@ -739,4 +843,315 @@
 
 }
 
+- (void)runLargeImageBenchmark {
+    printf("==========================================\n");
+    printf("Large Image Tile Decode Benchmark\n");
+    
+    // a 4096x16384 JPEG (256MB as BGRA bitmap), encoded without a whole bitmap in memory
+    size_t width = 4096, height = 16384;
+    size_t offset = 0;
+    CGDataProviderSequentialCallbacks callbacks = {0, YYBenchmarkPatternGetBytes, YYBenchmarkPatternSkipForward, YYBenchmarkPatternRewind, NULL};
+    CGDataProviderRef provider = CGDataProviderCreateSequential(&offset, &callbacks);
+    CGImageRef pattern = CGImageCreate(width, height, 8, 32, width * 4, YYCGColorSpaceGetDeviceRGB(), kCGBitmapByteOrderDefault | kCGImageAlphaNoneSkipLast, provider, NULL, false, kCGRenderingIntentDefault);
+    CFRelease(provider);
+    NSMutableData *data = [NSMutableData new];
+    CGImageDestinationRef dest = CGImageDestinationCreateWithData((CFMutableDataRef)data, kUTTypeJPEG, 1, NULL);
+    CGImageDestinationAddImage(dest, pattern, (CFDictionaryRef)@{(id)kCGImageDestinationLossyCompressionQuality : @0.9});
+    CGImageDestinationFinalize(dest);
+    CFRelease(dest);
+    CFRelease(pattern);
+    printf("image: %dx%d jpeg, length: %d\n", (int)width, (int)height, (int)data.length);
+    printf("------------------------------------------\n");
+    printf("method          time(ms) peak_delta(MB) bitmap(MB)\n");
+    
+    // peak memory is monotonic, so run the cheapest case first
+    YYImageTileCache *cache = [[YYImageTileCache alloc] initWithTileSize:256];
+    for (NSNumber *level in @[@0, @3]) {
+        @autoreleasepool {
+            __block UIImage *tile = nil;
+            int64_t peak = YYBenchmarkMemoryPeak();
+            YYBenchmark(^{
+                YYImageDecoder *decoder = [YYImageDecoder decoderWithData:data scale:1];
+                tile = [cache tileForKey:@"large" decoder:decoder level:level.unsignedIntegerValue column:0 row:0];
+            }, ^(double ms) {
+                CGImageRef imageRef = tile.CGImage;
+                double bitmap = imageRef ? CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef) / 1024.0 / 1024.0 : 0;
+                printf("first_tile_l%d   %8.2f %14.2f %10.2f\n", level.intValue, ms, (YYBenchmarkMemoryPeak() - peak) / 1024.0 / 1024.0, bitmap);
+            });
+        }
+    }
+    @autoreleasepool {
+        __block UIImage *image = nil;
+        int64_t peak = YYBenchmarkMemoryPeak();
+        YYBenchmark(^{
+            YYImageDecoder *decoder = [YYImageDecoder decoderWithData:data scale:1];
+            image = [decoder frameAtIndex:0 decodeForDisplay:YES].image;
+        }, ^(double ms) {
+            CGImageRef imageRef = image.CGImage;
+            double bitmap = imageRef ? CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef) / 1024.0 / 1024.0 : 0;
+            printf("full_decode     %8.2f %14.2f %10.2f\n", ms, (YYBenchmarkMemoryPeak() - peak) / 1024.0 / 1024.0, bitmap);
+        });
+    }
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runBufferPoolBenchmark {
+    printf("==========================================\n");
+    printf("Animated Image Buffer Pool Benchmark\n");
+    printf("GIF playback loop, keep 4 frames in buffer like YYAnimatedImageView\n");
+    printf("------------------------------------------\n");
+    printf("pool  loops   time(ms) malloc reuse\n");
+    
+    NSData *gif = [NSData dataNamed:@"ermilio.gif"];
+    YYBitmapBufferPool *pool = [YYBitmapBufferPool sharedPool];
+    NSUInteger byteLimit = pool.byteLimit;
+    int loops = 5;
+    for (NSNumber *enable in @[@NO, @YES]) {
+        @autoreleasepool {
+            pool.byteLimit = enable.boolValue ? byteLimit : 0;
+            [pool removeAllBuffers];
+            [pool resetStatistics];
+            YYImage *image = [YYImage imageWithData:gif];
+            NSUInteger frameCount = image.animatedImageFrameCount;
+            NSMutableArray *buffer = [NSMutableArray new];
+            YYBenchmark(^{
+                for (int l = 0; l < loops; l++) {
+                    for (NSUInteger i = 0; i < frameCount; i++) {
+                        @autoreleasepool {
+                            UIImage *frame = [image animatedImageFrameAtIndex:i].imageByDecoded;
+                            if (frame) [buffer addObject:frame];
+                            if (buffer.count > 4) [buffer removeObjectAtIndex:0];
+                        }
+                    }
+                }
+                [buffer removeAllObjects];
+            }, ^(double ms) {
+                printf("%4s %6d %10.2f %6d %5d\n", enable.boolValue ? "on" : "off", loops, ms, (int)pool.allocationCount, (int)pool.reuseCount);
+            });
+        }
+    }
+    pool.byteLimit = byteLimit;
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runRequestCoalescingBenchmark {
+    printf("==========================================\n");
+    printf("Web Image Request Coalescing Benchmark\n");
+    printf("5 image URLs, 20 concurrent requests for each URL (like a fast scroll)\n");
+    printf("local stand-in server with 50ms latency, no image cache\n");
+    printf("------------------------------------------\n");
+    printf("coalesce requests fetches   time(ms)\n");
+    
+    [NSURLProtocol registerClass:[YYBenchmarkImageURLProtocol class]];
+    NSArray *names = @[@"dribbble64_imageio.png", @"dribbble128_imageio.png", @"dribbble256_imageio.png", @"dribbble512_imageio.png", @"ermilio.png"];
+    int repeat = 20;
+    for (NSNumber *coalesce in @[@NO, @YES]) {
+        @autoreleasepool {
+            NSOperationQueue *queue = [NSOperationQueue new];
+            YYWebImageManager *manager = [[YYWebImageManager alloc] initWithCache:nil queue:queue];
+            manager.transport = YYBenchmarkSessionTransport();
+            manager.shouldCoalesceRequests = coalesce.boolValue;
+            [YYBenchmarkImageURLProtocol resetFetchCount];
+            __block int32_t finished = 0;
+            YYBenchmark(^{
+                dispatch_group_t group = dispatch_group_create();
+                for (int r = 0; r < repeat; r++) {
+                    for (NSString *name in names) {
+                        NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"yybench://image/%@", name]];
+                        dispatch_group_enter(group);
+                        [manager requestImageWithURL:url options:kNilOptions progress:nil transform:nil completion:^(UIImage *image, NSURL *imageURL, YYWebImageFromType from, YYWebImageStage stage, NSError *error) {
+                            if (stage == YYWebImageStageProgress) return;
+                            if (image) OSAtomicIncrement32(&finished);
+                            dispatch_group_leave(group);
+                        }];
+                    }
+                }
+                dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+            }, ^(double ms) {
+                printf("%8s %8d %7d %10.2f\n", coalesce.boolValue ? "on" : "off", finished, (int)[YYBenchmarkImageURLProtocol fetchCount], ms);
+            });
+        }
+    }
+    [NSURLProtocol unregisterClass:[YYBenchmarkImageURLProtocol class]];
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runRequestSchedulingBenchmark {
+    printf("==========================================\n");
+    printf("Web Image Scheduling Benchmark\n");
+    printf("fling over 200 rows (1 row per 8ms), 6 rows visible, then stop\n");
+    printf("local stand-in server with 50ms latency, no image cache\n");
+    printf("time-to-visible: from the end of fling to the visible images loaded\n");
+    printf("------------------------------------------\n");
+    printf("scheduler    avg(ms)    max(ms)\n");
+    
+    [NSURLProtocol registerClass:[YYBenchmarkImageURLProtocol class]];
+    int rowCount = 200, visibleCount = 6;
+    for (NSNumber *schedule in @[@NO, @YES]) {
+        @autoreleasepool {
+            NSOperationQueue *queue = [NSOperationQueue new];
+            YYWebImageManager *manager = [[YYWebImageManager alloc] initWithCache:nil queue:queue];
+            manager.transport = YYBenchmarkSessionTransport();
+            if (schedule.boolValue) {
+                manager.maxConcurrentOperationCount = 4;
+            } else { // FIFO queue
+                manager.maxConcurrentOperationCount = 0;
+                queue.maxConcurrentOperationCount = 4;
+            }
+            
+            NSMutableArray *operations = [NSMutableArray new];
+            NSMutableData *times = [NSMutableData dataWithLength:rowCount * sizeof(double)];
+            double *finishTimes = times.mutableBytes;
+            dispatch_group_t group = dispatch_group_create();
+            for (int row = 0; row < rowCount; row++) {
+                NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"yybench://image/dribbble128_imageio.png?row=%d", row]];
+                BOOL last = row >= rowCount - visibleCount;
+                if (last) dispatch_group_enter(group);
+                YYWebImageOperation *operation = [manager requestImageWithURL:url options:kNilOptions progress:nil transform:nil completion:^(UIImage *image, NSURL *imageURL, YYWebImageFromType from, YYWebImageStage stage, NSError *error) {
+                    if (stage != YYWebImageStageFinished) return;
+                    ((double *)times.mutableBytes)[row] = CACurrentMediaTime();
+                    if (last) dispatch_group_leave(group);
+                }];
+                if (operation) [operations addObject:operation];
+                if (schedule.boolValue && row >= visibleCount) { // the row scrolled off the screen
+                    YYWebImageOperation *offscreen = operations[row - visibleCount];
+                    offscreen.priority = YYWebImagePriorityPrefetch;
+                }
+                usleep(8 * 1000);
+            }
+            double stopTime = CACurrentMediaTime();
+            dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+            
+            double sum = 0, max = 0;
+            for (int row = rowCount - visibleCount; row < rowCount; row++) {
+                double ms = MAX(0, finishTimes[row] - stopTime) * 1000;
+                sum += ms;
+                max = MAX(max, ms);
+            }
+            printf("%9s %10.2f %10.2f\n", schedule.boolValue ? "priority" : "fifo", sum / visibleCount, max);
+            
+            for (YYWebImageOperation *operation in operations) [operation cancel];
+        }
+    }
+    [NSURLProtocol unregisterClass:[YYBenchmarkImageURLProtocol class]];
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runTransportThroughputBenchmark {
+    printf("==========================================\n");
+    printf("Web Image Transport Throughput Benchmark\n");
+    printf("1000 small images (64x64 PNG) from one host, 16 concurrent operations\n");
+    printf("local stand-in server with 50ms latency, no image cache\n");
+    printf("------------------------------------------\n");
+    printf("transport    images   time(ms)   images/s\n");
+    
+    [NSURLProtocol registerClass:[YYBenchmarkImageURLProtocol class]];
+    int imageCount = 1000;
+    NSArray *transports = @[[YYWebImageConnectionTransport sharedTransport], YYBenchmarkSessionTransport()];
+    NSArray *names = @[@"connection", @"session"];
+    for (NSUInteger t = 0; t < transports.count; t++) {
+        @autoreleasepool {
+            NSOperationQueue *queue = [NSOperationQueue new];
+            YYWebImageManager *manager = [[YYWebImageManager alloc] initWithCache:nil queue:queue];
+            manager.transport = transports[t];
+            manager.shouldCoalesceRequests = NO;
+            manager.maxConcurrentOperationCount = 16;
+            manager.maxConcurrentOperationCountPerHost = 0;
+            __block int32_t finished = 0;
+            YYBenchmark(^{
+                dispatch_group_t group = dispatch_group_create();
+                for (int i = 0; i < imageCount; i++) {
+                    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"yybench://image/dribbble64_imageio.png?t=%d&i=%d", (int)t, i]];
+                    dispatch_group_enter(group);
+                    [manager requestImageWithURL:url options:kNilOptions progress:nil transform:nil completion:^(UIImage *image, NSURL *imageURL, YYWebImageFromType from, YYWebImageStage stage, NSError *error) {
+                        if (stage == YYWebImageStageProgress) return;
+                        if (image) OSAtomicIncrement32(&finished);
+                        dispatch_group_leave(group);
+                    }];
+                }
+                dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+            }, ^(double ms) {
+                printf("%10s %8d %10.2f %10.1f\n", [names[t] UTF8String], finished, ms, finished / (ms / 1000.0));
+            });
+        }
+    }
+    [NSURLProtocol unregisterClass:[YYBenchmarkImageURLProtocol class]];
+    printf("------------------------------------------\n\n");
+}
+
+/// Checks that the default persistence policy doesn't keep the bitmap of a cheap image.
+- (void)checkPersistencePolicy {
+    YYImagePersistencePolicy *policy = [YYImagePersistencePolicy new];
+    NSUInteger bitmapSize = 1000 * 1000 * 4;
+    
+    // not measured yet: the initial estimates are not used
+    NSAssert([policy persistenceForType:YYImageTypeJPEG frameCount:1 hasAlpha:NO bitmapSize:bitmapSize] == YYImagePersistenceOriginal, @"An unmeasured JPEG should not be kept as bitmap");
+    NSAssert([policy persistenceForType:YYImageTypePNG frameCount:1 hasAlpha:YES bitmapSize:bitmapSize] == YYImagePersistenceOriginal, @"An unmeasured PNG should not be kept as bitmap");
+    
+    // measured as cheap (10ns per pixel)
+    for (int i = 0; i < 10; i++) {
+        [policy recordDecodeTime:0.010 pixelCount:1000 * 1000 type:YYImageTypeJPEG];
+        [policy recordDecodeTime:0.010 pixelCount:1000 * 1000 type:YYImageTypePNG];
+    }
+    NSAssert([policy persistenceForType:YYImageTypeJPEG frameCount:1 hasAlpha:NO bitmapSize:bitmapSize] == YYImagePersistenceOriginal, @"A cheap JPEG should not be kept as bitmap");
+    NSAssert([policy persistenceForType:YYImageTypePNG frameCount:1 hasAlpha:YES bitmapSize:bitmapSize] == YYImagePersistenceOriginal, @"A cheap PNG should not be kept as bitmap");
+    
+    // measured as expensive (200ns per pixel)
+    for (int i = 0; i < 20; i++) {
+        [policy recordDecodeTime:0.200 pixelCount:1000 * 1000 type:YYImageTypeWebP];
+    }
+    NSAssert([policy persistenceForType:YYImageTypeWebP frameCount:1 hasAlpha:NO bitmapSize:bitmapSize] == YYImagePersistenceBitmap, @"An expensive WebP should be kept as bitmap");
+    printf("persistence policy check passed\n\n");
+}
+
+- (void)runBitmapTierBenchmark {
+    [self checkPersistencePolicy];
+    printf("==========================================\n");
+    printf("Image Cache Bitmap Tier Benchmark\n");
+    printf("disk cache hit until the pixels are in memory, no memory cache\n");
+    
+    NSData *data = [NSData dataNamed:@"mew_baseline.jpg"];
+    UIImage *original = [UIImage imageWithData:data];
+    printf("image: %dx%d jpeg, length: %d\n", (int)(original.size.width * original.scale), (int)(original.size.height * original.scale), (int)data.length);
+    printf("------------------------------------------\n");
+    printf("tier        disk(KB)  time(ms)\n");
+    
+    NSString *basePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"yybench_bitmap_%@", [NSUUID UUID].UUIDString]];
+    NSArray *names = @[@"jpeg", @"bitmap", @"bitmap_lz4"];
+    int count = 50;
+    for (NSUInteger t = 0; t < names.count; t++) {
+        @autoreleasepool {
+            NSString *path = [basePath stringByAppendingPathComponent:names[t]];
+            YYImageCache *cache = [[YYImageCache alloc] initWithPath:[path stringByAppendingPathComponent:@"images"]];
+            YYImagePersistencePolicy *policy = [YYImagePersistencePolicy new];
+            policy.bitmapCostThreshold = 0; // keep the bitmap regardless of the measured cost
+            cache.persistencePolicy = policy;
+            if (t > 0) {
+                cache.bitmapDiskCache = [[YYDiskCache alloc] initWithPath:[path stringByAppendingPathComponent:@"bitmaps"] inlineThreshold:0];
+                cache.shouldCompressBitmap = (t == 2);
+            }
+            [cache setImage:nil imageData:data forKey:@"mew" withType:YYImageCacheTypeDisk];
+            [cache getImageForKey:@"mew" withType:YYImageCacheTypeDisk]; // the bitmap is written in background
+            for (int i = 0; i < 500 && cache.bitmapDiskCache && ![cache.bitmapDiskCache containsObjectForKey:@"mew"]; i++) {
+                usleep(10000);
+            }
+            NSInteger diskCost = cache.bitmapDiskCache ? cache.bitmapDiskCache.totalCost : cache.diskCache.totalCost;
+            
+            YYBenchmark(^{
+                for (int i = 0; i < count; i++) {
+                    @autoreleasepool {
+                        UIImage *image = [cache getImageForKey:@"mew" withType:YYImageCacheTypeDisk];
+                        CFDataRef pixels = CGDataProviderCopyData(CGImageGetDataProvider(image.CGImage)); // page in
+                        if (pixels) CFRelease(pixels);
+                    }
+                }
+            }, ^(double ms) {
+                printf("%10s %9.1f %9.3f\n", [names[t] UTF8String], diskCost / 1024.0, ms / count);
+            });
+        }
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:basePath error:NULL];
+    printf("------------------------------------------\n\n");
+}
+
 @end
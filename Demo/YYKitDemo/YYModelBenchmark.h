@@ -0,0 +1,13 @@
+//
+//  YYModelBenchmark.h
+//  YYKitExample
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <UIKit/UIKit.h>
+
+@interface YYModelBenchmark : UITableViewController
+
+@end
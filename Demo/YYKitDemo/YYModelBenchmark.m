@@ -0,0 +1,916 @@
+//
+//  YYModelBenchmark.m
+//  YYKitExample
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "YYModelBenchmark.h"
+#import "YYModelBenchmarkSuite.h"
+#import "YYKit.h"
+#import "WBModel.h"
+#import "T1Model.h"
+#import <malloc/malloc.h>
+
+/// A model with a date property, to test the date conversion of YYModel.
+@interface YYBenchmarkDateModel : NSObject
+@property (nonatomic, strong) NSDate *date;
+@end
+
+@implementation YYBenchmarkDateModel
+@end
+
+/// A model accessed with setters and getters.
+@interface YYBenchmarkAccessorModel : NSObject <NSCoding>
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, copy) NSString *text;
+@property (nonatomic, strong) NSURL *url;
+@property (nonatomic, strong) NSNumber *count;
+@property (nonatomic, strong) NSArray *tags;
+@property (nonatomic, assign) int64_t uid;
+@property (nonatomic, assign) int32_t level;
+@property (nonatomic, assign) double score;
+@property (nonatomic, assign) BOOL verified;
+@property (nonatomic, strong) YYBenchmarkAccessorModel *child;
+@end
+
+@implementation YYBenchmarkAccessorModel
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [self modelEncodeWithCoder:aCoder];
+}
+- (id)initWithCoder:(NSCoder *)aDecoder {
+    self = [super init];
+    return [self modelInitWithCoder:aDecoder];
+}
+@end
+
+/// Same as YYBenchmarkAccessorModel, but the ivars are accessed directly.
+@interface YYBenchmarkIvarModel : YYBenchmarkAccessorModel
+@end
+
+@implementation YYBenchmarkIvarModel
++ (NSArray *)modelPropertyDirectIvarList {
+    return @[@"name", @"text", @"url", @"count", @"tags", @"uid", @"level", @"score", @"verified", @"child"];
+}
+@end
+
+/// Same as WBStatus, but transformed concurrently in container.
+@interface YYBenchmarkConcurrentStatus : WBStatus
+@end
+
+@implementation YYBenchmarkConcurrentStatus
++ (BOOL)modelTransformConcurrently {
+    return YES;
+}
+@end
+
+/// Same as WBUser, but the repeated strings are interned.
+@interface YYBenchmarkInternUser : WBUser
+@end
+
+@implementation YYBenchmarkInternUser
++ (NSArray *)modelPropertyInternList {
+    return @[@"idString", @"genderString", @"desc", @"domain", @"name", @"screenName", @"remark",
+             @"province", @"city", @"url", @"profileURL", @"location", @"weihao", @"lang",
+             @"verifiedReason", @"verifiedSource"];
+}
+@end
+
+/// Same as WBStatus, but the repeated strings (and the user's) are interned.
+@interface YYBenchmarkInternStatus : WBStatus
+@end
+
+@implementation YYBenchmarkInternStatus
++ (NSDictionary *)modelContainerPropertyGenericClass {
+    NSMutableDictionary *generic = [super modelContainerPropertyGenericClass].mutableCopy;
+    generic[@"user"] = [YYBenchmarkInternUser class];
+    generic[@"retweetedStatus"] = [YYBenchmarkInternStatus class];
+    return generic;
+}
++ (NSArray *)modelPropertyInternList {
+    return @[@"source", @"inReplyToScreenName", @"inReplyToUserId"];
+}
+@end
+
+/// Same as WBStatus, but the nested models are created on first access.
+@interface YYBenchmarkLazyStatus : WBStatus
+@end
+
+@implementation YYBenchmarkLazyStatus
++ (NSArray *)modelPropertyLazyList {
+    return @[@"user", @"title", @"topicStruct", @"tagStruct"];
+}
+@end
+
+/// Same as T1Tweet, but transformed concurrently in container.
+@interface YYBenchmarkConcurrentTweet : T1Tweet
+@end
+
+@implementation YYBenchmarkConcurrentTweet
++ (BOOL)modelTransformConcurrently {
+    return YES;
+}
+@end
+
+/// Returns the heap memory in use of the current process.
+static size_t YYBenchmarkHeapSize(void) {
+    malloc_statistics_t stats = {0};
+    malloc_zone_statistics(NULL, &stats);
+    return stats.size_in_use;
+}
+
+
+@implementation YYModelBenchmark {
+    UIActivityIndicatorView *_indicator;
+    UIView *_hud;
+    NSMutableArray *_titles;
+    NSMutableArray *_blocks;
+}
+
+- (void)viewDidLoad {
+    [super viewDidLoad];
+    [self initHUD];
+    _titles = [NSMutableArray new];
+    _blocks = [NSMutableArray new];
+    self.title = @"Benchmark (See Logs in Xcode)";
+    
+    [self addCell:@"JSON to Model (Streaming)" selector:@selector(runJSONStreamingBenchmark)];
+    [self addCell:@"Metadata Cache (Multi-thread)" selector:@selector(runMetaCacheBenchmark)];
+    [self addCell:@"Date Parse and Write" selector:@selector(runDateBenchmark)];
+    [self addCell:@"Direct Ivar Access" selector:@selector(runIvarAccessBenchmark)];
+    [self addCell:@"Model Archive" selector:@selector(runArchiveBenchmark)];
+    [self addCell:@"Model to JSON Data" selector:@selector(runJSONWriterBenchmark)];
+    [self addCell:@"Model Array (Concurrent)" selector:@selector(runConcurrentArrayBenchmark)];
+    [self addCell:@"String Intern" selector:@selector(runInternBenchmark)];
+    [self addCell:@"Lazy Nested Model" selector:@selector(runLazyModelBenchmark)];
+    [self addCell:@"Benchmark Suite (JSON Lines)" selector:@selector(runBenchmarkSuite)];
+    
+    [self.tableView reloadData];
+}
+
+- (void)addCell:(NSString *)title selector:(SEL)sel {
+    __weak typeof(self) _self = self;
+    void (^block)(void) = ^() {
+        if (![_self respondsToSelector:sel]) return;
+        
+        [_self startHUD];
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Warc-performSelector-leaks"
+            [_self performSelector:sel];
+#pragma clang diagnostic pop
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [_self stopHUD];
+            });
+        });
+    };
+    [_titles addObject:title];
+    [_blocks addObject:block];
+}
+
+- (void)dealloc {
+    [_hud removeFromSuperview];
+}
+
+- (void)initHUD {
+    _hud = [UIView new];
+    _hud.size = CGSizeMake(130, 80);
+    _hud.backgroundColor = [UIColor colorWithWhite:0.000 alpha:0.7];
+    _hud.clipsToBounds = YES;
+    _hud.layer.cornerRadius = 5;
+    
+    _indicator = [[UIActivityIndicatorView alloc] initWithActivityIndicatorStyle:UIActivityIndicatorViewStyleWhiteLarge];
+    _indicator.size = CGSizeMake(50, 50);
+    _indicator.centerX = _hud.width / 2;
+    _indicator.centerY = _hud.height / 2 - 9;
+    [_hud addSubview:_indicator];
+    
+    UILabel *label = [UILabel new];
+    label.textAlignment = NSTextAlignmentCenter;
+    label.size = CGSizeMake(_hud.width, 20);
+    label.text = @"See logs in Xcode";
+    label.font = [UIFont systemFontOfSize:12];
+    label.textColor = [UIColor whiteColor];
+    label.centerX = _hud.width / 2;
+    label.bottom = _hud.height - 8;
+    [_hud addSubview:label];
+}
+
+- (void)startHUD {
+    UIWindow *window = [[UIApplication sharedApplication].windows firstObject];
+    _hud.center = CGPointMake(window.width / 2, window.height / 2);
+    [_indicator startAnimating];
+    
+    [window addSubview:_hud];
+    self.navigationController.view.userInteractionEnabled = NO;
+}
+
+- (void)stopHUD {
+    [_indicator stopAnimating];
+    [_hud removeFromSuperview];
+    self.navigationController.view.userInteractionEnabled = YES;
+}
+
+- (void)tableView:(UITableView *)tableView didSelectRowAtIndexPath:(NSIndexPath *)indexPath {
+    [tableView deselectRowAtIndexPath:indexPath animated:YES];
+    ((void (^)(void))_blocks[indexPath.row])();
+}
+
+- (NSInteger)tableView:(UITableView *)tableView numberOfRowsInSection:(NSInteger)section {
+    return _titles.count;
+}
+
+- (UITableViewCell *)tableView:(UITableView *)tableView cellForRowAtIndexPath:(NSIndexPath *)indexPath {
+    UITableViewCell *cell = [tableView dequeueReusableCellWithIdentifier:@"YY"];
+    if (!cell) {
+        cell = [[UITableViewCell alloc] initWithStyle:UITableViewCellStyleDefault reuseIdentifier:@"YY"];
+    }
+    cell.textLabel.text = _titles[indexPath.row];
+    return cell;
+}
+
+#pragma mark - Benchmark
+
+/// Returns the demo JSON files, key: file name, value: model class.
+- (NSArray *)jsonFiles {
+    NSMutableArray *files = [NSMutableArray new];
+    for (int i = 0; i <= 7; i++) {
+        [files addObject:@[[NSString stringWithFormat:@"weibo_%d.json", i], [WBTimelineItem class]]];
+    }
+    for (int i = 0; i <= 3; i++) {
+        [files addObject:@[[NSString stringWithFormat:@"twitter_%d.json", i], [T1APIRespose class]]];
+    }
+    return files;
+}
+
+/// Returns the dictionaries of YYBenchmarkAccessorModel.
+- (NSArray *)accessorModelDictionaries {
+    NSMutableArray *dicts = [NSMutableArray new];
+    for (int i = 0; i < 1000; i++) {
+        NSDictionary *child = @{@"name" : [NSString stringWithFormat:@"child %d", i],
+                                @"uid" : @(i * 7),
+                                @"score" : @(i / 3.0)};
+        [dicts addObject:@{@"name" : [NSString stringWithFormat:@"user %d", i],
+                           @"text" : @"The quick brown fox jumps over the lazy dog.",
+                           @"url" : @"https://github.com/ibireme/YYKit",
+                           @"count" : @(i),
+                           @"tags" : @[@"a", @"b", @"c"],
+                           @"uid" : @(1000000000000LL + i),
+                           @"level" : @(i % 10),
+                           @"score" : @(i * 0.5),
+                           @"verified" : @(i % 2),
+                           @"child" : child}];
+    }
+    return dicts;
+}
+
+- (void)runJSONStreamingBenchmark {
+    printf("==========================================\n");
+    printf("JSON to Model Benchmark\n");
+    printf("stream: modelWithJSON: (single pass)\n");
+    printf("dict:   NSJSONSerialization + modelWithDictionary:\n");
+    printf("------------------------------------------\n");
+    printf("file              size(KB) stream(ms)  dict(ms)  same\n");
+    
+    int count = 20;
+    for (NSArray *file in [self jsonFiles]) {
+        @autoreleasepool {
+            NSString *name = file[0];
+            Class cls = file[1];
+            NSData *data = [NSData dataNamed:name];
+            if (!data) continue;
+            
+            // the two paths should create same models
+            id streamModel = [cls modelWithJSON:data];
+            id dictModel = [cls modelWithDictionary:[NSJSONSerialization JSONObjectWithData:data options:0 error:NULL]];
+            BOOL same = [[streamModel modelToJSONObject] isEqual:[dictModel modelToJSONObject]];
+            
+            __block double streamTime = 0, dictTime = 0;
+            YYBenchmark(^{
+                for (int i = 0; i < count; i++) {
+                    @autoreleasepool {
+                        [cls modelWithJSON:data];
+                    }
+                }
+            }, ^(double ms) {
+                streamTime = ms / count;
+            });
+            YYBenchmark(^{
+                for (int i = 0; i < count; i++) {
+                    @autoreleasepool {
+                        NSDictionary *dic = [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL];
+                        [cls modelWithDictionary:dic];
+                    }
+                }
+            }, ^(double ms) {
+                dictTime = ms / count;
+            });
+            printf("%-17s %8.1f %10.3f %9.3f  %s\n", name.UTF8String, data.length / 1024.0, streamTime, dictTime, same ? "yes" : "NO");
+        }
+    }
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runMetaCacheBenchmark {
+    printf("==========================================\n");
+    printf("Metadata Cache Multi-thread Benchmark\n");
+    printf("lookup: classInfoWithClass: (lock-free) vs semaphore + CFDictionary\n");
+    printf("parse:  modelWithDictionary: on weibo json\n");
+    printf("------------------------------------------\n");
+    printf("threads lookup(ms) locked(ms)  parse(ms)\n");
+    
+    NSArray *classes = @[[WBTimelineItem class], [WBStatus class], [WBUser class], [WBPicture class], [T1Tweet class], [T1User class]];
+    for (Class cls in classes) [YYClassInfo classInfoWithClass:cls];
+    
+    // the previous cache: a dictionary guarded by a semaphore
+    CFMutableDictionaryRef lockedCache = CFDictionaryCreateMutable(CFAllocatorGetDefault(), 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+    dispatch_semaphore_t lock = dispatch_semaphore_create(1);
+    for (Class cls in classes) {
+        CFDictionarySetValue(lockedCache, (__bridge const void *)(cls), (__bridge const void *)([YYClassInfo classInfoWithClass:cls]));
+    }
+    
+    NSMutableArray *dicts = [NSMutableArray new];
+    for (int i = 0; i <= 7; i++) {
+        NSData *data = [NSData dataNamed:[NSString stringWithFormat:@"weibo_%d.json", i]];
+        id dic = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] : nil;
+        if (dic) [dicts addObject:dic];
+    }
+    
+    int lookups = 200000, rounds = 8;
+    for (size_t threads = 1; threads <= 8; threads *= 2) {
+        __block double lookupTime = 0, lockedTime = 0, parseTime = 0;
+        YYBenchmark(^{
+            dispatch_apply(threads, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t t) {
+                for (int i = 0; i < lookups; i++) {
+                    [YYClassInfo classInfoWithClass:classes[i % classes.count]];
+                }
+            });
+        }, ^(double ms) {
+            lookupTime = ms;
+        });
+        YYBenchmark(^{
+            dispatch_apply(threads, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t t) {
+                for (int i = 0; i < lookups; i++) {
+                    Class cls = classes[i % classes.count];
+                    dispatch_semaphore_wait(lock, DISPATCH_TIME_FOREVER);
+                    __unused id info = CFDictionaryGetValue(lockedCache, (__bridge const void *)(cls));
+                    dispatch_semaphore_signal(lock);
+                }
+            });
+        }, ^(double ms) {
+            lockedTime = ms;
+        });
+        YYBenchmark(^{
+            dispatch_apply(threads, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t t) {
+                for (int r = 0; r < rounds; r++) {
+                    @autoreleasepool {
+                        for (NSDictionary *dic in dicts) {
+                            [WBTimelineItem modelWithDictionary:dic];
+                        }
+                    }
+                }
+            });
+        }, ^(double ms) {
+            parseTime = ms;
+        });
+        printf("%7d %10.2f %10.2f %10.2f\n", (int)threads, lookupTime, lockedTime, parseTime);
+    }
+    CFRelease(lockedCache);
+    printf("(each thread does the same work, flat time means linear scaling)\n");
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runDateBenchmark {
+    printf("==========================================\n");
+    printf("Date Parse and Write Benchmark\n");
+    printf("model: NSString -> NSDate -> JSON with YYModel\n");
+    printf("formatter: NSDateFormatter with the same format\n");
+    printf("------------------------------------------\n");
+    
+    // format, time zone (nil: random), same as YYNSDateFromString()
+    NSArray *formats = @[@[@"yyyy-MM-dd", @YES],
+                         @[@"yyyy-MM-dd'T'HH:mm:ss", @YES],
+                         @[@"yyyy-MM-dd HH:mm:ss", @YES],
+                         @[@"yyyy-MM-dd'T'HH:mm:ss.SSS", @YES],
+                         @[@"yyyy-MM-dd HH:mm:ss.SSS", @YES],
+                         @[@"yyyy-MM-dd'T'HH:mm:ssZ", @NO],
+                         @[@"yyyy-MM-dd'T'HH:mm:ssZZZZZ", @NO],
+                         @[@"yyyy-MM-dd'T'HH:mm:ss.SSSZ", @NO],
+                         @[@"yyyy-MM-dd'T'HH:mm:ss.SSSZZZZZ", @NO],
+                         @[@"EEE MMM dd HH:mm:ss Z yyyy", @NO],
+                         @[@"EEE MMM dd HH:mm:ss.SSS Z yyyy", @NO]];
+    NSLocale *locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    NSDateFormatter *isoFormatter = [NSDateFormatter new];
+    isoFormatter.locale = locale;
+    isoFormatter.dateFormat = @"yyyy-MM-dd'T'HH:mm:ssZ";
+    
+    printf("format                           parse(us)  formatter(us)  diff\n");
+    int count = 2000;
+    NSUInteger totalDiff = 0;
+    for (NSArray *format in formats) {
+        @autoreleasepool {
+            NSDateFormatter *writer = [NSDateFormatter new];
+            writer.locale = locale;
+            writer.dateFormat = format[0];
+            NSDateFormatter *reader = [NSDateFormatter new];
+            reader.locale = locale;
+            reader.dateFormat = [format[0] stringByReplacingOccurrencesOfString:@"ZZZZZ" withString:@"Z"];
+            if ([format[1] boolValue]) {
+                writer.timeZone = reader.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+            }
+            NSMutableArray *strings = [NSMutableArray new];
+            for (int i = 0; i < count; i++) {
+                if (![format[1] boolValue]) {
+                    writer.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:((int)arc4random_uniform(14 * 4 * 2 + 1) - 14 * 4) * 900]; // -14:00~+14:00
+                }
+                NSTimeInterval time = arc4random_uniform(UINT32_MAX) * 2.0 + arc4random_uniform(1000) / 1000.0; // 1970~2242
+                [strings addObject:[writer stringFromDate:[NSDate dateWithTimeIntervalSince1970:time]]];
+            }
+            [strings addObjectsFromArray:@[@"2014-02-30", @"2014-13-01", @"2014-01-20T25:00:00", @"1500-01-01", @"Foo Sep 04 00:12:21 +0800 2015"]];
+            
+            // the model should get the same dates and ISO strings as the formatters
+            NSUInteger diff = 0;
+            for (NSString *string in strings) {
+                YYBenchmarkDateModel *model = [YYBenchmarkDateModel modelWithDictionary:@{@"date" : string}];
+                NSDate *expected = [reader dateFromString:string];
+                if (!model.date != !expected || (expected && fabs(model.date.timeIntervalSince1970 - expected.timeIntervalSince1970) > 1e-6)) {
+                    diff++;
+                    printf("  parse diff: %s\n", string.UTF8String);
+                } else if (expected && ![[model modelToJSONObject][@"date"] isEqual:[isoFormatter stringFromDate:expected]]) {
+                    diff++;
+                    printf("  write diff: %s\n", string.UTF8String);
+                }
+            }
+            totalDiff += diff;
+            
+            __block double parseTime = 0, formatterTime = 0;
+            YYBenchmarkDateModel *model = [YYBenchmarkDateModel new];
+            YYBenchmark(^{
+                for (NSString *string in strings) {
+                    [model modelSetWithDictionary:@{@"date" : string}];
+                }
+            }, ^(double ms) {
+                parseTime = ms * 1000 / strings.count;
+            });
+            YYBenchmark(^{
+                for (NSString *string in strings) {
+                    model.date = [reader dateFromString:string];
+                }
+            }, ^(double ms) {
+                formatterTime = ms * 1000 / strings.count;
+            });
+            printf("%-32s %9.3f %14.3f %5d\n", [format[0] UTF8String], parseTime, formatterTime, (int)diff);
+        }
+    }
+    printf("total diff: %d\n", (int)totalDiff);
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runIvarAccessBenchmark {
+    printf("==========================================\n");
+    printf("Direct Ivar Access Benchmark\n");
+    printf("accessor: setters and getters\n");
+    printf("ivar:     +modelPropertyDirectIvarList returns all properties\n");
+    printf("------------------------------------------\n");
+    
+    NSArray *dicts = [self accessorModelDictionaries];
+    
+    // the two models should have same values
+    BOOL same = YES;
+    for (NSDictionary *dic in dicts) {
+        YYBenchmarkAccessorModel *accessorModel = [YYBenchmarkAccessorModel modelWithDictionary:dic];
+        YYBenchmarkIvarModel *ivarModel = [YYBenchmarkIvarModel modelWithDictionary:dic];
+        if (![[accessorModel modelToJSONObject] isEqual:[ivarModel modelToJSONObject]] ||
+            ![[[ivarModel modelCopy] modelToJSONObject] isEqual:[ivarModel modelToJSONObject]]) {
+            same = NO;
+        }
+    }
+    
+    printf("                 accessor(ms)  ivar(ms)\n");
+    int rounds = 20;
+    NSArray *classes = @[[YYBenchmarkAccessorModel class], [YYBenchmarkIvarModel class]];
+    double times[3][2] = {{0}};
+    for (int c = 0; c < 2; c++) {
+        __block double parseTime = 0, jsonTime = 0, copyTime = 0;
+        Class cls = classes[c];
+        NSMutableArray *models = [NSMutableArray new];
+        for (NSDictionary *dic in dicts) [models addObject:[cls modelWithDictionary:dic]];
+        YYBenchmark(^{
+            for (int r = 0; r < rounds; r++) {
+                @autoreleasepool {
+                    for (NSDictionary *dic in dicts) [cls modelWithDictionary:dic];
+                }
+            }
+        }, ^(double ms) {
+            parseTime = ms;
+        });
+        YYBenchmark(^{
+            for (int r = 0; r < rounds; r++) {
+                @autoreleasepool {
+                    for (id model in models) [model modelToJSONObject];
+                }
+            }
+        }, ^(double ms) {
+            jsonTime = ms;
+        });
+        YYBenchmark(^{
+            for (int r = 0; r < rounds; r++) {
+                @autoreleasepool {
+                    for (id model in models) [model modelCopy];
+                }
+            }
+        }, ^(double ms) {
+            copyTime = ms;
+        });
+        times[0][c] = parseTime;
+        times[1][c] = jsonTime;
+        times[2][c] = copyTime;
+    }
+    printf("dict to model  %14.2f %9.2f\n", times[0][0], times[0][1]);
+    printf("model to json  %14.2f %9.2f\n", times[1][0], times[1][1]);
+    printf("model copy     %14.2f %9.2f\n", times[2][0], times[2][1]);
+    printf("same: %s\n", same ? "yes" : "NO");
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runArchiveBenchmark {
+    printf("==========================================\n");
+    printf("Model Archive Benchmark\n");
+    printf("archive: modelToArchiveData / modelWithArchiveData:\n");
+    printf("keyed:   NSKeyedArchiver with modelEncodeWithCoder:\n");
+    printf("------------------------------------------\n");
+    
+    NSMutableArray *models = [NSMutableArray new];
+    for (NSDictionary *dic in [self accessorModelDictionaries]) {
+        [models addObject:[YYBenchmarkAccessorModel modelWithDictionary:dic]];
+    }
+    
+    // the unarchived models should have same values
+    NSData *archiveData = [models modelToArchiveData];
+    NSData *keyedData = [NSKeyedArchiver archivedDataWithRootObject:models];
+    NSArray *archiveModels = [NSArray modelWithArchiveData:archiveData];
+    BOOL same = [[archiveModels modelToJSONObject] isEqual:[models modelToJSONObject]];
+    
+    // one archive for each model, same as YYDiskCache
+    int rounds = 5;
+    __block double archiveEncodeTime = 0, keyedEncodeTime = 0, archiveDecodeTime = 0, keyedDecodeTime = 0;
+    NSUInteger archiveSize = 0, keyedSize = 0;
+    NSMutableArray *archives = [NSMutableArray new], *keyeds = [NSMutableArray new];
+    for (id model in models) {
+        NSData *data = [model modelToArchiveData];
+        if (!data || ![[[YYBenchmarkAccessorModel modelWithArchiveData:data] modelToJSONObject] isEqual:[model modelToJSONObject]]) same = NO;
+        [archives addObject:data ?: [NSData data]];
+        [keyeds addObject:[NSKeyedArchiver archivedDataWithRootObject:model]];
+        archiveSize += [archives.lastObject length];
+        keyedSize += [keyeds.lastObject length];
+    }
+    YYBenchmark(^{
+        for (int r = 0; r < rounds; r++) {
+            @autoreleasepool {
+                for (id model in models) [model modelToArchiveData];
+            }
+        }
+    }, ^(double ms) {
+        archiveEncodeTime = ms / rounds;
+    });
+    YYBenchmark(^{
+        for (int r = 0; r < rounds; r++) {
+            @autoreleasepool {
+                for (id model in models) [NSKeyedArchiver archivedDataWithRootObject:model];
+            }
+        }
+    }, ^(double ms) {
+        keyedEncodeTime = ms / rounds;
+    });
+    YYBenchmark(^{
+        for (int r = 0; r < rounds; r++) {
+            @autoreleasepool {
+                for (NSData *data in archives) [YYBenchmarkAccessorModel modelWithArchiveData:data];
+            }
+        }
+    }, ^(double ms) {
+        archiveDecodeTime = ms / rounds;
+    });
+    YYBenchmark(^{
+        for (int r = 0; r < rounds; r++) {
+            @autoreleasepool {
+                for (NSData *data in keyeds) [NSKeyedUnarchiver unarchiveObjectWithData:data];
+            }
+        }
+    }, ^(double ms) {
+        keyedDecodeTime = ms / rounds;
+    });
+    
+    printf("%d models     encode(ms) decode(ms)  size(KB)\n", (int)models.count);
+    printf("archive  %14.2f %10.2f %9.1f\n", archiveEncodeTime, archiveDecodeTime, archiveSize / 1024.0);
+    printf("keyed    %14.2f %10.2f %9.1f\n", keyedEncodeTime, keyedDecodeTime, keyedSize / 1024.0);
+    printf("array archive: %.1f KB, keyed: %.1f KB\n", archiveData.length / 1024.0, keyedData.length / 1024.0);
+    
+    // the demo models with YYDiskCache
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"YYModelArchiveBenchmark"];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+    YYDiskCache *cache = [[YYDiskCache alloc] initWithPath:path];
+    cache.customArchiveBlock = ^NSData *(id object) { return [object modelToArchiveData]; };
+    cache.customUnarchiveBlock = ^id(NSData *data) { return [NSObject modelWithArchiveData:data]; };
+    printf("file              json(KB) archive(KB)  same\n");
+    for (NSArray *file in [self jsonFiles]) {
+        @autoreleasepool {
+            NSString *name = file[0];
+            NSData *data = [NSData dataNamed:name];
+            id model = data ? [file[1] modelWithJSON:data] : nil;
+            if (!model) continue;
+            [cache setObject:model forKey:name];
+            id cached = [cache objectForKey:name];
+            BOOL fileSame = [cached isKindOfClass:file[1]] && [[cached modelToJSONObject] isEqual:[model modelToJSONObject]];
+            if (!fileSame) same = NO;
+            printf("%-17s %8.1f %11.1f  %s\n", name.UTF8String, data.length / 1024.0, [model modelToArchiveData].length / 1024.0, fileSame ? "yes" : "NO");
+        }
+    }
+    [cache removeAllObjects];
+    printf("same: %s\n", same ? "yes" : "NO");
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runJSONWriterBenchmark {
+    printf("==========================================\n");
+    printf("Model to JSON Data Benchmark\n");
+    printf("writer: modelToJSONData (write JSON directly)\n");
+    printf("object: modelToJSONObject + NSJSONSerialization\n");
+    printf("------------------------------------------\n");
+    printf("file              writer(ms) object(ms)  bytes  json\n");
+    
+    int count = 20;
+    for (NSArray *file in [self jsonFiles]) {
+        @autoreleasepool {
+            NSString *name = file[0];
+            NSData *data = [NSData dataNamed:name];
+            id model = data ? [file[1] modelWithJSON:data] : nil;
+            if (!model) continue;
+            
+            // the keys may be in different order, so compare the bytes and the parsed objects
+            NSData *writerData = [model modelToJSONData];
+            NSData *objectData = [NSJSONSerialization dataWithJSONObject:[model modelToJSONObject] options:0 error:NULL];
+            BOOL sameBytes = [writerData isEqualToData:objectData];
+            id writerJSON = writerData ? [NSJSONSerialization JSONObjectWithData:writerData options:0 error:NULL] : nil;
+            id objectJSON = objectData ? [NSJSONSerialization JSONObjectWithData:objectData options:0 error:NULL] : nil;
+            BOOL sameJSON = writerJSON && [writerJSON isEqual:objectJSON];
+            
+            __block double writerTime = 0, objectTime = 0;
+            YYBenchmark(^{
+                for (int i = 0; i < count; i++) {
+                    @autoreleasepool {
+                        [model modelToJSONData];
+                    }
+                }
+            }, ^(double ms) {
+                writerTime = ms / count;
+            });
+            YYBenchmark(^{
+                for (int i = 0; i < count; i++) {
+                    @autoreleasepool {
+                        [NSJSONSerialization dataWithJSONObject:[model modelToJSONObject] options:0 error:NULL];
+                    }
+                }
+            }, ^(double ms) {
+                objectTime = ms / count;
+            });
+            printf("%-17s %10.3f %10.3f  %5s  %4s\n", name.UTF8String, writerTime, objectTime, sameBytes ? "yes" : "no", sameJSON ? "yes" : "NO");
+        }
+    }
+    printf("(bytes: same key order; json: same parsed object)\n");
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runConcurrentArrayBenchmark {
+    printf("==========================================\n");
+    printf("Model Array Concurrent Benchmark (%d CPU)\n", (int)[NSProcessInfo processInfo].activeProcessorCount);
+    printf("serial:     modelArrayWithClass: / modelDictionaryWithClass:\n");
+    printf("concurrent: same, the class returns YES in +modelTransformConcurrently\n");
+    printf("------------------------------------------\n");
+    printf("json             count serial(ms) concurrent(ms) speedup  same\n");
+    
+    // weibo statuses and twitter tweets of all the demo files
+    NSMutableArray *statuses = [NSMutableArray new];
+    for (int i = 0; i <= 7; i++) {
+        NSData *data = [NSData dataNamed:[NSString stringWithFormat:@"weibo_%d.json", i]];
+        NSDictionary *dic = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] : nil;
+        NSArray *array = dic[@"statuses"];
+        if ([array isKindOfClass:[NSArray class]]) [statuses addObjectsFromArray:array];
+    }
+    NSMutableDictionary *tweets = [NSMutableDictionary new];
+    for (int i = 0; i <= 3; i++) {
+        NSData *data = [NSData dataNamed:[NSString stringWithFormat:@"twitter_%d.json", i]];
+        NSDictionary *dic = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] : nil;
+        NSDictionary *one = dic[@"twitter_objects"][@"tweets"];
+        if ([one isKindOfClass:[NSDictionary class]]) [tweets addEntriesFromDictionary:one];
+    }
+    if (statuses.count == 0 || tweets.count == 0) return;
+    
+    int count = 10;
+    for (NSUInteger size = 64; size <= 4096; size *= 4) {
+        @autoreleasepool {
+            // repeat the elements to the size
+            NSMutableArray *array = [NSMutableArray new];
+            NSMutableDictionary *dictionary = [NSMutableDictionary new];
+            NSArray *tweetKeys = tweets.allKeys;
+            for (NSUInteger i = 0; i < size; i++) {
+                [array addObject:statuses[i % statuses.count]];
+                NSString *key = tweetKeys[i % tweetKeys.count];
+                dictionary[[NSString stringWithFormat:@"%@_%d", key, (int)(i / tweetKeys.count)]] = tweets[key];
+            }
+            
+            for (int type = 0; type < 2; type++) {
+                __block double serialTime = 0, concurrentTime = 0;
+                BOOL same;
+                if (type == 0) {
+                    // the order should be preserved
+                    same = [[[NSArray modelArrayWithClass:[WBStatus class] json:array] modelToJSONObject] isEqual:
+                            [[NSArray modelArrayWithClass:[YYBenchmarkConcurrentStatus class] json:array] modelToJSONObject]];
+                    YYBenchmark(^{
+                        for (int i = 0; i < count; i++) {
+                            @autoreleasepool {
+                                [NSArray modelArrayWithClass:[WBStatus class] json:array];
+                            }
+                        }
+                    }, ^(double ms) {
+                        serialTime = ms / count;
+                    });
+                    YYBenchmark(^{
+                        for (int i = 0; i < count; i++) {
+                            @autoreleasepool {
+                                [NSArray modelArrayWithClass:[YYBenchmarkConcurrentStatus class] json:array];
+                            }
+                        }
+                    }, ^(double ms) {
+                        concurrentTime = ms / count;
+                    });
+                } else {
+                    same = [[[NSDictionary modelDictionaryWithClass:[T1Tweet class] json:dictionary] modelToJSONObject] isEqual:
+                            [[NSDictionary modelDictionaryWithClass:[YYBenchmarkConcurrentTweet class] json:dictionary] modelToJSONObject]];
+                    YYBenchmark(^{
+                        for (int i = 0; i < count; i++) {
+                            @autoreleasepool {
+                                [NSDictionary modelDictionaryWithClass:[T1Tweet class] json:dictionary];
+                            }
+                        }
+                    }, ^(double ms) {
+                        serialTime = ms / count;
+                    });
+                    YYBenchmark(^{
+                        for (int i = 0; i < count; i++) {
+                            @autoreleasepool {
+                                [NSDictionary modelDictionaryWithClass:[YYBenchmarkConcurrentTweet class] json:dictionary];
+                            }
+                        }
+                    }, ^(double ms) {
+                        concurrentTime = ms / count;
+                    });
+                }
+                printf("%-16s %5d %10.3f %14.3f %6.2fx  %s\n", type == 0 ? "weibo statuses" : "twitter tweets",
+                       (int)size, serialTime, concurrentTime, serialTime / concurrentTime, same ? "yes" : "NO");
+            }
+        }
+    }
+    printf("(less than 128 elements are transformed serially)\n");
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runInternBenchmark {
+    printf("==========================================\n");
+    printf("String Intern Benchmark\n");
+    printf("plain:  WBStatus\n");
+    printf("intern: same, the user names, locations, sources... are interned\n");
+    printf("------------------------------------------\n");
+    printf("pages statuses plain(KB) intern(KB)  saved plain(ms) intern(ms)  same\n");
+    
+    // the weibo timeline pages (json data), loaded repeatedly as the user scrolls
+    NSMutableArray *pages = [NSMutableArray new];
+    for (int i = 0; i <= 7; i++) {
+        NSData *data = [NSData dataNamed:[NSString stringWithFormat:@"weibo_%d.json", i]];
+        NSDictionary *dic = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] : nil;
+        NSArray *statuses = dic[@"statuses"];
+        if (![statuses isKindOfClass:[NSArray class]]) continue;
+        NSData *page = [NSJSONSerialization dataWithJSONObject:statuses options:0 error:NULL];
+        if (page) [pages addObject:page];
+    }
+    if (pages.count == 0) return;
+    
+    for (int pageCount = 8; pageCount <= 64; pageCount *= 2) {
+        NSMutableArray *plainModels = [NSMutableArray new], *internModels = [NSMutableArray new];
+        __block double plainTime = 0, internTime = 0;
+        __block NSUInteger statusCount = 0;
+        size_t plainSize, internSize;
+        
+        // the retained memory of the models created from the pages
+        size_t begin = YYBenchmarkHeapSize();
+        YYBenchmark(^{
+            for (int i = 0; i < pageCount; i++) {
+                @autoreleasepool {
+                    NSArray *models = [NSArray modelArrayWithClass:[WBStatus class] json:pages[i % pages.count]];
+                    statusCount += models.count;
+                    [plainModels addObject:models];
+                }
+            }
+        }, ^(double ms) {
+            plainTime = ms;
+        });
+        plainSize = YYBenchmarkHeapSize() - begin;
+        
+        begin = YYBenchmarkHeapSize();
+        YYBenchmark(^{
+            for (int i = 0; i < pageCount; i++) {
+                @autoreleasepool {
+                    [internModels addObject:[NSArray modelArrayWithClass:[YYBenchmarkInternStatus class] json:pages[i % pages.count]]];
+                }
+            }
+        }, ^(double ms) {
+            internTime = ms;
+        });
+        internSize = YYBenchmarkHeapSize() - begin;
+        
+        BOOL same = [[plainModels modelToJSONObject] isEqual:[internModels modelToJSONObject]];
+        printf("%5d %8d %9.1f %10.1f %5.1f%% %9.2f %10.2f  %s\n", pageCount, (int)statusCount,
+               plainSize / 1024.0, internSize / 1024.0, (1 - (double)internSize / plainSize) * 100,
+               plainTime, internTime, same ? "yes" : "NO");
+    }
+    printf("(retained heap memory of the models, measured with malloc statistics)\n");
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runLazyModelBenchmark {
+    printf("==========================================\n");
+    printf("Lazy Nested Model Benchmark\n");
+    printf("eager:   WBStatus\n");
+    printf("lazy:    same, user/title/topics/tags are created on first access\n");
+    printf("visible: transform, then read the users of the first 6 statuses\n");
+    printf("------------------------------------------\n");
+    printf("file        statuses eager(ms)  lazy(ms) visible(ms)  same\n");
+    
+    int count = 20;
+    for (int f = 0; f <= 7; f++) {
+        @autoreleasepool {
+            NSString *name = [NSString stringWithFormat:@"weibo_%d.json", f];
+            NSData *data = [NSData dataNamed:name];
+            NSDictionary *dic = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] : nil;
+            NSArray *statuses = dic[@"statuses"];
+            if (![statuses isKindOfClass:[NSArray class]]) continue;
+            NSData *page = [NSJSONSerialization dataWithJSONObject:statuses options:0 error:NULL];
+            
+            // all the nested models are created when the json object is created
+            NSArray *eagerModels = [NSArray modelArrayWithClass:[WBStatus class] json:page];
+            NSArray *lazyModels = [NSArray modelArrayWithClass:[YYBenchmarkLazyStatus class] json:page];
+            BOOL same = [[eagerModels modelToJSONObject] isEqual:[lazyModels modelToJSONObject]];
+            
+            __block double eagerTime = 0, lazyTime = 0, visibleTime = 0;
+            YYBenchmark(^{
+                for (int i = 0; i < count; i++) {
+                    @autoreleasepool {
+                        [NSArray modelArrayWithClass:[WBStatus class] json:page];
+                    }
+                }
+            }, ^(double ms) {
+                eagerTime = ms / count;
+            });
+            YYBenchmark(^{
+                for (int i = 0; i < count; i++) {
+                    @autoreleasepool {
+                        [NSArray modelArrayWithClass:[YYBenchmarkLazyStatus class] json:page];
+                    }
+                }
+            }, ^(double ms) {
+                lazyTime = ms / count;
+            });
+            YYBenchmark(^{
+                for (int i = 0; i < count; i++) {
+                    @autoreleasepool {
+                        NSArray *models = [NSArray modelArrayWithClass:[YYBenchmarkLazyStatus class] json:page];
+                        for (NSUInteger j = 0; j < MIN(models.count, 6); j++) {
+                            WBStatus *status = models[j];
+                            [status.user.screenName length];
+                            [status.title.text length];
+                        }
+                    }
+                }
+            }, ^(double ms) {
+                visibleTime = ms / count;
+            });
+            printf("%-14s %6d %9.3f %9.3f %11.3f  %s\n", name.UTF8String, (int)statuses.count, eagerTime, lazyTime, visibleTime, same ? "yes" : "NO");
+        }
+    }
+    printf("------------------------------------------\n\n");
+}
+
+- (void)runBenchmarkSuite {
+    printf("==========================================\n");
+    printf("YYModel Benchmark Suite\n");
+    printf("------------------------------------------\n");
+    YYModelBenchmarkSuite *suite = [YYModelBenchmarkSuite new];
+    NSString *documents = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject;
+    suite.outputPath = [documents stringByAppendingPathComponent:@"yymodel_benchmark.jsonl"];
+    [suite run];
+    printf("------------------------------------------\n");
+    printf("(appended to %s)\n\n", suite.outputPath.UTF8String);
+}
+
+@end
@@ -0,0 +1,64 @@
+//
+//  YYModelBenchmarkSuite.h
+//  YYKitExample
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A benchmark suite of YYModel, which transforms the demo JSON files (weibo_0..7.json
+ with `WBTimelineItem`, and twitter_0..3.json with `T1APIRespose`) repeatedly.
+
+ @discussion It doesn't depend on UIKit, so it can be run by any target which
+ includes the demo models and JSON files (for example, a unit test bundle).
+
+ The phases of each corpus:
+
+     json_parse           NSJSONSerialization only, the baseline of parsing
+     json_to_model        +modelWithJSON: with the JSON data
+     dictionary_to_model  +modelWithDictionary: with the parsed JSON (value conversion)
+     meta_lookup          +modelWithDictionary: with an empty dictionary for each model class
+     date_parse           NSString to NSDate of the "created_at" values
+     model_to_json        -modelToJSONData
+     model_to_json_object -modelToJSONObject
+     copy                 -modelCopy
+     equal_hash           -modelIsEqual: with the copy, and -modelHash
+     coding               NSKeyedArchiver and NSKeyedUnarchiver, with -modelEncodeWithCoder:
+                          and -modelInitWithCoder:
+     archive              -modelToArchiveData and +modelWithArchiveData:
+
+ Each result is printed as one line of JSON (and appended to `outputPath`), so the
+ numbers can be compared by scripts:
+
+     {"suite":"YYModel","corpus":"weibo","phase":"json_to_model","iterations":20,"ops":8,
+      "bytes":<json size>,"ms":<total time>,"ms_per_op":<time>,"ops_per_sec":<throughput>,
+      "mb_per_sec":<throughput>,"live_bytes":<memory>,"live_blocks":<allocations>}
+
+ `ops` is the count of operations in one iteration, `bytes` is the JSON size of one
+ iteration. `live_bytes` and `live_blocks` are the heap memory retained by the
+ results of one iteration (measured with malloc statistics), they are 0 if the phase
+ doesn't create objects.
+ */
+@interface YYModelBenchmarkSuite : NSObject
+
+/// The iterations of each phase. Default is 20.
+@property (nonatomic, assign) NSUInteger iterations;
+
+/// The file which the JSON lines are appended to, nil to only print the lines.
+@property (nullable, nonatomic, copy) NSString *outputPath;
+
+/**
+ Runs all the phases on all the corpora, it may take a few seconds.
+
+ @return The results, same as the printed JSON lines.
+ */
+- (NSArray<NSDictionary *> *)run;
+
+@end
+
+NS_ASSUME_NONNULL_END
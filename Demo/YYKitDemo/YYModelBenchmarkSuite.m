@@ -0,0 +1,330 @@
+//
+//  YYModelBenchmarkSuite.m
+//  YYKitExample
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "YYModelBenchmarkSuite.h"
+#import "YYKit.h"
+#import "WBModel.h"
+#import "T1Model.h"
+#import <malloc/malloc.h>
+
+/// A model with a date property, to test the date parsing.
+@interface _YYModelBenchmarkDate : NSObject
+@property (nonatomic, strong) NSDate *date;
+@end
+
+@implementation _YYModelBenchmarkDate
+@end
+
+/**
+ Encodes a model which doesn't conform to NSCoding (the demo models) with
+ `modelEncodeWithCoder:`, and decodes it with `modelInitWithCoder:`.
+ */
+@interface _YYModelBenchmarkCodingBox : NSObject <NSCoding>
+@property (nonatomic, strong) id model;
+@end
+
+@implementation _YYModelBenchmarkCodingBox
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [aCoder encodeObject:NSStringFromClass([_model class]) forKey:@"$modelClass"];
+    [_model modelEncodeWithCoder:aCoder];
+}
+
+- (id)initWithCoder:(NSCoder *)aDecoder {
+    self = [super init];
+    Class cls = NSClassFromString([aDecoder decodeObjectForKey:@"$modelClass"]);
+    _model = [[cls new] modelInitWithCoder:aDecoder];
+    return self;
+}
+
+- (id)awakeAfterUsingCoder:(NSCoder *)aDecoder {
+    return _model;
+}
+
+@end
+
+/// Replaces the models with _YYModelBenchmarkCodingBox while archiving.
+@interface _YYModelBenchmarkArchiverDelegate : NSObject <NSKeyedArchiverDelegate>
+@end
+
+@implementation _YYModelBenchmarkArchiverDelegate
+
+- (id)archiver:(NSKeyedArchiver *)archiver willEncodeObject:(id)object {
+    if ([object conformsToProtocol:@protocol(NSCoding)]) return object;
+    _YYModelBenchmarkCodingBox *box = [_YYModelBenchmarkCodingBox new];
+    box.model = object;
+    return box;
+}
+
+@end
+
+/// A corpus of the demo JSON files.
+@interface _YYModelBenchmarkCorpus : NSObject
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, assign) Class cls;            ///< the model class of the files
+@property (nonatomic, strong) NSArray *modelClasses; ///< all model classes in the files
+@property (nonatomic, strong) NSArray *datas;       ///< NSData of the files
+@property (nonatomic, strong) NSArray *jsons;       ///< parsed JSON of the files
+@property (nonatomic, strong) NSArray *models;      ///< models of the files
+@property (nonatomic, strong) NSArray *dates;       ///< the "created_at" strings in the files
+@property (nonatomic, assign) NSUInteger bytes;     ///< total size of the files
+@end
+
+@implementation _YYModelBenchmarkCorpus
+@end
+
+/// Returns the heap memory in use.
+static malloc_statistics_t YYBenchmarkSuiteHeapStatistics(void) {
+    malloc_statistics_t stats = {0};
+    malloc_zone_statistics(NULL, &stats);
+    return stats;
+}
+
+/// Collects the string values of the key in JSON object.
+static void YYBenchmarkSuiteCollectStrings(id json, NSString *key, NSMutableArray *strings) {
+    if ([json isKindOfClass:[NSDictionary class]]) {
+        [((NSDictionary *)json) enumerateKeysAndObjectsUsingBlock:^(id oneKey, id obj, BOOL *stop) {
+            if ([oneKey isEqual:key] && [obj isKindOfClass:[NSString class]]) [strings addObject:obj];
+            else YYBenchmarkSuiteCollectStrings(obj, key, strings);
+        }];
+    } else if ([json isKindOfClass:[NSArray class]]) {
+        for (id obj in (NSArray *)json) YYBenchmarkSuiteCollectStrings(obj, key, strings);
+    }
+}
+
+
+@implementation YYModelBenchmarkSuite {
+    NSMutableArray *_results;
+}
+
+- (instancetype)init {
+    self = [super init];
+    _iterations = 20;
+    return self;
+}
+
+- (_YYModelBenchmarkCorpus *)corpusWithName:(NSString *)name fileCount:(int)fileCount cls:(Class)cls modelClasses:(NSArray *)modelClasses {
+    NSMutableArray *datas = [NSMutableArray new], *jsons = [NSMutableArray new], *models = [NSMutableArray new];
+    NSMutableArray *dates = [NSMutableArray new];
+    NSUInteger bytes = 0;
+    for (int i = 0; i < fileCount; i++) {
+        NSData *data = [NSData dataNamed:[NSString stringWithFormat:@"%@_%d.json", name, i]];
+        id json = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] : nil;
+        id model = json ? [cls modelWithJSON:data] : nil;
+        if (!model) continue;
+        [datas addObject:data];
+        [jsons addObject:json];
+        [models addObject:model];
+        YYBenchmarkSuiteCollectStrings(json, @"created_at", dates);
+        bytes += data.length;
+    }
+    if (models.count == 0) return nil;
+    _YYModelBenchmarkCorpus *corpus = [_YYModelBenchmarkCorpus new];
+    corpus.name = name;
+    corpus.cls = cls;
+    corpus.modelClasses = modelClasses;
+    corpus.datas = datas;
+    corpus.jsons = jsons;
+    corpus.models = models;
+    corpus.dates = dates;
+    corpus.bytes = bytes;
+    return corpus;
+}
+
+/**
+ Runs a phase and records the result.
+
+ @param block Runs one iteration of the phase, and returns the objects created
+              in the iteration (or nil), which are used to measure the memory.
+ */
+- (void)runPhase:(NSString *)phase corpus:(_YYModelBenchmarkCorpus *)corpus ops:(NSUInteger)ops bytes:(NSUInteger)bytes block:(id (^)(void))block {
+    // warm up, and measure the memory retained by the results
+    size_t liveBytes = 0, liveBlocks = 0;
+    @autoreleasepool {
+        block();
+    }
+    @autoreleasepool {
+        id results = nil;
+        malloc_statistics_t begin = YYBenchmarkSuiteHeapStatistics();
+        @autoreleasepool {
+            results = block();
+        }
+        malloc_statistics_t end = YYBenchmarkSuiteHeapStatistics();
+        if (results) {
+            if (end.size_in_use > begin.size_in_use) liveBytes = end.size_in_use - begin.size_in_use;
+            if (end.blocks_in_use > begin.blocks_in_use) liveBlocks = end.blocks_in_use - begin.blocks_in_use;
+        }
+        results = nil;
+    }
+
+    NSUInteger iterations = _iterations;
+    __block double time = 0;
+    YYBenchmark(^{
+        for (NSUInteger i = 0; i < iterations; i++) {
+            @autoreleasepool {
+                block();
+            }
+        }
+    }, ^(double ms) {
+        time = ms;
+    });
+
+    double opTime = time / iterations / ops;
+    NSMutableDictionary *result = [NSMutableDictionary new];
+    result[@"suite"] = @"YYModel";
+    result[@"corpus"] = corpus.name;
+    result[@"phase"] = phase;
+    result[@"iterations"] = @(iterations);
+    result[@"ops"] = @(ops);
+    result[@"bytes"] = @(bytes);
+    result[@"ms"] = @(time);
+    result[@"ms_per_op"] = @(opTime);
+    result[@"ops_per_sec"] = @(opTime > 0 ? 1000 / opTime : 0);
+    result[@"mb_per_sec"] = @(time > 0 ? bytes * iterations / (time / 1000) / (1024 * 1024) : 0);
+    result[@"live_bytes"] = @(liveBytes);
+    result[@"live_blocks"] = @(liveBlocks);
+    [self outputResult:result];
+}
+
+- (void)outputResult:(NSDictionary *)result {
+    [_results addObject:result];
+    NSData *data = [NSJSONSerialization dataWithJSONObject:result options:0 error:NULL];
+    if (!data) return;
+    printf("%.*s\n", (int)data.length, (const char *)data.bytes);
+    if (_outputPath) {
+        NSFileHandle *file = [NSFileHandle fileHandleForWritingAtPath:_outputPath];
+        if (!file) {
+            [[NSFileManager defaultManager] createFileAtPath:_outputPath contents:nil attributes:nil];
+            file = [NSFileHandle fileHandleForWritingAtPath:_outputPath];
+        }
+        [file seekToEndOfFile];
+        [file writeData:data];
+        [file writeData:[@"\n" dataUsingEncoding:NSUTF8StringEncoding]];
+        [file closeFile];
+    }
+}
+
+- (void)runCorpus:(_YYModelBenchmarkCorpus *)corpus {
+    Class cls = corpus.cls;
+    NSArray *datas = corpus.datas, *jsons = corpus.jsons, *models = corpus.models;
+    NSArray *modelClasses = corpus.modelClasses;
+    NSUInteger count = models.count, bytes = corpus.bytes;
+
+    NSMutableArray *copies = [NSMutableArray new];
+    for (id model in models) [copies addObject:[model modelCopy]];
+    NSMutableArray *dateDicts = [NSMutableArray new];
+    for (NSString *date in corpus.dates) [dateDicts addObject:@{@"date" : date}];
+    _YYModelBenchmarkArchiverDelegate *delegate = [_YYModelBenchmarkArchiverDelegate new];
+
+    [self runPhase:@"json_parse" corpus:corpus ops:count bytes:bytes block:^id{
+        NSMutableArray *results = [NSMutableArray new];
+        for (NSData *data in datas) [results addObject:[NSJSONSerialization JSONObjectWithData:data options:0 error:NULL]];
+        return results;
+    }];
+    [self runPhase:@"json_to_model" corpus:corpus ops:count bytes:bytes block:^id{
+        NSMutableArray *results = [NSMutableArray new];
+        for (NSData *data in datas) [results addObject:[cls modelWithJSON:data]];
+        return results;
+    }];
+    [self runPhase:@"dictionary_to_model" corpus:corpus ops:count bytes:0 block:^id{
+        NSMutableArray *results = [NSMutableArray new];
+        for (NSDictionary *json in jsons) [results addObject:[cls modelWithDictionary:json]];
+        return results;
+    }];
+    [self runPhase:@"meta_lookup" corpus:corpus ops:modelClasses.count * 100 bytes:0 block:^id{
+        for (int i = 0; i < 100; i++) {
+            for (Class modelClass in modelClasses) [modelClass modelWithDictionary:@{}];
+        }
+        return nil;
+    }];
+    if (dateDicts.count) {
+        [self runPhase:@"date_parse" corpus:corpus ops:dateDicts.count bytes:0 block:^id{
+            NSMutableArray *results = [NSMutableArray new];
+            for (NSDictionary *dic in dateDicts) [results addObject:[_YYModelBenchmarkDate modelWithDictionary:dic]];
+            return results;
+        }];
+    }
+    [self runPhase:@"model_to_json" corpus:corpus ops:count bytes:bytes block:^id{
+        NSMutableArray *results = [NSMutableArray new];
+        for (id model in models) [results addObject:[model modelToJSONData]];
+        return results;
+    }];
+    [self runPhase:@"model_to_json_object" corpus:corpus ops:count bytes:0 block:^id{
+        NSMutableArray *results = [NSMutableArray new];
+        for (id model in models) [results addObject:[model modelToJSONObject]];
+        return results;
+    }];
+    [self runPhase:@"copy" corpus:corpus ops:count bytes:0 block:^id{
+        NSMutableArray *results = [NSMutableArray new];
+        for (id model in models) [results addObject:[model modelCopy]];
+        return results;
+    }];
+    [self runPhase:@"equal_hash" corpus:corpus ops:count bytes:0 block:^id{
+        for (NSUInteger i = 0; i < models.count; i++) {
+            [models[i] modelIsEqual:copies[i]];
+            [models[i] modelHash];
+        }
+        return nil;
+    }];
+    [self runPhase:@"coding" corpus:corpus ops:count bytes:0 block:^id{
+        NSMutableArray *results = [NSMutableArray new];
+        for (id model in models) {
+            NSMutableData *data = [NSMutableData new];
+            NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc] initForWritingWithMutableData:data];
+            archiver.delegate = delegate;
+            [archiver encodeObject:model forKey:NSKeyedArchiveRootObjectKey];
+            [archiver finishEncoding];
+            id one = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+            if (one) [results addObject:one];
+        }
+        return results;
+    }];
+    [self runPhase:@"archive" corpus:corpus ops:count bytes:0 block:^id{
+        NSMutableArray *results = [NSMutableArray new];
+        for (id model in models) {
+            id one = [cls modelWithArchiveData:[model modelToArchiveData]];
+            if (one) [results addObject:one];
+        }
+        return results;
+    }];
+}
+
+- (NSArray<NSDictionary *> *)run {
+    _results = [NSMutableArray new];
+    NSProcessInfo *info = [NSProcessInfo processInfo];
+    NSMutableDictionary *header = [NSMutableDictionary new];
+    header[@"suite"] = @"YYModel";
+    header[@"phase"] = @"environment";
+    header[@"os"] = info.operatingSystemVersionString;
+    header[@"cpu"] = @(info.activeProcessorCount);
+    header[@"memory"] = @(info.physicalMemory);
+    header[@"date"] = [NSDate new].stringWithISOFormat;
+    [self outputResult:header];
+
+    NSMutableArray *corpora = [NSMutableArray new];
+    _YYModelBenchmarkCorpus *weibo = [self corpusWithName:@"weibo" fileCount:8 cls:[WBTimelineItem class]
+                                             modelClasses:@[[WBTimelineItem class], [WBStatus class], [WBUser class], [WBPicture class],
+                                                            [WBPictureMetadata class], [WBURL class], [WBTopic class], [WBTag class],
+                                                            [WBButtonLink class], [WBPageInfo class], [WBStatusTitle class]]];
+    if (weibo) [corpora addObject:weibo];
+    _YYModelBenchmarkCorpus *twitter = [self corpusWithName:@"twitter" fileCount:4 cls:[T1APIRespose class]
+                                               modelClasses:@[[T1APIRespose class], [T1Tweet class], [T1User class], [T1URL class],
+                                                              [T1Media class], [T1MediaMeta class], [T1HashTag class], [T1UserMention class],
+                                                              [T1Place class], [T1Card class], [T1Conversation class]]];
+    if (twitter) [corpora addObject:twitter];
+    for (_YYModelBenchmarkCorpus *corpus in corpora) {
+        @autoreleasepool {
+            [self runCorpus:corpus];
+        }
+    }
+    NSArray *results = _results.copy;
+    _results = nil;
+    return results;
+}
+
+@end
@@ -23,6 +23,7 @@
     self.titles = @[].mutableCopy;
     self.classNames = @[].mutableCopy;
     [self addCell:@"Model" class:@"YYModelExample"];
+//    [self addCell:@"Model Benchmark" class:@"YYModelBenchmark"];
     [self addCell:@"Image" class:@"YYImageExample"];
     [self addCell:@"Text" class:@"YYTextExample"];
 //    [self addCell:@"Utility" class:@"YYUtilityExample"];
@@ -221,6 +221,21 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)objectForKey:(NSString *)key withBlock:(void(^)(NSString *key, id<NSCoding> _Nullable object))block;
 
+/**
+ Returns the archived data of the value associated with a given key, the data
+ is memory-mapped if the value is stored in file.
+ This method may blocks the calling thread until the file is opened.
+ 
+ @discussion The data is not unarchived, and the extended data is not attached.
+ A mapped file's pages are read on demand and can be purged by the system, so
+ it's useful to access a large value (set `inlineThreshold` to 0 to store all
+ values in files).
+ 
+ @param key A string identifying the value. If nil, just return nil.
+ @return The archived data associated with key, or nil if no value is associated with key.
+ */
+- (nullable NSData *)mappedDataForKey:(NSString *)key;
+
 /**
  Sets the value of the specified key in the cache.
  This method may blocks the calling thread until file write finished.
@@ -240,6 +255,32 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)setObject:(nullable id<NSCoding>)object forKey:(NSString *)key withBlock:(void(^)(void))block;
 
+/**
+ Sets the content of a file as the archived value of the specified key in the cache.
+ This method may blocks the calling thread until file write finished.
+ 
+ @discussion The file's content is stored as is, without `customArchiveBlock`, so 
+ it should be the data which `customUnarchiveBlock` can read. The file is moved 
+ (not copied) into the cache if it's larger than `inlineThreshold`, so the value is 
+ saved atomically. The file is removed when this method returns.
+ 
+ @param path         The path of the file, typically created at `temporaryFilePath`.
+ @param extendedData The extended data for the value (pass nil to ignore it).
+ @param key          The key with which to associate the value. If nil, this method 
+                     only removes the file.
+ @return Whether succeed.
+ */
+- (BOOL)setFileAtPath:(NSString *)path extendedData:(nullable NSData *)extendedData forKey:(NSString *)key;
+
+/**
+ Returns a new path to write a file which will be passed to 
+ `setFileAtPath:extendedData:forKey:`.
+ 
+ @discussion The path is in the same volume with the cache, so the file can be
+ moved into the cache without copy. The file is not created by this method.
+ */
+- (nullable NSString *)temporaryFilePath;
+
 /**
  Removes the value of the specified key in the cache.
  This method may blocks the calling thread until file delete finished.
@@ -247,6 +247,14 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
     });
 }
 
+- (NSData *)mappedDataForKey:(NSString *)key {
+    if (!key) return nil;
+    Lock();
+    NSData *data = [_kv getItemMappedValueForKey:key];
+    Unlock();
+    return data;
+}
+
 - (void)setObject:(id<NSCoding>)object forKey:(NSString *)key {
     if (!key) return;
     if (!object) {
@@ -288,6 +296,37 @@ static void _YYDiskCacheSetGlobal(YYDiskCache *cache) {
     });
 }
 
+- (BOOL)setFileAtPath:(NSString *)path extendedData:(NSData *)extendedData forKey:(NSString *)key {
+    if (!path) return NO;
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:NULL];
+    unsigned long long size = [attributes fileSize];
+    BOOL suc = NO;
+    if (key && size > 0) {
+        if (_kv.type == YYKVStorageTypeSQLite || size <= _inlineThreshold) {
+            NSData *value = [NSData dataWithContentsOfFile:path];
+            if (value) {
+                Lock();
+                suc = [_kv saveItemWithKey:key value:value filename:nil extendedData:extendedData];
+                Unlock();
+            }
+        } else {
+            NSString *filename = [self _filenameForKey:key];
+            Lock();
+            suc = [_kv saveItemWithKey:key fileAtPath:path filename:filename extendedData:extendedData];
+            Unlock();
+        }
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+    return suc;
+}
+
+- (NSString *)temporaryFilePath {
+    Lock();
+    NSString *path = [_kv temporaryFilePath];
+    Unlock();
+    return path;
+}
+
 - (void)removeObjectForKey:(NSString *)key {
     if (!key) return;
     Lock();
@@ -160,6 +160,40 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
                filename:(nullable NSString *)filename
            extendedData:(nullable NSData *)extendedData;
 
+/**
+ Save an item with the content of a file, or update the item with 'key' if it 
+ already exists.
+ 
+ @discussion The file is moved (not copied) to the storage's data directory and 
+ named with `filename`, so the item is saved atomically: readers see either the 
+ old value or the whole file. The file should be in the same volume with the 
+ storage, typically created at `temporaryFilePath`. If this method failed, the 
+ file may still exist at `path`, and the caller should remove it.
+ 
+ If the `type` is YYKVStorageTypeSQLite, this method will failed.
+ 
+ @param key           The key, should not be empty (nil or zero length).
+ @param path          The path of the file, the file should not be empty.
+ @param filename      The filename, should not be empty (nil or zero length).
+ @param extendedData  The extended data for this item (pass nil to ignore it).
+ 
+ @return Whether succeed.
+ */
+- (BOOL)saveItemWithKey:(NSString *)key
+             fileAtPath:(NSString *)path
+               filename:(NSString *)filename
+           extendedData:(nullable NSData *)extendedData;
+
+/**
+ Returns a new path to write a file which will be saved with 
+ `saveItemWithKey:fileAtPath:filename:extendedData:`.
+ 
+ @discussion The path is in a temporary directory of the storage, the file is not 
+ created by this method. The files left in this directory (for example, when app 
+ crashed during writing) are removed when the storage is initialized next time.
+ */
+- (NSString *)temporaryFilePath;
+
 #pragma mark - Remove Items
 ///=============================================================================
 /// @name Remove Items
@@ -268,6 +302,31 @@ typedef NS_ENUM(NSUInteger, YYKVStorageType) {
  */
 - (nullable NSData *)getItemValueForKey:(NSString *)key;
 
+/**
+ Get item value with a specified key, the value stored in file is memory-mapped.
+ 
+ @discussion The file's pages are read on demand and can be purged by the system,
+ so a large value doesn't cost dirty memory. A value file is never rewritten in
+ place: it's replaced by renaming a new file and removed by unlinking, so the mapped
+ value is still valid after the item is replaced or removed.
+ 
+ @param key  A specified key.
+ @return Item's value, or nil if not exists / error occurs.
+ */
+- (nullable NSData *)getItemMappedValueForKey:(NSString *)key;
+
+/**
+ Get the recently accessed items, the access time is not updated.
+ 
+ @discussion It's used to load a small storage into memory. The values stored 
+ in files are read too, so it may be slow for a large file storage.
+ 
+ @param limit  The max count of items to get.
+ @return An array of `YYKVStorageItem` (the most recently accessed first), 
+    or nil if an error occurs.
+ */
+- (nullable NSArray<YYKVStorageItem *> *)getItemsWithLimit:(int)limit;
+
 /**
  Get items with an array of keys.
  
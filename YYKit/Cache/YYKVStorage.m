@@ -13,6 +13,8 @@
 #import "UIApplication+YYAdd.h"
 #import <UIKit/UIKit.h>
 #import <time.h>
+#import <sys/stat.h>
+#import <unistd.h>
 
 #if __has_include(<sqlite3.h>)
 #import <sqlite3.h>
@@ -29,6 +31,7 @@ static NSString *const kDBShmFileName = @"manifest.sqlite-shm";
 static NSString *const kDBWalFileName = @"manifest.sqlite-wal";
 static NSString *const kDataDirectoryName = @"data";
 static NSString *const kTrashDirectoryName = @"trash";
+static NSString *const kTempDirectoryName = @"tmp";
 
 /*
  File:
@@ -41,6 +44,8 @@ static NSString *const kTrashDirectoryName = @"trash";
            /e10adc3949ba59abbe56e057f20f883e
       /trash/
             /unused_file_or_folder
+      /tmp/
+          /file_being_written
  
  SQL:
  create table if not exists manifest (
@@ -66,6 +71,7 @@ static NSString *const kTrashDirectoryName = @"trash";
     NSString *_dbPath;
     NSString *_dataPath;
     NSString *_trashPath;
+    NSString *_tempPath;
     
     sqlite3 *_db;
     CFMutableDictionaryRef _dbStmtCache;
@@ -205,6 +211,10 @@ static NSString *const kTrashDirectoryName = @"trash";
 }
 
 - (BOOL)_dbSaveWithKey:(NSString *)key value:(NSData *)value fileName:(NSString *)fileName extendedData:(NSData *)extendedData {
+    return [self _dbSaveWithKey:key value:value size:(int)value.length fileName:fileName extendedData:extendedData];
+}
+
+- (BOOL)_dbSaveWithKey:(NSString *)key value:(NSData *)value size:(int)size fileName:(NSString *)fileName extendedData:(NSData *)extendedData {
     NSString *sql = @"insert or replace into manifest (key, filename, size, inline_data, modification_time, last_access_time, extended_data) values (?1, ?2, ?3, ?4, ?5, ?6, ?7);";
     sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
     if (!stmt) return NO;
@@ -212,7 +222,7 @@ static NSString *const kTrashDirectoryName = @"trash";
     int timestamp = (int)time(NULL);
     sqlite3_bind_text(stmt, 1, key.UTF8String, -1, NULL);
     sqlite3_bind_text(stmt, 2, fileName.UTF8String, -1, NULL);
-    sqlite3_bind_int(stmt, 3, (int)value.length);
+    sqlite3_bind_int(stmt, 3, size);
     if (fileName.length == 0) {
         sqlite3_bind_blob(stmt, 4, value.bytes, (int)value.length, 0);
     } else {
@@ -525,6 +535,29 @@ static NSString *const kTrashDirectoryName = @"trash";
     return filenames;
 }
 
+- (NSMutableArray *)_dbGetItemsOrderByTimeDescWithLimit:(int)count {
+    NSString *sql = @"select key, filename, size, inline_data, modification_time, last_access_time, extended_data from manifest order by last_access_time desc limit ?1;";
+    sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
+    if (!stmt) return nil;
+    sqlite3_bind_int(stmt, 1, count);
+    
+    NSMutableArray *items = [NSMutableArray new];
+    do {
+        int result = sqlite3_step(stmt);
+        if (result == SQLITE_ROW) {
+            YYKVStorageItem *item = [self _dbGetItemFromStmt:stmt excludeInlineData:NO];
+            if (item.key) [items addObject:item];
+        } else if (result == SQLITE_DONE) {
+            break;
+        } else {
+            if (_errorLogsEnabled) NSLog(@"%s line:%d sqlite query error (%d): %s", __FUNCTION__, __LINE__, result, sqlite3_errmsg(_db));
+            items = nil;
+            break;
+        }
+    } while (1);
+    return items;
+}
+
 - (NSMutableArray *)_dbGetItemSizeInfoOrderByTimeAscWithLimit:(int)count {
     NSString *sql = @"select key, filename, size from manifest order by last_access_time asc limit ?1;";
     sqlite3_stmt *stmt = [self _dbPrepareStmt:sql];
@@ -599,12 +632,17 @@ static NSString *const kTrashDirectoryName = @"trash";
 
 - (BOOL)_fileWriteWithName:(NSString *)filename data:(NSData *)data {
     NSString *path = [_dataPath stringByAppendingPathComponent:filename];
-    return [data writeToFile:path atomically:NO];
+    // write to a temporary file and rename, the old file may be mapped by a reader
+    return [data writeToFile:path options:NSDataWritingAtomic error:NULL];
 }
 
 - (NSData *)_fileReadWithName:(NSString *)filename {
+    return [self _fileReadWithName:filename mapped:NO];
+}
+
+- (NSData *)_fileReadWithName:(NSString *)filename mapped:(BOOL)mapped {
     NSString *path = [_dataPath stringByAppendingPathComponent:filename];
-    NSData *data = [NSData dataWithContentsOfFile:path];
+    NSData *data = [NSData dataWithContentsOfFile:path options:(mapped ? NSDataReadingMappedIfSafe : 0) error:NULL];
     return data;
 }
 
@@ -626,6 +664,16 @@ static NSString *const kTrashDirectoryName = @"trash";
     return suc;
 }
 
+- (BOOL)_fileMoveTempFilesToTrash {
+    CFUUIDRef uuidRef = CFUUIDCreate(NULL);
+    CFStringRef uuid = CFUUIDCreateString(NULL, uuidRef);
+    CFRelease(uuidRef);
+    NSString *tmpPath = [_trashPath stringByAppendingPathComponent:(__bridge NSString *)(uuid)];
+    BOOL suc = [[NSFileManager defaultManager] moveItemAtPath:_tempPath toPath:tmpPath error:nil];
+    CFRelease(uuid);
+    return suc;
+}
+
 - (void)_fileEmptyTrashInBackground {
     NSString *trashPath = _trashPath;
     dispatch_queue_t queue = _trashQueue;
@@ -676,9 +724,11 @@ static NSString *const kTrashDirectoryName = @"trash";
     _type = type;
     _dataPath = [path stringByAppendingPathComponent:kDataDirectoryName];
     _trashPath = [path stringByAppendingPathComponent:kTrashDirectoryName];
+    _tempPath = [path stringByAppendingPathComponent:kTempDirectoryName];
     _trashQueue = dispatch_queue_create("com.ibireme.cache.disk.trash", DISPATCH_QUEUE_SERIAL);
     _dbPath = [path stringByAppendingPathComponent:kDBFileName];
     _errorLogsEnabled = YES;
+    [self _fileMoveTempFilesToTrash]; // the files which were not saved at last time
     NSError *error = nil;
     if (![[NSFileManager defaultManager] createDirectoryAtPath:path
                                    withIntermediateDirectories:YES
@@ -689,6 +739,10 @@ static NSString *const kTrashDirectoryName = @"trash";
                                                     attributes:nil
                                                          error:&error] ||
         ![[NSFileManager defaultManager] createDirectoryAtPath:[path stringByAppendingPathComponent:kTrashDirectoryName]
+                                   withIntermediateDirectories:YES
+                                                    attributes:nil
+                                                         error:&error] ||
+        ![[NSFileManager defaultManager] createDirectoryAtPath:[path stringByAppendingPathComponent:kTempDirectoryName]
                                    withIntermediateDirectories:YES
                                                     attributes:nil
                                                          error:&error]) {
@@ -752,6 +806,34 @@ static NSString *const kTrashDirectoryName = @"trash";
     }
 }
 
+- (BOOL)saveItemWithKey:(NSString *)key fileAtPath:(NSString *)path filename:(NSString *)filename extendedData:(NSData *)extendedData {
+    if (key.length == 0 || path.length == 0 || filename.length == 0) return NO;
+    if (_type == YYKVStorageTypeSQLite) return NO;
+    
+    struct stat st;
+    if (stat(path.fileSystemRepresentation, &st) != 0) return NO;
+    if (st.st_size <= 0 || st.st_size > INT_MAX) return NO;
+    
+    NSString *dataPath = [_dataPath stringByAppendingPathComponent:filename];
+    if (rename(path.fileSystemRepresentation, dataPath.fileSystemRepresentation) != 0) { // atomic, replaces the old file
+        return NO;
+    }
+    if (![self _dbSaveWithKey:key value:nil size:(int)st.st_size fileName:filename extendedData:extendedData]) {
+        [self _fileDeleteWithName:filename];
+        return NO;
+    }
+    return YES;
+}
+
+- (NSString *)temporaryFilePath {
+    CFUUIDRef uuidRef = CFUUIDCreate(NULL);
+    CFStringRef uuid = CFUUIDCreateString(NULL, uuidRef);
+    CFRelease(uuidRef);
+    NSString *path = [_tempPath stringByAppendingPathComponent:(__bridge NSString *)(uuid)];
+    CFRelease(uuid);
+    return path;
+}
+
 - (BOOL)removeItemForKey:(NSString *)key {
     if (key.length == 0) return NO;
     switch (_type) {
@@ -963,13 +1045,21 @@ static NSString *const kTrashDirectoryName = @"trash";
 }
 
 - (NSData *)getItemValueForKey:(NSString *)key {
+    return [self _getItemValueForKey:key mapped:NO];
+}
+
+- (NSData *)getItemMappedValueForKey:(NSString *)key {
+    return [self _getItemValueForKey:key mapped:YES];
+}
+
+- (NSData *)_getItemValueForKey:(NSString *)key mapped:(BOOL)mapped {
     if (key.length == 0) return nil;
     NSData *value = nil;
     switch (_type) {
         case YYKVStorageTypeFile: {
             NSString *filename = [self _dbGetFilenameWithKey:key];
             if (filename) {
-                value = [self _fileReadWithName:filename];
+                value = [self _fileReadWithName:filename mapped:mapped];
                 if (!value) {
                     [self _dbDeleteItemWithKey:key];
                     value = nil;
@@ -982,7 +1072,7 @@ static NSString *const kTrashDirectoryName = @"trash";
         case YYKVStorageTypeMixed: {
             NSString *filename = [self _dbGetFilenameWithKey:key];
             if (filename) {
-                value = [self _fileReadWithName:filename];
+                value = [self _fileReadWithName:filename mapped:mapped];
                 if (!value) {
                     [self _dbDeleteItemWithKey:key];
                     value = nil;
@@ -998,6 +1088,26 @@ static NSString *const kTrashDirectoryName = @"trash";
     return value;
 }
 
+- (NSArray *)getItemsWithLimit:(int)limit {
+    if (limit <= 0) return nil;
+    NSMutableArray *items = [self _dbGetItemsOrderByTimeDescWithLimit:limit];
+    if (_type != YYKVStorageTypeSQLite) {
+        for (NSInteger i = 0, max = items.count; i < max; i++) {
+            YYKVStorageItem *item = items[i];
+            if (item.filename) {
+                item.value = [self _fileReadWithName:item.filename];
+                if (!item.value) {
+                    if (item.key) [self _dbDeleteItemWithKey:item.key];
+                    [items removeObjectAtIndex:i];
+                    i--;
+                    max--;
+                }
+            }
+        }
+    }
+    return items;
+}
+
 - (NSArray *)getItemForKeys:(NSArray *)keys {
     if (keys.count == 0) return nil;
     NSMutableArray *items = [self _dbGetItemWithKeys:keys excludeInlineData:NO];
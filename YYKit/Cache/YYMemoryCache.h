@@ -169,6 +169,18 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)setObject:(nullable id)object forKey:(id)key withCost:(NSUInteger)cost;
 
+/**
+ Changes the cost of the specified key-value pair, for an object whose memory 
+ usage has changed after it's stored. The key-value pair is not moved in the
+ LRU list, and the cache is trimmed if the total cost exceeds the `costLimit`.
+ 
+ @param cost   The new cost.
+ @param object The object stored in the cache. If the key is associated with
+               another object, this method has no effect.
+ @param key    The key with which the object is associated.
+ */
+- (void)updateCost:(NSUInteger)cost ofObject:(id)object forKey:(id)key;
+
 /**
  Removes the value of the specified key in the cache.
  
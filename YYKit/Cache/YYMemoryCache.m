@@ -464,6 +464,23 @@ static inline dispatch_queue_t YYMemoryCacheGetReleaseQueue() {
     pthread_mutex_unlock(&_lock);
 }
 
+- (void)updateCost:(NSUInteger)cost ofObject:(id)object forKey:(id)key {
+    if (!key || !object) return;
+    pthread_mutex_lock(&_lock);
+    _YYLinkedMapNode *node = CFDictionaryGetValue(_lru->_dic, (__bridge const void *)(key));
+    if (node && node->_value == object) {
+        _lru->_totalCost -= node->_cost;
+        _lru->_totalCost += cost;
+        node->_cost = cost;
+        if (_lru->_totalCost > _costLimit) {
+            dispatch_async(_queue, ^{
+                [self trimToCost:_costLimit];
+            });
+        }
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
 - (void)removeObjectForKey:(id)key {
     if (!key) return;
     pthread_mutex_lock(&_lock);
@@ -117,11 +117,12 @@ static int _YYWebImageSetterKey;
         }
         
         // get the image from memory as quickly as possible
+        CGSize pixelSize = _YYWebImagePixelSize(self.bounds.size, options);
         UIImage *imageFromMemory = nil;
         if (manager.cache &&
             !(options & YYWebImageOptionUseNSURLCache) &&
             !(options & YYWebImageOptionRefreshImageCache)) {
-            imageFromMemory = [manager.cache getImageForKey:[manager cacheKeyForURL:imageURL] withType:YYImageCacheTypeMemory];
+            imageFromMemory = [manager.cache getImageForKey:[manager cacheKeyForURL:imageURL] withType:YYImageCacheTypeMemory pixelSize:pixelSize];
         }
         if (imageFromMemory) {
             if (!(options & YYWebImageOptionAvoidSetImage)) {
@@ -172,7 +173,7 @@ static int _YYWebImageSetterKey;
                 });
             };
             
-            newSentinel = [setter setOperationWithSentinel:sentinel url:imageURL options:options manager:manager progress:_progress transform:transform completion:_completion];
+            newSentinel = [setter setOperationWithSentinel:sentinel url:imageURL options:options manager:manager pixelSize:pixelSize progress:_progress transform:transform completion:_completion];
             weakSetter = setter;
         });
     });
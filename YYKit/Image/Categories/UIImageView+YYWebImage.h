@@ -105,6 +105,18 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)cancelCurrentImageRequest;
 
+/**
+ The priority of the image requests (both image and highlighted image).
+ Default is YYWebImagePriorityVisible.
+ 
+ @discussion Change this value when the view moves, for example, set it to
+ `YYWebImagePriorityPrefetch` in `tableView:didEndDisplayingCell:forRowAtIndexPath:`
+ and `YYWebImagePriorityVisible` in `tableView:willDisplayCell:forRowAtIndexPath:`,
+ so the manager fetches the images of visible cells first. The priority of a 
+ waiting request is updated immediately.
+ */
+@property (nonatomic) YYWebImagePriority imagePriority;
+
 
 
 #pragma mark - highlight image
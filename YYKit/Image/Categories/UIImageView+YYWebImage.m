@@ -125,11 +125,12 @@ static int _YYWebImageHighlightedSetterKey;
         }
         
         // get the image from memory as quickly as possible
+        CGSize pixelSize = _YYWebImagePixelSize(self.bounds.size, options);
         UIImage *imageFromMemory = nil;
         if (manager.cache &&
             !(options & YYWebImageOptionUseNSURLCache) &&
             !(options & YYWebImageOptionRefreshImageCache)) {
-            imageFromMemory = [manager.cache getImageForKey:[manager cacheKeyForURL:imageURL] withType:YYImageCacheTypeMemory];
+            imageFromMemory = [manager.cache getImageForKey:[manager cacheKeyForURL:imageURL] withType:YYImageCacheTypeMemory pixelSize:pixelSize];
         }
         if (imageFromMemory) {
             if (!(options & YYWebImageOptionAvoidSetImage)) {
@@ -180,7 +181,7 @@ static int _YYWebImageHighlightedSetterKey;
                 });
             };
             
-            newSentinel = [setter setOperationWithSentinel:sentinel url:imageURL options:options manager:manager progress:_progress transform:transform completion:_completion];
+            newSentinel = [setter setOperationWithSentinel:sentinel url:imageURL options:options manager:manager pixelSize:pixelSize progress:_progress transform:transform completion:_completion];
             weakSetter = setter;
         });
     });
@@ -191,6 +192,27 @@ static int _YYWebImageHighlightedSetterKey;
     if (setter) [setter cancel];
 }
 
+- (YYWebImagePriority)imagePriority {
+    _YYWebImageSetter *setter = objc_getAssociatedObject(self, &_YYWebImageSetterKey);
+    return setter ? setter.priority : YYWebImagePriorityVisible;
+}
+
+- (void)setImagePriority:(YYWebImagePriority)imagePriority {
+    _YYWebImageSetter *setter = objc_getAssociatedObject(self, &_YYWebImageSetterKey);
+    if (!setter) {
+        setter = [_YYWebImageSetter new];
+        objc_setAssociatedObject(self, &_YYWebImageSetterKey, setter, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    setter.priority = imagePriority;
+    
+    _YYWebImageSetter *highlightedSetter = objc_getAssociatedObject(self, &_YYWebImageHighlightedSetterKey);
+    if (!highlightedSetter) {
+        highlightedSetter = [_YYWebImageSetter new];
+        objc_setAssociatedObject(self, &_YYWebImageHighlightedSetterKey, highlightedSetter, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    highlightedSetter.priority = imagePriority;
+}
+
 
 #pragma mark - highlighted image
 
@@ -289,11 +311,12 @@ static int _YYWebImageHighlightedSetterKey;
         }
         
         // get the image from memory as quickly as possible
+        CGSize pixelSize = _YYWebImagePixelSize(self.bounds.size, options);
         UIImage *imageFromMemory = nil;
         if (manager.cache &&
             !(options & YYWebImageOptionUseNSURLCache) &&
             !(options & YYWebImageOptionRefreshImageCache)) {
-            imageFromMemory = [manager.cache getImageForKey:[manager cacheKeyForURL:imageURL] withType:YYImageCacheTypeMemory];
+            imageFromMemory = [manager.cache getImageForKey:[manager cacheKeyForURL:imageURL] withType:YYImageCacheTypeMemory pixelSize:pixelSize];
         }
         if (imageFromMemory) {
             if (!(options & YYWebImageOptionAvoidSetImage)) {
@@ -344,7 +367,7 @@ static int _YYWebImageHighlightedSetterKey;
                 });
             };
             
-            newSentinel = [setter setOperationWithSentinel:sentinel url:imageURL options:options manager:manager progress:_progress transform:transform completion:_completion];
+            newSentinel = [setter setOperationWithSentinel:sentinel url:imageURL options:options manager:manager pixelSize:pixelSize progress:_progress transform:transform completion:_completion];
             weakSetter = setter;
         });
     });
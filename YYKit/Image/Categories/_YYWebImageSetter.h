@@ -21,6 +21,14 @@ extern NSString *const _YYWebImageFadeAnimationKey;
 extern const NSTimeInterval _YYWebImageFadeTime;
 extern const NSTimeInterval _YYWebImageProgressiveFadeTime;
 
+/// Returns the target pixel size of a view for `YYWebImageOptionDownsampleToViewSize`,
+/// or CGSizeZero if the option is not set. Should be called on main thread.
+static inline CGSize _YYWebImagePixelSize(CGSize viewSize, YYWebImageOptions options) {
+    if (!(options & YYWebImageOptionDownsampleToViewSize)) return CGSizeZero;
+    CGFloat scale = [UIScreen mainScreen].scale;
+    return CGSizeMake(ceil(viewSize.width * scale), ceil(viewSize.height * scale));
+}
+
 /**
  Private class used by web image categories.
  Typically, you should not use this class directly.
@@ -30,12 +38,15 @@ extern const NSTimeInterval _YYWebImageProgressiveFadeTime;
 @property (nullable, nonatomic, readonly) NSURL *imageURL;
 /// Current sentinel.
 @property (nonatomic, readonly) int32_t sentinel;
+/// The priority of current and later operations.
+@property (nonatomic) YYWebImagePriority priority;
 
 /// Create new operation for web image and return a sentinel value.
 - (int32_t)setOperationWithSentinel:(int32_t)sentinel
                                 url:(nullable NSURL *)imageURL
                             options:(YYWebImageOptions)options
                             manager:(YYWebImageManager *)manager
+                          pixelSize:(CGSize)pixelSize
                            progress:(nullable YYWebImageProgressBlock)progress
                           transform:(nullable YYWebImageTransformBlock)transform
                          completion:(nullable YYWebImageCompletionBlock)completion;
@@ -21,16 +21,33 @@ const NSTimeInterval _YYWebImageProgressiveFadeTime = 0.4;
 @implementation _YYWebImageSetter {
     dispatch_semaphore_t _lock;
     NSURL *_imageURL;
-    NSOperation *_operation;
+    YYWebImageOperation *_operation;
     int32_t _sentinel;
+    YYWebImagePriority _priority;
 }
 
 - (instancetype)init {
     self = [super init];
     _lock = dispatch_semaphore_create(1);
+    _priority = YYWebImagePriorityVisible;
     return self;
 }
 
+- (YYWebImagePriority)priority {
+    dispatch_semaphore_wait(_lock, DISPATCH_TIME_FOREVER);
+    YYWebImagePriority priority = _priority;
+    dispatch_semaphore_signal(_lock);
+    return priority;
+}
+
+- (void)setPriority:(YYWebImagePriority)priority {
+    dispatch_semaphore_wait(_lock, DISPATCH_TIME_FOREVER);
+    _priority = priority;
+    YYWebImageOperation *operation = _operation;
+    dispatch_semaphore_signal(_lock);
+    operation.priority = priority;
+}
+
 - (NSURL *)imageURL {
     dispatch_semaphore_wait(_lock, DISPATCH_TIME_FOREVER);
     NSURL *imageURL = _imageURL;
@@ -47,6 +64,7 @@ const NSTimeInterval _YYWebImageProgressiveFadeTime = 0.4;
                                 url:(NSURL *)imageURL
                             options:(YYWebImageOptions)options
                             manager:(YYWebImageManager *)manager
+                          pixelSize:(CGSize)pixelSize
                            progress:(YYWebImageProgressBlock)progress
                           transform:(YYWebImageTransformBlock)transform
                          completion:(YYWebImageCompletionBlock)completion {
@@ -55,7 +73,8 @@ const NSTimeInterval _YYWebImageProgressiveFadeTime = 0.4;
         return _sentinel;
     }
     
-    NSOperation *operation = [manager requestImageWithURL:imageURL options:options progress:progress transform:transform completion:completion];
+    YYWebImageOperation *operation = [manager requestImageWithURL:imageURL options:options pixelSize:pixelSize progress:progress transform:transform completion:completion];
+    operation.priority = self.priority;
     if (!operation && completion) {
         NSDictionary *userInfo = @{ NSLocalizedDescriptionKey : @"YYWebImageOperation create failed." };
         completion(nil, imageURL, YYWebImageFromNone, YYWebImageStageFinished, [NSError errorWithDomain:@"com.ibireme.yykit.webimage" code:-1 userInfo:userInfo]);
@@ -11,6 +11,9 @@
 
 #import <UIKit/UIKit.h>
 
+@class YYMemoryCache;
+@protocol YYAnimatedImage;
+
 NS_ASSUME_NONNULL_BEGIN
 
 /**
@@ -80,6 +83,85 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic) NSUInteger maxBufferSize;
 
+/**
+ How far (in seconds) the decoded frames should lead ahead of playback, default is 0.3.
+ 
+ @discussion The view measures the decode time of frames, and keeps at least 
+ `prefetchLeadTime` plus one frame's decode time of future frames in buffer (if 
+ the memory budget allows). If the image supports concurrent decoding (for example 
+ GIF or WebP with independent frames), these frames are decoded in parallel.
+ */
+@property (nonatomic) NSTimeInterval prefetchLeadTime;
+
+/**
+ The number of display refreshes at which the next frame was due but not decoded 
+ yet (the animation stalls). It's reset to 0 when the image changes.
+ 
+ It can be used to measure the playback smoothness.
+ */
+@property (nonatomic, readonly) NSUInteger droppedFrameCount;
+
+/**
+ Whether to share the decoded frames with other views through 
+ `[YYAnimatedImageFrameCache sharedCache]`, default is YES.
+ 
+ @discussion When several views display the same animated image, each frame is
+ decoded only once, and the views share a global memory budget. It has no effect
+ for the image which implements `animatedImageContentsRectAtIndex:` (sprite sheet).
+ */
+@property (nonatomic) BOOL shareFrameCache;
+
+@end
+
+
+
+/**
+ A process-wide cache for the decoded frames of animated images, shared by all
+ YYAnimatedImageView instances.
+ 
+ @discussion The frames are keyed by (image identity, frame index, scale). Images
+ created with the same `animatedImageData` object are treated as identical. The
+ total cost is limited by `memoryCache.costLimit`, and each animating view gets a
+ fair share of it for its inner frame buffer.
+ */
+@interface YYAnimatedImageFrameCache : NSObject
+
+/**
+ Returns global shared frame cache instance.
+ @return The singleton YYAnimatedImageFrameCache instance.
+ */
++ (instancetype)sharedCache;
+
+/** 
+ The underlying memory cache. The `costLimit` is the global byte budget, default 
+ is 20% of the device memory (but not larger than 60% of the free memory).
+ */
+@property (strong, readonly) YYMemoryCache *memoryCache;
+
+/** The number of views which are playing animation with shared frames. */
+@property (readonly) NSUInteger activeViewCount;
+
+/** The bytes each active view may use for its inner frame buffer. */
+@property (readonly) NSUInteger fairShareBytes;
+
+/**
+ Returns the cached frame, or nil if the frame is not decoded yet.
+ @param image An animated image.
+ @param index Frame index (zero based).
+ */
+- (nullable UIImage *)cachedFrameForImage:(UIImage<YYAnimatedImage> *)image index:(NSUInteger)index;
+
+/**
+ Returns the decoded frame from cache, or decodes and caches it if it's not cached.
+ If another thread is decoding the same frame, this method waits for its result.
+ 
+ @discussion This method may block the calling thread, do not call it on main thread.
+ @param image An animated image.
+ @param index Frame index (zero based).
+ @return The frame decoded for display, or nil if an error occurs.
+ */
+- (nullable UIImage *)frameForImage:(UIImage<YYAnimatedImage> *)image index:(NSUInteger)index;
+
 @end
 
 
@@ -120,6 +202,10 @@ NS_ASSUME_NONNULL_BEGIN
 /// will be displayed. The rectangle should not outside the image's bounds.
 /// It may used to display sprite animation with a single image (sprite sheet).
 - (CGRect)animatedImageContentsRectAtIndex:(NSUInteger)index;
+
+/// Whether `animatedImageFrameAtIndex:` can be called concurrently from multiple 
+/// threads. If YES, YYAnimatedImageView may decode several future frames in parallel.
+- (BOOL)animatedImageSupportsConcurrentDecoding;
 @end
 
 NS_ASSUME_NONNULL_END
@@ -13,7 +13,11 @@
 #import "YYWeakProxy.h"
 #import "UIDevice+YYAdd.h"
 #import "YYImageCoder.h"
+#import "YYImage.h"
+#import "YYMemoryCache.h"
 #import "YYKitMacro.h"
+#import <objc/runtime.h>
+#import <pthread.h>
 
 #define BUFFER_SIZE (10 * 1024 * 1024) // 10MB (minimum memory buffer size)
 
@@ -56,12 +60,28 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
     BOOL _bufferMiss; ///< whether miss frame on last opportunity
     NSUInteger _maxBufferCount; ///< maximum buffer count
     NSInteger _incrBufferCount; ///< current allowed buffer count (will increase by step)
+    NSTimeInterval _decodeCost; ///< moving average of the decode time of a frame
     
     CGRect _curContentsRect;
     BOOL _curImageHasContentsRect; ///< image has implementated "animatedImageContentsRectAtIndex:"
+    BOOL _activeInFrameCache; ///< counted as an active view by the shared frame cache
+    
+    __weak YYImage *_reportedImage; ///< image which the buffered frames are reported to
+    NSUInteger _reportedBufferSize; ///< buffered bytes reported to `_reportedImage`
 }
 @property (nonatomic, readwrite) BOOL currentIsPlayingAnimation;
+@property (nonatomic, readwrite) NSUInteger droppedFrameCount;
 - (void)calcMaxBufferCount;
+- (void)updateBufferedFramesSize;
+@end
+
+@interface YYImage (YYAnimatedImageView)
+- (void)_addBufferedFramesSize:(NSInteger)delta;
+@end
+
+@interface YYAnimatedImageFrameCache ()
+- (void)_viewDidBecomeActive;
+- (void)_viewDidResignActive;
 @end
 
 /// An operation for image fetch
@@ -69,6 +89,7 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
 @property (nonatomic, weak) YYAnimatedImageView *view;
 @property (nonatomic, assign) NSUInteger nextIndex;
 @property (nonatomic, strong) UIImage <YYAnimatedImage> *curImage;
+@property (nonatomic, assign) BOOL useSharedCache;
 @end
 
 @implementation _YYAnimatedImageViewFetchOperation
@@ -81,27 +102,89 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
     if (view->_incrBufferCount > (NSInteger)view->_maxBufferCount) {
         view->_incrBufferCount = view->_maxBufferCount;
     }
-    NSUInteger idx = _nextIndex;
-    NSUInteger max = view->_incrBufferCount < 1 ? 1 : view->_incrBufferCount;
+    NSInteger maxCount = view->_maxBufferCount;
+    if (_useSharedCache) { // fair share of the global budget
+        NSUInteger bytes = _curImage.animatedImageBytesPerFrame;
+        NSInteger fairCount = [YYAnimatedImageFrameCache sharedCache].fairShareBytes / (bytes ? bytes : 1024);
+        if (fairCount < 1) fairCount = 1;
+        if (maxCount > fairCount) maxCount = fairCount;
+        if (view->_incrBufferCount > fairCount) view->_incrBufferCount = fairCount;
+    }
     NSUInteger total = view->_totalFrameCount;
+    NSTimeInterval lead = view.prefetchLeadTime + view->_decodeCost;
+    NSInteger incr = view->_incrBufferCount;
     view = nil;
     
+    // frames required to keep `lead` seconds ahead of playback
+    NSUInteger leadCount = 0;
+    NSTimeInterval leadTime = 0;
+    for (NSUInteger idx = _nextIndex; leadCount < total && leadTime < lead; idx = (idx + 1) % total) {
+        leadTime += [_curImage animatedImageDurationAtIndex:idx];
+        leadCount++;
+    }
+    if ((NSInteger)leadCount > maxCount) leadCount = maxCount;
+    if (leadCount < 1) leadCount = 1;
+    NSUInteger max = MAX((NSInteger)leadCount, MIN(incr, maxCount));
+    
+    // decode the leading frames in parallel if the frames are independent
+    BOOL concurrent = leadCount > 1 &&
+                      [_curImage respondsToSelector:@selector(animatedImageSupportsConcurrentDecoding)] &&
+                      [_curImage animatedImageSupportsConcurrentDecoding];
+    if (concurrent) {
+        NSUInteger *indexes = malloc(leadCount * sizeof(NSUInteger));
+        NSUInteger count = 0;
+        view = _view;
+        if (view && indexes) {
+            LOCK_VIEW(
+                for (NSUInteger i = 0, idx = _nextIndex % total; i < leadCount; i++, idx = (idx + 1) % total) {
+                    if (view->_buffer[@(idx)] == nil) indexes[count++] = idx;
+                }
+            )
+        }
+        view = nil;
+        if (indexes && count > 1) {
+            dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+                @autoreleasepool {
+                    [self fetchFrameAtIndex:indexes[i]];
+                }
+            });
+        }
+        if (indexes) free(indexes);
+    }
+    
+    NSUInteger idx = _nextIndex;
     for (int i = 0; i < max; i++, idx++) {
         @autoreleasepool {
             if (idx >= total) idx = 0;
-            if ([self isCancelled]) break;
-            __strong YYAnimatedImageView *view = _view;
-            if (!view) break;
-            LOCK_VIEW(BOOL miss = (view->_buffer[@(idx)] == nil));
-            if (miss) {
-                UIImage *img = [_curImage animatedImageFrameAtIndex:idx];
-                img = img.imageByDecoded;
-                if ([self isCancelled]) break;
-                LOCK_VIEW(view->_buffer[@(idx)] = img ? img : [NSNull null]);
-                view = nil;
-            }
+            if (![self fetchFrameAtIndex:idx]) break;
         }
     }
+    [_view updateBufferedFramesSize];
+}
+
+/// Decodes a frame into view's buffer if it's not buffered, returns NO if the operation should stop.
+- (BOOL)fetchFrameAtIndex:(NSUInteger)idx {
+    if ([self isCancelled]) return NO;
+    __strong YYAnimatedImageView *view = _view;
+    if (!view) return NO;
+    LOCK_VIEW(BOOL miss = (view->_buffer[@(idx)] == nil));
+    if (!miss) return YES;
+    
+    CFTimeInterval begin = CACurrentMediaTime();
+    UIImage *img = nil;
+    if (_useSharedCache) {
+        img = [[YYAnimatedImageFrameCache sharedCache] frameForImage:_curImage index:idx];
+    } else {
+        img = [_curImage animatedImageFrameAtIndex:idx];
+        img = img.imageByDecoded;
+    }
+    CFTimeInterval cost = CACurrentMediaTime() - begin;
+    if ([self isCancelled]) return NO;
+    LOCK_VIEW(
+        view->_buffer[@(idx)] = img ? img : [NSNull null];
+        view->_decodeCost = view->_decodeCost > 0 ? view->_decodeCost * 0.8 + cost * 0.2 : cost;
+    )
+    return YES;
 }
 @end
 
@@ -111,6 +194,8 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
     self = [super init];
     _runloopMode = NSRunLoopCommonModes;
     _autoPlayAnimatedImage = YES;
+    _shareFrameCache = YES;
+    _prefetchLeadTime = 0.3;
     return self;
 }
 
@@ -118,6 +203,8 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
     self = [super initWithFrame:frame];
     _runloopMode = NSRunLoopCommonModes;
     _autoPlayAnimatedImage = YES;
+    _shareFrameCache = YES;
+    _prefetchLeadTime = 0.3;
     return self;
 }
 
@@ -125,6 +212,8 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
     self = [super init];
     _runloopMode = NSRunLoopCommonModes;
     _autoPlayAnimatedImage = YES;
+    _shareFrameCache = YES;
+    _prefetchLeadTime = 0.3;
     self.frame = (CGRect) {CGPointZero, image.size };
     self.image = image;
     return self;
@@ -134,6 +223,8 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
     self = [super init];
     _runloopMode = NSRunLoopCommonModes;
     _autoPlayAnimatedImage = YES;
+    _shareFrameCache = YES;
+    _prefetchLeadTime = 0.3;
     CGSize size = image ? image.size : highlightedImage.size;
     self.frame = (CGRect) {CGPointZero, size };
     self.image = image;
@@ -171,6 +262,7 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
          }
     );
     _link.paused = YES;
+    [self setActiveInFrameCache:NO];
     _time = 0;
     if (_curIndex != 0) {
         [self willChangeValueForKey:@"currentAnimatedImageIndex"];
@@ -185,6 +277,9 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
     _loopEnd = NO;
     _bufferMiss = NO;
     _incrBufferCount = 0;
+    _decodeCost = 0;
+    _droppedFrameCount = 0;
+    [self updateBufferedFramesSize];
 }
 
 - (void)setImage:(UIImage *)image {
@@ -299,16 +394,66 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
     int64_t max = MIN(total * 0.2, free * 0.6);
     max = MAX(max, BUFFER_SIZE);
     if (_maxBufferSize) max = max > _maxBufferSize ? _maxBufferSize : max;
+    if (_activeInFrameCache) max = MIN(max, (int64_t)[YYAnimatedImageFrameCache sharedCache].fairShareBytes);
     double maxBufferCount = (double)max / (double)bytes;
     maxBufferCount = YY_CLAMP(maxBufferCount, 1, 512);
     _maxBufferCount = maxBufferCount;
 }
 
+// report the buffered frames to the image, so caches can count them in its cost.
+- (void)updateBufferedFramesSize {
+    if (!_lock) return;
+    YYImage *oldImage = nil, *newImage = nil;
+    NSUInteger oldSize = 0, newSize = 0;
+    LOCK(
+         UIImage <YYAnimatedImage> *image = _curAnimatedImage;
+         YYImage *curImage = [image isKindOfClass:[YYImage class]] ? (YYImage *)image : nil;
+         NSUInteger size = curImage ? _buffer.count * curImage.animatedImageBytesPerFrame : 0;
+         YYImage *reported = _reportedImage;
+         NSUInteger delta = size > _reportedBufferSize ? size - _reportedBufferSize : _reportedBufferSize - size;
+         // skip the small changes, the buffer gains and loses a frame on every step
+         if (reported != curImage || (size != _reportedBufferSize && (size == 0 || delta >= _reportedBufferSize / 4))) {
+             oldImage = reported;
+             oldSize = _reportedBufferSize;
+             newImage = curImage;
+             newSize = size;
+             _reportedImage = curImage;
+             _reportedBufferSize = curImage ? size : 0;
+         }
+    )//LOCK
+    if (oldImage == newImage) {
+        [newImage _addBufferedFramesSize:(NSInteger)newSize - (NSInteger)oldSize];
+    } else {
+        [oldImage _addBufferedFramesSize:-(NSInteger)oldSize];
+        [newImage _addBufferedFramesSize:(NSInteger)newSize];
+    }
+}
+
+- (void)setActiveInFrameCache:(BOOL)active {
+    if (active) active = _shareFrameCache && !_curImageHasContentsRect;
+    if (_activeInFrameCache == active) return;
+    _activeInFrameCache = active;
+    if (active) {
+        [[YYAnimatedImageFrameCache sharedCache] _viewDidBecomeActive];
+    } else {
+        [[YYAnimatedImageFrameCache sharedCache] _viewDidResignActive];
+    }
+}
+
+- (void)setShareFrameCache:(BOOL)shareFrameCache {
+    if (_shareFrameCache == shareFrameCache) return;
+    _shareFrameCache = shareFrameCache;
+    if (!shareFrameCache) [self setActiveInFrameCache:NO];
+    else if (_curAnimatedImage && !_link.paused) [self setActiveInFrameCache:YES];
+}
+
 - (void)dealloc {
+    [self setActiveInFrameCache:NO];
     [_requestQueue cancelAllOperations];
     [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
     [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidEnterBackgroundNotification object:nil];
     [_link invalidate];
+    [_reportedImage _addBufferedFramesSize:-(NSInteger)_reportedBufferSize];
 }
 
 - (BOOL)isAnimating {
@@ -319,6 +464,7 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
     [super stopAnimating];
     [_requestQueue cancelAllOperations];
     _link.paused = YES;
+    [self setActiveInFrameCache:NO];
     self.currentIsPlayingAnimation = NO;
 }
 
@@ -335,6 +481,8 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
             _curLoop = 0;
             _loopEnd = NO;
             _link.paused = NO;
+            [self setActiveInFrameCache:YES];
+            [self calcMaxBufferCount];
             self.currentIsPlayingAnimation = YES;
         }
     }
@@ -353,6 +501,7 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
                  }
              }
         )//LOCK
+        [self updateBufferedFramesSize];
     }];
 }
 
@@ -367,6 +516,7 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
              }
          }
      )//LOCK
+    [self updateBufferedFramesSize];
 }
 
 - (void)step:(CADisplayLink *)link {
@@ -402,6 +552,10 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
     }
     LOCK(
          bufferedImage = buffer[@(nextIndex)];
+         if (!bufferedImage && _activeInFrameCache) { // may be decoded by another view
+             bufferedImage = [[YYAnimatedImageFrameCache sharedCache] cachedFrameForImage:image index:nextIndex];
+             if (bufferedImage) buffer[@(nextIndex)] = bufferedImage;
+         }
          if (bufferedImage) {
              if ((int)_incrBufferCount < _totalFrameCount) {
                  [buffer removeObjectForKey:@(nextIndex)];
@@ -421,6 +575,7 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
              }
          } else {
              _bufferMiss = YES;
+             _droppedFrameCount++;
          }
     )//LOCK
     
@@ -433,6 +588,7 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
         operation.view = self;
         operation.nextIndex = nextIndex;
         operation.curImage = image;
+        operation.useSharedCache = _activeInFrameCache;
         [_requestQueue addOperation:operation];
     }
 }
@@ -505,6 +661,7 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
              _bufferMiss = NO;
              [self.layer setNeedsDisplay];
          )//LOCK
+        [self updateBufferedFramesSize];
     });
 }
 
@@ -545,6 +702,16 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
     } else {
         _autoPlayAnimatedImage = YES;
     }
+    if ([aDecoder containsValueForKey:@"shareFrameCache"]) {
+        _shareFrameCache = [aDecoder decodeBoolForKey:@"shareFrameCache"];
+    } else {
+        _shareFrameCache = YES;
+    }
+    if ([aDecoder containsValueForKey:@"prefetchLeadTime"]) {
+        _prefetchLeadTime = [aDecoder decodeDoubleForKey:@"prefetchLeadTime"];
+    } else {
+        _prefetchLeadTime = 0.3;
+    }
     
     UIImage *image = [aDecoder decodeObjectForKey:@"YYAnimatedImage"];
     UIImage *highlightedImage = [aDecoder decodeObjectForKey:@"YYHighlightedAnimatedImage"];
@@ -563,6 +730,8 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
     [super encodeWithCoder:aCoder];
     [aCoder encodeObject:_runloopMode forKey:@"runloopMode"];
     [aCoder encodeBool:_autoPlayAnimatedImage forKey:@"autoPlayAnimatedImage"];
+    [aCoder encodeBool:_shareFrameCache forKey:@"shareFrameCache"];
+    [aCoder encodeDouble:_prefetchLeadTime forKey:@"prefetchLeadTime"];
     
     BOOL ani, multi;
     ani = [self.image conformsToProtocol:@protocol(YYAnimatedImage)];
@@ -575,3 +744,125 @@ typedef NS_ENUM(NSUInteger, YYAnimatedImageType) {
 }
 
 @end
+
+
+
+@implementation YYAnimatedImageFrameCache {
+    pthread_mutex_t _lock;
+    pthread_cond_t _condition; ///< signaled when a frame decoding finished
+    NSMutableSet *_decodingKeys;
+    uint64_t _identitySeed;
+    NSUInteger _activeViewCount;
+}
+
++ (instancetype)sharedCache {
+    static YYAnimatedImageFrameCache *cache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [self new];
+    });
+    return cache;
+}
+
+- (instancetype)init {
+    self = [super init];
+    pthread_mutex_init(&_lock, NULL);
+    pthread_cond_init(&_condition, NULL);
+    _decodingKeys = [NSMutableSet new];
+    
+    int64_t total = [UIDevice currentDevice].memoryTotal;
+    int64_t free = [UIDevice currentDevice].memoryFree;
+    int64_t max = MIN(total * 0.2, free * 0.6);
+    max = MAX(max, BUFFER_SIZE);
+    _memoryCache = [YYMemoryCache new];
+    _memoryCache.name = @"YYAnimatedImageFrameCache";
+    _memoryCache.costLimit = (NSUInteger)max;
+    _memoryCache.releaseAsynchronously = YES;
+    return self;
+}
+
+- (void)dealloc {
+    pthread_cond_destroy(&_condition);
+    pthread_mutex_destroy(&_lock);
+}
+
+- (NSUInteger)activeViewCount {
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _activeViewCount;
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+- (NSUInteger)fairShareBytes {
+    NSUInteger count = self.activeViewCount;
+    return _memoryCache.costLimit / (count ? count : 1);
+}
+
+- (void)_viewDidBecomeActive {
+    pthread_mutex_lock(&_lock);
+    _activeViewCount++;
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)_viewDidResignActive {
+    pthread_mutex_lock(&_lock);
+    if (_activeViewCount > 0) _activeViewCount--;
+    pthread_mutex_unlock(&_lock);
+}
+
+/// Returns the cache key of a frame, should be called in lock.
+- (NSString *)_keyForImage:(UIImage<YYAnimatedImage> *)image index:(NSUInteger)index {
+    static const void *kIdentityKey = &kIdentityKey;
+    id identity = image;
+    if ([image isKindOfClass:[YYImage class]]) {
+        NSData *data = ((YYImage *)image).animatedImageData;
+        if (data) identity = data; // same data, same frames
+    }
+    NSNumber *uid = objc_getAssociatedObject(identity, kIdentityKey);
+    if (!uid) {
+        uid = @(++_identitySeed);
+        objc_setAssociatedObject(identity, kIdentityKey, uid, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    }
+    return [NSString stringWithFormat:@"%@_%lu_%.2f", uid, (unsigned long)index, image.scale];
+}
+
+- (UIImage *)cachedFrameForImage:(UIImage<YYAnimatedImage> *)image index:(NSUInteger)index {
+    if (!image) return nil;
+    pthread_mutex_lock(&_lock);
+    NSString *key = [self _keyForImage:image index:index];
+    pthread_mutex_unlock(&_lock);
+    return [_memoryCache objectForKey:key];
+}
+
+- (UIImage *)frameForImage:(UIImage<YYAnimatedImage> *)image index:(NSUInteger)index {
+    if (!image) return nil;
+    pthread_mutex_lock(&_lock);
+    NSString *key = [self _keyForImage:image index:index];
+    UIImage *frame = [_memoryCache objectForKey:key];
+    while (!frame && [_decodingKeys containsObject:key]) {
+        pthread_cond_wait(&_condition, &_lock);
+        frame = [_memoryCache objectForKey:key];
+    }
+    if (frame) {
+        pthread_mutex_unlock(&_lock);
+        return frame;
+    }
+    [_decodingKeys addObject:key];
+    pthread_mutex_unlock(&_lock);
+    
+    frame = [image animatedImageFrameAtIndex:index];
+    frame = frame.imageByDecoded;
+    if (frame) {
+        CGImageRef imageRef = frame.CGImage;
+        NSUInteger cost = imageRef ? CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef) : 0;
+        [_memoryCache setObject:frame forKey:key withCost:cost ? cost : 1];
+    }
+    
+    pthread_mutex_lock(&_lock);
+    [_decodingKeys removeObject:key];
+    pthread_cond_broadcast(&_condition);
+    pthread_mutex_unlock(&_lock);
+    return frame;
+}
+
+@end
@@ -0,0 +1,86 @@
+//
+//  YYBitmapBufferPool.h
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A thread-safe pool of bitmap buffers.
+
+ @discussion Decoding an animated image for display allocates a new bitmap for
+ every frame, and these bitmaps always have the same size. The pool keeps the
+ released buffers (grouped by size class) and hands them out again, so playback
+ does not churn the allocator and fault in new pages for each frame.
+
+ Idle buffers are released in LRU order when the idle bytes exceed `byteLimit`,
+ and all idle buffers are released when the app receives a memory warning or
+ enters background.
+
+ The rented buffer is not zeroed.
+ */
+@interface YYBitmapBufferPool : NSObject
+
+/**
+ Returns global shared pool instance (used by YYImageCoder).
+ @return The singleton YYBitmapBufferPool instance.
+ */
++ (instancetype)sharedPool;
+
+/** The maximum bytes of idle buffers kept by the pool. Default is 16MB, set 0 to disable pooling. */
+@property NSUInteger byteLimit;
+
+/** The total bytes of idle buffers in the pool. */
+@property (readonly) NSUInteger idleBytes;
+
+/** The number of buffers allocated with malloc() (for profiling). */
+@property (readonly) NSUInteger allocationCount;
+
+/** The number of buffers reused from the pool (for profiling). */
+@property (readonly) NSUInteger reuseCount;
+
+/**
+ Rents a buffer which has at least `length` bytes.
+ @param length The buffer length in bytes.
+ @return A buffer, or NULL if an error occurs. Return it with `returnBuffer:length:`.
+ */
+- (nullable void *)rentBufferWithLength:(size_t)length;
+
+/**
+ Returns a buffer to the pool.
+ @param buffer A buffer rented from this pool. If NULL, this method has no effect.
+ @param length The same length passed to `rentBufferWithLength:`.
+ */
+- (void)returnBuffer:(nullable void *)buffer length:(size_t)length;
+
+/** Releases the least recently used idle buffers until idle bytes is not larger than `bytes`. */
+- (void)trimToBytes:(NSUInteger)bytes;
+
+/** Releases all idle buffers. */
+- (void)removeAllBuffers;
+
+/** Resets `allocationCount` and `reuseCount` to zero. */
+- (void)resetStatistics;
+
+@end
+
+
+/**
+ Creates a data provider with a buffer rented from the shared pool. The buffer
+ will be returned to the shared pool when the provider is released.
+
+ @param buffer A buffer rented from `[YYBitmapBufferPool sharedPool]`.
+ @param length The same length passed to `rentBufferWithLength:`.
+ @return A new data provider, or NULL if an error occurs (the buffer is not returned).
+ */
+CG_EXTERN CGDataProviderRef _Nullable YYBitmapBufferPoolCreateDataProvider(void *buffer, size_t length) CF_RETURNS_RETAINED;
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,223 @@
+//
+//  YYBitmapBufferPool.m
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import "YYBitmapBufferPool.h"
+#import <pthread.h>
+
+/**
+ Returns the size class of a buffer length.
+ Small buffers are rounded up to page size, large buffers are rounded up to
+ 1/16 of their power of 2, so the wasted memory is less than 6.25%.
+ */
+static inline size_t YYBitmapBufferSizeClass(size_t length) {
+    size_t page = 4096;
+    if (length <= page * 16) return (length + page - 1) / page * page;
+    size_t pow2 = 1;
+    while (pow2 < length) pow2 <<= 1;
+    size_t step = pow2 / 16;
+    return (length + step - 1) / step * step;
+}
+
+/// A linked list node of an idle buffer.
+typedef struct _YYBitmapBufferNode {
+    struct _YYBitmapBufferNode *prev; ///< more recently used
+    struct _YYBitmapBufferNode *next; ///< less recently used
+    void *data;
+    size_t size;
+} _YYBitmapBufferNode;
+
+static void YYBitmapBufferPoolReleaseDataCallback(void *info, const void *data, size_t size) {
+    [[YYBitmapBufferPool sharedPool] returnBuffer:info length:size];
+}
+
+CGDataProviderRef YYBitmapBufferPoolCreateDataProvider(void *buffer, size_t length) {
+    if (!buffer || length == 0) return NULL;
+    return CGDataProviderCreateWithData(buffer, buffer, length, YYBitmapBufferPoolReleaseDataCallback);
+}
+
+
+@implementation YYBitmapBufferPool {
+    pthread_mutex_t _lock;
+    _YYBitmapBufferNode *_head; ///< MRU
+    _YYBitmapBufferNode *_tail; ///< LRU
+    NSUInteger _byteLimit;
+    NSUInteger _idleBytes;
+    NSUInteger _allocationCount;
+    NSUInteger _reuseCount;
+}
+
+- (void)_appDidReceiveMemoryWarningNotification {
+    [self removeAllBuffers];
+}
+
+- (void)_appDidEnterBackgroundNotification {
+    [self removeAllBuffers];
+}
+
++ (instancetype)sharedPool {
+    static YYBitmapBufferPool *pool = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pool = [self new];
+    });
+    return pool;
+}
+
+- (instancetype)init {
+    self = [super init];
+    pthread_mutex_init(&_lock, NULL);
+    _byteLimit = 16 * 1024 * 1024;
+    [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_appDidReceiveMemoryWarningNotification) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_appDidEnterBackgroundNotification) name:UIApplicationDidEnterBackgroundNotification object:nil];
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidEnterBackgroundNotification object:nil];
+    [self removeAllBuffers];
+    pthread_mutex_destroy(&_lock);
+}
+
+- (NSUInteger)byteLimit {
+    pthread_mutex_lock(&_lock);
+    NSUInteger limit = _byteLimit;
+    pthread_mutex_unlock(&_lock);
+    return limit;
+}
+
+- (void)setByteLimit:(NSUInteger)byteLimit {
+    pthread_mutex_lock(&_lock);
+    _byteLimit = byteLimit;
+    pthread_mutex_unlock(&_lock);
+    [self trimToBytes:byteLimit];
+}
+
+- (NSUInteger)idleBytes {
+    pthread_mutex_lock(&_lock);
+    NSUInteger bytes = _idleBytes;
+    pthread_mutex_unlock(&_lock);
+    return bytes;
+}
+
+- (NSUInteger)allocationCount {
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _allocationCount;
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+- (NSUInteger)reuseCount {
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _reuseCount;
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+- (void)_unlinkNode:(_YYBitmapBufferNode *)node {
+    if (node->prev) node->prev->next = node->next;
+    if (node->next) node->next->prev = node->prev;
+    if (_head == node) _head = node->next;
+    if (_tail == node) _tail = node->prev;
+    node->prev = node->next = NULL;
+    _idleBytes -= node->size;
+}
+
+- (void *)rentBufferWithLength:(size_t)length {
+    if (length == 0) return NULL;
+    size_t size = YYBitmapBufferSizeClass(length);
+    void *data = NULL;
+    _YYBitmapBufferNode *node = NULL;
+
+    pthread_mutex_lock(&_lock);
+    for (node = _head; node; node = node->next) {
+        if (node->size == size) break;
+    }
+    if (node) {
+        [self _unlinkNode:node];
+        data = node->data;
+        _reuseCount++;
+    } else {
+        _allocationCount++;
+    }
+    pthread_mutex_unlock(&_lock);
+
+    if (node) {
+        free(node);
+        return data;
+    }
+    return malloc(size);
+}
+
+- (void)returnBuffer:(void *)buffer length:(size_t)length {
+    if (!buffer) return;
+    size_t size = YYBitmapBufferSizeClass(length);
+
+    pthread_mutex_lock(&_lock);
+    BOOL keep = size <= _byteLimit;
+    pthread_mutex_unlock(&_lock);
+    if (!keep) {
+        free(buffer);
+        return;
+    }
+
+    _YYBitmapBufferNode *node = malloc(sizeof(_YYBitmapBufferNode));
+    if (!node) {
+        free(buffer);
+        return;
+    }
+    node->data = buffer;
+    node->size = size;
+    node->prev = NULL;
+
+    pthread_mutex_lock(&_lock);
+    node->next = _head;
+    if (_head) _head->prev = node;
+    _head = node;
+    if (!_tail) _tail = node;
+    _idleBytes += size;
+    NSUInteger limit = _byteLimit;
+    pthread_mutex_unlock(&_lock);
+
+    [self trimToBytes:limit];
+}
+
+- (void)trimToBytes:(NSUInteger)bytes {
+    _YYBitmapBufferNode *released = NULL;
+    pthread_mutex_lock(&_lock);
+    while (_tail && _idleBytes > bytes) {
+        _YYBitmapBufferNode *node = _tail;
+        [self _unlinkNode:node];
+        node->next = released;
+        released = node;
+    }
+    pthread_mutex_unlock(&_lock);
+
+    while (released) { // free outside the lock
+        _YYBitmapBufferNode *next = released->next;
+        free(released->data);
+        free(released);
+        released = next;
+    }
+}
+
+- (void)removeAllBuffers {
+    [self trimToBytes:0];
+}
+
+- (void)resetStatistics {
+    pthread_mutex_lock(&_lock);
+    _allocationCount = 0;
+    _reuseCount = 0;
+    pthread_mutex_unlock(&_lock);
+}
+
+@end
@@ -111,6 +111,10 @@
     }
 }
 
+- (BOOL)animatedImageSupportsConcurrentDecoding {
+    return YES; // each frame is an individual image
+}
+
 - (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index {
     if (index >= _frameDurations.count) return 0;
     NSNumber *num = _frameDurations[index];
@@ -21,6 +21,9 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// Posted when the `residentMemorySize` of a YYImage changes, the object is the image.
+UIKIT_EXTERN NSString *const YYImageResidentMemorySizeDidChangeNotification;
+
 /**
  A YYImage object is a high-level way to display animated image data.
  
@@ -75,6 +78,16 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic) BOOL preloadAllAnimatedImageFrames;
 
+/**
+ The memory usage (in bytes) of the image now: the decoded first frame, the original
+ image data which is kept to decode other frames, the preloaded frames, and the
+ frames buffered by the `YYAnimatedImageView`s which display the image.
+ 
+ @discussion `YYImageResidentMemorySizeDidChangeNotification` is posted when the
+ frames are preloaded or released, and when a view's frame buffer grows or shrinks.
+ */
+@property (nonatomic, readonly) NSUInteger residentMemorySize;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -13,9 +13,13 @@
 #import "NSString+YYAdd.h"
 #import "NSBundle+YYAdd.h"
 
+NSString *const YYImageResidentMemorySizeDidChangeNotification = @"YYImageResidentMemorySizeDidChangeNotification";
+
 @implementation YYImage {
     YYImageDecoder *_decoder;
     NSArray *_preloadedFrames;
+    NSUInteger _preloadedFramesSize;
+    NSUInteger _bufferedFramesSize; ///< frames buffered by YYAnimatedImageView
     dispatch_semaphore_t _preloadedLock;
     NSUInteger _bytesPerFrame;
 }
@@ -98,27 +102,54 @@
 
 - (void)setPreloadAllAnimatedImageFrames:(BOOL)preloadAllAnimatedImageFrames {
     if (_preloadAllAnimatedImageFrames != preloadAllAnimatedImageFrames) {
+        _preloadAllAnimatedImageFrames = preloadAllAnimatedImageFrames;
         if (preloadAllAnimatedImageFrames && _decoder.frameCount > 0) {
             NSMutableArray *frames = [NSMutableArray new];
+            NSUInteger framesSize = 0;
             for (NSUInteger i = 0, max = _decoder.frameCount; i < max; i++) {
                 UIImage *img = [self animatedImageFrameAtIndex:i];
                 if (img) {
                     [frames addObject:img];
+                    framesSize += CGImageGetBytesPerRow(img.CGImage) * CGImageGetHeight(img.CGImage);
                 } else {
                     [frames addObject:[NSNull null]];
                 }
             }
             dispatch_semaphore_wait(_preloadedLock, DISPATCH_TIME_FOREVER);
             _preloadedFrames = frames;
+            _preloadedFramesSize = framesSize;
             dispatch_semaphore_signal(_preloadedLock);
         } else {
             dispatch_semaphore_wait(_preloadedLock, DISPATCH_TIME_FOREVER);
             _preloadedFrames = nil;
+            _preloadedFramesSize = 0;
             dispatch_semaphore_signal(_preloadedLock);
         }
+        [[NSNotificationCenter defaultCenter] postNotificationName:YYImageResidentMemorySizeDidChangeNotification object:self];
     }
 }
 
+- (NSUInteger)residentMemorySize {
+    CGImageRef imageRef = self.CGImage;
+    NSUInteger size = imageRef ? CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef) : 0;
+    if (!_decoder) return size;
+    size += _decoder.data.length;
+    dispatch_semaphore_wait(_preloadedLock, DISPATCH_TIME_FOREVER);
+    size += _preloadedFramesSize + _bufferedFramesSize;
+    dispatch_semaphore_signal(_preloadedLock);
+    return size;
+}
+
+/// Called by YYAnimatedImageView when the size of its frame buffer changes.
+- (void)_addBufferedFramesSize:(NSInteger)delta {
+    if (!_decoder || delta == 0) return;
+    dispatch_semaphore_wait(_preloadedLock, DISPATCH_TIME_FOREVER);
+    if (delta < 0 && (NSUInteger)(-delta) > _bufferedFramesSize) _bufferedFramesSize = 0;
+    else _bufferedFramesSize += delta;
+    dispatch_semaphore_signal(_preloadedLock);
+    [[NSNotificationCenter defaultCenter] postNotificationName:YYImageResidentMemorySizeDidChangeNotification object:self];
+}
+
 #pragma mark - protocol NSCoding
 
 - (instancetype)initWithCoder:(NSCoder *)aDecoder {
@@ -168,6 +199,10 @@
     return [_decoder frameAtIndex:index decodeForDisplay:YES].image;
 }
 
+- (BOOL)animatedImageSupportsConcurrentDecoding {
+    return _decoder.supportsConcurrentDecoding;
+}
+
 - (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index {
     NSTimeInterval duration = [_decoder frameDurationAtIndex:index];
     
@@ -11,7 +11,7 @@
 
 #import <UIKit/UIKit.h>
 
-@class YYMemoryCache, YYDiskCache;
+@class YYMemoryCache, YYDiskCache, YYImagePersistencePolicy;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -56,7 +56,17 @@ typedef NS_OPTIONS(NSUInteger, YYImageCacheType) {
 /** The name of the cache. Default is nil. */
 @property (nullable, copy) NSString *name;
 
-/** The underlying memory cache. see `YYMemoryCache` for more information.*/
+/**
+ The underlying memory cache. see `YYMemoryCache` for more information.
+ 
+ @discussion The cost of an image is its memory usage in bytes: the decoded bitmap.
+ An image which is stored from data and not decoded yet costs the data length, until
+ it's returned from the cache (to be drawn), then its cost is updated to the bitmap size.
+ An animated `YYImage` also costs its image data, preloaded frames and the frames 
+ buffered by `YYAnimatedImageView`, and its cost is updated when they change (see 
+ `-[YYImage residentMemorySize]`). So the memory cache's `costLimit` limits the memory 
+ used by the images.
+ */
 @property (strong, readonly) YYMemoryCache *memoryCache;
 
 /** The underlying disk cache. see `YYDiskCache` for more information.*/
@@ -78,6 +88,43 @@ typedef NS_OPTIONS(NSUInteger, YYImageCacheType) {
  */
 @property BOOL decodeForDisplay;
 
+/**
+ The policy which decides how the image data is persisted in disk cache.
+ Default is `[YYImagePersistencePolicy sharedPolicy]`.
+ 
+ @discussion The original image data is always written to disk first. If the policy 
+ allows and prefers to transcode it (for example, a non-animated WebP image which decodes 
+ much slower than JPEG on this device), the data is transcoded later in background when 
+ the cache is idle, so it doesn't compete with the images being displayed. The decode 
+ time of disk cache hits is recorded to the policy. Set nil to keep all the original data.
+ */
+@property (nullable, strong) YYImagePersistencePolicy *persistencePolicy;
+
+/**
+ The disk cache which keeps the decoded bitmaps of the images. Default is nil.
+ 
+ @discussion If it's set, a full size single frame image is also written to this 
+ cache as raw bitmap (see `YYCGImageCreateRawBitmapData()`) when the `persistencePolicy` 
+ prefers, and later disk hits of the image are displayed from the memory-mapped 
+ bitmap without decode. It's useful for the large images which decode slowly, at 
+ the cost of more disk space. The bitmaps are removed with the images, but they 
+ have their own limits (count, cost, age and free disk space).
+ 
+ The cache should be created with another path, and its `inlineThreshold` should
+ be 0 so that the bitmaps are stored in files which can be mapped. Its archive 
+ blocks are replaced by the image cache. Set this property before using the cache.
+ */
+@property (nullable, nonatomic, strong) YYDiskCache *bitmapDiskCache;
+
+/**
+ Whether to compress the bitmaps in `bitmapDiskCache` with LZ4. Default is NO.
+ 
+ @discussion A compressed bitmap costs less disk space (especially for the images 
+ with large flat areas), but it's decompressed to memory when read, instead of 
+ memory-mapped.
+ */
+@property BOOL shouldCompressBitmap;
+
 
 #pragma mark - Initializer
 ///=============================================================================
@@ -136,6 +183,54 @@ typedef NS_OPTIONS(NSUInteger, YYImageCacheType) {
           forKey:(NSString *)key
         withType:(YYImageCacheType)type;
 
+/**
+ Sets the image decoded at a target pixel size with the specified key in the cache.
+ This method returns immediately and executes the store operation in background.
+ 
+ @discussion The memory cache stores the image with a key derived from `key` and
+ `pixelSize`, so that thumbnails of different sizes do not replace each other.
+ The disk cache always stores the original `imageData` with `key`, and the `image`
+ is not written to disk if `imageData` is nil, as it's not the original image.
+ The images of all pixel sizes are removed with `key` (see `removeImageForKey:`),
+ and they are removed from memory cache when the image is stored to disk again.
+ 
+ @param image     The image to be stored in the cache.
+ @param imageData The original image data to be stored in the cache.
+ @param key       The key with which to associate the image. If nil, this method has no effect.
+ @param type      The cache type to store image.
+ @param pixelSize The target pixel size which the image is decoded at, 
+                  pass CGSizeZero for full size image.
+ */
+- (void)setImage:(nullable UIImage *)image
+       imageData:(nullable NSData *)imageData
+          forKey:(NSString *)key
+        withType:(YYImageCacheType)type
+       pixelSize:(CGSize)pixelSize;
+
+/**
+ Sets the image with the specified key in the cache, the original image data is 
+ read from a file. This method may blocks the calling thread until the file is 
+ moved into the disk cache.
+ 
+ @discussion This method is same as `setImage:imageData:forKey:withType:pixelSize:`,
+ but the image data file is moved into the disk cache instead of written again, 
+ so the data don't need to be in memory. The file should be created at 
+ `diskCache.temporaryFilePath`, and it's removed when this method returns.
+ 
+ @param image     The image to be stored in the memory cache.
+ @param path      The path of the original image data file.
+ @param key       The key with which to associate the image. If nil, this method 
+                  only removes the file.
+ @param type      The cache type to store image.
+ @param pixelSize The target pixel size which the image is decoded at,
+                  pass CGSizeZero for full size image.
+ */
+- (void)setImage:(nullable UIImage *)image
+ imageFileAtPath:(NSString *)path
+          forKey:(NSString *)key
+        withType:(YYImageCacheType)type
+       pixelSize:(CGSize)pixelSize;
+
 /**
  Removes the image of the specified key in the cache (both memory and disk).
  This method returns immediately and executes the remove operation in background.
@@ -194,6 +289,24 @@ typedef NS_OPTIONS(NSUInteger, YYImageCacheType) {
  */
 - (nullable UIImage *)getImageForKey:(NSString *)key withType:(YYImageCacheType)type;
 
+/**
+ Returns the image associated with a given key, decoded at a target pixel size.
+ If the image is not in memory and the `type` contains `YYImageCacheTypeDisk`,
+ this method may blocks the calling thread until file read and decode finished.
+ 
+ @discussion The original image data is read from disk cache and scaled down
+ while decoding (see `-[YYImageDecoder frameAtIndex:decodeForDisplay:pixelSize:]`),
+ so a thumbnail never costs a full size bitmap. Animated image is not scaled.
+ 
+ @param key       A string identifying the image. If nil, just return nil.
+ @param type      The cache type.
+ @param pixelSize The target pixel size, pass CGSizeZero for full size image.
+ @return The image associated with key, or nil if no image is associated with key.
+ */
+- (nullable UIImage *)getImageForKey:(NSString *)key
+                            withType:(YYImageCacheType)type
+                           pixelSize:(CGSize)pixelSize;
+
 /**
  Asynchronously get the image associated with a given key.
  
@@ -15,6 +15,8 @@
 #import "UIImage+YYAdd.h"
 #import "NSObject+YYAdd.h"
 #import "YYImage.h"
+#import "YYImagePersistencePolicy.h"
+#import <pthread.h>
 
 #if __has_include("YYDispatchQueuePool.h")
 #import "YYDispatchQueuePool.h"
@@ -37,33 +39,190 @@ static inline dispatch_queue_t YYImageCacheDecodeQueue() {
 #endif
 }
 
+static inline dispatch_queue_t YYImageCacheTranscodeQueue() {
+    static dispatch_queue_t queue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        queue = dispatch_queue_create("com.ibireme.yykit.imagecache.transcode", DISPATCH_QUEUE_SERIAL);
+        dispatch_set_target_queue(queue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0));
+    });
+    return queue;
+}
+
+/// The cache is idle if there's no disk access in this interval.
+static const NSTimeInterval kTranscodeIdleInterval = 3;
+
+static BOOL YYImageHasAlpha(UIImage *image) {
+    CGImageRef imageRef = image.CGImage;
+    if (!imageRef) return YES;
+    CGImageAlphaInfo alphaInfo = CGImageGetAlphaInfo(imageRef) & kCGBitmapAlphaInfoMask;
+    return !(alphaInfo == kCGImageAlphaNone ||
+             alphaInfo == kCGImageAlphaNoneSkipFirst ||
+             alphaInfo == kCGImageAlphaNoneSkipLast);
+}
+
+/// Returns the memory cache key for an image decoded at a target pixel size.
+static inline NSString *YYImageCacheMemoryKey(NSString *key, CGSize pixelSize) {
+    if (!key || (pixelSize.width <= 0 && pixelSize.height <= 0)) return key;
+    return [NSString stringWithFormat:@"%@#%dx%d", key, (int)pixelSize.width, (int)pixelSize.height];
+}
+
 
 @interface YYImageCache ()
 - (NSUInteger)imageCost:(UIImage *)image;
 - (UIImage *)imageFromData:(NSData *)data;
+- (UIImage *)imageFromData:(NSData *)data pixelSize:(CGSize)pixelSize;
 @end
 
 
-@implementation YYImageCache
+@implementation YYImageCache {
+    pthread_mutex_t _costLock;
+    NSMapTable *_costKeys; ///< animated image (weak) -> memory cache keys (NSMutableSet), to update the cost
+    NSMapTable *_lazyCostKeys; ///< not decoded image (weak) -> memory cache keys (NSMutableSet), charged the data length
+    pthread_mutex_t _variantLock;
+    NSMutableDictionary *_variantKeys; ///< key -> memory cache keys of the images decoded at pixel sizes (NSMutableSet)
+    pthread_mutex_t _transcodeLock;
+    NSMutableOrderedSet *_transcodeKeys; ///< keys of the image data to transcode in idle time
+    BOOL _transcodeScheduled;
+    NSTimeInterval _lastDiskAccessTime; ///< accessed with atomic load/store
+}
 
+/**
+ Returns the memory cost of an image in bytes, when it's decoded.
+ */
 - (NSUInteger)imageCost:(UIImage *)image {
-    CGImageRef cgImage = image.CGImage;
-    if (!cgImage) return 1;
-    CGFloat height = CGImageGetHeight(cgImage);
-    size_t bytesPerRow = CGImageGetBytesPerRow(cgImage);
-    NSUInteger cost = bytesPerRow * height;
+    NSUInteger cost = 0;
+    if ([image isKindOfClass:[YYImage class]]) {
+        cost = ((YYImage *)image).residentMemorySize; // includes the image data and the preloaded frames
+    } else {
+        CGImageRef cgImage = image.CGImage;
+        if (cgImage) cost = CGImageGetBytesPerRow(cgImage) * CGImageGetHeight(cgImage);
+    }
     if (cost == 0) cost = 1;
     return cost;
 }
 
+/**
+ Stores an image to memory cache, the cost of an animated image is updated when it changes.
+ 
+ @param dataLength The length of the data which the image is created from, or 0 if 
+    the image is returned to the caller. An image which is not decoded yet is charged 
+    the data length, until it's returned from the cache (to be drawn and decoded).
+ */
+- (void)_setMemoryImage:(UIImage *)image forKey:(NSString *)memoryKey dataLength:(NSUInteger)dataLength {
+    if (!image || !memoryKey) return;
+    if (dataLength > 0 && !image.isDecodedForDisplay && ![image isKindOfClass:[YYImage class]]) {
+        pthread_mutex_lock(&_costLock);
+        NSMutableSet *memoryKeys = [_lazyCostKeys objectForKey:image];
+        if (!memoryKeys) {
+            memoryKeys = [NSMutableSet new];
+            [_lazyCostKeys setObject:memoryKeys forKey:image];
+        }
+        [memoryKeys addObject:memoryKey];
+        pthread_mutex_unlock(&_costLock);
+        [_memoryCache setObject:image forKey:memoryKey withCost:dataLength];
+        return;
+    }
+    if ([image isKindOfClass:[YYImage class]] && ((YYImage *)image).animatedImageFrameCount > 1) {
+        // one image may be stored with several keys (for example, by setImage:forKey:)
+        pthread_mutex_lock(&_costLock);
+        NSMutableSet *memoryKeys = [_costKeys objectForKey:image];
+        if (!memoryKeys) {
+            memoryKeys = [NSMutableSet new];
+            [_costKeys setObject:memoryKeys forKey:image];
+        }
+        [memoryKeys addObject:memoryKey];
+        pthread_mutex_unlock(&_costLock);
+    }
+    [_memoryCache setObject:image forKey:memoryKey withCost:[self imageCost:image]];
+}
+
+/// Records the memory cache key of an image decoded at a pixel size, to remove it with the key.
+- (void)_addVariantMemoryKey:(NSString *)memoryKey forKey:(NSString *)key {
+    if ([memoryKey isEqualToString:key]) return;
+    pthread_mutex_lock(&_variantLock);
+    NSMutableSet *memoryKeys = _variantKeys[key];
+    if (!memoryKeys) {
+        memoryKeys = [NSMutableSet new];
+        _variantKeys[key] = memoryKeys;
+    }
+    [memoryKeys addObject:memoryKey];
+    pthread_mutex_unlock(&_variantLock);
+}
+
+/// Removes the images decoded at pixel sizes from memory cache, they are stale.
+- (void)_removeVariantMemoryImagesForKey:(NSString *)key {
+    pthread_mutex_lock(&_variantLock);
+    NSSet *memoryKeys = _variantKeys[key];
+    [_variantKeys removeObjectForKey:key];
+    pthread_mutex_unlock(&_variantLock);
+    for (NSString *memoryKey in memoryKeys) {
+        [_memoryCache removeObjectForKey:memoryKey];
+    }
+}
+
+- (BOOL)_containsVariantMemoryImageForKey:(NSString *)key {
+    pthread_mutex_lock(&_variantLock);
+    NSArray *memoryKeys = [_variantKeys[key] allObjects];
+    pthread_mutex_unlock(&_variantLock);
+    for (NSString *memoryKey in memoryKeys) {
+        if ([_memoryCache containsObjectForKey:memoryKey]) return YES;
+    }
+    return NO;
+}
+
+/// Called when an image is returned from memory cache, it will be drawn and decoded.
+- (void)_memoryImageWillDisplay:(UIImage *)image {
+    if (!image || image.isDecodedForDisplay) return;
+    pthread_mutex_lock(&_costLock);
+    NSArray *memoryKeys = nil;
+    if (_lazyCostKeys.count) {
+        memoryKeys = [[_lazyCostKeys objectForKey:image] allObjects];
+        if (memoryKeys) [_lazyCostKeys removeObjectForKey:image];
+    }
+    pthread_mutex_unlock(&_costLock);
+    if (memoryKeys.count == 0) return;
+    NSUInteger cost = [self imageCost:image];
+    for (NSString *memoryKey in memoryKeys) {
+        [_memoryCache updateCost:cost ofObject:image forKey:memoryKey];
+    }
+}
+
+- (void)_imageResidentMemorySizeDidChange:(NSNotification *)notification {
+    UIImage *image = notification.object;
+    if (!image) return;
+    pthread_mutex_lock(&_costLock);
+    NSArray *memoryKeys = [[_costKeys objectForKey:image] allObjects];
+    pthread_mutex_unlock(&_costLock);
+    if (memoryKeys.count == 0) return;
+    NSUInteger cost = [self imageCost:image];
+    for (NSString *memoryKey in memoryKeys) {
+        [_memoryCache updateCost:cost ofObject:image forKey:memoryKey];
+    }
+}
+
 - (UIImage *)imageFromData:(NSData *)data {
+    return [self imageFromData:data pixelSize:CGSizeZero];
+}
+
+- (UIImage *)imageFromData:(NSData *)data pixelSize:(CGSize)pixelSize {
     NSData *scaleData = [YYDiskCache getExtendedDataFromObject:data];
     CGFloat scale = 0;
     if (scaleData) {
         scale = ((NSNumber *)[NSKeyedUnarchiver unarchiveObjectWithData:scaleData]).doubleValue;
     }
     if (scale <= 0) scale = [UIScreen mainScreen].scale;
+    [self _updateLastDiskAccessTime];
     UIImage *image;
+    if (pixelSize.width > 0 || pixelSize.height > 0) {
+        YYImageDecoder *decoder = [YYImageDecoder decoderWithData:data scale:scale];
+        if (decoder.frameCount == 1 || !_allowAnimatedImage) { // animated image is not scaled
+            image = [decoder frameAtIndex:0 decodeForDisplay:_decodeForDisplay pixelSize:pixelSize].image;
+            if (image) return image;
+            // downsampling failed (unsupported format, etc.), fall back to full decoding
+        }
+    }
+    CFTimeInterval begin = CACurrentMediaTime();
     if (_allowAnimatedImage) {
         image = [[YYImage alloc] initWithData:data scale:scale];
         if (_decodeForDisplay) image = [image imageByDecoded];
@@ -71,9 +230,186 @@ static inline dispatch_queue_t YYImageCacheDecodeQueue() {
         YYImageDecoder *decoder = [YYImageDecoder decoderWithData:data scale:scale];
         image = [decoder frameAtIndex:0 decodeForDisplay:_decodeForDisplay].image;
     }
+    if (_decodeForDisplay) [self _recordDecodeTime:CACurrentMediaTime() - begin image:image data:data];
+    return image;
+}
+
+/// Records the decode time of a full size, single frame image to the persistence policy.
+- (void)_recordDecodeTime:(CFTimeInterval)time image:(UIImage *)image data:(NSData *)data {
+    YYImagePersistencePolicy *policy = self.persistencePolicy;
+    CGImageRef imageRef = image.CGImage;
+    if (!policy || !imageRef) return;
+    if ([image isKindOfClass:[YYImage class]] && ((YYImage *)image).animatedImageFrameCount > 1) return;
+    NSUInteger pixelCount = CGImageGetWidth(imageRef) * CGImageGetHeight(imageRef);
+    [policy recordDecodeTime:time pixelCount:pixelCount type:YYImageDetectType((__bridge CFDataRef)data)];
+}
+
+#pragma mark Bitmap
+
+/// Returns the size of the raw bitmap of an image, or 0 if there's no bitmap disk cache.
+- (NSUInteger)_bitmapSizeOfImage:(UIImage *)image {
+    CGImageRef imageRef = image.CGImage;
+    if (!_bitmapDiskCache || !imageRef) return 0;
+    size_t bytesPerRow = (CGImageGetWidth(imageRef) * 4 + 63) & ~(size_t)63; // same as the raw bitmap
+    return bytesPerRow * CGImageGetHeight(imageRef);
+}
+
+/// Writes the decoded bitmap of a full size image to the bitmap disk cache in background.
+- (void)_storeBitmapOfImage:(UIImage *)image forKey:(NSString *)key {
+    YYDiskCache *bitmapDiskCache = _bitmapDiskCache;
+    if (!bitmapDiskCache || !image.CGImage) return;
+    BOOL compress = self.shouldCompressBitmap;
+    __weak typeof(self) _self = self;
+    dispatch_async(YYImageCacheIOQueue(), ^{
+        __strong typeof(_self) self = _self;
+        if (!self) return;
+        if ([bitmapDiskCache containsObjectForKey:key]) return; // stored by another hit
+        NSData *data = CFBridgingRelease(YYCGImageCreateRawBitmapData(image.CGImage, image.scale, image.imageOrientation, compress));
+        if (!data) return;
+        if (![self.diskCache containsObjectForKey:key]) return; // removed while writing
+        [bitmapDiskCache setObject:data forKey:key];
+    });
+}
+
+/// Returns the image in bitmap disk cache, or nil if there's no bitmap for the key.
+- (UIImage *)_bitmapImageForKey:(NSString *)key {
+    YYDiskCache *bitmapDiskCache = _bitmapDiskCache;
+    if (!bitmapDiskCache) return nil;
+    NSData *data = [bitmapDiskCache mappedDataForKey:key];
+    if (!data) return nil;
+    [self _updateLastDiskAccessTime];
+    CGFloat scale = 1;
+    UIImageOrientation orientation = UIImageOrientationUp;
+    CGImageRef imageRef = YYCGImageCreateWithRawBitmapData((__bridge CFDataRef)data, &scale, &orientation);
+    if (!imageRef) {
+        [bitmapDiskCache removeObjectForKey:key]; // broken or old format
+        return nil;
+    }
+    UIImage *image = [UIImage imageWithCGImage:imageRef scale:scale orientation:orientation];
+    CFRelease(imageRef);
+    image.isDecodedForDisplay = YES;
+    return image;
+}
+
+/// Reads an image from disk, the bitmap disk cache is preferred for full size image.
+- (UIImage *)_diskImageForKey:(NSString *)key pixelSize:(CGSize)pixelSize {
+    BOOL scaled = pixelSize.width > 0 || pixelSize.height > 0;
+    if (!scaled) {
+        UIImage *image = [self _bitmapImageForKey:key];
+        if (image) return image;
+    }
+    NSData *data = (id)[_diskCache objectForKey:key];
+    UIImage *image = [self imageFromData:data pixelSize:pixelSize];
+    if (image && !scaled && _bitmapDiskCache) {
+        YYImageType type = YYImageDetectType((__bridge CFDataRef)data);
+        if ([self _persistenceOfType:type image:image fullSize:YES] == YYImagePersistenceBitmap) {
+            [self _storeBitmapOfImage:image forKey:key];
+        }
+    }
     return image;
 }
 
+#pragma mark Transcode
+
+/// Returns how the policy prefers to persist an image, a scaled image is not kept as bitmap.
+- (YYImagePersistence)_persistenceOfType:(YYImageType)type image:(UIImage *)image fullSize:(BOOL)fullSize {
+    YYImagePersistencePolicy *policy = self.persistencePolicy;
+    if (!policy) return YYImagePersistenceOriginal;
+    NSUInteger frameCount = 0;
+    if ([image isKindOfClass:[YYImage class]]) frameCount = ((YYImage *)image).animatedImageFrameCount;
+    else if (image) frameCount = 1;
+    BOOL hasAlpha = image ? YYImageHasAlpha(image) : YES;
+    NSUInteger bitmapSize = fullSize ? [self _bitmapSizeOfImage:image] : 0;
+    return [policy persistenceForType:type frameCount:frameCount hasAlpha:hasAlpha bitmapSize:bitmapSize];
+}
+
+/// Keeps the bitmap of the image, or adds the image data to the transcode list, 
+/// if the policy prefers.
+- (void)_persistImageOfType:(YYImageType)type image:(UIImage *)image fullSize:(BOOL)fullSize forKey:(NSString *)key {
+    [self _updateLastDiskAccessTime];
+    YYImagePersistence persistence = [self _persistenceOfType:type image:image fullSize:fullSize];
+    if (persistence == YYImagePersistenceBitmap) {
+        [self _storeBitmapOfImage:image forKey:key];
+        return;
+    }
+    if (persistence != YYImagePersistenceTranscode) return;
+    
+    pthread_mutex_lock(&_transcodeLock);
+    [_transcodeKeys addObject:key];
+    pthread_mutex_unlock(&_transcodeLock);
+    [self _scheduleTranscode];
+}
+
+- (void)_scheduleTranscode {
+    pthread_mutex_lock(&_transcodeLock);
+    BOOL schedule = !_transcodeScheduled && _transcodeKeys.count > 0;
+    if (schedule) _transcodeScheduled = YES;
+    pthread_mutex_unlock(&_transcodeLock);
+    if (!schedule) return;
+    
+    __weak typeof(self) _self = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kTranscodeIdleInterval * NSEC_PER_SEC)), YYImageCacheTranscodeQueue(), ^{
+        __strong typeof(_self) self = _self;
+        [self _transcodeInIdleTime];
+    });
+}
+
+/// Called on every disk access (from any thread), transcoding waits until the cache is idle.
+- (void)_updateLastDiskAccessTime {
+    NSTimeInterval time = CACurrentMediaTime();
+    __atomic_store(&_lastDiskAccessTime, &time, __ATOMIC_RELAXED);
+}
+
+- (NSTimeInterval)_lastDiskAccessTime {
+    NSTimeInterval time;
+    __atomic_load(&_lastDiskAccessTime, &time, __ATOMIC_RELAXED);
+    return time;
+}
+
+/// Transcodes the image data one by one while the cache is idle.
+- (void)_transcodeInIdleTime {
+    while (CACurrentMediaTime() - [self _lastDiskAccessTime] >= kTranscodeIdleInterval) {
+        pthread_mutex_lock(&_transcodeLock);
+        NSString *key = _transcodeKeys.firstObject;
+        if (key) [_transcodeKeys removeObjectAtIndex:0];
+        pthread_mutex_unlock(&_transcodeLock);
+        if (!key) break;
+        @autoreleasepool {
+            [self _transcodeImageDataForKey:key];
+        }
+    }
+    pthread_mutex_lock(&_transcodeLock);
+    _transcodeScheduled = NO;
+    pthread_mutex_unlock(&_transcodeLock);
+    [self _scheduleTranscode]; // the cache is busy, try again later
+}
+
+- (void)_transcodeImageDataForKey:(NSString *)key {
+    YYImagePersistencePolicy *policy = self.persistencePolicy;
+    if (!policy) return;
+    NSData *data = (id)[_diskCache objectForKey:key];
+    if (!data) return;
+    YYImageType type = YYImageDetectType((__bridge CFDataRef)data);
+    NSData *scaleData = [YYDiskCache getExtendedDataFromObject:data];
+    CGFloat scale = 0;
+    if (scaleData) {
+        scale = ((NSNumber *)[NSKeyedUnarchiver unarchiveObjectWithData:scaleData]).doubleValue;
+    }
+    if (scale <= 0) scale = [UIScreen mainScreen].scale;
+    
+    YYImageDecoder *decoder = [YYImageDecoder decoderWithData:data scale:scale];
+    if (decoder.frameCount != 1) return; // animated or broken
+    UIImage *image = [decoder frameAtIndex:0 decodeForDisplay:NO].image;
+    if (!image) return;
+    if ([policy persistenceForType:type frameCount:1 hasAlpha:YYImageHasAlpha(image)] != YYImagePersistenceTranscode) return;
+    NSData *newData = [image imageDataRepresentation];
+    if (newData.length == 0 || newData.length > data.length * policy.transcodeSizeRatio) return; // keep the smaller original
+    
+    if (![_diskCache containsObjectForKey:key]) return; // removed while transcoding
+    if (scaleData) [YYDiskCache setExtendedData:scaleData toObject:newData];
+    [_diskCache setObject:newData forKey:key];
+}
+
 #pragma mark Public
 
 + (instancetype)sharedCache {
@@ -112,44 +448,80 @@ static inline dispatch_queue_t YYImageCacheDecodeQueue() {
     _diskCache = diskCache;
     _allowAnimatedImage = YES;
     _decodeForDisplay = YES;
+    _persistencePolicy = [YYImagePersistencePolicy sharedPolicy];
+    _costKeys = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality
+                                          valueOptions:NSPointerFunctionsStrongMemory
+                                              capacity:0];
+    _lazyCostKeys = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality
+                                              valueOptions:NSPointerFunctionsStrongMemory
+                                                  capacity:0];
+    pthread_mutex_init(&_costLock, NULL);
+    _variantKeys = [NSMutableDictionary new];
+    pthread_mutex_init(&_variantLock, NULL);
+    _transcodeKeys = [NSMutableOrderedSet new];
+    pthread_mutex_init(&_transcodeLock, NULL);
+    [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_imageResidentMemorySizeDidChange:) name:YYImageResidentMemorySizeDidChangeNotification object:nil];
     return self;
 }
 
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self name:YYImageResidentMemorySizeDidChangeNotification object:nil];
+    pthread_mutex_destroy(&_costLock);
+    pthread_mutex_destroy(&_variantLock);
+    pthread_mutex_destroy(&_transcodeLock);
+}
+
+- (void)setBitmapDiskCache:(YYDiskCache *)bitmapDiskCache {
+    bitmapDiskCache.customArchiveBlock = ^(id object) { return (NSData *)object; };
+    bitmapDiskCache.customUnarchiveBlock = ^(NSData *data) { return (id)data; };
+    _bitmapDiskCache = bitmapDiskCache;
+}
+
 - (void)setImage:(UIImage *)image forKey:(NSString *)key {
     [self setImage:image imageData:nil forKey:key withType:YYImageCacheTypeAll];
 }
 
 - (void)setImage:(UIImage *)image imageData:(NSData *)imageData forKey:(NSString *)key withType:(YYImageCacheType)type {
+    [self setImage:image imageData:imageData forKey:key withType:type pixelSize:CGSizeZero];
+}
+
+- (void)setImage:(UIImage *)image imageData:(NSData *)imageData forKey:(NSString *)key withType:(YYImageCacheType)type pixelSize:(CGSize)pixelSize {
     if (!key || (image == nil && imageData.length == 0)) return;
+    BOOL scaled = pixelSize.width > 0 || pixelSize.height > 0;
+    NSString *memoryKey = YYImageCacheMemoryKey(key, pixelSize);
+    if (type & YYImageCacheTypeDisk) [self _removeVariantMemoryImagesForKey:key]; // the original image is replaced
+    if (type & YYImageCacheTypeMemory) [self _addVariantMemoryKey:memoryKey forKey:key];
     
     __weak typeof(self) _self = self;
     if (type & YYImageCacheTypeMemory) { // add to memory cache
         if (image) {
             if (image.isDecodedForDisplay) {
-                [_memoryCache setObject:image forKey:key withCost:[_self imageCost:image]];
+                [self _setMemoryImage:image forKey:memoryKey dataLength:0];
             } else {
                 dispatch_async(YYImageCacheDecodeQueue(), ^{
                     __strong typeof(_self) self = _self;
                     if (!self) return;
-                    [self.memoryCache setObject:[image imageByDecoded] forKey:key withCost:[self imageCost:image]];
+                    [self _setMemoryImage:[image imageByDecoded] forKey:memoryKey dataLength:0];
                 });
             }
         } else if (imageData) {
             dispatch_async(YYImageCacheDecodeQueue(), ^{
                 __strong typeof(_self) self = _self;
                 if (!self) return;
-                UIImage *newImage = [self imageFromData:imageData];
-                [self.memoryCache setObject:newImage forKey:key withCost:[self imageCost:newImage]];
+                UIImage *newImage = [self imageFromData:imageData pixelSize:pixelSize];
+                [self _setMemoryImage:newImage forKey:memoryKey dataLength:imageData.length];
             });
         }
     }
     if (type & YYImageCacheTypeDisk) { // add to disk cache
+        [_bitmapDiskCache removeObjectForKey:key]; // the bitmap may be stale
         if (imageData) {
             if (image) {
                 [YYDiskCache setExtendedData:[NSKeyedArchiver archivedDataWithRootObject:@(image.scale)] toObject:imageData];
             }
             [_diskCache setObject:imageData forKey:key];
-        } else if (image) {
+            [self _persistImageOfType:YYImageDetectType((__bridge CFDataRef)imageData) image:image fullSize:!scaled forKey:key];
+        } else if (image && !scaled) { // a scaled image is not the original, do not persist it
             dispatch_async(YYImageCacheIOQueue(), ^{
                 __strong typeof(_self) self = _self;
                 if (!self) return;
@@ -161,13 +533,41 @@ static inline dispatch_queue_t YYImageCacheDecodeQueue() {
     }
 }
 
+- (void)setImage:(UIImage *)image imageFileAtPath:(NSString *)path forKey:(NSString *)key withType:(YYImageCacheType)type pixelSize:(CGSize)pixelSize {
+    if (!path) return;
+    if (key && (type & YYImageCacheTypeDisk)) [self _removeVariantMemoryImagesForKey:key]; // the original image is replaced
+    if (key && image && (type & YYImageCacheTypeMemory)) {
+        [self setImage:image imageData:nil forKey:key withType:YYImageCacheTypeMemory pixelSize:pixelSize];
+    }
+    if (!key || !(type & YYImageCacheTypeDisk)) {
+        [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+        return;
+    }
+    [_bitmapDiskCache removeObjectForKey:key]; // the bitmap may be stale
+    BOOL scaled = pixelSize.width > 0 || pixelSize.height > 0;
+    NSData *extendedData = image ? [NSKeyedArchiver archivedDataWithRootObject:@(image.scale)] : nil;
+    NSFileHandle *file = [NSFileHandle fileHandleForReadingAtPath:path];
+    NSData *header = [file readDataOfLength:16];
+    [file closeFile];
+    if ([_diskCache setFileAtPath:path extendedData:extendedData forKey:key]) {
+        [self _persistImageOfType:YYImageDetectType((__bridge CFDataRef)header) image:image fullSize:!scaled forKey:key];
+    }
+}
+
 - (void)removeImageForKey:(NSString *)key {
     [self removeImageForKey:key withType:YYImageCacheTypeAll];
 }
 
 - (void)removeImageForKey:(NSString *)key withType:(YYImageCacheType)type {
-    if (type & YYImageCacheTypeMemory) [_memoryCache removeObjectForKey:key];
-    if (type & YYImageCacheTypeDisk) [_diskCache removeObjectForKey:key];
+    if (!key) return;
+    if (type & YYImageCacheTypeMemory) {
+        [_memoryCache removeObjectForKey:key];
+        [self _removeVariantMemoryImagesForKey:key];
+    }
+    if (type & YYImageCacheTypeDisk) {
+        [_diskCache removeObjectForKey:key];
+        [_bitmapDiskCache removeObjectForKey:key];
+    }
 }
 
 - (BOOL)containsImageForKey:(NSString *)key {
@@ -175,8 +575,10 @@ static inline dispatch_queue_t YYImageCacheDecodeQueue() {
 }
 
 - (BOOL)containsImageForKey:(NSString *)key withType:(YYImageCacheType)type {
+    if (!key) return NO;
     if (type & YYImageCacheTypeMemory) {
         if ([_memoryCache containsObjectForKey:key]) return YES;
+        if ([self _containsVariantMemoryImageForKey:key]) return YES;
     }
     if (type & YYImageCacheTypeDisk) {
         if ([_diskCache containsObjectForKey:key]) return YES;
@@ -189,16 +591,24 @@ static inline dispatch_queue_t YYImageCacheDecodeQueue() {
 }
 
 - (UIImage *)getImageForKey:(NSString *)key withType:(YYImageCacheType)type {
+    return [self getImageForKey:key withType:type pixelSize:CGSizeZero];
+}
+
+- (UIImage *)getImageForKey:(NSString *)key withType:(YYImageCacheType)type pixelSize:(CGSize)pixelSize {
     if (!key) return nil;
+    NSString *memoryKey = YYImageCacheMemoryKey(key, pixelSize);
     if (type & YYImageCacheTypeMemory) {
-        UIImage *image = [_memoryCache objectForKey:key];
-        if (image) return image;
+        UIImage *image = [_memoryCache objectForKey:memoryKey];
+        if (image) {
+            [self _memoryImageWillDisplay:image];
+            return image;
+        }
     }
     if (type & YYImageCacheTypeDisk) {
-        NSData *data = (id)[_diskCache objectForKey:key];
-        UIImage *image = [self imageFromData:data];
+        UIImage *image = [self _diskImageForKey:key pixelSize:pixelSize];
         if (image && (type & YYImageCacheTypeMemory)) {
-            [_memoryCache setObject:image forKey:key withCost:[self imageCost:image]];
+            [self _addVariantMemoryKey:memoryKey forKey:key];
+            [self _setMemoryImage:image forKey:memoryKey dataLength:0];
         }
         return image;
     }
@@ -213,6 +623,7 @@ static inline dispatch_queue_t YYImageCacheDecodeQueue() {
         if (type & YYImageCacheTypeMemory) {
             image = [_memoryCache objectForKey:key];
             if (image) {
+                [self _memoryImageWillDisplay:image];
                 dispatch_async(dispatch_get_main_queue(), ^{
                     block(image, YYImageCacheTypeMemory);
                 });
@@ -221,10 +632,9 @@ static inline dispatch_queue_t YYImageCacheDecodeQueue() {
         }
         
         if (type & YYImageCacheTypeDisk) {
-            NSData *data = (id)[_diskCache objectForKey:key];
-            image = [self imageFromData:data];
+            image = [self _diskImageForKey:key pixelSize:CGSizeZero];
             if (image) {
-                [_memoryCache setObject:image forKey:key];
+                [self _setMemoryImage:image forKey:key dataLength:0];
                 dispatch_async(dispatch_get_main_queue(), ^{
                     block(image, YYImageCacheTypeDisk);
                 });
@@ -135,6 +135,13 @@ typedef NS_ENUM(NSUInteger, YYImageBlendOperation) {
 @property (nonatomic, readonly) NSUInteger height;         ///< Image canvas height.
 @property (nonatomic, readonly, getter=isFinalized) BOOL finalized;
 
+/**
+ Whether frames can be decoded concurrently from multiple threads.
+ It's YES when the decoder is finalized and the frames don't need blending 
+ (for example GIF, or WebP/APNG with full size frames).
+ */
+@property (nonatomic, readonly) BOOL supportsConcurrentDecoding;
+
 /**
  Creates an image decoder.
  
@@ -162,6 +169,26 @@ typedef NS_ENUM(NSUInteger, YYImageBlendOperation) {
  */
 - (BOOL)updateData:(nullable NSData *)data final:(BOOL)final;
 
+/**
+ Updates the incremental image with new data segments.
+ 
+ @discussion This method is the same as `updateData:final:`, but the data accumulated
+ so far is passed as a list of segments (for example, the packets received from
+ network), so the caller don't need to copy them into a contiguous buffer.
+ 
+ The segments of a JPEG/PNG/GIF (or other ImageIO supported) image are read by the
+ image source through a data provider without being flattened, and the decoder's 
+ `data` is nil until it's updated with `updateData:final:`. Other images (and the 
+ final data) are flattened into one buffer.
+ 
+ @param segments The segments of all the image file data accumulated so far.
+    The segments are retained by decoder, you should not modify them.
+ @param final    A value that specifies whether the data is the final set.
+ 
+ @return Whether succeed.
+ */
+- (BOOL)updateDataSegments:(NSArray<NSData *> *)segments final:(BOOL)final;
+
 /**
  Convenience method to create a decoder with specified data.
  @param data  Image data.
@@ -179,6 +206,46 @@ typedef NS_ENUM(NSUInteger, YYImageBlendOperation) {
  */
 - (nullable YYImageFrame *)frameAtIndex:(NSUInteger)index decodeForDisplay:(BOOL)decodeForDisplay;
 
+/**
+ Decodes and returns a frame from a specified index, scaled down to a target size.
+ 
+ @discussion A thumbnail should not cost a full resolution bitmap. The frame is 
+ scaled down (keeping aspect ratio) until it just covers the `pixelSize`, it is 
+ never scaled up. A single frame JPEG/PNG/WebP image is decoded with the codec's 
+ native scaling (JPEG DCT scaling via ImageIO, WebP `use_scaling`), other images
+ are decoded at full size and then resampled with vImage.
+ 
+ @param index  Frame image index (zero-based).
+ @param decodeForDisplay Whether decode the image to memory bitmap for display.
+ @param pixelSize The target size in pixels (display orientation). Pass CGSizeZero 
+    to decode at full resolution, or pass 0 in one dimension to ignore it.
+ @return A new frame with image, or nil if an error occurs.
+ */
+- (nullable YYImageFrame *)frameAtIndex:(NSUInteger)index
+                       decodeForDisplay:(BOOL)decodeForDisplay
+                              pixelSize:(CGSize)pixelSize;
+
+/**
+ Decodes and returns a region of the first frame.
+
+ @discussion A very large image (long screenshot, map) may cost more memory than
+ we can afford if decoded as a whole. This method decodes only the pixels inside
+ `rect`, so the peak memory is about the size of the result bitmap. WebP is decoded
+ with the codec's native cropping and scaling. ImageIO formats are decoded once for
+ each `scale` (level of detail) at the scaled size, the decoder keeps the bitmap of
+ the last scale and crops the regions of that scale from it, so decode the tiles
+ level by level. Other images are decoded as a whole and cropped.
+
+ The decoder should be finalized. The rect is in the pixel coordinate of the
+ encoded image (the EXIF orientation is not applied).
+
+ @param rect  The region in pixels, it will be clipped to the image bounds.
+ @param scale The sampling scale in range (0,1]. For example, 0.5 returns a bitmap
+    with half width and height of the `rect`.
+ @return A decoded image (with the decoder's scale), or nil if an error occurs.
+ */
+- (nullable UIImage *)decodeRect:(CGRect)rect scale:(CGFloat)scale;
+
 /**
  Returns the frame duration from a specified index.
  @param index  Frame image (zero-based).
@@ -432,6 +499,16 @@ CG_EXTERN CGImageRef _Nullable YYCGImageCreateAffineTransformCopy(CGImageRef ima
                                                                   CGSize destSize,
                                                                   CGBitmapInfo destBitmapInfo);
 
+/**
+ Create a scaled image copy with vImage (Lanczos resampling).
+ 
+ @param imageRef  Source image.
+ @param destSize  Destination image size in pixels.
+ @return A new image in BGRA8888 (premultiplied) or BGRX8888 format, which can be
+    displayed without additional decode, or NULL if an error occurs.
+ */
+CG_EXTERN CGImageRef _Nullable YYCGImageCreateScaledCopy(CGImageRef imageRef, CGSize destSize);
+
 /**
  Encode an image to data with CGImageDestination.
  
@@ -442,6 +519,44 @@ CG_EXTERN CGImageRef _Nullable YYCGImageCreateAffineTransformCopy(CGImageRef ima
  */
 CG_EXTERN CFDataRef _Nullable YYCGImageCreateEncodedData(CGImageRef imageRef, YYImageType type, CGFloat quality);
 
+/**
+ Create raw bitmap data from an image, which can be displayed without decode.
+ 
+ @discussion The raw bitmap data contains a 64-byte header (size, pixel format, 
+ scale and orientation) and the image's pixels in BGRA8888 (premultiplied) or 
+ BGRX8888 format, each row is 64-byte aligned. The data is written in host byte
+ order, so it should not be shared with other devices. If `compress` is YES, the 
+ pixels are compressed with LZ4 (block format) if it makes the data smaller.
+ 
+ @param imageRef    The image.
+ @param scale       The image scale, stored in the header.
+ @param orientation The image orientation, stored in the header.
+ @param compress    Whether to compress the pixels with LZ4.
+ @return A new raw bitmap data, or NULL if an error occurs.
+ */
+CG_EXTERN CFDataRef _Nullable YYCGImageCreateRawBitmapData(CGImageRef imageRef,
+                                                           CGFloat scale,
+                                                           UIImageOrientation orientation,
+                                                           BOOL compress);
+
+/**
+ Create an image from raw bitmap data (created by `YYCGImageCreateRawBitmapData()`).
+ 
+ @discussion If the pixels are not compressed, the image references the pixels in
+ the data without copy and retains the data, so an image created from memory-mapped 
+ data (see `NSDataReadingMappedIfSafe`) loads its pixels from file on demand, and 
+ doesn't cost dirty memory. Compressed pixels are decompressed to a buffer rented
+ from YYBitmapBufferPool.
+ 
+ @param data        The raw bitmap data.
+ @param scale       Output the image scale, pass NULL to ignore.
+ @param orientation Output the image orientation, pass NULL to ignore.
+ @return A new image, or NULL if the data is invalid.
+ */
+CG_EXTERN CGImageRef _Nullable YYCGImageCreateWithRawBitmapData(CFDataRef data,
+                                                                CGFloat *_Nullable scale,
+                                                                UIImageOrientation *_Nullable orientation);
+
 
 /**
  Whether WebP is available in YYImage.
@@ -20,6 +20,7 @@
 #import <pthread.h>
 #import <zlib.h>
 #import "YYImage.h"
+#import "YYBitmapBufferPool.h"
 #import "YYKitMacro.h"
 
 #ifndef YYIMAGE_WEBP_ENABLED
@@ -640,6 +641,20 @@ static inline CGFloat YYImageDegreesToRadians(CGFloat degrees) {
     return degrees * M_PI / 180;
 }
 
+/**
+ Returns the size that an image should be scaled down to for a target size.
+ The result keeps the aspect ratio and just covers the target size (aspect fill).
+ Returns CGSizeZero if the image is already small enough.
+ */
+static CGSize YYImageDownsampledSize(size_t width, size_t height, CGSize targetSize) {
+    if (width == 0 || height == 0) return CGSizeZero;
+    CGFloat scaleX = targetSize.width > 0 ? targetSize.width / width : 0;
+    CGFloat scaleY = targetSize.height > 0 ? targetSize.height / height : 0;
+    CGFloat scale = MAX(scaleX, scaleY);
+    if (scale <= 0 || scale >= 1) return CGSizeZero;
+    return CGSizeMake(MAX(1, round(width * scale)), MAX(1, round(height * scale)));
+}
+
 CGColorSpaceRef YYCGColorSpaceGetDeviceRGB() {
     static CGColorSpaceRef space;
     static dispatch_once_t onceToken;
@@ -821,14 +836,16 @@ static BOOL YYCGImageDecodeToBitmapBufferWith32BitFormat(CGImageRef srcImage, vI
     } else {
         contextBitmapInfo |= alphaFirst ? kCGImageAlphaPremultipliedFirst : kCGImageAlphaPremultipliedLast;
     }
-    CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, YYCGColorSpaceGetDeviceRGB(), contextBitmapInfo);
+    size_t bytesPerRow = YYImageByteAlign(width * 4, 32);
+    size_t length = height * bytesPerRow;
+    CGContextRef context = NULL;
+    void *data = [[YYBitmapBufferPool sharedPool] rentBufferWithLength:length]; // temporary canvas
+    if (!data) goto fail;
+    memset(data, 0, length);
+    context = CGBitmapContextCreate(data, width, height, 8, bytesPerRow, YYCGColorSpaceGetDeviceRGB(), contextBitmapInfo);
     if (!context) goto fail;
     
     CGContextDrawImage(context, CGRectMake(0, 0, width, height), srcImage); // decode and convert
-    size_t bytesPerRow = CGBitmapContextGetBytesPerRow(context);
-    size_t length = height * bytesPerRow;
-    void *data = CGBitmapContextGetData(context);
-    if (length == 0 || !data) goto fail;
     
     dest->data = malloc(length);
     dest->width = width;
@@ -854,14 +871,125 @@ static BOOL YYCGImageDecodeToBitmapBufferWith32BitFormat(CGImageRef srcImage, vI
     }
     
     CFRelease(context);
+    [[YYBitmapBufferPool sharedPool] returnBuffer:data length:length];
     return YES;
     
 fail:
     if (context) CFRelease(context);
+    if (data) [[YYBitmapBufferPool sharedPool] returnBuffer:data length:length];
     if (dest->data) free(dest->data);
     dest->data = NULL;
     return NO;
-    return NO;
+}
+
+/**
+ Redraw an image to a new bitmap image (BGRA8888 premultiplied or BGRX8888),
+ same as UIGraphicsBeginImageContext() and -[UIView drawRect:].
+ The bitmap is rented from the shared YYBitmapBufferPool, and will be returned
+ to the pool when the image is released.
+ 
+ @param imageRef The source image.
+ @param width    The destination width in pixels.
+ @param height   The destination height in pixels.
+ @return A new image, or NULL if an error occurs.
+ */
+static CGImageRef YYCGImageCreateRedrawnCopy(CGImageRef imageRef, size_t width, size_t height) CF_RETURNS_RETAINED {
+    if (!imageRef || width == 0 || height == 0) return NULL;
+    CGImageAlphaInfo alphaInfo = CGImageGetAlphaInfo(imageRef) & kCGBitmapAlphaInfoMask;
+    BOOL hasAlpha = NO;
+    if (alphaInfo == kCGImageAlphaPremultipliedLast ||
+        alphaInfo == kCGImageAlphaPremultipliedFirst ||
+        alphaInfo == kCGImageAlphaLast ||
+        alphaInfo == kCGImageAlphaFirst) {
+        hasAlpha = YES;
+    }
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host;
+    bitmapInfo |= hasAlpha ? kCGImageAlphaPremultipliedFirst : kCGImageAlphaNoneSkipFirst;
+    size_t bytesPerRow = YYImageByteAlign(width * 4, 32);
+    size_t length = bytesPerRow * height;
+    
+    YYBitmapBufferPool *pool = [YYBitmapBufferPool sharedPool];
+    void *data = [pool rentBufferWithLength:length];
+    if (!data) return NULL;
+    if (hasAlpha) memset(data, 0, length); // the buffer may be dirty
+    CGContextRef context = CGBitmapContextCreate(data, width, height, 8, bytesPerRow, YYCGColorSpaceGetDeviceRGB(), bitmapInfo);
+    if (!context) {
+        [pool returnBuffer:data length:length];
+        return NULL;
+    }
+    if (width != CGImageGetWidth(imageRef) || height != CGImageGetHeight(imageRef)) {
+        CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
+    }
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), imageRef); // decode
+    CFRelease(context);
+    
+    CGDataProviderRef provider = YYBitmapBufferPoolCreateDataProvider(data, length);
+    if (!provider) {
+        [pool returnBuffer:data length:length];
+        return NULL;
+    }
+    CGImageRef newImage = CGImageCreate(width, height, 8, 32, bytesPerRow, YYCGColorSpaceGetDeviceRGB(), bitmapInfo, provider, NULL, false, kCGRenderingIntentDefault);
+    CFRelease(provider);
+    return newImage;
+}
+
+/**
+ Creates a bitmap image from a bitmap context's current content, like
+ CGBitmapContextCreateImage(), but the copy is rented from YYBitmapBufferPool,
+ so the animation frames with same size can reuse the memory.
+ The content is copied immediately, so only use it for the images which are
+ kept (the returned frames), not for a transient snapshot.
+ 
+ @param context A bitmap context.
+ @return A new image, or NULL if an error occurs.
+ */
+static CGImageRef YYCGBitmapContextCreatePooledImage(CGContextRef context) CF_RETURNS_RETAINED {
+    if (!context) return NULL;
+    void *contextData = CGBitmapContextGetData(context);
+    size_t width = CGBitmapContextGetWidth(context);
+    size_t height = CGBitmapContextGetHeight(context);
+    size_t bytesPerRow = CGBitmapContextGetBytesPerRow(context);
+    size_t length = bytesPerRow * height;
+    if (!contextData || length == 0) return CGBitmapContextCreateImage(context);
+    
+    YYBitmapBufferPool *pool = [YYBitmapBufferPool sharedPool];
+    void *data = [pool rentBufferWithLength:length];
+    if (!data) return NULL;
+    memcpy(data, contextData, length);
+    CGDataProviderRef provider = YYBitmapBufferPoolCreateDataProvider(data, length);
+    if (!provider) {
+        [pool returnBuffer:data length:length];
+        return NULL;
+    }
+    CGImageRef image = CGImageCreate(width, height,
+                                     CGBitmapContextGetBitsPerComponent(context),
+                                     CGBitmapContextGetBitsPerPixel(context),
+                                     bytesPerRow,
+                                     CGBitmapContextGetColorSpace(context),
+                                     CGBitmapContextGetBitmapInfo(context),
+                                     provider, NULL, false, kCGRenderingIntentDefault);
+    CFRelease(provider);
+    return image;
+}
+
+/**
+ Decode a region of an image to a new bitmap image (BGRA8888 premultiplied or BGRX8888).
+ If the source image is lazily decoded (kCGImageSourceShouldCache = NO), ImageIO only 
+ keeps the result bitmap in memory.
+ 
+ @param imageRef The source image.
+ @param rect     The region in source image's pixel coordinate (top-left origin).
+ @param width    The destination width in pixels.
+ @param height   The destination height in pixels.
+ @return A new image, or NULL if an error occurs.
+ */
+static CGImageRef YYCGImageCreateRegionCopy(CGImageRef imageRef, CGRect rect, size_t width, size_t height) CF_RETURNS_RETAINED {
+    if (!imageRef || width == 0 || height == 0) return NULL;
+    CGImageRef regionRef = CGImageCreateWithImageInRect(imageRef, rect);
+    if (!regionRef) return NULL;
+    CGImageRef newImage = YYCGImageCreateRedrawnCopy(regionRef, width, height);
+    CFRelease(regionRef);
+    return newImage;
 }
 
 CGImageRef YYCGImageCreateDecodedCopy(CGImageRef imageRef, BOOL decodeForDisplay) {
@@ -871,24 +999,8 @@ CGImageRef YYCGImageCreateDecodedCopy(CGImageRef imageRef, BOOL decodeForDisplay
     if (width == 0 || height == 0) return NULL;
     
     if (decodeForDisplay) { //decode with redraw (may lose some precision)
-        CGImageAlphaInfo alphaInfo = CGImageGetAlphaInfo(imageRef) & kCGBitmapAlphaInfoMask;
-        BOOL hasAlpha = NO;
-        if (alphaInfo == kCGImageAlphaPremultipliedLast ||
-            alphaInfo == kCGImageAlphaPremultipliedFirst ||
-            alphaInfo == kCGImageAlphaLast ||
-            alphaInfo == kCGImageAlphaFirst) {
-            hasAlpha = YES;
-        }
-        // BGRA8888 (premultiplied) or BGRX8888
-        // same as UIGraphicsBeginImageContext() and -[UIView drawRect:]
-        CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host;
-        bitmapInfo |= hasAlpha ? kCGImageAlphaPremultipliedFirst : kCGImageAlphaNoneSkipFirst;
-        CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, YYCGColorSpaceGetDeviceRGB(), bitmapInfo);
-        if (!context) return NULL;
-        CGContextDrawImage(context, CGRectMake(0, 0, width, height), imageRef); // decode
-        CGImageRef newImage = CGBitmapContextCreateImage(context);
-        CFRelease(context);
-        return newImage;
+        // BGRA8888 (premultiplied) or BGRX8888, the bitmap is reused through YYBitmapBufferPool
+        return YYCGImageCreateRedrawnCopy(imageRef, width, height);
         
     } else {
         CGColorSpaceRef space = CGImageGetColorSpace(imageRef);
@@ -977,6 +1089,58 @@ fail:
     return NULL;
 }
 
+CGImageRef YYCGImageCreateScaledCopy(CGImageRef imageRef, CGSize destSize) {
+    if (!imageRef) return NULL;
+    size_t srcWidth = CGImageGetWidth(imageRef);
+    size_t srcHeight = CGImageGetHeight(imageRef);
+    size_t destWidth = round(destSize.width);
+    size_t destHeight = round(destSize.height);
+    if (srcWidth == 0 || srcHeight == 0 || destWidth == 0 || destHeight == 0) return NULL;
+    
+    CGImageAlphaInfo alphaInfo = CGImageGetAlphaInfo(imageRef) & kCGBitmapAlphaInfoMask;
+    BOOL hasAlpha = NO;
+    if (alphaInfo == kCGImageAlphaPremultipliedLast ||
+        alphaInfo == kCGImageAlphaPremultipliedFirst ||
+        alphaInfo == kCGImageAlphaLast ||
+        alphaInfo == kCGImageAlphaFirst) {
+        hasAlpha = YES;
+    }
+    // BGRA8888 (premultiplied) or BGRX8888, resample premultiplied pixels to avoid color fringes
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host;
+    bitmapInfo |= hasAlpha ? kCGImageAlphaPremultipliedFirst : kCGImageAlphaNoneSkipFirst;
+    
+    CGDataProviderRef provider = NULL;
+    CGImageRef destImage = NULL;
+    vImage_Buffer src = {0}, dest = {0};
+    if (!YYCGImageDecodeToBitmapBufferWith32BitFormat(imageRef, &src, bitmapInfo)) return NULL;
+    
+    size_t destBytesPerRow = YYImageByteAlign(destWidth * 4, 32);
+    size_t destLength = destHeight * destBytesPerRow;
+    dest.data = malloc(destLength);
+    if (!dest.data) goto fail;
+    dest.width = destWidth;
+    dest.height = destHeight;
+    dest.rowBytes = destBytesPerRow;
+    
+    // vImageScale uses a SIMD Lanczos kernel (3 lobes, or 5 lobes for high quality).
+    vImage_Error error = vImageScale_ARGB8888(&src, &dest, NULL, kvImageNoFlags);
+    if (error != kvImageNoError) goto fail;
+    free(src.data);
+    src.data = NULL;
+    
+    provider = CGDataProviderCreateWithData(dest.data, dest.data, destLength, YYCGDataProviderReleaseDataCallback);
+    if (!provider) goto fail;
+    dest.data = NULL; // hold by provider
+    destImage = CGImageCreate(destWidth, destHeight, 8, 32, destBytesPerRow, YYCGColorSpaceGetDeviceRGB(), bitmapInfo, provider, NULL, false, kCGRenderingIntentDefault);
+    CFRelease(provider);
+    return destImage;
+    
+fail:
+    if (src.data) free(src.data);
+    if (dest.data) free(dest.data);
+    return NULL;
+}
+
 UIImageOrientation YYUIImageOrientationFromEXIFValue(NSInteger value) {
     switch (value) {
         case kCGImagePropertyOrientationUp: return UIImageOrientationUp;
@@ -1227,6 +1391,307 @@ CFDataRef YYCGImageCreateEncodedData(CGImageRef imageRef, YYImageType type, CGFl
     return data;
 }
 
+#pragma mark - Raw Bitmap
+
+#define YY_RAW_BITMAP_MAGIC 0x4D425959 // "YYBM"
+#define YY_RAW_BITMAP_VERSION 1
+#define YY_RAW_BITMAP_FLAG_LZ4 (1 << 0)
+
+/**
+ The header of raw bitmap data (64 bytes, host byte order),
+ followed by the pixels (maybe compressed).
+ */
+typedef struct {
+    uint32_t magic;       ///< YY_RAW_BITMAP_MAGIC
+    uint16_t version;     ///< YY_RAW_BITMAP_VERSION
+    uint16_t flags;       ///< YY_RAW_BITMAP_FLAG_*
+    uint32_t width;       ///< in pixels
+    uint32_t height;      ///< in pixels
+    uint32_t bytesPerRow;
+    uint32_t bitmapInfo;  ///< CGBitmapInfo
+    uint32_t orientation; ///< UIImageOrientation
+    float scale;
+    uint32_t pixelLength; ///< length of the pixels after the header
+    uint8_t reserved[28];
+} yy_raw_bitmap_header;
+
+#define YY_LZ4_MIN_MATCH 4
+#define YY_LZ4_LAST_LITERALS 5 // the last 5 bytes are always literals
+#define YY_LZ4_MF_LIMIT 12     // the last match starts at least 12 bytes before the end
+#define YY_LZ4_MAX_OFFSET 65535
+#define YY_LZ4_HASH_LOG 14
+
+static inline uint32_t YYLZ4Read32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+static inline uint64_t YYLZ4Read64(const uint8_t *p) {
+    uint64_t value;
+    memcpy(&value, p, 8);
+    return value;
+}
+
+static inline uint8_t *YYLZ4WriteLength(uint8_t *op, size_t length) {
+    for (; length >= 255; length -= 255) *op++ = 255;
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+/**
+ Write a LZ4 sequence (literals and a match).
+ 
+ @param offset      The match offset, 0 for the last sequence (literals only).
+ @param matchLength The match length minus YY_LZ4_MIN_MATCH.
+ @return The new output position, or NULL if the output buffer is full.
+ */
+static uint8_t *YYLZ4WriteSequence(uint8_t *op, uint8_t *oend, const uint8_t *literal, size_t literalLength, size_t offset, size_t matchLength) {
+    size_t need = 1 + literalLength + literalLength / 255 + 1;
+    if (offset) need += 2 + matchLength / 255 + 1;
+    if ((size_t)(oend - op) < need) return NULL;
+    
+    uint8_t *token = op++;
+    if (literalLength >= 15) {
+        *token = 15 << 4;
+        op = YYLZ4WriteLength(op, literalLength - 15);
+    } else {
+        *token = (uint8_t)(literalLength << 4);
+    }
+    memcpy(op, literal, literalLength);
+    op += literalLength;
+    if (offset) {
+        *op++ = (uint8_t)(offset & 0xFF);
+        *op++ = (uint8_t)(offset >> 8);
+        if (matchLength >= 15) {
+            *token |= 15;
+            op = YYLZ4WriteLength(op, matchLength - 15);
+        } else {
+            *token |= (uint8_t)matchLength;
+        }
+    }
+    return op;
+}
+
+/**
+ Compress data to LZ4 block format (a greedy matcher like LZ4's fast mode).
+ 
+ @return The compressed length, or 0 if the output buffer is not large enough.
+ */
+static size_t YYLZ4Compress(const uint8_t *src, size_t length, uint8_t *dst, size_t capacity) {
+    const uint8_t *ip = src, *anchor = src, *iend = src + length;
+    uint8_t *op = dst, *oend = dst + capacity;
+    if (length > YY_LZ4_MF_LIMIT) {
+        uint32_t *table = calloc(1 << YY_LZ4_HASH_LOG, sizeof(uint32_t)); // position of last 4-byte sequences
+        if (!table) return 0;
+        const uint8_t *mflimit = iend - YY_LZ4_MF_LIMIT;
+        const uint8_t *matchlimit = iend - YY_LZ4_LAST_LITERALS;
+        while (ip < mflimit) {
+            uint32_t sequence = YYLZ4Read32(ip);
+            uint32_t hash = (sequence * 2654435761U) >> (32 - YY_LZ4_HASH_LOG);
+            const uint8_t *ref = src + table[hash];
+            table[hash] = (uint32_t)(ip - src);
+            if (ref >= ip || ip - ref > YY_LZ4_MAX_OFFSET || YYLZ4Read32(ref) != sequence) {
+                ip += 1 + ((ip - anchor) >> 6); // skip faster in incompressible data
+                continue;
+            }
+            size_t offset = ip - ref;
+            const uint8_t *matchEnd = ip + YY_LZ4_MIN_MATCH;
+            ref += YY_LZ4_MIN_MATCH;
+            while (matchEnd + 8 <= matchlimit && YYLZ4Read64(matchEnd) == YYLZ4Read64(ref)) {
+                matchEnd += 8;
+                ref += 8;
+            }
+            while (matchEnd < matchlimit && *matchEnd == *ref) {
+                matchEnd++;
+                ref++;
+            }
+            op = YYLZ4WriteSequence(op, oend, anchor, ip - anchor, offset, matchEnd - ip - YY_LZ4_MIN_MATCH);
+            if (!op) break;
+            ip = anchor = matchEnd;
+        }
+        free(table);
+        if (!op) return 0;
+    }
+    op = YYLZ4WriteSequence(op, oend, anchor, iend - anchor, 0, 0);
+    return op ? op - dst : 0;
+}
+
+/**
+ Decompress LZ4 block format data.
+ 
+ @return The decompressed length, or 0 if the data is invalid.
+ */
+static size_t YYLZ4Decompress(const uint8_t *src, size_t length, uint8_t *dst, size_t capacity) {
+    const uint8_t *ip = src, *iend = src + length;
+    uint8_t *op = dst, *oend = dst + capacity;
+    while (ip < iend) {
+        uint8_t token = *ip++;
+        uint8_t byte;
+        
+        size_t literalLength = token >> 4;
+        if (literalLength == 15) {
+            do {
+                if (ip >= iend) return 0;
+                byte = *ip++;
+                literalLength += byte;
+            } while (byte == 255);
+        }
+        if (literalLength > (size_t)(iend - ip) || literalLength > (size_t)(oend - op)) return 0;
+        memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+        if (ip == iend) break; // the last sequence has no match
+        
+        if (iend - ip < 2) return 0;
+        size_t offset = ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) return 0;
+        size_t matchLength = token & 15;
+        if (matchLength == 15) {
+            do {
+                if (ip >= iend) return 0;
+                byte = *ip++;
+                matchLength += byte;
+            } while (byte == 255);
+        }
+        matchLength += YY_LZ4_MIN_MATCH;
+        if (matchLength > (size_t)(oend - op)) return 0;
+        
+        // the match may overlap the output, copy the repeated bytes doubly each time
+        const uint8_t *match = op - offset;
+        while (matchLength > 0) {
+            size_t copyLength = MIN((size_t)(op - match), matchLength);
+            memcpy(op, match, copyLength);
+            op += copyLength;
+            matchLength -= copyLength;
+        }
+    }
+    return op - dst;
+}
+
+static void YYRawBitmapDataProviderRelease(void *info, const void *data, size_t size) {
+    if (info) CFRelease(info);
+}
+
+CFDataRef YYCGImageCreateRawBitmapData(CGImageRef imageRef, CGFloat scale, UIImageOrientation orientation, BOOL compress) {
+    if (!imageRef) return NULL;
+    size_t width = CGImageGetWidth(imageRef);
+    size_t height = CGImageGetHeight(imageRef);
+    if (width == 0 || height == 0 || width > UINT32_MAX / 4 || height > UINT32_MAX) return NULL;
+    CGImageAlphaInfo alphaInfo = CGImageGetAlphaInfo(imageRef) & kCGBitmapAlphaInfoMask;
+    BOOL hasAlpha = NO;
+    if (alphaInfo == kCGImageAlphaPremultipliedLast ||
+        alphaInfo == kCGImageAlphaPremultipliedFirst ||
+        alphaInfo == kCGImageAlphaLast ||
+        alphaInfo == kCGImageAlphaFirst) {
+        hasAlpha = YES;
+    }
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host;
+    bitmapInfo |= hasAlpha ? kCGImageAlphaPremultipliedFirst : kCGImageAlphaNoneSkipFirst;
+    size_t bytesPerRow = YYImageByteAlign(width * 4, 64);
+    size_t pixelLength = bytesPerRow * height;
+    if (pixelLength > UINT32_MAX) return NULL;
+    size_t headerLength = sizeof(yy_raw_bitmap_header);
+    
+    CFMutableDataRef data = CFDataCreateMutable(CFAllocatorGetDefault(), 0);
+    if (!data) return NULL;
+    CFDataSetLength(data, headerLength + pixelLength); // zero-filled
+    uint8_t *pixels = CFDataGetMutableBytePtr(data) + headerLength;
+    CGContextRef context = CGBitmapContextCreate(pixels, width, height, 8, bytesPerRow, YYCGColorSpaceGetDeviceRGB(), bitmapInfo);
+    if (!context) {
+        CFRelease(data);
+        return NULL;
+    }
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), imageRef); // decode
+    CFRelease(context);
+    
+    yy_raw_bitmap_header header = {0};
+    header.magic = YY_RAW_BITMAP_MAGIC;
+    header.version = YY_RAW_BITMAP_VERSION;
+    header.width = (uint32_t)width;
+    header.height = (uint32_t)height;
+    header.bytesPerRow = (uint32_t)bytesPerRow;
+    header.bitmapInfo = bitmapInfo;
+    header.orientation = (uint32_t)orientation;
+    header.scale = scale;
+    header.pixelLength = (uint32_t)pixelLength;
+    
+    if (compress) {
+        // keep the pixels uncompressed if the compressed data is not smaller
+        uint8_t *buffer = malloc(pixelLength);
+        size_t compressedLength = buffer ? YYLZ4Compress(pixels, pixelLength, buffer, pixelLength - 1) : 0;
+        if (compressedLength > 0) {
+            memcpy(pixels, buffer, compressedLength);
+            CFDataSetLength(data, headerLength + compressedLength);
+            header.flags |= YY_RAW_BITMAP_FLAG_LZ4;
+            header.pixelLength = (uint32_t)compressedLength;
+        }
+        if (buffer) free(buffer);
+    }
+    memcpy(CFDataGetMutableBytePtr(data), &header, headerLength);
+    return data;
+}
+
+CGImageRef YYCGImageCreateWithRawBitmapData(CFDataRef data, CGFloat *scale, UIImageOrientation *orientation) {
+    if (!data) return NULL;
+    size_t headerLength = sizeof(yy_raw_bitmap_header);
+    size_t length = CFDataGetLength(data);
+    const uint8_t *bytes = CFDataGetBytePtr(data);
+    if (!bytes || length < headerLength) return NULL;
+    
+    yy_raw_bitmap_header header;
+    memcpy(&header, bytes, headerLength);
+    if (header.magic != YY_RAW_BITMAP_MAGIC || header.version != YY_RAW_BITMAP_VERSION) return NULL;
+    if (header.width == 0 || header.height == 0 || header.bytesPerRow < (uint64_t)header.width * 4) return NULL;
+    if (header.pixelLength != length - headerLength) return NULL;
+    if (header.orientation > UIImageOrientationRightMirrored) return NULL;
+    CGImageAlphaInfo alphaInfo = header.bitmapInfo & kCGBitmapAlphaInfoMask;
+    if ((header.bitmapInfo & kCGBitmapByteOrderMask) != kCGBitmapByteOrder32Host ||
+        (alphaInfo != kCGImageAlphaPremultipliedFirst && alphaInfo != kCGImageAlphaNoneSkipFirst)) return NULL;
+    
+    // validate the size before any allocation, the data may be corrupted (the product may overflow in 32-bit)
+    uint64_t decodedLength = (uint64_t)header.bytesPerRow * header.height;
+    if (decodedLength > UINT32_MAX) return NULL; // same limit as the writer
+    if (header.flags & YY_RAW_BITMAP_FLAG_LZ4) {
+        // each LZ4 input byte produces at most 255 output bytes
+        if (decodedLength > (uint64_t)header.pixelLength * 255) return NULL;
+    } else {
+        if (decodedLength != header.pixelLength) return NULL;
+    }
+    size_t pixelLength = (size_t)decodedLength;
+    
+    CGDataProviderRef provider = NULL;
+    if (header.flags & YY_RAW_BITMAP_FLAG_LZ4) {
+        YYBitmapBufferPool *pool = [YYBitmapBufferPool sharedPool];
+        void *pixels = [pool rentBufferWithLength:pixelLength];
+        if (!pixels) return NULL;
+        if (YYLZ4Decompress(bytes + headerLength, header.pixelLength, pixels, pixelLength) != pixelLength) {
+            [pool returnBuffer:pixels length:pixelLength];
+            return NULL;
+        }
+        provider = YYBitmapBufferPoolCreateDataProvider(pixels, pixelLength);
+        if (!provider) {
+            [pool returnBuffer:pixels length:pixelLength];
+            return NULL;
+        }
+    } else {
+        // reference the pixels without copy, the data is released with the provider
+        CFRetain(data);
+        provider = CGDataProviderCreateWithData((void *)data, bytes + headerLength, pixelLength, YYRawBitmapDataProviderRelease);
+        if (!provider) {
+            CFRelease(data);
+            return NULL;
+        }
+    }
+    CGImageRef imageRef = CGImageCreate(header.width, header.height, 8, 32, header.bytesPerRow, YYCGColorSpaceGetDeviceRGB(), header.bitmapInfo, provider, NULL, false, kCGRenderingIntentDefault);
+    CFRelease(provider);
+    if (!imageRef) return NULL;
+    if (scale) *scale = header.scale;
+    if (orientation) *orientation = header.orientation;
+    return imageRef;
+}
+
 #if YYIMAGE_WEBP_ENABLED
 
 BOOL YYImageWebPAvailable() {
@@ -1504,11 +1969,75 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
 @end
 
 
+/// Image data segments read through a direct data provider.
+typedef struct {
+    CFArrayRef segments; ///< Array<NSData>
+    size_t *offsets;     ///< offset of each segment
+    size_t count;
+    size_t length;
+} YYImageDataSegments;
+
+static size_t YYImageDataSegmentsGetBytes(void *info, void *buffer, off_t position, size_t count) {
+    YYImageDataSegments *ctx = info;
+    if (position < 0 || (size_t)position >= ctx->length || ctx->count == 0) return 0;
+    if (count > ctx->length - (size_t)position) count = ctx->length - (size_t)position;
+    
+    // find the last segment which begins at or before the position
+    size_t lo = 0, hi = ctx->count - 1;
+    while (lo < hi) {
+        size_t mid = (lo + hi + 1) / 2;
+        if (ctx->offsets[mid] <= (size_t)position) lo = mid;
+        else hi = mid - 1;
+    }
+    size_t copied = 0;
+    for (size_t i = lo; i < ctx->count && copied < count; i++) {
+        CFDataRef segment = CFArrayGetValueAtIndex(ctx->segments, i);
+        size_t begin = (size_t)position + copied - ctx->offsets[i];
+        size_t segmentLength = CFDataGetLength(segment);
+        if (begin >= segmentLength) continue;
+        size_t size = MIN(segmentLength - begin, count - copied);
+        memcpy((uint8_t *)buffer + copied, CFDataGetBytePtr(segment) + begin, size);
+        copied += size;
+    }
+    return copied;
+}
+
+static void YYImageDataSegmentsRelease(void *info) {
+    YYImageDataSegments *ctx = info;
+    if (ctx->segments) CFRelease(ctx->segments);
+    if (ctx->offsets) free(ctx->offsets);
+    free(ctx);
+}
+
+/// Creates a direct data provider over data segments (not copied).
+static CGDataProviderRef YYCGDataProviderCreateWithSegments(NSArray *segments) {
+    if (segments.count == 0) return NULL;
+    YYImageDataSegments *ctx = calloc(1, sizeof(YYImageDataSegments));
+    if (!ctx) return NULL;
+    ctx->offsets = malloc(segments.count * sizeof(size_t));
+    if (!ctx->offsets) {
+        free(ctx);
+        return NULL;
+    }
+    ctx->segments = CFBridgingRetain(segments.copy);
+    ctx->count = segments.count;
+    for (NSUInteger i = 0; i < segments.count; i++) {
+        ctx->offsets[i] = ctx->length;
+        ctx->length += ((NSData *)segments[i]).length;
+    }
+    CGDataProviderDirectCallbacks callbacks = {0, NULL, NULL, YYImageDataSegmentsGetBytes, YYImageDataSegmentsRelease};
+    CGDataProviderRef provider = CGDataProviderCreateDirect(ctx, ctx->length, &callbacks);
+    if (!provider) YYImageDataSegmentsRelease(ctx);
+    return provider;
+}
+
 @implementation YYImageDecoder {
     pthread_mutex_t _lock; // recursive lock
     
     BOOL _sourceTypeDetected;
     CGImageSourceRef _source;
+    CGDataProviderRef _sourceDataProvider; ///< the data segments of an incremental ImageIO source
+    NSUInteger _sourceDataLength;
     yy_png_info *_apngSource;
 #if YYIMAGE_WEBP_ENABLED
     WebPDemuxer *_webpSource;
@@ -1518,17 +2047,22 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
     dispatch_semaphore_t _framesLock;
     NSArray *_frames; ///< Array<GGImageDecoderFrame>, without image
     BOOL _needBlend;
+    BOOL _concurrentDecodable; ///< finalized and no blend, accessed with atomic load/store
     NSUInteger _blendFrameIndex;
     CGContextRef _blendCanvas;
+    CGImageRef _regionImage; ///< the image of the last decoded level of detail, shared by its regions
+    size_t _regionImageMaxPixelSize;
 }
 
 - (void)dealloc {
     if (_source) CFRelease(_source);
+    if (_sourceDataProvider) CFRelease(_sourceDataProvider);
     if (_apngSource) yy_png_info_release(_apngSource);
 #if YYIMAGE_WEBP_ENABLED
     if (_webpSource) WebPDemuxDelete(_webpSource);
 #endif
     if (_blendCanvas) CFRelease(_blendCanvas);
+    if (_regionImage) CFRelease(_regionImage);
     pthread_mutex_destroy(&_lock);
 }
 
@@ -1557,11 +2091,32 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
     BOOL result = NO;
     pthread_mutex_lock(&_lock);
     result = [self _updateData:data final:final];
+    [self _updateConcurrentDecodable];
     pthread_mutex_unlock(&_lock);
     return result;
 }
 
+- (BOOL)updateDataSegments:(NSArray<NSData *> *)segments final:(BOOL)final {
+    BOOL result = NO;
+    pthread_mutex_lock(&_lock);
+    result = [self _updateDataSegments:segments final:final];
+    [self _updateConcurrentDecodable];
+    pthread_mutex_unlock(&_lock);
+    return result;
+}
+
+- (BOOL)supportsConcurrentDecoding {
+    return __atomic_load_n(&_concurrentDecodable, __ATOMIC_ACQUIRE);
+}
+
 - (YYImageFrame *)frameAtIndex:(NSUInteger)index decodeForDisplay:(BOOL)decodeForDisplay {
+    if (__atomic_load_n(&_concurrentDecodable, __ATOMIC_ACQUIRE)) {
+        // The sources and frames will not change after finalized, and there's
+        // no blend canvas to share, so the frames can be decoded concurrently.
+        // The ImageIO calls on the shared source are still serialized by _lock
+        // (see _newUnblendedImageAtIndex:), only the decoding runs in parallel.
+        return [self _frameAtIndex:index decodeForDisplay:decodeForDisplay];
+    }
     YYImageFrame *result = nil;
     pthread_mutex_lock(&_lock);
     result = [self _frameAtIndex:index decodeForDisplay:decodeForDisplay];
@@ -1569,6 +2124,22 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
     return result;
 }
 
+- (YYImageFrame *)frameAtIndex:(NSUInteger)index decodeForDisplay:(BOOL)decodeForDisplay pixelSize:(CGSize)pixelSize {
+    YYImageFrame *result = nil;
+    pthread_mutex_lock(&_lock);
+    result = [self _frameAtIndex:index decodeForDisplay:decodeForDisplay pixelSize:pixelSize];
+    pthread_mutex_unlock(&_lock);
+    return result;
+}
+
+- (UIImage *)decodeRect:(CGRect)rect scale:(CGFloat)scale {
+    UIImage *result = nil;
+    pthread_mutex_lock(&_lock);
+    result = [self _decodeRect:rect scale:scale];
+    pthread_mutex_unlock(&_lock);
+    return result;
+}
+
 - (NSTimeInterval)frameDurationAtIndex:(NSUInteger)index {
     NSTimeInterval result = 0;
     dispatch_semaphore_wait(_framesLock, DISPATCH_TIME_FOREVER);
@@ -1597,11 +2168,23 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
 
 #pragma private (wrap)
 
+/// Publishes the state read by the lock-free path, must be called in _lock.
+/// The release store pairs with the acquire load in frameAtIndex:decodeForDisplay:,
+/// so a reader which sees YES also sees the finalized sources and frames.
+- (void)_updateConcurrentDecodable {
+    __atomic_store_n(&_concurrentDecodable, (BOOL)(_finalized && !_needBlend), __ATOMIC_RELEASE);
+}
+
 - (BOOL)_updateData:(NSData *)data final:(BOOL)final {
     if (_finalized) return NO;
-    if (data.length < _data.length) return NO;
+    if (data.length < MAX(_data.length, _sourceDataLength)) return NO;
     _finalized = final;
     _data = data;
+    _sourceDataLength = data.length;
+    if (_sourceDataProvider) {
+        CFRelease(_sourceDataProvider);
+        _sourceDataProvider = NULL;
+    }
     
     YYImageType type = YYImageDetectType((__bridge CFDataRef)data);
     if (_sourceTypeDetected) {
@@ -1620,6 +2203,56 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
     return YES;
 }
 
+- (BOOL)_updateDataSegments:(NSArray *)segments final:(BOOL)final {
+    if (_finalized || segments.count == 0) return NO;
+    if (segments.count == 1) return [self _updateData:segments.firstObject final:final];
+    
+    NSUInteger length = 0;
+    for (NSData *segment in segments) length += segment.length;
+    if (length < MAX(_data.length, _sourceDataLength)) return NO;
+    
+    YYImageType type = YYImageTypeUnknown;
+    if (length > 16) {
+        uint8_t header[16];
+        NSUInteger headerLength = 0;
+        for (NSData *segment in segments) {
+            NSUInteger size = MIN(segment.length, 16 - headerLength);
+            [segment getBytes:header + headerLength length:size];
+            headerLength += size;
+            if (headerLength == 16) break;
+        }
+        CFDataRef headerData = CFDataCreateWithBytesNoCopy(NULL, header, 16, kCFAllocatorNull);
+        if (headerData) {
+            type = YYImageDetectType(headerData);
+            CFRelease(headerData);
+        }
+    }
+    
+    BOOL readSegments = !final;
+    switch (type) { // the types decoded by ImageIO
+        case YYImageTypeUnknown:
+        case YYImageTypeWebP:
+        case YYImageTypeOther: readSegments = NO; break;
+        default: break;
+    }
+    if (!readSegments || (_sourceTypeDetected && _type != type)) {
+        NSMutableData *data = [NSMutableData dataWithCapacity:length];
+        for (NSData *segment in segments) [data appendData:segment];
+        return [self _updateData:data final:final];
+    }
+    
+    CGDataProviderRef provider = YYCGDataProviderCreateWithSegments(segments);
+    if (!provider) return NO;
+    if (_sourceDataProvider) CFRelease(_sourceDataProvider);
+    _sourceDataProvider = provider;
+    _sourceDataLength = length;
+    _data = nil;
+    _type = type;
+    _sourceTypeDetected = YES;
+    [self _updateSource];
+    return YES;
+}
+
 - (YYImageFrame *)_frameAtIndex:(NSUInteger)index decodeForDisplay:(BOOL)decodeForDisplay {
     if (index >= _frames.count) return 0;
     _YYImageDecoderFrame *frame = [(_YYImageDecoderFrame *)_frames[index] copy];
@@ -1665,7 +2298,7 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
                 CGContextDrawImage(_blendCanvas, CGRectMake(frame.offsetX, frame.offsetY, frame.width, frame.height), unblendedImage);
                 CFRelease(unblendedImage);
             }
-            imageRef = CGBitmapContextCreateImage(_blendCanvas);
+            imageRef = YYCGBitmapContextCreatePooledImage(_blendCanvas);
             if (frame.dispose == YYImageDisposeBackground) {
                 CGContextClearRect(_blendCanvas, CGRectMake(frame.offsetX, frame.offsetY, frame.width, frame.height));
             }
@@ -1700,6 +2333,86 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
     return frame;
 }
 
+- (YYImageFrame *)_frameAtIndex:(NSUInteger)index decodeForDisplay:(BOOL)decodeForDisplay pixelSize:(CGSize)pixelSize {
+    if (index >= _frames.count) return nil;
+    CGSize targetSize = pixelSize;
+    switch (_orientation) { // pixelSize is in display orientation
+        case UIImageOrientationLeft:
+        case UIImageOrientationRight:
+        case UIImageOrientationLeftMirrored:
+        case UIImageOrientationRightMirrored: {
+            targetSize = CGSizeMake(pixelSize.height, pixelSize.width);
+        } break;
+        default: break;
+    }
+    CGSize scaledSize = CGSizeZero;
+    if (_type != YYImageTypeICO) { // ICO contains multi-size frame, just pick the frame.
+        scaledSize = YYImageDownsampledSize(_width, _height, targetSize);
+    }
+    if (scaledSize.width == 0 || scaledSize.height == 0) {
+        return [self _frameAtIndex:index decodeForDisplay:decodeForDisplay];
+    }
+    
+    // try format-native scaling first
+    BOOL decoded = NO;
+    CGImageRef imageRef = [self _newDownsampledImageAtIndex:index size:scaledSize decoded:&decoded];
+    if (imageRef) {
+        if (decodeForDisplay && !decoded) {
+            CGImageRef imageRefDecoded = YYCGImageCreateDecodedCopy(imageRef, YES);
+            if (imageRefDecoded) {
+                CFRelease(imageRef);
+                imageRef = imageRefDecoded;
+                decoded = YES;
+            }
+        }
+        UIImage *image = [UIImage imageWithCGImage:imageRef scale:_scale orientation:_orientation];
+        CFRelease(imageRef);
+        if (!image) return nil;
+        image.isDecodedForDisplay = decoded;
+        _YYImageDecoderFrame *frame = [(_YYImageDecoderFrame *)_frames[index] copy];
+        frame.image = image;
+        frame.width = scaledSize.width;
+        frame.height = scaledSize.height;
+        return frame;
+    }
+    
+    // decode at full size, then resample
+    YYImageFrame *frame = [self _frameAtIndex:index decodeForDisplay:decodeForDisplay];
+    CGImageRef fullImageRef = frame.image.CGImage;
+    if (!fullImageRef) return frame;
+    CGFloat scale = scaledSize.width / _width;
+    size_t width = CGImageGetWidth(fullImageRef);
+    size_t height = CGImageGetHeight(fullImageRef);
+    imageRef = YYCGImageCreateScaledCopy(fullImageRef, CGSizeMake(MAX(1, round(width * scale)), MAX(1, round(height * scale))));
+    if (!imageRef) return frame;
+    UIImage *image = [UIImage imageWithCGImage:imageRef scale:_scale orientation:frame.image.imageOrientation];
+    CFRelease(imageRef);
+    if (!image) return frame;
+    image.isDecodedForDisplay = YES;
+    frame.image = image;
+    frame.width = round(frame.width * scale);
+    frame.height = round(frame.height * scale);
+    frame.offsetX = round(frame.offsetX * scale);
+    frame.offsetY = round(frame.offsetY * scale);
+    return frame;
+}
+
+- (UIImage *)_decodeRect:(CGRect)rect scale:(CGFloat)scale {
+    if (!_finalized || _frames.count == 0) return nil;
+    if (scale <= 0 || scale > 1) scale = 1;
+    rect = CGRectIntersection(CGRectIntegral(rect), CGRectMake(0, 0, _width, _height));
+    if (CGRectIsNull(rect) || CGRectIsEmpty(rect)) return nil;
+    size_t width = MAX(1, round(rect.size.width * scale));
+    size_t height = MAX(1, round(rect.size.height * scale));
+    
+    CGImageRef imageRef = [self _newRegionImageWithRect:rect width:width height:height];
+    if (!imageRef) return nil;
+    UIImage *image = [UIImage imageWithCGImage:imageRef scale:_scale orientation:UIImageOrientationUp];
+    CFRelease(imageRef);
+    image.isDecodedForDisplay = YES;
+    return image;
+}
+
 - (NSDictionary *)_framePropertiesAtIndex:(NSUInteger)index {
     if (index >= _frames.count) return nil;
     if (!_source) return nil;
@@ -1945,7 +2658,10 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
     _frames = nil;
     dispatch_semaphore_signal(_framesLock);
     
-    if (!_source) {
+    if (_sourceDataProvider) { // data segments, not finalized
+        if (!_source) _source = CGImageSourceCreateIncremental(NULL);
+        if (_source) CGImageSourceUpdateDataProvider(_source, _sourceDataProvider, false);
+    } else if (!_source) {
         if (_finalized) {
             _source = CGImageSourceCreateWithData((__bridge CFDataRef)_data, NULL);
         } else {
@@ -2044,7 +2760,11 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
     _YYImageDecoderFrame *frame = _frames[index];
     
     if (_source) {
+        // CGImageSource is not safe to be accessed from multiple threads,
+        // lock it in case this is called from the concurrent decoding path.
+        pthread_mutex_lock(&_lock);
         CGImageRef imageRef = CGImageSourceCreateImageAtIndex(_source, index, (CFDictionaryRef)@{(id)kCGImageSourceShouldCache:@(YES)});
+        pthread_mutex_unlock(&_lock);
         if (imageRef && extendToCanvas) {
             size_t width = CGImageGetWidth(imageRef);
             size_t height = CGImageGetHeight(imageRef);
@@ -2144,11 +2864,13 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
         size_t length = bytesPerRow * height;
         CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst; //bgrA
         
-        void *pixels = calloc(1, length);
+        YYBitmapBufferPool *pool = [YYBitmapBufferPool sharedPool];
+        void *pixels = [pool rentBufferWithLength:length];
         if (!pixels) {
             WebPDemuxReleaseIterator(&iter);
             return NULL;
         }
+        memset(pixels, 0, length);
         
         config.output.colorspace = MODE_bgrA;
         config.output.is_external_memory = 1;
@@ -2158,13 +2880,13 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
         VP8StatusCode result = WebPDecode(payload, payloadSize, &config); // decode
         if ((result != VP8_STATUS_OK) && (result != VP8_STATUS_NOT_ENOUGH_DATA)) {
             WebPDemuxReleaseIterator(&iter);
-            free(pixels);
+            [pool returnBuffer:pixels length:length];
             return NULL;
         }
         WebPDemuxReleaseIterator(&iter);
         
         if (extendToCanvas && (iter.x_offset != 0 || iter.y_offset != 0)) {
-            void *tmp = calloc(1, length);
+            void *tmp = [pool rentBufferWithLength:length];
             if (tmp) {
                 vImage_Buffer src = {pixels, height, width, bytesPerRow};
                 vImage_Buffer dest = {tmp, height, width, bytesPerRow};
@@ -2174,10 +2896,97 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
                 if (error == kvImageNoError) {
                     memcpy(pixels, tmp, length);
                 }
-                free(tmp);
+                [pool returnBuffer:tmp length:length];
             }
         }
         
+        CGDataProviderRef provider = YYBitmapBufferPoolCreateDataProvider(pixels, length);
+        if (!provider) {
+            [pool returnBuffer:pixels length:length];
+            return NULL;
+        }
+        pixels = NULL; // hold by provider
+        
+        CGImageRef image = CGImageCreate(width, height, bitsPerComponent, bitsPerPixel, bytesPerRow, YYCGColorSpaceGetDeviceRGB(), bitmapInfo, provider, NULL, false, kCGRenderingIntentDefault);
+        CFRelease(provider);
+        if (decoded) *decoded = YES;
+        return image;
+    }
+#endif
+    
+    return NULL;
+}
+
+- (CGImageRef)_newDownsampledImageAtIndex:(NSUInteger)index
+                                    size:(CGSize)size
+                                 decoded:(BOOL *)decoded CF_RETURNS_RETAINED {
+    // Native scaling only works on a single full-size frame without blending.
+    if (_frameCount != 1 || index != 0 || _needBlend) return NULL;
+    if (!_finalized) return NULL;
+    
+    if (_source) {
+        /*
+         The thumbnail API lets the codec decode at a reduced size directly
+         (e.g. JPEG DCT scaling), instead of decoding the full bitmap first.
+         */
+        NSDictionary *options = @{(id)kCGImageSourceCreateThumbnailFromImageAlways : @(YES),
+                                  (id)kCGImageSourceCreateThumbnailWithTransform : @(NO),
+                                  (id)kCGImageSourceThumbnailMaxPixelSize : @(MAX(size.width, size.height))};
+        CGImageRef imageRef = CGImageSourceCreateThumbnailAtIndex(_source, index, (CFDictionaryRef)options);
+        if (imageRef && decoded) *decoded = NO;
+        return imageRef;
+    }
+    
+#if YYIMAGE_WEBP_ENABLED
+    if (_webpSource) {
+        WebPIterator iter;
+        if (!WebPDemuxGetFrame(_webpSource, 1, &iter)) return NULL;
+        if (iter.x_offset != 0 || iter.y_offset != 0 || iter.width != _width || iter.height != _height) {
+            WebPDemuxReleaseIterator(&iter);
+            return NULL;
+        }
+        const uint8_t *payload = iter.fragment.bytes;
+        size_t payloadSize = iter.fragment.size;
+        
+        WebPDecoderConfig config;
+        if (!WebPInitDecoderConfig(&config)) {
+            WebPDemuxReleaseIterator(&iter);
+            return NULL;
+        }
+        if (WebPGetFeatures(payload , payloadSize, &config.input) != VP8_STATUS_OK) {
+            WebPDemuxReleaseIterator(&iter);
+            return NULL;
+        }
+        
+        int width = size.width;
+        int height = size.height;
+        size_t bitsPerComponent = 8;
+        size_t bitsPerPixel = 32;
+        size_t bytesPerRow = YYImageByteAlign(bitsPerPixel / 8 * width, 32);
+        size_t length = bytesPerRow * height;
+        CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst; //bgrA
+        
+        void *pixels = calloc(1, length);
+        if (!pixels) {
+            WebPDemuxReleaseIterator(&iter);
+            return NULL;
+        }
+        
+        config.options.use_scaling = 1; // scale while decoding
+        config.options.scaled_width = width;
+        config.options.scaled_height = height;
+        config.output.colorspace = MODE_bgrA;
+        config.output.is_external_memory = 1;
+        config.output.u.RGBA.rgba = pixels;
+        config.output.u.RGBA.stride = (int)bytesPerRow;
+        config.output.u.RGBA.size = length;
+        VP8StatusCode result = WebPDecode(payload, payloadSize, &config); // decode
+        WebPDemuxReleaseIterator(&iter);
+        if ((result != VP8_STATUS_OK) && (result != VP8_STATUS_NOT_ENOUGH_DATA)) {
+            free(pixels);
+            return NULL;
+        }
+        
         CGDataProviderRef provider = CGDataProviderCreateWithData(pixels, pixels, length, YYCGDataProviderReleaseDataCallback);
         if (!provider) {
             free(pixels);
@@ -2195,6 +3004,97 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
     return NULL;
 }
 
+- (CGImageRef)_newRegionImageWithRect:(CGRect)rect width:(size_t)width height:(size_t)height CF_RETURNS_RETAINED {
+    BOOL singleFrame = _frameCount == 1 && !_needBlend;
+    
+#if YYIMAGE_WEBP_ENABLED
+    // libwebp may snap odd crop offsets to even, so only use it for even offsets.
+    if (_webpSource && singleFrame && ((int)rect.origin.x & 1) == 0 && ((int)rect.origin.y & 1) == 0) {
+        WebPIterator iter;
+        if (WebPDemuxGetFrame(_webpSource, 1, &iter)) {
+            CGImageRef image = NULL;
+            void *pixels = NULL;
+            CGDataProviderRef provider = NULL;
+            WebPDecoderConfig config;
+            VP8StatusCode result;
+            size_t bytesPerRow = YYImageByteAlign(4 * width, 32);
+            size_t length = bytesPerRow * height;
+            const uint8_t *payload = iter.fragment.bytes;
+            size_t payloadSize = iter.fragment.size;
+            
+            if (iter.x_offset != 0 || iter.y_offset != 0 || iter.width != _width || iter.height != _height) goto webp_end;
+            if (!WebPInitDecoderConfig(&config)) goto webp_end;
+            if (WebPGetFeatures(payload, payloadSize, &config.input) != VP8_STATUS_OK) goto webp_end;
+            pixels = calloc(1, length);
+            if (!pixels) goto webp_end;
+            
+            config.options.use_cropping = 1; // decode the region only
+            config.options.crop_left = rect.origin.x;
+            config.options.crop_top = rect.origin.y;
+            config.options.crop_width = rect.size.width;
+            config.options.crop_height = rect.size.height;
+            if (width != (size_t)rect.size.width || height != (size_t)rect.size.height) {
+                config.options.use_scaling = 1;
+                config.options.scaled_width = (int)width;
+                config.options.scaled_height = (int)height;
+            }
+            config.output.colorspace = MODE_bgrA;
+            config.output.is_external_memory = 1;
+            config.output.u.RGBA.rgba = pixels;
+            config.output.u.RGBA.stride = (int)bytesPerRow;
+            config.output.u.RGBA.size = length;
+            result = WebPDecode(payload, payloadSize, &config);
+            if ((result != VP8_STATUS_OK) && (result != VP8_STATUS_NOT_ENOUGH_DATA)) goto webp_end;
+            
+            provider = CGDataProviderCreateWithData(pixels, pixels, length, YYCGDataProviderReleaseDataCallback);
+            if (!provider) goto webp_end;
+            pixels = NULL; // hold by provider
+            image = CGImageCreate(width, height, 8, 32, bytesPerRow, YYCGColorSpaceGetDeviceRGB(), kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst, provider, NULL, false, kCGRenderingIntentDefault); //bgrA
+            CFRelease(provider);
+            
+        webp_end:
+            if (pixels) free(pixels);
+            WebPDemuxReleaseIterator(&iter);
+            if (image) return image;
+        }
+    }
+#endif
+    
+    if (_source && singleFrame) {
+        /*
+         The image is decoded once for each level of detail (sampling scale), at the
+         level's size with the thumbnail API, and the regions of the level are cropped
+         from it. So the tiles of one level don't decode the whole image again, and a
+         low level doesn't decode the full size bitmap.
+         */
+        CGFloat scale = MIN(1, (CGFloat)width / rect.size.width);
+        size_t maxPixelSize = MAX(1, (size_t)ceil(MAX(_width, _height) * scale));
+        if (!_regionImage || _regionImageMaxPixelSize != maxPixelSize) {
+            if (_regionImage) CFRelease(_regionImage);
+            NSDictionary *options = @{(id)kCGImageSourceCreateThumbnailFromImageAlways : @(YES),
+                                      (id)kCGImageSourceCreateThumbnailWithTransform : @(NO),
+                                      (id)kCGImageSourceThumbnailMaxPixelSize : @(maxPixelSize)};
+            _regionImage = CGImageSourceCreateThumbnailAtIndex(_source, 0, (CFDictionaryRef)options);
+            _regionImageMaxPixelSize = maxPixelSize;
+        }
+        if (_regionImage) {
+            CGFloat scaleX = (CGFloat)CGImageGetWidth(_regionImage) / _width;
+            CGFloat scaleY = (CGFloat)CGImageGetHeight(_regionImage) / _height;
+            CGRect levelRect = CGRectMake(rect.origin.x * scaleX, rect.origin.y * scaleY,
+                                          rect.size.width * scaleX, rect.size.height * scaleY);
+            CGImageRef image = YYCGImageCreateRegionCopy(_regionImage, levelRect, width, height);
+            if (image) return image;
+        }
+    }
+    
+    // decode the whole frame, then crop
+    YYImageFrame *frame = [self _frameAtIndex:0 decodeForDisplay:YES];
+    CGImageRef imageRef = frame.image.CGImage;
+    if (!imageRef) return NULL;
+    if (CGImageGetWidth(imageRef) != _width || CGImageGetHeight(imageRef) != _height) return NULL;
+    return YYCGImageCreateRegionCopy(imageRef, rect, width, height);
+}
+
 - (BOOL)_createBlendContextIfNeeded {
     if (!_blendCanvas) {
         _blendFrameIndex = NSNotFound;
@@ -2231,27 +3131,27 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
     CGImageRef imageRef = NULL;
     if (frame.dispose == YYImageDisposePrevious) {
         if (frame.blend == YYImageBlendOver) {
-            CGImageRef previousImage = CGBitmapContextCreateImage(_blendCanvas);
+            CGImageRef previousImage = CGBitmapContextCreateImage(_blendCanvas); // transient, copy-on-write
             CGImageRef unblendImage = [self _newUnblendedImageAtIndex:frame.index extendToCanvas:NO decoded:NULL];
             if (unblendImage) {
                 CGContextDrawImage(_blendCanvas, CGRectMake(frame.offsetX, frame.offsetY, frame.width, frame.height), unblendImage);
                 CFRelease(unblendImage);
             }
-            imageRef = CGBitmapContextCreateImage(_blendCanvas);
+            imageRef = YYCGBitmapContextCreatePooledImage(_blendCanvas);
             CGContextClearRect(_blendCanvas, CGRectMake(0, 0, _width, _height));
             if (previousImage) {
                 CGContextDrawImage(_blendCanvas, CGRectMake(0, 0, _width, _height), previousImage);
                 CFRelease(previousImage);
             }
         } else {
-            CGImageRef previousImage = CGBitmapContextCreateImage(_blendCanvas);
+            CGImageRef previousImage = CGBitmapContextCreateImage(_blendCanvas); // transient, copy-on-write
             CGImageRef unblendImage = [self _newUnblendedImageAtIndex:frame.index extendToCanvas:NO decoded:NULL];
             if (unblendImage) {
                 CGContextClearRect(_blendCanvas, CGRectMake(frame.offsetX, frame.offsetY, frame.width, frame.height));
                 CGContextDrawImage(_blendCanvas, CGRectMake(frame.offsetX, frame.offsetY, frame.width, frame.height), unblendImage);
                 CFRelease(unblendImage);
             }
-            imageRef = CGBitmapContextCreateImage(_blendCanvas);
+            imageRef = YYCGBitmapContextCreatePooledImage(_blendCanvas);
             CGContextClearRect(_blendCanvas, CGRectMake(0, 0, _width, _height));
             if (previousImage) {
                 CGContextDrawImage(_blendCanvas, CGRectMake(0, 0, _width, _height), previousImage);
@@ -2265,7 +3165,7 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
                 CGContextDrawImage(_blendCanvas, CGRectMake(frame.offsetX, frame.offsetY, frame.width, frame.height), unblendImage);
                 CFRelease(unblendImage);
             }
-            imageRef = CGBitmapContextCreateImage(_blendCanvas);
+            imageRef = YYCGBitmapContextCreatePooledImage(_blendCanvas);
             CGContextClearRect(_blendCanvas, CGRectMake(frame.offsetX, frame.offsetY, frame.width, frame.height));
         } else {
             CGImageRef unblendImage = [self _newUnblendedImageAtIndex:frame.index extendToCanvas:NO decoded:NULL];
@@ -2274,7 +3174,7 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
                 CGContextDrawImage(_blendCanvas, CGRectMake(frame.offsetX, frame.offsetY, frame.width, frame.height), unblendImage);
                 CFRelease(unblendImage);
             }
-            imageRef = CGBitmapContextCreateImage(_blendCanvas);
+            imageRef = YYCGBitmapContextCreatePooledImage(_blendCanvas);
             CGContextClearRect(_blendCanvas, CGRectMake(frame.offsetX, frame.offsetY, frame.width, frame.height));
         }
     } else { // no dispose
@@ -2284,7 +3184,7 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
                 CGContextDrawImage(_blendCanvas, CGRectMake(frame.offsetX, frame.offsetY, frame.width, frame.height), unblendImage);
                 CFRelease(unblendImage);
             }
-            imageRef = CGBitmapContextCreateImage(_blendCanvas);
+            imageRef = YYCGBitmapContextCreatePooledImage(_blendCanvas);
         } else {
             CGImageRef unblendImage = [self _newUnblendedImageAtIndex:frame.index extendToCanvas:NO decoded:NULL];
             if (unblendImage) {
@@ -2292,7 +3192,7 @@ CGImageRef YYCGImageCreateWithWebPData(CFDataRef webpData,
                 CGContextDrawImage(_blendCanvas, CGRectMake(frame.offsetX, frame.offsetY, frame.width, frame.height), unblendImage);
                 CFRelease(unblendImage);
             }
-            imageRef = CGBitmapContextCreateImage(_blendCanvas);
+            imageRef = YYCGBitmapContextCreatePooledImage(_blendCanvas);
         }
     }
     return imageRef;
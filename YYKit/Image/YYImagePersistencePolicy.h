@@ -0,0 +1,151 @@
+//
+//  YYImagePersistencePolicy.h
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import <UIKit/UIKit.h>
+
+#if __has_include(<YYKit/YYKit.h>)
+#import <YYKit/YYImageCoder.h>
+#else
+#import "YYImageCoder.h"
+#endif
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// How the data of an image is persisted in disk cache.
+typedef NS_ENUM(NSUInteger, YYImagePersistence) {
+
+    /// Keep the original image data.
+    YYImagePersistenceOriginal = 0,
+
+    /// Keep the original image data first, then transcode it to a format which
+    /// decodes faster (JPEG for opaque image, PNG for image with alpha) in idle time.
+    /// The transcoded data replaces the original data, see `allowTranscode`.
+    YYImagePersistenceTranscode,
+
+    /// Keep the original image data, and also keep the decoded bitmap in the
+    /// bitmap disk cache (see `YYImageCache.bitmapDiskCache`), which can be
+    /// displayed without decode.
+    YYImagePersistenceBitmap,
+};
+
+/**
+ YYImagePersistencePolicy decides how the data of an image is persisted by `YYImageCache`.
+
+ @discussion The policy measures the decode time of each image format (recorded by
+ `YYImageCache` and `YYWebImageOperation` when they decode an image for display),
+ and prefers to transcode an image only if its format decodes much slower than the
+ format it would be transcoded to. So a non-animated GIF or WebP image is not
+ re-encoded if it decodes fast enough on this device, and the original data (which
+ is often smaller) is kept. Animated images, JPEG and PNG images are always kept as is.
+ Transcoding is lossy and replaces the stored data, so it's disabled by default,
+ see `allowTranscode`.
+ If the cache has a bitmap disk cache, the decoded bitmaps of the slow formats are
+ kept too, so they are displayed without decode later.
+
+ The decode costs start with rough estimates and are updated with the moving
+ average of the measured values. This class is thread safe.
+ */
+@interface YYImagePersistencePolicy : NSObject
+
+/**
+ Returns the global policy used by `YYImageCache` by default.
+ */
++ (instancetype)sharedPolicy;
+
+/**
+ Whether the image data can be transcoded (and replaced in disk cache). Default is NO.
+ 
+ @discussion If the value is NO, the original image data is always kept, and only 
+ `YYImagePersistenceOriginal` or `YYImagePersistenceBitmap` is returned.
+ The transcoded data may lose quality (JPEG), metadata and color profile.
+ */
+@property (nonatomic) BOOL allowTranscode;
+
+/**
+ An image is transcoded only if its format's decode cost is larger than the target
+ format's decode cost multiplied by this value. Default is 1.5.
+ */
+@property (nonatomic) double transcodeCostRatio;
+
+/**
+ The transcoded data is dropped (and the original data is kept) if it's larger than
+ the original data multiplied by this value. Default is 1.25.
+ */
+@property (nonatomic) double transcodeSizeRatio;
+
+/**
+ A decoded bitmap is kept only if its format's measured decode cost (nanoseconds
+ per pixel) is not less than this value, the initial estimates are never used. The
+ raw bitmap is several times larger than the encoded data, so the default value is 50,
+ which is above the usual cost of JPEG and PNG. Set 0 to keep the bitmaps of all
+ single frame images.
+ */
+@property (nonatomic) double bitmapCostThreshold;
+
+/**
+ A decoded bitmap is kept only if its size in bytes is not larger than this value. 
+ Default is 16MB (a 2048x2048 image), a larger bitmap costs too much disk space.
+ */
+@property (nonatomic) NSUInteger bitmapSizeLimit;
+
+/**
+ Records a measured decode.
+
+ @param time       The decode time in seconds.
+ @param pixelCount The decoded pixel count (width * height).
+ @param type       The image data type.
+ */
+- (void)recordDecodeTime:(NSTimeInterval)time pixelCount:(NSUInteger)pixelCount type:(YYImageType)type;
+
+/**
+ Returns the decode cost of an image format in nanoseconds per pixel.
+ */
+- (double)decodeCostForType:(YYImageType)type;
+
+/**
+ Returns the format which an image is transcoded to.
+
+ @param hasAlpha Whether the image has alpha channel.
+ @return YYImageTypePNG or YYImageTypeJPEG.
+ */
+- (YYImageType)transcodeTypeWithAlpha:(BOOL)hasAlpha;
+
+/**
+ Decides how to persist an image.
+
+ @param type       The image data type.
+ @param frameCount The frame count of the image (pass 0 if unknown).
+ @param hasAlpha   Whether the image has alpha channel (pass YES if unknown).
+ @return The persistence.
+ */
+- (YYImagePersistence)persistenceForType:(YYImageType)type frameCount:(NSUInteger)frameCount hasAlpha:(BOOL)hasAlpha;
+
+/**
+ Decides how to persist an image, which may be kept as decoded bitmap.
+ 
+ @discussion A single frame image is kept as bitmap if its format is measured to
+ decode slower than `bitmapCostThreshold` and the bitmap is not larger than `bitmapSizeLimit`,
+ otherwise it's same as `persistenceForType:frameCount:hasAlpha:`.
+ 
+ @param type       The image data type.
+ @param frameCount The frame count of the image (pass 0 if unknown).
+ @param hasAlpha   Whether the image has alpha channel (pass YES if unknown).
+ @param bitmapSize The decoded bitmap size in bytes, pass 0 if the bitmap can not be kept.
+ @return The persistence.
+ */
+- (YYImagePersistence)persistenceForType:(YYImageType)type
+                              frameCount:(NSUInteger)frameCount
+                                hasAlpha:(BOOL)hasAlpha
+                              bitmapSize:(NSUInteger)bitmapSize;
+
+@end
+
+NS_ASSUME_NONNULL_END
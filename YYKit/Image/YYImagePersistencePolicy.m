@@ -0,0 +1,119 @@
+//
+//  YYImagePersistencePolicy.m
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import "YYImagePersistencePolicy.h"
+#import <pthread.h>
+
+#define YY_IMAGE_TYPE_COUNT (YYImageTypeOther + 1)
+
+/// The weight of a new sample in the moving average.
+static const double kDecodeCostSampleWeight = 0.2;
+
+/// Small images are ignored, their decode time is dominated by the fixed overhead.
+static const NSUInteger kDecodeCostMinPixelCount = 64 * 64;
+
+
+@implementation YYImagePersistencePolicy {
+    pthread_mutex_t _lock;
+    double _costs[YY_IMAGE_TYPE_COUNT]; ///< nanoseconds per pixel
+    BOOL _measured[YY_IMAGE_TYPE_COUNT]; ///< the cost is measured, not the initial estimate
+}
+
++ (instancetype)sharedPolicy {
+    static YYImagePersistencePolicy *policy = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        policy = [self new];
+    });
+    return policy;
+}
+
+- (instancetype)init {
+    self = [super init];
+    pthread_mutex_init(&_lock, NULL);
+    _transcodeCostRatio = 1.5;
+    _transcodeSizeRatio = 1.25;
+    _bitmapCostThreshold = 50; // above the initial estimates below
+    _bitmapSizeLimit = 2048 * 2048 * 4;
+
+    // rough estimates on iPhone 6, replaced by the measured values soon
+    for (int i = 0; i < YY_IMAGE_TYPE_COUNT; i++) _costs[i] = 30;
+    _costs[YYImageTypeJPEG] = 10;
+    _costs[YYImageTypePNG] = 15;
+    _costs[YYImageTypeGIF] = 20;
+    _costs[YYImageTypeWebP] = 40;
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+- (void)recordDecodeTime:(NSTimeInterval)time pixelCount:(NSUInteger)pixelCount type:(YYImageType)type {
+    if (type >= YY_IMAGE_TYPE_COUNT || time <= 0 || pixelCount < kDecodeCostMinPixelCount) return;
+    double cost = time * 1e9 / pixelCount;
+    pthread_mutex_lock(&_lock);
+    _costs[type] = _costs[type] * (1 - kDecodeCostSampleWeight) + cost * kDecodeCostSampleWeight;
+    _measured[type] = YES;
+    pthread_mutex_unlock(&_lock);
+}
+
+- (double)decodeCostForType:(YYImageType)type {
+    if (type >= YY_IMAGE_TYPE_COUNT) type = YYImageTypeOther;
+    pthread_mutex_lock(&_lock);
+    double cost = _costs[type];
+    pthread_mutex_unlock(&_lock);
+    return cost;
+}
+
+/// Whether the decoded bitmap of the type is worth keeping on disk.
+- (BOOL)_shouldKeepBitmapOfType:(YYImageType)type {
+    if (_bitmapCostThreshold <= 0) return YES;
+    if (type >= YY_IMAGE_TYPE_COUNT) type = YYImageTypeOther;
+    pthread_mutex_lock(&_lock);
+    BOOL keep = _measured[type] && _costs[type] >= _bitmapCostThreshold;
+    pthread_mutex_unlock(&_lock);
+    return keep;
+}
+
+- (YYImageType)transcodeTypeWithAlpha:(BOOL)hasAlpha {
+    return hasAlpha ? YYImageTypePNG : YYImageTypeJPEG;
+}
+
+- (YYImagePersistence)persistenceForType:(YYImageType)type frameCount:(NSUInteger)frameCount hasAlpha:(BOOL)hasAlpha {
+    return [self persistenceForType:type frameCount:frameCount hasAlpha:hasAlpha bitmapSize:0];
+}
+
+- (YYImagePersistence)persistenceForType:(YYImageType)type frameCount:(NSUInteger)frameCount hasAlpha:(BOOL)hasAlpha bitmapSize:(NSUInteger)bitmapSize {
+    if (frameCount == 1 && bitmapSize > 0 && bitmapSize <= _bitmapSizeLimit &&
+        [self _shouldKeepBitmapOfType:type]) {
+        return YYImagePersistenceBitmap;
+    }
+    if (!_allowTranscode) return YYImagePersistenceOriginal;
+    if (frameCount > 1) return YYImagePersistenceOriginal; // transcoding drops the animation
+    switch (type) {
+        case YYImageTypeJPEG:
+        case YYImageTypePNG: {
+            return YYImagePersistenceOriginal;
+        }
+        case YYImageTypeGIF:
+        case YYImageTypeWebP: {
+            double cost = [self decodeCostForType:type];
+            double targetCost = [self decodeCostForType:[self transcodeTypeWithAlpha:hasAlpha]];
+            return cost > targetCost * _transcodeCostRatio ? YYImagePersistenceTranscode : YYImagePersistenceOriginal;
+        }
+        default: { // the other formats may not be supported by YYImage's decoder
+            return YYImagePersistenceTranscode;
+        }
+    }
+}
+
+@end
@@ -0,0 +1,130 @@
+//
+//  YYImageTileCache.h
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import <UIKit/UIKit.h>
+
+@class YYMemoryCache, YYImageDecoder;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ YYImageTileCache is a memory cache for the tiles of very large images.
+
+ @discussion A very large image (long screenshot, map) is split into square tiles
+ in several levels of detail. Level 0 is the full resolution, and each next level
+ halves the width and height (scale = 1 / 2^level). A tile always has `tileSize`
+ pixels on each side (except the tiles on the right and bottom edge), so a tile
+ in level n covers (tileSize * 2^n) pixels of the original image.
+
+ Tiles are keyed by (image key, level, column, row) and decoded on demand with
+ `-[YYImageDecoder decodeRect:scale:]`, so only visible tiles cost memory.
+ */
+@interface YYImageTileCache : NSObject
+
+/** The name of the cache. Default is nil. */
+@property (nullable, copy) NSString *name;
+
+/** The underlying memory cache. see `YYMemoryCache` for more information.*/
+@property (strong, readonly) YYMemoryCache *memoryCache;
+
+/** The side length of a tile in pixels. */
+@property (readonly) NSUInteger tileSize;
+
+/**
+ Returns global shared tile cache instance (tile size is 256 pixels).
+ @return The singleton YYImageTileCache instance.
+ */
++ (instancetype)sharedCache;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+
+/**
+ The designated initializer.
+ @param tileSize The side length of a tile in pixels (should be larger than 0).
+ @return A new cache object, or nil if an error occurs.
+ */
+- (nullable instancetype)initWithTileSize:(NSUInteger)tileSize NS_DESIGNATED_INITIALIZER;
+
+/**
+ Returns the most detailed level that is not larger than needed for a display scale.
+ @param scale The display scale (displayed pixels / image pixels), for example 0.3.
+ @return The level (0 for scale >= 1).
+ */
++ (NSUInteger)levelForScale:(CGFloat)scale;
+
+/**
+ Returns the tile region in the original image's pixel coordinate.
+ @param column The tile's column.
+ @param row    The tile's row.
+ @param level  The level of detail.
+ @return The tile's region (not clipped to image bounds).
+ */
+- (CGRect)rectForTileAtColumn:(NSUInteger)column row:(NSUInteger)row level:(NSUInteger)level;
+
+/**
+ Enumerates the tiles which intersect with a visible rect.
+ @param rect      The visible rect in the original image's pixel coordinate.
+ @param imageSize The original image size in pixels.
+ @param level     The level of detail.
+ @param block     The block to invoke on each tile, `tileRect` is clipped to image bounds.
+ */
+- (void)enumerateTilesInRect:(CGRect)rect
+                   imageSize:(CGSize)imageSize
+                       level:(NSUInteger)level
+                  usingBlock:(void (^)(NSUInteger column, NSUInteger row, CGRect tileRect, BOOL *stop))block;
+
+#pragma mark - Access Methods
+///=============================================================================
+/// @name Access Methods
+///=============================================================================
+
+/**
+ Sets the tile image in the cache.
+ @param tile   The tile image. If nil, this method has no effect.
+ @param key    The key of the original image. If nil, this method has no effect.
+ @param level  The level of detail.
+ @param column The tile's column.
+ @param row    The tile's row.
+ */
+- (void)setTile:(nullable UIImage *)tile forKey:(NSString *)key level:(NSUInteger)level column:(NSUInteger)column row:(NSUInteger)row;
+
+/**
+ Returns the tile image from the cache.
+ @param key    The key of the original image. If nil, this method returns nil.
+ @param level  The level of detail.
+ @param column The tile's column.
+ @param row    The tile's row.
+ @return The cached tile, or nil.
+ */
+- (nullable UIImage *)getTileForKey:(NSString *)key level:(NSUInteger)level column:(NSUInteger)column row:(NSUInteger)row;
+
+/**
+ Returns the tile image from the cache, or decode it with the decoder if not cached.
+
+ @discussion This method may block the calling thread until the tile is decoded.
+
+ @param key     The key of the original image. If nil, this method returns nil.
+ @param decoder A finalized decoder of the original image.
+ @param level   The level of detail.
+ @param column  The tile's column.
+ @param row     The tile's row.
+ @return The tile image, or nil if the tile is out of image bounds or an error occurs.
+ */
+- (nullable UIImage *)tileForKey:(NSString *)key
+                         decoder:(YYImageDecoder *)decoder
+                           level:(NSUInteger)level
+                          column:(NSUInteger)column
+                             row:(NSUInteger)row;
+
+@end
+
+NS_ASSUME_NONNULL_END
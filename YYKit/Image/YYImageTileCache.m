@@ -0,0 +1,120 @@
+//
+//  YYImageTileCache.m
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import "YYImageTileCache.h"
+#import "YYMemoryCache.h"
+#import "YYImageCoder.h"
+
+#define YYImageTileMaxLevel 16
+
+/// Returns the memory cache key for a tile.
+static inline NSString *YYImageTileCacheKey(NSString *key, NSUInteger level, NSUInteger column, NSUInteger row) {
+    return [NSString stringWithFormat:@"%@#%lu_%lu_%lu", key, (unsigned long)level, (unsigned long)column, (unsigned long)row];
+}
+
+@implementation YYImageTileCache
+
+- (NSUInteger)tileCost:(UIImage *)tile {
+    CGImageRef cgImage = tile.CGImage;
+    if (!cgImage) return 1;
+    NSUInteger cost = CGImageGetBytesPerRow(cgImage) * CGImageGetHeight(cgImage);
+    if (cost == 0) cost = 1;
+    return cost;
+}
+
++ (instancetype)sharedCache {
+    static YYImageTileCache *cache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [[self alloc] initWithTileSize:256];
+    });
+    return cache;
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYImageTileCache init error" reason:@"YYImageTileCache must be initialized with a tile size. Use 'initWithTileSize:' instead." userInfo:nil];
+    return [self initWithTileSize:256];
+}
+
+- (instancetype)initWithTileSize:(NSUInteger)tileSize {
+    if (tileSize == 0) return nil;
+    YYMemoryCache *memoryCache = [YYMemoryCache new];
+    if (!memoryCache) return nil;
+    memoryCache.shouldRemoveAllObjectsOnMemoryWarning = YES;
+    memoryCache.shouldRemoveAllObjectsWhenEnteringBackground = YES;
+    memoryCache.costLimit = 64 * 1024 * 1024; // 256 tiles of 256x256 BGRA
+
+    self = [super init];
+    _memoryCache = memoryCache;
+    _tileSize = tileSize;
+    return self;
+}
+
++ (NSUInteger)levelForScale:(CGFloat)scale {
+    if (scale >= 1 || scale <= 0) return 0;
+    NSUInteger level = floor(log2(1.0 / scale));
+    return MIN(level, YYImageTileMaxLevel);
+}
+
+- (CGRect)rectForTileAtColumn:(NSUInteger)column row:(NSUInteger)row level:(NSUInteger)level {
+    CGFloat side = (CGFloat)_tileSize * (1UL << MIN(level, YYImageTileMaxLevel));
+    return CGRectMake(column * side, row * side, side, side);
+}
+
+- (void)enumerateTilesInRect:(CGRect)rect imageSize:(CGSize)imageSize level:(NSUInteger)level usingBlock:(void (^)(NSUInteger, NSUInteger, CGRect, BOOL *))block {
+    if (!block) return;
+    CGRect bounds = CGRectMake(0, 0, imageSize.width, imageSize.height);
+    rect = CGRectIntersection(rect, bounds);
+    if (CGRectIsNull(rect) || CGRectIsEmpty(rect)) return;
+
+    CGFloat side = (CGFloat)_tileSize * (1UL << MIN(level, YYImageTileMaxLevel));
+    NSUInteger firstColumn = floor(CGRectGetMinX(rect) / side);
+    NSUInteger lastColumn = ceil(CGRectGetMaxX(rect) / side) - 1;
+    NSUInteger firstRow = floor(CGRectGetMinY(rect) / side);
+    NSUInteger lastRow = ceil(CGRectGetMaxY(rect) / side) - 1;
+    BOOL stop = NO;
+    for (NSUInteger row = firstRow; row <= lastRow; row++) {
+        for (NSUInteger column = firstColumn; column <= lastColumn; column++) {
+            CGRect tileRect = CGRectMake(column * side, row * side, side, side);
+            tileRect = CGRectIntersection(tileRect, bounds);
+            block(column, row, tileRect, &stop);
+            if (stop) return;
+        }
+    }
+}
+
+- (void)setTile:(UIImage *)tile forKey:(NSString *)key level:(NSUInteger)level column:(NSUInteger)column row:(NSUInteger)row {
+    if (!tile || !key) return;
+    [_memoryCache setObject:tile forKey:YYImageTileCacheKey(key, level, column, row) withCost:[self tileCost:tile]];
+}
+
+- (UIImage *)getTileForKey:(NSString *)key level:(NSUInteger)level column:(NSUInteger)column row:(NSUInteger)row {
+    if (!key) return nil;
+    return [_memoryCache objectForKey:YYImageTileCacheKey(key, level, column, row)];
+}
+
+- (UIImage *)tileForKey:(NSString *)key decoder:(YYImageDecoder *)decoder level:(NSUInteger)level column:(NSUInteger)column row:(NSUInteger)row {
+    if (!key) return nil;
+    NSString *tileKey = YYImageTileCacheKey(key, level, column, row);
+    UIImage *tile = [_memoryCache objectForKey:tileKey];
+    if (tile) return tile;
+    if (!decoder) return nil;
+
+    CGRect bounds = CGRectMake(0, 0, decoder.width, decoder.height);
+    CGRect rect = CGRectIntersection([self rectForTileAtColumn:column row:row level:level], bounds);
+    if (CGRectIsNull(rect) || CGRectIsEmpty(rect)) return nil;
+    CGFloat scale = 1.0 / (1UL << MIN(level, YYImageTileMaxLevel));
+    tile = [decoder decodeRect:rect scale:scale];
+    if (tile) [_memoryCache setObject:tile forKey:tileKey withCost:[self tileCost:tile]];
+    return tile;
+}
+
+@end
@@ -18,6 +18,8 @@
 #endif
 
 @class YYWebImageOperation;
+@class YYWebImageTransform;
+@protocol YYWebImageTransport;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -71,9 +73,23 @@ typedef NS_OPTIONS(NSUInteger, YYWebImageOptions) {
     /// You may set the image manually.
     YYWebImageOptionAvoidSetImage = 1 << 13,
     
-    /// This flag will add the URL to a blacklist (in memory) when the URL fail to be downloaded,
-    /// so the library won't keep trying.
+    /// This flag will add the URL to a blacklist when the URL fail to be downloaded,
+    /// so the library won't keep trying. The URL is blocked for an interval which grows
+    /// with each failure, and the blacklist is kept across launches (see `YYWebImageURLBlacklist`).
     YYWebImageOptionIgnoreFailedURL = 1 << 14,
+    
+    /// Decode the image at the view's pixel size (bounds size * screen scale) instead
+    /// of full resolution. The original image data is still stored in disk cache.
+    /// This flag is used by the view categories, see also the `pixelSize` parameter
+    /// of `requestImageWithURL:options:pixelSize:progress:transform:completion:`.
+    YYWebImageOptionDownsampleToViewSize = 1 << 15,
+    
+    /// Write the received data to a temporary file in the disk cache while downloading,
+    /// and move the file into the disk cache when the image is decoded. The image is
+    /// decoded from the mapped file and stored with the original data (no re-encoding),
+    /// so the downloaded data is not kept in memory. This flag is ignored if the image
+    /// is not stored to disk cache (UseNSURLCache, IgnoreDiskCache or without cache).
+    YYWebImageOptionStreamToDiskCache = 1 << 16,
 };
 
 /// Indicated where the image came from.
@@ -110,6 +126,19 @@ typedef NS_ENUM(NSInteger, YYWebImageStage) {
     YYWebImageStageFinished  = 1,
 };
 
+/// The priority of an image request, used by YYWebImageManager to schedule operations.
+typedef NS_ENUM(NSInteger, YYWebImagePriority) {
+    
+    /// The image may be displayed later (prefetching).
+    YYWebImagePriorityPrefetch    = 0,
+    
+    /// The image's view is about to be visible.
+    YYWebImagePriorityNearVisible = 1,
+    
+    /// The image's view is visible (default).
+    YYWebImagePriorityVisible     = 2,
+};
+
 
 /**
  The block invoked in remote image fetch progress.
@@ -125,6 +154,8 @@ typedef void(^YYWebImageProgressBlock)(NSInteger receivedSize, NSInteger expecte
  @discussion This block will be invoked before `YYWebImageCompletionBlock` to give
  you a chance to do additional image process (such as resize or crop). If there's
  no need to transform the image, just return the `image` parameter.
+ The transformed image replaces the original image in cache, use `YYWebImageTransform`
+ if you want to cache the transformed image separately.
  
  @example You can clip the image, blur it and add rounded corners with these code:
     ^(UIImage *image, NSURL *url) {
@@ -201,6 +232,55 @@ typedef void (^YYWebImageCompletionBlock)(UIImage * _Nullable image,
                                             transform:(nullable YYWebImageTransformBlock)transform
                                            completion:(nullable YYWebImageCompletionBlock)completion;
 
+/**
+ Creates and returns a new image operation which decodes the image at a target
+ pixel size, the operation will start immediately.
+ 
+ @discussion The image is scaled down while decoding (see `YYImageDecoder`), and
+ the memory cache key is derived from the cache key and the `pixelSize`.
+ 
+ @param url        The image url (remote or local file path).
+ @param options    The options to control image operation.
+ @param pixelSize  The target pixel size (pass CGSizeZero to decode at full size).
+ @param progress   Progress block which will be invoked on background thread (pass nil to avoid).
+ @param transform  Transform block which will be invoked on background thread  (pass nil to avoid).
+ @param completion Completion block which will be invoked on background thread  (pass nil to avoid).
+ @return A new image operation.
+ */
+- (nullable YYWebImageOperation *)requestImageWithURL:(NSURL *)url
+                                              options:(YYWebImageOptions)options
+                                            pixelSize:(CGSize)pixelSize
+                                             progress:(nullable YYWebImageProgressBlock)progress
+                                            transform:(nullable YYWebImageTransformBlock)transform
+                                           completion:(nullable YYWebImageCompletionBlock)completion;
+
+/**
+ Creates and returns a new image operation which returns a derived image, the
+ operation will start immediately.
+ 
+ @discussion The derived image is cached separately from the original image, with
+ the key `[imageTransform cacheKeyForKey:]` (see `YYWebImageOperation.imageTransform`),
+ so it's returned from cache without fetching or decoding the original image later.
+ Concurrent requests for the same original image with different transforms share
+ one fetch and decode, then each request transforms the image in background.
+ The `sharedTransformBlock` is not used by this method.
+ 
+ @param url            The image url (remote or local file path).
+ @param options        The options to control image operation.
+ @param pixelSize      The target pixel size to decode the original image at
+                        (pass CGSizeZero to decode at full size).
+ @param imageTransform The transform which creates the derived image (pass nil to return the original image).
+ @param progress       Progress block which will be invoked on background thread (pass nil to avoid).
+ @param completion     Completion block which will be invoked on background thread  (pass nil to avoid).
+ @return A new image operation.
+ */
+- (nullable YYWebImageOperation *)requestImageWithURL:(NSURL *)url
+                                              options:(YYWebImageOptions)options
+                                            pixelSize:(CGSize)pixelSize
+                                       imageTransform:(nullable YYWebImageTransform *)imageTransform
+                                             progress:(nullable YYWebImageProgressBlock)progress
+                                           completion:(nullable YYWebImageCompletionBlock)completion;
+
 /**
  The image cache used by image operation. 
  You can set it to nil to avoid image cache.
@@ -216,6 +296,41 @@ typedef void (^YYWebImageCompletionBlock)(UIImage * _Nullable image,
  */
 @property (nullable, nonatomic, strong) NSOperationQueue *queue;
 
+/**
+ The maximum number of operations which are added to `queue` at the same time.
+ Default is 0, which adds new operations to `queue` immediately (FIFO) as before,
+ set a positive value (for example, 8) to opt in.
+ 
+ @discussion The other operations are kept by the manager until a running operation
+ finishes. The next operation to run is the one with the highest `priority`, and
+ the most recently requested one among the operations with the same priority (LIFO),
+ so after a fast scroll, the images of visible cells are fetched before the ones
+ which have scrolled off. The priority of an operation can be changed while it's
+ waiting (see `-[YYWebImageOperation priority]`).
+ 
+ The waiting operations are not in `queue` yet, so they are not cancelled by
+ `[queue cancelAllOperations]`, cancel them with the operations returned by
+ `requestImageWithURL:...`. This value has no effect if `queue` is nil.
+ */
+@property (nonatomic) NSUInteger maxConcurrentOperationCount;
+
+/**
+ The maximum number of running operations for one host. Default is 0 (no limit),
+ set a positive value (for example, 4) to opt in. This value has no effect if `maxConcurrentOperationCount` is 0.
+ */
+@property (nonatomic) NSUInteger maxConcurrentOperationCountPerHost;
+
+/**
+ The transport which loads the image requests. Default is nil, which means
+ `[YYWebImageSessionTransport sharedTransport]`: a keep-alive connection pool
+ with 4 connections per host. 
+ 
+ @discussion Set a `YYWebImageSessionTransport` with your own session configuration
+ to change the per-host limit or the protocol classes, or your own transport to load
+ images with another network stack.
+ */
+@property (nullable, nonatomic, strong) id<YYWebImageTransport> transport;
+
 /**
  The shared transform block to process image. Default is nil.
  
@@ -229,6 +344,17 @@ typedef void (^YYWebImageCompletionBlock)(UIImage * _Nullable image,
  */
 @property (nonatomic) NSTimeInterval timeout;
 
+/**
+ Whether concurrent requests for the same image share one in-flight operation. Default is YES.
+
+ @discussion When enabled, requests with the same cache key, options, pixel size
+ and transform block are coalesced: only one operation fetches and decodes the image,
+ and each request gets its own operation subscribed to it (see
+ `-[YYWebImageOperation subscribeToOperation:]`). Cancelling one of them doesn't
+ affect the others, and the fetch is cancelled when all of them are cancelled.
+ */
+@property (nonatomic) BOOL shouldCoalesceRequests;
+
 /**
  The username used by NSURLCredential, default is nil.
  */
@@ -13,8 +13,27 @@
 #import "YYImageCache.h"
 #import "YYWebImageOperation.h"
 #import "YYImageCoder.h"
+#import <pthread.h>
 
-@implementation YYWebImageManager
+/// Options which only affect how the image is displayed, ignored when coalescing requests.
+#define YYWebImageOptionDisplayMask (YYWebImageOptionIgnorePlaceHolder | \
+                                     YYWebImageOptionSetImageWithFadeAnimation | \
+                                     YYWebImageOptionAvoidSetImage | \
+                                     YYWebImageOptionDownsampleToViewSize)
+
+@interface YYWebImageOperation (YYWebImageManager)
+/// Invoked once when the operation is cancelled or finished, with the operation's lock held.
+/// It's used instead of `completionBlock`, which belongs to the user.
+@property (nonatomic, copy) void (^finishHandler)(YYWebImageOperation *operation);
+@end
+
+@implementation YYWebImageManager {
+    pthread_mutex_t _lock;
+    NSMutableDictionary *_operations; ///< coalescing key -> in-flight operation
+    NSMutableArray *_pendingOperations; ///< waiting operations, in request order
+    NSMutableSet *_runningOperations;
+    NSCountedSet *_runningHosts;
+}
 
 + (instancetype)sharedManager {
     static YYWebImageManager *manager;
@@ -41,6 +60,12 @@
     _cache = cache;
     _queue = queue;
     _timeout = 15.0;
+    _shouldCoalesceRequests = YES;
+    _operations = [NSMutableDictionary new];
+    _pendingOperations = [NSMutableArray new];
+    _runningOperations = [NSMutableSet new];
+    _runningHosts = [NSCountedSet new];
+    pthread_mutex_init(&_lock, NULL);
     if (YYImageWebPAvailable()) {
         _headers = @{ @"Accept" : @"image/webp,image/*;q=0.8" };
     } else {
@@ -49,12 +74,103 @@
     return self;
 }
 
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+- (YYWebImageOperation *)requestImageWithURL:(NSURL *)url
+                                     options:(YYWebImageOptions)options
+                                    progress:(YYWebImageProgressBlock)progress
+                                   transform:(YYWebImageTransformBlock)transform
+                                  completion:(YYWebImageCompletionBlock)completion {
+    return [self requestImageWithURL:url options:options pixelSize:CGSizeZero progress:progress transform:transform completion:completion];
+}
+
 - (YYWebImageOperation *)requestImageWithURL:(NSURL *)url
                                      options:(YYWebImageOptions)options
+                                   pixelSize:(CGSize)pixelSize
                                     progress:(YYWebImageProgressBlock)progress
                                    transform:(YYWebImageTransformBlock)transform
                                   completion:(YYWebImageCompletionBlock)completion {
+    if (!transform) transform = _sharedTransformBlock;
+    return [self _requestImageWithURL:url options:options pixelSize:pixelSize imageTransform:nil progress:progress transform:transform completion:completion];
+}
+
+- (YYWebImageOperation *)requestImageWithURL:(NSURL *)url
+                                     options:(YYWebImageOptions)options
+                                   pixelSize:(CGSize)pixelSize
+                              imageTransform:(YYWebImageTransform *)imageTransform
+                                    progress:(YYWebImageProgressBlock)progress
+                                  completion:(YYWebImageCompletionBlock)completion {
+    return [self _requestImageWithURL:url options:options pixelSize:pixelSize imageTransform:imageTransform progress:progress transform:nil completion:completion];
+}
+
+- (YYWebImageOperation *)_requestImageWithURL:(NSURL *)url
+                                      options:(YYWebImageOptions)options
+                                    pixelSize:(CGSize)pixelSize
+                               imageTransform:(YYWebImageTransform *)imageTransform
+                                     progress:(YYWebImageProgressBlock)progress
+                                    transform:(YYWebImageTransformBlock)transform
+                                   completion:(YYWebImageCompletionBlock)completion {
+    NSString *cacheKey = [self cacheKeyForURL:url];
+    if (!_shouldCoalesceRequests || !cacheKey) {
+        YYWebImageOperation *operation = [self _operationWithURL:url options:options cacheKey:cacheKey pixelSize:pixelSize progress:progress transform:transform completion:completion];
+        operation.imageTransform = imageTransform;
+        [self _observeOperation:operation forKey:nil];
+        [self _startOperation:operation];
+        return operation;
+    }
+    
+    /*
+     Concurrent requests for the same image share one in-flight operation. Every
+     caller gets its own operation subscribed to the shared one, so cancelling it
+     only removes the caller's blocks, and the shared operation is cancelled when
+     the last subscriber is cancelled. The transform block is part of the key, so
+     only requests with the same transform (usually nil or the shared one) are
+     coalesced. The image transform is not: the shared operation fetches and decodes
+     the original image once, and each subscriber derives its own image from it (or
+     finds the derived image in cache, then leaves the shared operation).
+     */
+    NSString *key = [NSString stringWithFormat:@"%@|%lu|%.0fx%.0f|%p", cacheKey,
+                     (unsigned long)(options & ~YYWebImageOptionDisplayMask),
+                     pixelSize.width, pixelSize.height, transform];
+    YYWebImageOperation *subscriber = [self _operationWithURL:url options:options cacheKey:cacheKey pixelSize:pixelSize progress:progress transform:nil completion:completion];
+    if (!subscriber) return nil;
+    subscriber.imageTransform = imageTransform;
+    
+    // don't hold the lock while subscribing, the operation's lock may be held by a callback which requests another image
+    pthread_mutex_lock(&_lock);
+    YYWebImageOperation *inflight = _operations[key];
+    pthread_mutex_unlock(&_lock);
+    if (inflight && [subscriber subscribeToOperation:inflight]) {
+        [subscriber start];
+        return subscriber;
+    }
     
+    YYWebImageOperation *shared = [self _operationWithURL:url options:options cacheKey:cacheKey pixelSize:pixelSize progress:nil transform:transform completion:nil];
+    if (!shared) return nil;
+    // register it before subscribing, the subscriber may be cancelled (and the key dropped) at any time
+    [self _observeOperation:shared forKey:key];
+    pthread_mutex_lock(&_lock);
+    _operations[key] = shared;
+    pthread_mutex_unlock(&_lock);
+    if (![subscriber subscribeToOperation:shared]) {
+        [shared cancel];
+        return nil;
+    }
+    
+    [subscriber start];
+    [self _startOperation:shared];
+    return subscriber;
+}
+
+- (YYWebImageOperation *)_operationWithURL:(NSURL *)url
+                                   options:(YYWebImageOptions)options
+                                  cacheKey:(NSString *)cacheKey
+                                 pixelSize:(CGSize)pixelSize
+                                  progress:(YYWebImageProgressBlock)progress
+                                 transform:(YYWebImageTransformBlock)transform
+                                completion:(YYWebImageCompletionBlock)completion {
     NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
     request.timeoutInterval = _timeout;
     request.HTTPShouldHandleCookies = (options & YYWebImageOptionHandleCookies) != 0;
@@ -66,23 +182,119 @@
     YYWebImageOperation *operation = [[YYWebImageOperation alloc] initWithRequest:request
                                                                           options:options
                                                                             cache:_cache
-                                                                         cacheKey:[self cacheKeyForURL:url]
+                                                                         cacheKey:cacheKey
                                                                          progress:progress
-                                                                        transform:transform ? transform : _sharedTransformBlock
+                                                                        transform:transform
                                                                        completion:completion];
 
+    operation.pixelSize = pixelSize;
+    operation.transport = _transport;
     if (_username && _password) {
         operation.credential = [NSURLCredential credentialWithUser:_username password:_password persistence:NSURLCredentialPersistenceForSession];
     }
-    if (operation) {
-        NSOperationQueue *queue = _queue;
+    return operation;
+}
+
+/// Releases the slot and the coalescing key (if not nil) of the operation when it's cancelled or finished.
+- (void)_observeOperation:(YYWebImageOperation *)operation forKey:(NSString *)key {
+    if (!operation) return;
+    __weak typeof(self) _self = self;
+    operation.finishHandler = ^(YYWebImageOperation *finishedOperation) {
+        // the operation's lock is held here, handle it asynchronously to avoid lock inversion
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [_self _operationDidFinish:finishedOperation forKey:key];
+        });
+    };
+}
+
+- (void)_startOperation:(YYWebImageOperation *)operation {
+    if (!operation) return;
+    NSOperationQueue *queue = _queue;
+    if (!queue) {
+        [operation start];
+    } else if (_maxConcurrentOperationCount == 0) {
+        [queue addOperation:operation];
+    } else {
+        pthread_mutex_lock(&_lock);
+        [_pendingOperations addObject:operation];
+        pthread_mutex_unlock(&_lock);
+        [self _schedulePendingOperations];
+    }
+}
+
+static inline NSString *YYWebImageOperationHost(YYWebImageOperation *operation) {
+    return operation.request.URL.host;
+}
+
+/// Moves the waiting operations to the queue while there are free slots.
+- (void)_schedulePendingOperations {
+    // cancelled operations finish immediately and don't take a slot;
+    // don't check them with the lock held, an operation's callback may request another image
+    pthread_mutex_lock(&_lock);
+    NSArray *pending = _pendingOperations.copy;
+    pthread_mutex_unlock(&_lock);
+    NSMutableArray *cancelled = nil;
+    for (YYWebImageOperation *operation in pending) {
+        if (!operation.isCancelled) continue;
+        if (!cancelled) cancelled = [NSMutableArray new];
+        [cancelled addObject:operation];
+    }
+    
+    NSMutableArray *operations = nil;
+    pthread_mutex_lock(&_lock);
+    for (YYWebImageOperation *operation in cancelled) {
+        NSUInteger index = [_pendingOperations indexOfObjectIdenticalTo:operation];
+        if (index == NSNotFound) continue; // scheduled by another thread
+        [_pendingOperations removeObjectAtIndex:index];
+        if (!operations) operations = [NSMutableArray new];
+        [operations addObject:operation];
+    }
+    NSUInteger maxCount = _maxConcurrentOperationCount;
+    NSUInteger maxCountPerHost = _maxConcurrentOperationCountPerHost;
+    while (_pendingOperations.count && (maxCount == 0 || _runningOperations.count < maxCount)) {
+        // highest priority first, the last requested one first in the same priority
+        YYWebImageOperation *next = nil;
+        NSInteger nextIndex = -1;
+        for (NSInteger i = _pendingOperations.count - 1; i >= 0; i--) {
+            YYWebImageOperation *operation = _pendingOperations[i];
+            if (next && operation.priority <= next.priority) continue;
+            NSString *host = YYWebImageOperationHost(operation);
+            if (host && maxCountPerHost > 0 && [_runningHosts countForObject:host] >= maxCountPerHost) continue;
+            next = operation;
+            nextIndex = i;
+        }
+        if (!next) break;
+        [_pendingOperations removeObjectAtIndex:nextIndex];
+        [_runningOperations addObject:next];
+        NSString *host = YYWebImageOperationHost(next);
+        if (host) [_runningHosts addObject:host];
+        if (!operations) operations = [NSMutableArray new];
+        [operations addObject:next];
+    }
+    pthread_mutex_unlock(&_lock);
+    
+    if (!operations) return;
+    NSOperationQueue *queue = _queue;
+    for (YYWebImageOperation *operation in operations) {
         if (queue) {
             [queue addOperation:operation];
         } else {
             [operation start];
         }
     }
-    return operation;
+}
+
+- (void)_operationDidFinish:(YYWebImageOperation *)operation forKey:(NSString *)key {
+    if (!operation) return;
+    pthread_mutex_lock(&_lock);
+    if (key && _operations[key] == operation) [_operations removeObjectForKey:key];
+    if ([_runningOperations containsObject:operation]) {
+        [_runningOperations removeObject:operation];
+        NSString *host = YYWebImageOperationHost(operation);
+        if (host) [_runningHosts removeObject:host];
+    }
+    pthread_mutex_unlock(&_lock);
+    [self _schedulePendingOperations];
 }
 
 - (NSDictionary *)headersForURL:(NSURL *)url {
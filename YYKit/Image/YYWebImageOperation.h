@@ -14,9 +14,13 @@
 #if __has_include(<YYKit/YYKit.h>)
 #import <YYKit/YYImageCache.h>
 #import <YYKit/YYWebImageManager.h>
+#import <YYKit/YYWebImageTransport.h>
+#import <YYKit/YYWebImageTransform.h>
 #else
 #import "YYImageCache.h"
 #import "YYWebImageManager.h"
+#import "YYWebImageTransport.h"
+#import "YYWebImageTransform.h"
 #endif
 
 NS_ASSUME_NONNULL_BEGIN
@@ -30,7 +34,7 @@ NS_ASSUME_NONNULL_BEGIN
  operation is started, it will:
  
      1. Get the image from the cache, if exist, return it with `completion` block.
-     2. Start an URL connection to fetch image from the request, invoke the `progress`
+     2. Start a transport task to fetch image from the request, invoke the `progress`
         to notify request progress (and invoke `completion` block to return the 
         progressive image if enabled by progressive option).
      3. Process the image by invoke the `transform` block.
@@ -49,19 +53,91 @@ NS_ASSUME_NONNULL_BEGIN
  Whether the URL connection should consult the credential storage for authenticating 
  the connection. Default is YES.
  
- @discussion This is the value that is returned in the `NSURLConnectionDelegate` 
- method `-connectionShouldUseCredentialStorage:`.
+ @discussion This is the value that is returned in the `YYWebImageTransportTaskDelegate`
+ method `-transportTaskShouldUseCredentialStorage:`.
  */
 @property (nonatomic) BOOL shouldUseCredentialStorage;
 
 /**
- The credential used for authentication challenges in `-connection:didReceiveAuthenticationChallenge:`.
+ The credential used for authentication challenges in `-transportTask:didReceiveChallenge:completionHandler:`.
  
  @discussion This will be overridden by any shared credentials that exist for the 
  username or password of the request URL, if present.
  */
 @property (nullable, nonatomic, strong) NSURLCredential *credential;
 
+/**
+ The transport which loads the request. Default is nil, which means
+ `[YYWebImageSessionTransport sharedTransport]`.
+ 
+ @discussion The transport's events are handled in a serial queue of the operation,
+ the queues of different operations run concurrently. You should set this value 
+ before the operation is started.
+ */
+@property (nullable, nonatomic, strong) id<YYWebImageTransport> transport;
+
+/**
+ The target pixel size to decode the image at. Default is CGSizeZero (full size).
+ 
+ @discussion If the value is not zero, the image is scaled down while decoding,
+ and the memory cache uses a key derived from `cacheKey` and this value. The 
+ original image data is still stored in disk cache with `cacheKey`. 
+ You should set this value before the operation is started.
+ */
+@property (nonatomic) CGSize pixelSize;
+
+/**
+ The declarative transform applied to the fetched image. Default is nil.
+ 
+ @discussion If the value is not nil, the operation returns the transformed (derived)
+ image, which is cached in memory and disk with the key `[imageTransform cacheKeyForKey:]`,
+ separately from the original image. When started, the operation looks up the derived
+ image in cache first, then fetches the original image (from cache or remote) and
+ transforms it in background. The progressive images are not returned.
+ 
+ If the operation is subscribed to another operation, the original image is shared
+ with the other subscribers, and each subscriber transforms it with its own transform.
+ An operation with an image transform can not be subscribed to.
+ You should set this value before the operation is started.
+ */
+@property (nullable, nonatomic, strong) YYWebImageTransform *imageTransform;
+
+/**
+ The priority of the operation. Default is YYWebImagePriorityVisible.
+ 
+ @discussion YYWebImageManager runs the waiting operation with the highest priority
+ first, you can change this value when the image's view moves (for example, when a
+ cell scrolls off the screen). It also changes the operation's `queuePriority`.
+ If the operation is subscribed to another operation, the priority of that operation
+ is the highest priority of its subscribers.
+ */
+@property (nonatomic) YYWebImagePriority priority;
+
+/**
+ The operation which fetches the image for this operation, or nil if this
+ operation fetches the image itself. see `subscribeToOperation:`.
+ */
+@property (nullable, strong, readonly) YYWebImageOperation *coalescedOperation;
+
+/**
+ Subscribes this operation to another operation which fetches the same image.
+
+ @discussion A subscribed operation does not fetch the image itself, its `progress`
+ and `completion` blocks are invoked with the fetched operation's result (its own
+ `transform` block is ignored). Cancelling a subscribed operation only removes it
+ from the fetching operation, and the fetching operation is cancelled when all of
+ its subscribers are cancelled (or have found their derived images in cache, see
+ `imageTransform`). YYWebImageManager uses this method to coalesce concurrent 
+ requests for the same image.
+
+ You should call this method before the receiver is started.
+
+ @param operation The operation to subscribe.
+ @return YES if subscribed, NO if the operation has been finished or cancelled,
+         or it has an image transform.
+ */
+- (BOOL)subscribeToOperation:(YYWebImageOperation *)operation;
+
 /**
  Creates and returns a new operation.
  
@@ -12,10 +12,13 @@
 #import "YYWebImageOperation.h"
 #import "UIApplication+YYAdd.h"
 #import "YYImage.h"
-#import "YYWeakProxy.h"
+#import "YYImagePersistencePolicy.h"
+#import "YYWebImageURLBlacklist.h"
 #import "UIImage+YYAdd.h"
 #import <ImageIO/ImageIO.h>
 #import "YYKitMacro.h"
+#import <fcntl.h>
+#import <unistd.h>
 
 #if __has_include("YYDispatchQueuePool.h")
 #import "YYDispatchQueuePool.h"
@@ -41,69 +44,70 @@ static BOOL YYCGImageLastPixelFilled(CGImageRef image) {
     return !isAlpha;
 }
 
-/// Returns JPEG SOS (Start Of Scan) Marker
-static NSData *JPEGSOSMarker() {
-    // "Start Of Scan" Marker
-    static NSData *marker = nil;
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        uint8_t bytes[2] = {0xFF, 0xDA};
-        marker = [NSData dataWithBytes:bytes length:2];
-    });
-    return marker;
+/// Returns YES if the bytes contain JPEG SOS (Start Of Scan) Marker (0xFF 0xDA).
+/// @param lastByte The byte before `bytes`, to find the marker across two segments.
+static BOOL JPEGSOSMarkerFind(const uint8_t *bytes, NSUInteger length, uint8_t lastByte) {
+    if (length == 0) return NO;
+    if (lastByte == 0xFF && bytes[0] == 0xDA) return YES;
+    const uint8_t *cur = bytes, *end = bytes + length - 1;
+    while (cur < end) {
+        cur = memchr(cur, 0xFF, end - cur);
+        if (!cur) return NO;
+        if (cur[1] == 0xDA) return YES;
+        cur++;
+    }
+    return NO;
 }
 
 
-static NSMutableSet *URLBlacklist;
-static dispatch_semaphore_t URLBlacklistLock;
-
-static void URLBlacklistInit() {
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        URLBlacklist = [NSMutableSet new];
-        URLBlacklistLock = dispatch_semaphore_create(1);
-    });
-}
-
 static BOOL URLBlackListContains(NSURL *url) {
-    if (!url || url == (id)[NSNull null]) return NO;
-    URLBlacklistInit();
-    dispatch_semaphore_wait(URLBlacklistLock, DISPATCH_TIME_FOREVER);
-    BOOL contains = [URLBlacklist containsObject:url];
-    dispatch_semaphore_signal(URLBlacklistLock);
-    return contains;
+    return [[YYWebImageURLBlacklist sharedBlacklist] containsURL:url];
 }
 
 static void URLInBlackListAdd(NSURL *url) {
-    if (!url || url == (id)[NSNull null]) return;
-    URLBlacklistInit();
-    dispatch_semaphore_wait(URLBlacklistLock, DISPATCH_TIME_FOREVER);
-    [URLBlacklist addObject:url];
-    dispatch_semaphore_signal(URLBlacklistLock);
+    [[YYWebImageURLBlacklist sharedBlacklist] addFailedURL:url];
+}
+
+static void URLInBlackListRemove(NSURL *url) {
+    [[YYWebImageURLBlacklist sharedBlacklist] removeURL:url];
 }
 
 
-@interface YYWebImageOperation() <NSURLConnectionDelegate>
+@interface YYWebImageOperation() <YYWebImageTransportTaskDelegate>
 @property (readwrite, getter=isExecuting) BOOL executing;
 @property (readwrite, getter=isFinished) BOOL finished;
 @property (readwrite, getter=isCancelled) BOOL cancelled;
 @property (readwrite, getter=isStarted) BOOL started;
 @property (nonatomic, strong) NSRecursiveLock *lock;
-@property (nonatomic, strong) NSURLConnection *connection;
-@property (nonatomic, strong) NSMutableData *data;
+@property (nonatomic, strong) dispatch_queue_t requestQueue; ///< the request events are handled serially in this queue
+@property (nonatomic, strong) id<YYWebImageTransportTask> task;
+@property (nonatomic, strong) NSData *data; ///< the received data in one buffer, after the task finished
+@property (nonatomic, strong) NSMutableArray *dataSegments; ///< Array<NSData>, the received packets
+@property (nonatomic, assign) NSUInteger receivedSize;
 @property (nonatomic, assign) NSInteger expectedSize;
+@property (nonatomic, assign) int streamFileDescriptor; ///< -1 if the data is not streamed to file
+@property (nonatomic, strong) NSString *streamFilePath; ///< the temporary file in disk cache
 @property (nonatomic, assign) UIBackgroundTaskIdentifier taskID;
 
 @property (nonatomic, assign) NSTimeInterval lastProgressiveDecodeTimestamp;
 @property (nonatomic, strong) YYImageDecoder *progressiveDecoder;
 @property (nonatomic, assign) BOOL progressiveIgnored;
 @property (nonatomic, assign) BOOL progressiveDetected;
-@property (nonatomic, assign) NSUInteger progressiveScanedLength;
+@property (nonatomic, assign) NSUInteger progressiveScanedSegmentCount;
+@property (nonatomic, assign) uint8_t progressiveScanedLastByte;
+@property (nonatomic, assign) NSUInteger progressiveChunkOffset; ///< the next PNG chunk
+@property (nonatomic, assign) NSUInteger readSegmentIndex;  ///< cursor of `_getReceivedBytes:range:`
+@property (nonatomic, assign) NSUInteger readSegmentOffset; ///< cursor of `_getReceivedBytes:range:`
 @property (nonatomic, assign) NSUInteger progressiveDisplayCount;
 
 @property (nonatomic, copy) YYWebImageProgressBlock progress;
 @property (nonatomic, copy) YYWebImageTransformBlock transform;
 @property (nonatomic, copy) YYWebImageCompletionBlock completion;
+@property (nonatomic, assign) BOOL transforming; ///< the derived image is being created, guarded by lock
+
+@property (nonatomic, strong) NSMutableArray *subscribers; ///< guarded by lock
+@property (strong, readwrite) YYWebImageOperation *coalescedOperation;
+@property (nonatomic, copy) void (^finishHandler)(YYWebImageOperation *operation); ///< guarded by lock, see YYWebImageManager
 @end
 
 
@@ -112,28 +116,39 @@ static void URLInBlackListAdd(NSURL *url) {
 @synthesize finished = _finished;
 @synthesize cancelled = _cancelled;
 
-/// Network thread entry point.
-+ (void)_networkThreadMain:(id)object {
-    @autoreleasepool {
-        [[NSThread currentThread] setName:@"com.ibireme.yykit.webimage.request"];
-        NSRunLoop *runLoop = [NSRunLoop currentRunLoop];
-        [runLoop addPort:[NSMachPort port] forMode:NSDefaultRunLoopMode];
-        [runLoop run];
-    }
-}
-
-/// Global image request network thread, used by NSURLConnection delegate.
-+ (NSThread *)_networkThread {
-    static NSThread *thread = nil;
+/// Global request queues, the events of one operation are handled serially in one of them.
++ (dispatch_queue_t)_requestQueue {
+#ifdef YYDispatchQueuePool_h
+    static YYDispatchQueuePool *pool;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pool = [[YYDispatchQueuePool alloc] initWithName:@"com.ibireme.yykit.webimage.request" queueCount:[NSProcessInfo processInfo].activeProcessorCount qos:NSQualityOfServiceUtility];
+    });
+    return pool.queue;
+#else
+    #define MAX_QUEUE_COUNT 16
+    static int queueCount;
+    static dispatch_queue_t queues[MAX_QUEUE_COUNT];
     static dispatch_once_t onceToken;
+    static int32_t counter = 0;
     dispatch_once(&onceToken, ^{
-        thread = [[NSThread alloc] initWithTarget:self selector:@selector(_networkThreadMain:) object:nil];
-        if ([thread respondsToSelector:@selector(setQualityOfService:)]) {
-            thread.qualityOfService = NSQualityOfServiceBackground;
+        queueCount = (int)[NSProcessInfo processInfo].activeProcessorCount;
+        queueCount = queueCount < 1 ? 1 : queueCount > MAX_QUEUE_COUNT ? MAX_QUEUE_COUNT : queueCount;
+        for (NSUInteger i = 0; i < queueCount; i++) {
+            if ([UIDevice currentDevice].systemVersion.floatValue >= 8.0) {
+                dispatch_queue_attr_t attr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0);
+                queues[i] = dispatch_queue_create("com.ibireme.yykit.webimage.request", attr);
+            } else {
+                queues[i] = dispatch_queue_create("com.ibireme.yykit.webimage.request", DISPATCH_QUEUE_SERIAL);
+                dispatch_set_target_queue(queues[i], dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0));
+            }
         }
-        [thread start];
     });
-    return thread;
+    int32_t cur = OSAtomicIncrement32(&counter);
+    if (cur < 0) cur = -cur;
+    return queues[(cur) % queueCount];
+    #undef MAX_QUEUE_COUNT
+#endif
 }
 
 /// Global image queue, used for image reading and decoding.
@@ -188,6 +203,7 @@ static void URLInBlackListAdd(NSURL *url) {
     _cache = cache;
     _cacheKey = cacheKey ? cacheKey : request.URL.absoluteString;
     _shouldUseCredentialStorage = YES;
+    _priority = YYWebImagePriorityVisible;
     _progress = progress;
     _transform = transform;
     _completion = completion;
@@ -195,6 +211,8 @@ static void URLInBlackListAdd(NSURL *url) {
     _finished = NO;
     _cancelled = NO;
     _taskID = UIBackgroundTaskInvalid;
+    _streamFileDescriptor = -1;
+    _requestQueue = [self.class _requestQueue];
     _lock = [NSRecursiveLock new];
     return self;
 }
@@ -208,8 +226,8 @@ static void URLInBlackListAdd(NSURL *url) {
     if ([self isExecuting]) {
         self.cancelled = YES;
         self.finished = YES;
-        if (_connection) {
-            [_connection cancel];
+        if (_task) {
+            [_task cancel];
             if (![_request.URL isFileURL] && (_options & YYWebImageOptionShowNetworkActivity)) {
                 [[UIApplication sharedExtensionApplication] decrementNetworkActivityCount];
             }
@@ -220,6 +238,7 @@ static void URLInBlackListAdd(NSURL *url) {
             }
         }
     }
+    [self _removeStreamFile];
     [_lock unlock];
 }
 
@@ -232,15 +251,263 @@ static void URLInBlackListAdd(NSURL *url) {
     [_lock unlock];
 }
 
+#pragma mark - Subscribers
+
+- (BOOL)subscribeToOperation:(YYWebImageOperation *)operation {
+    if (!operation || operation == self) return NO;
+    self.coalescedOperation = operation;
+    if ([operation _addSubscriber:self]) return YES;
+    self.coalescedOperation = nil;
+    return NO;
+}
+
+- (BOOL)_addSubscriber:(YYWebImageOperation *)subscriber {
+    BOOL added = NO;
+    [_lock lock];
+    if (!_finished && !_cancelled && !_imageTransform) {
+        if (!_subscribers) _subscribers = [NSMutableArray new];
+        [_subscribers addObject:subscriber];
+        added = YES;
+    }
+    [_lock unlock];
+    if (added) [self _updatePriorityFromSubscribers];
+    return added;
+}
+
+/// Removes a cancelled subscriber, and cancels self when the last subscriber leaves.
+- (void)_removeSubscriber:(YYWebImageOperation *)subscriber {
+    BOOL shouldCancel = NO;
+    [_lock lock];
+    if (_subscribers) {
+        [_subscribers removeObjectIdenticalTo:subscriber];
+        shouldCancel = _subscribers.count == 0;
+    }
+    [_lock unlock];
+    if (shouldCancel) {
+        [self cancel];
+    } else {
+        [self _updatePriorityFromSubscribers];
+    }
+}
+
+/// Sets the priority to the highest priority of the subscribers.
+- (void)_updatePriorityFromSubscribers {
+    [_lock lock];
+    if (_subscribers.count) {
+        YYWebImagePriority priority = YYWebImagePriorityPrefetch;
+        for (YYWebImageOperation *subscriber in _subscribers) {
+            priority = MAX(priority, subscriber.priority);
+        }
+        [self _setPriority:priority];
+    }
+    [_lock unlock];
+}
+
+- (void)_setPriority:(YYWebImagePriority)priority {
+    _priority = priority;
+    switch (priority) {
+        case YYWebImagePriorityVisible: self.queuePriority = NSOperationQueuePriorityHigh; break;
+        case YYWebImagePriorityNearVisible: self.queuePriority = NSOperationQueuePriorityNormal; break;
+        default: self.queuePriority = NSOperationQueuePriorityLow; break;
+    }
+}
+
+- (void)setPriority:(YYWebImagePriority)priority {
+    [_lock lock];
+    [self _setPriority:priority];
+    YYWebImageOperation *coalescedOperation = _coalescedOperation;
+    [_lock unlock];
+    [coalescedOperation _updatePriorityFromSubscribers];
+}
+
+// caller should hold the lock
+- (void)_invokeProgressWithReceivedSize:(NSInteger)receivedSize expectedSize:(NSInteger)expectedSize {
+    if (_progress) _progress(receivedSize, expectedSize);
+    if (_subscribers.count == 0) return;
+    for (YYWebImageOperation *subscriber in _subscribers.copy) {
+        [subscriber _receiveProgressWithReceivedSize:receivedSize expectedSize:expectedSize];
+    }
+}
+
+// caller should hold the lock
+- (void)_invokeCompletionWithImage:(UIImage *)image from:(YYWebImageFromType)from stage:(YYWebImageStage)stage error:(NSError *)error {
+    [self _invokeOwnCompletionWithImage:image from:from stage:stage error:error];
+    if (_subscribers.count == 0) return;
+    NSArray *subscribers = _subscribers.copy;
+    if (stage != YYWebImageStageProgress) _subscribers = nil;
+    for (YYWebImageOperation *subscriber in subscribers) {
+        [subscriber _receiveImage:image from:from stage:stage error:error];
+    }
+}
+
+/**
+ Invokes the completion block of self (not the subscribers). If there's an image
+ transform, the finished image is transformed in background first, and the operation
+ is finished after the completion block is invoked.
+ */
+// caller should hold the lock
+- (void)_invokeOwnCompletionWithImage:(UIImage *)image from:(YYWebImageFromType)from stage:(YYWebImageStage)stage error:(NSError *)error {
+    if (_imageTransform && stage == YYWebImageStageProgress) return; // the progressive image is not transformed
+    if (!_imageTransform || !image || stage != YYWebImageStageFinished) {
+        if (_completion) _completion(image, _request.URL, from, stage, error);
+        return;
+    }
+    
+    _transforming = YES;
+    dispatch_async([self.class _imageQueue], ^{ // self is retained until the completion block is invoked
+        UIImage *derivedImage = nil;
+        if (![self isCancelled]) derivedImage = [self _derivedImageFromImage:image];
+        [self.lock lock];
+        self.transforming = NO;
+        if (![self isCancelled]) {
+            NSError *transformError = nil;
+            if (!derivedImage) {
+                transformError = [NSError errorWithDomain:@"com.ibireme.yykit.image" code:-1 userInfo:@{ NSLocalizedDescriptionKey : @"Web image transform fail." }];
+            }
+            if (self.completion) self.completion(derivedImage, self.request.URL, from, YYWebImageStageFinished, transformError);
+            [self _finish];
+        }
+        [self.lock unlock];
+    });
+}
+
+/// Returns the cache key of the derived image, which depends on the decoded size of the original image.
+- (NSString *)_derivedCacheKey {
+    NSString *key = _cacheKey;
+    if (_pixelSize.width > 0 || _pixelSize.height > 0) {
+        key = [NSString stringWithFormat:@"%@#%dx%d", key, (int)_pixelSize.width, (int)_pixelSize.height];
+    }
+    return [_imageTransform cacheKeyForKey:key];
+}
+
+// runs on image queue, transforms the original image and puts the derived image to cache
+- (UIImage *)_derivedImageFromImage:(UIImage *)image {
+    UIImage *derivedImage = [_imageTransform transformImage:image];
+    if (derivedImage && _cache) {
+        YYImageCacheType cacheType = (_options & YYWebImageOptionIgnoreDiskCache) ? YYImageCacheTypeMemory : YYImageCacheTypeAll;
+        [_cache setImage:derivedImage imageData:nil forKey:[self _derivedCacheKey] withType:cacheType];
+    }
+    return derivedImage;
+}
+
+- (void)_receiveProgressWithReceivedSize:(NSInteger)receivedSize expectedSize:(NSInteger)expectedSize {
+    [_lock lock];
+    if (![self isCancelled] && _progress) _progress(receivedSize, expectedSize);
+    [_lock unlock];
+}
+
+- (void)_receiveImage:(UIImage *)image from:(YYWebImageFromType)from stage:(YYWebImageStage)stage error:(NSError *)error {
+    [_lock lock];
+    if (![self isCancelled] && ![self isFinished]) { // may be finished with the derived image in cache
+        [self _invokeOwnCompletionWithImage:image from:from stage:stage error:error];
+        if (stage != YYWebImageStageProgress) [self _finish];
+    }
+    [_lock unlock];
+}
+
+#pragma mark - Received data
+
+/// Returns the received segments in one buffer (copied once, without realloc).
+- (NSData *)_receivedData {
+    if (_dataSegments.count == 0) return nil;
+    if (_dataSegments.count == 1) return _dataSegments.firstObject;
+    NSMutableData *data = [NSMutableData dataWithCapacity:_receivedSize];
+    for (NSData *segment in _dataSegments) [data appendData:segment];
+    return data;
+}
+
+/// Copies the received bytes in a range, the range should not begin before the last read.
+- (BOOL)_getReceivedBytes:(void *)buffer range:(NSRange)range {
+    if (NSMaxRange(range) > _receivedSize) return NO;
+    NSUInteger index = _readSegmentIndex, begin = _readSegmentOffset, count = _dataSegments.count;
+    while (index < count && begin + ((NSData *)_dataSegments[index]).length <= range.location) {
+        begin += ((NSData *)_dataSegments[index]).length;
+        index++;
+    }
+    _readSegmentIndex = index;
+    _readSegmentOffset = begin;
+    
+    NSUInteger copied = 0;
+    for (; index < count && copied < range.length; index++) {
+        NSData *segment = _dataSegments[index];
+        NSUInteger from = range.location + copied - begin;
+        NSUInteger size = MIN(segment.length - from, range.length - copied);
+        [segment getBytes:(uint8_t *)buffer + copied range:NSMakeRange(from, size)];
+        copied += size;
+        begin += segment.length;
+    }
+    return copied == range.length;
+}
+
+/// Creates the temporary file in disk cache if the data should be streamed to file.
+- (void)_openStreamFile {
+    if (!(_options & YYWebImageOptionStreamToDiskCache)) return;
+    if (!_cache.diskCache) return;
+    if (_options & (YYWebImageOptionUseNSURLCache | YYWebImageOptionIgnoreDiskCache)) return;
+    NSString *path = [_cache.diskCache temporaryFilePath];
+    if (!path) return;
+    int fd = open(path.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return;
+    _streamFileDescriptor = fd;
+    _streamFilePath = path;
+}
+
+- (BOOL)_writeStreamFileWithData:(NSData *)data {
+    const uint8_t *bytes = data.bytes;
+    size_t length = data.length;
+    while (length > 0) {
+        ssize_t written = write(_streamFileDescriptor, bytes, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return NO;
+        }
+        bytes += written;
+        length -= written;
+    }
+    return YES;
+}
+
+- (void)_closeStreamFile {
+    if (_streamFileDescriptor >= 0) {
+        close(_streamFileDescriptor);
+        _streamFileDescriptor = -1;
+    }
+}
+
+- (void)_removeStreamFile {
+    [self _closeStreamFile];
+    if (_streamFilePath) {
+        unlink(_streamFilePath.fileSystemRepresentation);
+        _streamFilePath = nil;
+    }
+}
+
+/// Reads the streamed data back to memory when the file write failed, returns NO if the data is lost.
+- (BOOL)_fallbackStreamFileToMemory {
+    if (!_dataSegments) {
+        [self _closeStreamFile];
+        NSData *written = [NSData dataWithContentsOfFile:_streamFilePath];
+        if (written.length < _receivedSize) {
+            [self _removeStreamFile];
+            return NO;
+        }
+        _dataSegments = [NSMutableArray new];
+        if (_receivedSize) [_dataSegments addObject:[written subdataWithRange:NSMakeRange(0, _receivedSize)]];
+    }
+    [self _removeStreamFile];
+    return YES;
+}
+
 #pragma mark - Runs in operation thread
 
 - (void)_finish {
+    if (_transforming) return; // finished when the derived image is returned
     self.executing = NO;
     self.finished = YES;
     [self _endBackgroundTask];
 }
 
-// runs on network thread
+// runs on request queue
 - (void)_startOperation {
     if ([self isCancelled]) return;
     @autoreleasepool {
@@ -248,11 +515,11 @@ static void URLInBlackListAdd(NSURL *url) {
         if (_cache &&
             !(_options & YYWebImageOptionUseNSURLCache) &&
             !(_options & YYWebImageOptionRefreshImageCache)) {
-            UIImage *image = [_cache getImageForKey:_cacheKey withType:YYImageCacheTypeMemory];
+            UIImage *image = [_cache getImageForKey:_cacheKey withType:YYImageCacheTypeMemory pixelSize:_pixelSize];
             if (image) {
                 [_lock lock];
                 if (![self isCancelled]) {
-                    if (_completion) _completion(image, _request.URL, YYWebImageFromMemoryCache, YYWebImageStageFinished, nil);
+                    [self _invokeCompletionWithImage:image from:YYWebImageFromMemoryCache stage:YYWebImageStageFinished error:nil];
                 }
                 [self _finish];
                 [_lock unlock];
@@ -263,22 +530,76 @@ static void URLInBlackListAdd(NSURL *url) {
                 dispatch_async([self.class _imageQueue], ^{
                     __strong typeof(_self) self = _self;
                     if (!self || [self isCancelled]) return;
-                    UIImage *image = [self.cache getImageForKey:self.cacheKey withType:YYImageCacheTypeDisk];
+                    UIImage *image = [self.cache getImageForKey:self.cacheKey withType:YYImageCacheTypeDisk pixelSize:self.pixelSize];
                     if (image) {
-                        [self.cache setImage:image imageData:nil forKey:self.cacheKey withType:YYImageCacheTypeMemory];
-                        [self performSelector:@selector(_didReceiveImageFromDiskCache:) onThread:[self.class _networkThread] withObject:image waitUntilDone:NO];
+                        [self.cache setImage:image imageData:nil forKey:self.cacheKey withType:YYImageCacheTypeMemory pixelSize:self.pixelSize];
+                        dispatch_async(self.requestQueue, ^{
+                            [self _didReceiveImageFromDiskCache:image];
+                        });
                     } else {
-                        [self performSelector:@selector(_startRequest:) onThread:[self.class _networkThread] withObject:nil waitUntilDone:NO];
+                        dispatch_async(self.requestQueue, ^{
+                            [self _startRequest:nil];
+                        });
                     }
                 });
                 return;
             }
         }
     }
-    [self performSelector:@selector(_startRequest:) onThread:[self.class _networkThread] withObject:nil waitUntilDone:NO];
+    [self _startRequest:nil];
+}
+
+// runs on request queue, looks up the derived image in cache before fetching the original image
+- (void)_startDerivedOperation {
+    if ([self isCancelled]) return;
+    @autoreleasepool {
+        if (_cache &&
+            !(_options & YYWebImageOptionUseNSURLCache) &&
+            !(_options & YYWebImageOptionRefreshImageCache)) {
+            NSString *derivedKey = [self _derivedCacheKey];
+            UIImage *image = [_cache getImageForKey:derivedKey withType:YYImageCacheTypeMemory];
+            if (image) {
+                [self _didReceiveDerivedImage:image from:YYWebImageFromMemoryCache];
+                return;
+            }
+            if (!(_options & YYWebImageOptionIgnoreDiskCache)) {
+                __weak typeof(self) _self = self;
+                dispatch_async([self.class _imageQueue], ^{
+                    __strong typeof(_self) self = _self;
+                    if (!self || [self isCancelled]) return;
+                    UIImage *image = [self.cache getImageForKey:derivedKey withType:YYImageCacheTypeDisk];
+                    if (image) {
+                        [self.cache setImage:image imageData:nil forKey:derivedKey withType:YYImageCacheTypeMemory];
+                    }
+                    dispatch_async(self.requestQueue, ^{
+                        if (image) {
+                            [self _didReceiveDerivedImage:image from:YYWebImageFromDiskCache];
+                        } else if (!self.coalescedOperation) {
+                            [self _startOperation];
+                        }
+                    });
+                });
+                return;
+            }
+        }
+    }
+    if (!_coalescedOperation) [self _startOperation]; // or wait for the coalesced operation
+}
+
+// runs on request queue
+- (void)_didReceiveDerivedImage:(UIImage *)image from:(YYWebImageFromType)from {
+    YYWebImageOperation *coalescedOperation = nil;
+    [_lock lock];
+    if (![self isCancelled] && ![self isFinished] && !_transforming) {
+        if (_completion) _completion(image, _request.URL, from, YYWebImageStageFinished, nil);
+        coalescedOperation = _coalescedOperation;
+        [self _finish];
+    }
+    [_lock unlock];
+    [coalescedOperation _removeSubscriber:self]; // the original image is not needed
 }
 
-// runs on network thread
+// runs on request queue
 - (void)_startRequest:(id)object {
     if ([self isCancelled]) return;
     @autoreleasepool {
@@ -286,7 +607,7 @@ static void URLInBlackListAdd(NSURL *url) {
             NSError *error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorFileDoesNotExist userInfo:@{ NSLocalizedDescriptionKey : @"Failed to load URL, blacklisted." }];
             [_lock lock];
             if (![self isCancelled]) {
-                if (_completion) _completion(nil, _request.URL, YYWebImageFromNone, YYWebImageStageFinished, error);
+                [self _invokeCompletionWithImage:nil from:YYWebImageFromNone stage:YYWebImageStageFinished error:error];
             }
             [self _finish];
             [_lock unlock];
@@ -303,7 +624,8 @@ static void URLInBlackListAdd(NSURL *url) {
         // request image from web
         [_lock lock];
         if (![self isCancelled]) {
-            _connection = [[NSURLConnection alloc] initWithRequest:_request delegate:[YYWeakProxy proxyWithTarget:self]];
+            id<YYWebImageTransport> transport = _transport ? _transport : [YYWebImageSessionTransport sharedTransport];
+            _task = [transport startTaskWithRequest:_request delegate:self delegateQueue:_requestQueue];
             if (![_request.URL isFileURL] && (_options & YYWebImageOptionShowNetworkActivity)) {
                 [[UIApplication sharedExtensionApplication] incrementNetworkActivityCount];
             }
@@ -312,29 +634,32 @@ static void URLInBlackListAdd(NSURL *url) {
     }
 }
 
-// runs on network thread, called from outer "cancel"
+// runs on request queue, called from outer "cancel"
 - (void)_cancelOperation {
     @autoreleasepool {
-        if (_connection) {
+        if (_task) {
             if (![_request.URL isFileURL] && (_options & YYWebImageOptionShowNetworkActivity)) {
                 [[UIApplication sharedExtensionApplication] decrementNetworkActivityCount];
             }
         }
-        [_connection cancel];
-        _connection = nil;
-        if (_completion) _completion(nil, _request.URL, YYWebImageFromNone, YYWebImageStageCancelled, nil);
+        [_task cancel];
+        _task = nil;
+        [self _removeStreamFile];
+        [_lock lock];
+        [self _invokeCompletionWithImage:nil from:YYWebImageFromNone stage:YYWebImageStageCancelled error:nil];
+        [_lock unlock];
         [self _endBackgroundTask];
     }
 }
 
 
-// runs on network thread
+// runs on request queue
 - (void)_didReceiveImageFromDiskCache:(UIImage *)image {
     @autoreleasepool {
         [_lock lock];
         if (![self isCancelled]) {
             if (image) {
-                if (_completion) _completion(image, _request.URL, YYWebImageFromDiskCache, YYWebImageStageFinished, nil);
+                [self _invokeCompletionWithImage:image from:YYWebImageFromDiskCache stage:YYWebImageStageFinished error:nil];
                 [self _finish];
             } else {
                 [self _startRequest:nil];
@@ -351,14 +676,24 @@ static void URLInBlackListAdd(NSURL *url) {
             if (_cache) {
                 if (image || (_options & YYWebImageOptionRefreshImageCache)) {
                     NSData *data = _data;
+                    NSString *filePath = nil;
+                    if (_streamFilePath && data && image) { // the original data is kept, move the file to disk cache
+                        filePath = _streamFilePath;
+                        _streamFilePath = nil;
+                        data = nil;
+                    }
                     dispatch_async([YYWebImageOperation _imageQueue], ^{
                         YYImageCacheType cacheType = (_options & YYWebImageOptionIgnoreDiskCache) ? YYImageCacheTypeMemory : YYImageCacheTypeAll;
-                        [_cache setImage:image imageData:data forKey:_cacheKey withType:cacheType];
-
+                        if (filePath) {
+                            [_cache setImage:image imageFileAtPath:filePath forKey:_cacheKey withType:cacheType pixelSize:_pixelSize];
+                        } else {
+                            [_cache setImage:image imageData:data forKey:_cacheKey withType:cacheType pixelSize:_pixelSize];
+                        }
                     });
                 }
             }
             _data = nil;
+            [self _removeStreamFile];
             NSError *error = nil;
             if (!image) {
                 error = [NSError errorWithDomain:@"com.ibireme.yykit.image" code:-1 userInfo:@{ NSLocalizedDescriptionKey : @"Web image decode fail." }];
@@ -369,45 +704,44 @@ static void URLInBlackListAdd(NSURL *url) {
                         URLInBlackListAdd(_request.URL);
                     }
                 }
+            } else if (_options & YYWebImageOptionIgnoreFailedURL) {
+                URLInBlackListRemove(_request.URL);
             }
-            if (_completion) _completion(image, _request.URL, YYWebImageFromRemote, YYWebImageStageFinished, error);
+            [self _invokeCompletionWithImage:image from:YYWebImageFromRemote stage:YYWebImageStageFinished error:error];
             [self _finish];
         }
         [_lock unlock];
     }
 }
 
-#pragma mark - NSURLConnectionDelegate runs in operation thread
+#pragma mark - YYWebImageTransportTaskDelegate runs in request queue
 
-- (BOOL)connectionShouldUseCredentialStorage:(NSURLConnection *)connection {
+- (BOOL)transportTaskShouldUseCredentialStorage:(id<YYWebImageTransportTask>)task {
     return _shouldUseCredentialStorage;
 }
 
-- (void)connection:(NSURLConnection *)connection willSendRequestForAuthenticationChallenge:(NSURLAuthenticationChallenge *)challenge {
+- (void)transportTask:(id<YYWebImageTransportTask>)task didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition, NSURLCredential *))completionHandler {
     @autoreleasepool {
         if ([challenge.protectionSpace.authenticationMethod isEqualToString:NSURLAuthenticationMethodServerTrust]) {
-            if (!(_options & YYWebImageOptionAllowInvalidSSLCertificates) &&
-                [challenge.sender respondsToSelector:@selector(performDefaultHandlingForAuthenticationChallenge:)]) {
-                [challenge.sender performDefaultHandlingForAuthenticationChallenge:challenge];
+            if (!(_options & YYWebImageOptionAllowInvalidSSLCertificates)) {
+                completionHandler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
             } else {
                 NSURLCredential *credential = [NSURLCredential credentialForTrust:challenge.protectionSpace.serverTrust];
-                [[challenge sender] useCredential:credential forAuthenticationChallenge:challenge];
+                completionHandler(NSURLSessionAuthChallengeUseCredential, credential);
             }
         } else {
-            if ([challenge previousFailureCount] == 0) {
-                if (_credential) {
-                    [[challenge sender] useCredential:_credential forAuthenticationChallenge:challenge];
-                } else {
-                    [[challenge sender] continueWithoutCredentialForAuthenticationChallenge:challenge];
-                }
+            if ([challenge previousFailureCount] == 0 && _credential) {
+                completionHandler(NSURLSessionAuthChallengeUseCredential, _credential);
+            } else if ([challenge previousFailureCount] == 0 && _shouldUseCredentialStorage) {
+                completionHandler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
             } else {
-                [[challenge sender] continueWithoutCredentialForAuthenticationChallenge:challenge];
+                completionHandler(NSURLSessionAuthChallengeUseCredential, nil); // continue without credential
             }
         }
     }
 }
 
-- (NSCachedURLResponse *)connection:(NSURLConnection *)connection willCacheResponse:(NSCachedURLResponse *)cachedResponse {
+- (NSCachedURLResponse *)transportTask:(id<YYWebImageTransportTask>)task willCacheResponse:(NSCachedURLResponse *)cachedResponse {
     if (!cachedResponse) return cachedResponse;
     if (_options & YYWebImageOptionUseNSURLCache) {
         return cachedResponse;
@@ -417,7 +751,15 @@ static void URLInBlackListAdd(NSURL *url) {
     }
 }
 
-- (void)connection:(NSURLConnection *)connection didReceiveResponse:(NSURLResponse *)response {
+- (void)transportTask:(id<YYWebImageTransportTask>)task didCompleteWithError:(NSError *)error {
+    if (error) {
+        [self _didFailWithError:error];
+    } else {
+        [self _didFinishLoading];
+    }
+}
+
+- (void)transportTask:(id<YYWebImageTransportTask>)task didReceiveResponse:(NSURLResponse *)response {
     @autoreleasepool {
         NSError *error = nil;
         if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
@@ -428,45 +770,61 @@ static void URLInBlackListAdd(NSURL *url) {
             }
         }
         if (error) {
-            [_connection cancel];
-            [self connection:_connection didFailWithError:error];
+            [_task cancel];
+            [self _didFailWithError:error];
         } else {
             if (response.expectedContentLength) {
                 _expectedSize = (NSInteger)response.expectedContentLength;
                 if (_expectedSize < 0) _expectedSize = -1;
             }
-            _data = [NSMutableData dataWithCapacity:_expectedSize > 0 ? _expectedSize : 0];
-            if (_progress) {
-                [_lock lock];
-                if (![self isCancelled]) _progress(0, _expectedSize);
-                [_lock unlock];
+            _receivedSize = 0;
+            [self _removeStreamFile];
+            [self _openStreamFile];
+            if (_streamFileDescriptor < 0 || (_options & (YYWebImageOptionProgressive | YYWebImageOptionProgressiveBlur))) {
+                _dataSegments = [NSMutableArray new]; // the progressive decoder reads data from memory
+            } else {
+                _dataSegments = nil;
             }
+            [_lock lock];
+            if (![self isCancelled]) [self _invokeProgressWithReceivedSize:0 expectedSize:_expectedSize];
+            [_lock unlock];
         }
     }
 }
 
-- (void)connection:(NSURLConnection *)connection didReceiveData:(NSData *)data {
+- (void)transportTask:(id<YYWebImageTransportTask>)task didReceiveData:(NSData *)data {
     @autoreleasepool {
         [_lock lock];
         BOOL canceled = [self isCancelled];
         [_lock unlock];
         if (canceled) return;
         
-        if (data) [_data appendData:data];
-        if (_progress) {
-            [_lock lock];
-            if (![self isCancelled]) {
-                _progress(_data.length, _expectedSize);
+        if (data.length) {
+            if (_streamFileDescriptor >= 0 && ![self _writeStreamFileWithData:data]) {
+                if (![self _fallbackStreamFileToMemory]) {
+                    NSError *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{ NSLocalizedDescriptionKey : @"Failed to write image data to disk cache." }];
+                    [_task cancel];
+                    [self _didFailWithError:error];
+                    return;
+                }
             }
-            [_lock unlock];
+            [_dataSegments addObject:data]; // not copied, the packet is immutable
+            _receivedSize += data.length;
+        }
+        [_lock lock];
+        if (![self isCancelled]) {
+            [self _invokeProgressWithReceivedSize:_receivedSize expectedSize:_expectedSize];
         }
+        BOOL hasReceiver = _completion || _subscribers.count > 0; // the subscribers are changed with lock
+        [_lock unlock];
         
         /*--------------------------- progressive ----------------------------*/
         BOOL progressive = (_options & YYWebImageOptionProgressive) > 0;
         BOOL progressiveBlur = (_options & YYWebImageOptionProgressiveBlur) > 0;
-        if (!_completion || !(progressive || progressiveBlur)) return;
+        if (!(progressive || progressiveBlur)) return;
+        if (!hasReceiver) return;
         if (data.length <= 16) return;
-        if (_expectedSize > 0 && data.length >= _expectedSize * 0.99) return;
+        if (_expectedSize > 0 && _receivedSize >= _expectedSize * 0.99) return;
         if (_progressiveIgnored) return;
         
         NSTimeInterval min = progressiveBlur ? MIN_PROGRESSIVE_BLUR_TIME_INTERVAL : MIN_PROGRESSIVE_TIME_INTERVAL;
@@ -476,7 +834,7 @@ static void URLInBlackListAdd(NSURL *url) {
         if (!_progressiveDecoder) {
             _progressiveDecoder = [[YYImageDecoder alloc] initWithScale:[UIScreen mainScreen].scale];
         }
-        [_progressiveDecoder updateData:_data final:NO];
+        [_progressiveDecoder updateDataSegments:_dataSegments final:NO];
         if ([self isCancelled]) return;
         
         if (_progressiveDecoder.type == YYImageTypeUnknown ||
@@ -501,7 +859,7 @@ static void URLInBlackListAdd(NSURL *url) {
             if (frame.image) {
                 [_lock lock];
                 if (![self isCancelled]) {
-                    _completion(frame.image, _request.URL, YYWebImageFromRemote, YYWebImageStageProgress, nil);
+                    [self _invokeCompletionWithImage:frame.image from:YYWebImageFromRemote stage:YYWebImageStageProgress error:nil];
                     _lastProgressiveDecodeTimestamp = now;
                 }
                 [_lock unlock];
@@ -521,12 +879,15 @@ static void URLInBlackListAdd(NSURL *url) {
                     _progressiveDetected = YES;
                 }
                 
-                NSInteger scanLength = (NSInteger)_data.length - (NSInteger)_progressiveScanedLength - 4;
-                if (scanLength <= 2) return;
-                NSRange scanRange = NSMakeRange(_progressiveScanedLength, scanLength);
-                NSRange markerRange = [_data rangeOfData:JPEGSOSMarker() options:kNilOptions range:scanRange];
-                _progressiveScanedLength = _data.length;
-                if (markerRange.location == NSNotFound) return;
+                // only scan the new segments, display the image when a new scan begins
+                BOOL markerFound = NO;
+                for (NSUInteger i = _progressiveScanedSegmentCount; i < _dataSegments.count; i++) {
+                    NSData *segment = _dataSegments[i];
+                    if (!markerFound) markerFound = JPEGSOSMarkerFind(segment.bytes, segment.length, _progressiveScanedLastByte);
+                    _progressiveScanedLastByte = ((const uint8_t *)segment.bytes)[segment.length - 1];
+                }
+                _progressiveScanedSegmentCount = _dataSegments.count;
+                if (!markerFound) return;
                 if ([self isCancelled]) return;
                 
             } else if (_progressiveDecoder.type == YYImageTypePNG) {
@@ -541,6 +902,22 @@ static void URLInBlackListAdd(NSURL *url) {
                     }
                     _progressiveDetected = YES;
                 }
+                
+                // walk the new chunks, display the image when an IDAT chunk is completed
+                BOOL chunkFound = NO;
+                if (_progressiveChunkOffset == 0) _progressiveChunkOffset = 8; // signature
+                uint8_t header[8]; // length, type
+                while ([self _getReceivedBytes:header range:NSMakeRange(_progressiveChunkOffset, 8)]) {
+                    uint32_t length;
+                    memcpy(&length, header, 4);
+                    length = CFSwapInt32BigToHost(length);
+                    NSUInteger chunkEnd = _progressiveChunkOffset + 12 + length; // length, type, data, crc
+                    if (chunkEnd > _receivedSize) break;
+                    if (memcmp(header + 4, "IDAT", 4) == 0) chunkFound = YES;
+                    _progressiveChunkOffset = chunkEnd;
+                }
+                if (!chunkFound) return;
+                if ([self isCancelled]) return;
             }
             
             YYImageFrame *frame = [_progressiveDecoder frameAtIndex:0 decodeForDisplay:YES];
@@ -553,7 +930,7 @@ static void URLInBlackListAdd(NSURL *url) {
             
             CGFloat radius = 32;
             if (_expectedSize > 0) {
-                radius *= 1.0 / (3 * _data.length / (CGFloat)_expectedSize + 0.6) - 0.25;
+                radius *= 1.0 / (3 * _receivedSize / (CGFloat)_expectedSize + 0.6) - 0.25;
             } else {
                 radius /= (_progressiveDisplayCount);
             }
@@ -562,7 +939,7 @@ static void URLInBlackListAdd(NSURL *url) {
             if (image) {
                 [_lock lock];
                 if (![self isCancelled]) {
-                    _completion(image, _request.URL, YYWebImageFromRemote, YYWebImageStageProgress, nil);
+                    [self _invokeCompletionWithImage:image from:YYWebImageFromRemote stage:YYWebImageStageProgress error:nil];
                     _lastProgressiveDecodeTimestamp = now;
                 }
                 [_lock unlock];
@@ -571,21 +948,41 @@ static void URLInBlackListAdd(NSURL *url) {
     }
 }
 
-- (void)connectionDidFinishLoading:(NSURLConnection *)connection {
+- (void)_didFinishLoading {
     @autoreleasepool {
         [_lock lock];
-        _connection = nil;
+        _task = nil;
+        [self _closeStreamFile];
         if (![self isCancelled]) {
+            NSString *streamFilePath = _streamFilePath;
             __weak typeof(self) _self = self;
             dispatch_async([self.class _imageQueue], ^{
                 __strong typeof(_self) self = _self;
                 if (!self) return;
                 
+                if (streamFilePath) { // decode from the mapped file, the data is not copied to memory
+                    self.data = [NSData dataWithContentsOfFile:streamFilePath options:NSDataReadingMappedIfSafe error:NULL];
+                } else {
+                    self.data = [self _receivedData];
+                }
+                self.dataSegments = nil;
                 BOOL shouldDecode = (self.options & YYWebImageOptionIgnoreImageDecoding) == 0;
                 BOOL allowAnimation = (self.options & YYWebImageOptionIgnoreAnimatedImage) == 0;
-                UIImage *image;
+                UIImage *image = nil;
                 BOOL hasAnimation = NO;
-                if (allowAnimation) {
+                BOOL scaled = NO;
+                CGSize pixelSize = self.pixelSize;
+                if (pixelSize.width > 0 || pixelSize.height > 0) { // animated image is not scaled
+                    YYImageDecoder *decoder = [YYImageDecoder decoderWithData:self.data scale:[UIScreen mainScreen].scale];
+                    if (decoder.frameCount == 1 || !allowAnimation) {
+                        image = [decoder frameAtIndex:0 decodeForDisplay:shouldDecode pixelSize:pixelSize].image;
+                        scaled = image != nil;
+                    }
+                }
+                CFTimeInterval decodeBegin = CACurrentMediaTime();
+                if (scaled) {
+                    // decoded at target pixel size
+                } else if (allowAnimation) {
                     image = [[YYImage alloc] initWithData:self.data scale:[UIScreen mainScreen].scale];
                     if (shouldDecode) image = [image imageByDecoded];
                     if ([((YYImage *)image) animatedImageFrameCount] > 1) {
@@ -596,28 +993,16 @@ static void URLInBlackListAdd(NSURL *url) {
                     image = [decoder frameAtIndex:0 decodeForDisplay:shouldDecode].image;
                 }
                 
+                if (!scaled && shouldDecode && !hasAnimation && image.CGImage) { // measure the full size decode
+                    NSUInteger pixelCount = CGImageGetWidth(image.CGImage) * CGImageGetHeight(image.CGImage);
+                    YYImageType imageType = YYImageDetectType((__bridge CFDataRef)self.data);
+                    [self.cache.persistencePolicy recordDecodeTime:CACurrentMediaTime() - decodeBegin pixelCount:pixelCount type:imageType];
+                }
+                
                 /*
-                 If the image has animation, save the original image data to disk cache.
-                 If the image is not PNG or JPEG, re-encode the image to PNG or JPEG for
-                 better decoding performance.
+                 Save the original image data to disk cache, the cache's persistence policy
+                 may transcode it to PNG or JPEG in idle time for better decoding performance.
                  */
-                YYImageType imageType = YYImageDetectType((__bridge CFDataRef)self.data);
-                switch (imageType) {
-                    case YYImageTypeJPEG:
-                    case YYImageTypeGIF:
-                    case YYImageTypePNG:
-                    case YYImageTypeWebP: { // save to disk cache
-                        if (!hasAnimation) {
-                            if (imageType == YYImageTypeGIF ||
-                                imageType == YYImageTypeWebP) {
-                                self.data = nil; // clear the data, re-encode for disk cache
-                            }
-                        }
-                    } break;
-                    default: {
-                        self.data = nil; // clear the data, re-encode for disk cache
-                    } break;
-                }
                 if ([self isCancelled]) return;
                 
                 if (self.transform && image) {
@@ -629,7 +1014,9 @@ static void URLInBlackListAdd(NSURL *url) {
                     if ([self isCancelled]) return;
                 }
                 
-                [self performSelector:@selector(_didReceiveImageFromWeb:) onThread:[self.class _networkThread] withObject:image waitUntilDone:NO];
+                dispatch_async(self.requestQueue, ^{
+                    [self _didReceiveImageFromWeb:image];
+                });
             });
             if (![self.request.URL isFileURL] && (self.options & YYWebImageOptionShowNetworkActivity)) {
                 [[UIApplication sharedExtensionApplication] decrementNetworkActivityCount];
@@ -639,15 +1026,15 @@ static void URLInBlackListAdd(NSURL *url) {
     }
 }
 
-- (void)connection:(NSURLConnection *)connection didFailWithError:(NSError *)error {
+- (void)_didFailWithError:(NSError *)error {
     @autoreleasepool {
         [_lock lock];
         if (![self isCancelled]) {
-            if (_completion) {
-                _completion(nil, _request.URL, YYWebImageFromNone, YYWebImageStageFinished, error);
-            }
-            _connection = nil;
+            [self _invokeCompletionWithImage:nil from:YYWebImageFromNone stage:YYWebImageStageFinished error:error];
+            _task = nil;
             _data = nil;
+            _dataSegments = nil;
+            [self _removeStreamFile];
             if (![_request.URL isFileURL] && (_options & YYWebImageOptionShowNetworkActivity)) {
                 [[UIApplication sharedExtensionApplication] decrementNetworkActivityCount];
             }
@@ -674,18 +1061,33 @@ static void URLInBlackListAdd(NSURL *url) {
         [_lock lock];
         self.started = YES;
         if ([self isCancelled]) {
-            [self performSelector:@selector(_cancelOperation) onThread:[[self class] _networkThread] withObject:nil waitUntilDone:NO modes:@[NSDefaultRunLoopMode]];
+            dispatch_async(_requestQueue, ^{
+                [self _cancelOperation];
+            });
             self.finished = YES;
         } else if ([self isReady] && ![self isFinished] && ![self isExecuting]) {
             if (!_request) {
                 self.finished = YES;
                 if (_completion) {
                     NSError *error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorFileDoesNotExist userInfo:@{NSLocalizedDescriptionKey:@"request in nil"}];
-                    _completion(nil, _request.URL, YYWebImageFromNone, YYWebImageStageFinished, error);
+                    [self _invokeCompletionWithImage:nil from:YYWebImageFromNone stage:YYWebImageStageFinished error:error];
+                }
+            } else if (_coalescedOperation) {
+                self.executing = YES; // wait for the coalesced operation
+                if (_imageTransform) {
+                    dispatch_async(_requestQueue, ^{
+                        [self _startDerivedOperation];
+                    });
                 }
             } else {
                 self.executing = YES;
-                [self performSelector:@selector(_startOperation) onThread:[[self class] _networkThread] withObject:nil waitUntilDone:NO modes:@[NSDefaultRunLoopMode]];
+                dispatch_async(_requestQueue, ^{
+                    if (self.imageTransform) {
+                        [self _startDerivedOperation];
+                    } else {
+                        [self _startOperation];
+                    }
+                });
                 if ((_options & YYWebImageOptionAllowBackgroundTask) && ![UIApplication isAppExtension]) {
                     __weak __typeof__ (self) _self = self;
                     if (_taskID == UIBackgroundTaskInvalid) {
@@ -705,19 +1107,25 @@ static void URLInBlackListAdd(NSURL *url) {
 }
 
 - (void)cancel {
+    BOOL unsubscribe = NO;
     [_lock lock];
     if (![self isCancelled]) {
+        unsubscribe = _coalescedOperation != nil;
         [super cancel];
         self.cancelled = YES;
+        [self _invokeFinishHandler];
         if ([self isExecuting]) {
             self.executing = NO;
-            [self performSelector:@selector(_cancelOperation) onThread:[[self class] _networkThread] withObject:nil waitUntilDone:NO modes:@[NSDefaultRunLoopMode]];
+            dispatch_async(_requestQueue, ^{
+                [self _cancelOperation];
+            });
         }
         if (self.started) {
             self.finished = YES;
         }
     }
     [_lock unlock];
+    if (unsubscribe) [_coalescedOperation _removeSubscriber:self];
 }
 
 - (void)setExecuting:(BOOL)executing {
@@ -743,10 +1151,19 @@ static void URLInBlackListAdd(NSURL *url) {
         [self willChangeValueForKey:@"isFinished"];
         _finished = finished;
         [self didChangeValueForKey:@"isFinished"];
+        if (finished) [self _invokeFinishHandler];
     }
     [_lock unlock];
 }
 
+// caller should hold the lock
+- (void)_invokeFinishHandler {
+    void (^handler)(YYWebImageOperation *operation) = _finishHandler;
+    if (!handler) return;
+    _finishHandler = nil; // invoked once, when cancelled or finished
+    handler(self);
+}
+
 - (BOOL)isFinished {
     [_lock lock];
     BOOL finished = _finished;
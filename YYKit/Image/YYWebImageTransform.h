@@ -0,0 +1,114 @@
+//
+//  YYWebImageTransform.h
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A declarative image transform (resize, crop, round corner, blur, or a custom block)
+ used by `YYWebImageManager` and `YYWebImageOperation`.
+
+ @discussion Each transform has a stable `identifier` which describes the transform
+ and its parameters, so the transformed (derived) image can be cached with a key
+ derived from the original image's cache key and the identifier. Two transforms
+ with the same identifier should produce the same image.
+
+ Transforms are immutable and can be composed with `transformByAppendingTransform:`.
+ This class is thread safe, the transform may be applied on any thread.
+
+ Example:
+
+     YYWebImageTransform *transform = [[YYWebImageTransform resizeToSize:CGSizeMake(100, 100)
+                                                             contentMode:UIViewContentModeScaleAspectFill]
+                                       transformByAppendingTransform:[YYWebImageTransform roundCornerRadius:5]];
+ */
+@interface YYWebImageTransform : NSObject
+
+/**
+ Returns a transform which resizes the image.
+
+ @param size        The new size in points, values should be positive.
+ @param contentMode The content mode for image content.
+ */
++ (instancetype)resizeToSize:(CGSize)size contentMode:(UIViewContentMode)contentMode;
+
+/**
+ Returns a transform which crops the image.
+
+ @param rect The image's inner rect in points.
+ */
++ (instancetype)cropToRect:(CGRect)rect;
+
+/**
+ Returns a transform which rounds the image's corners.
+
+ @param radius The radius of each corner oval.
+ */
++ (instancetype)roundCornerRadius:(CGFloat)radius;
+
+/**
+ Returns a transform which rounds the image's corners and strokes a border.
+
+ @param radius      The radius of each corner oval.
+ @param borderWidth The inset border line width.
+ @param borderColor The border stroke color. nil means clear color.
+ */
++ (instancetype)roundCornerRadius:(CGFloat)radius
+                      borderWidth:(CGFloat)borderWidth
+                      borderColor:(nullable UIColor *)borderColor;
+
+/**
+ Returns a transform which blurs the image.
+
+ @param radius The blur radius in points.
+ */
++ (instancetype)blurRadius:(CGFloat)radius;
+
+/**
+ Returns a custom transform.
+
+ @param identifier A string which identifies the transform and its parameters,
+                   it should be unique in the app (for example, "com.foo.sepia(0.8)").
+ @param block      The block which returns the transformed image, or nil if an error occurs.
+ */
++ (nullable instancetype)transformWithIdentifier:(NSString *)identifier
+                                           block:(UIImage * _Nullable (^)(UIImage *image))block;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+
+/** The stable identifier of the transform. */
+@property (nonatomic, readonly) NSString *identifier;
+
+/**
+ Returns a new transform which applies the receiver first, then the other transform.
+ */
+- (instancetype)transformByAppendingTransform:(YYWebImageTransform *)transform;
+
+/**
+ Applies the transform to an image.
+
+ @param image The source image.
+ @return The transformed image, or nil if an error occurs.
+ */
+- (nullable UIImage *)transformImage:(UIImage *)image;
+
+/**
+ Returns the cache key of the transformed image.
+
+ @param key The cache key of the source image.
+ */
+- (NSString *)cacheKeyForKey:(NSString *)key;
+
+@end
+
+NS_ASSUME_NONNULL_END
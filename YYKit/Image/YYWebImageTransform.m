@@ -0,0 +1,96 @@
+//
+//  YYWebImageTransform.m
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import "YYWebImageTransform.h"
+#import "UIImage+YYAdd.h"
+#import "UIColor+YYAdd.h"
+
+typedef UIImage *(^YYWebImageTransformImageBlock)(UIImage *image);
+
+@implementation YYWebImageTransform {
+    YYWebImageTransformImageBlock _block;
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYWebImageTransform init error" reason:@"Use the factory methods to create a transform." userInfo:nil];
+    return [self _initWithIdentifier:@"" block:nil];
+}
+
+- (instancetype)_initWithIdentifier:(NSString *)identifier block:(YYWebImageTransformImageBlock)block {
+    self = [super init];
+    if (!self) return nil;
+    _identifier = identifier.copy;
+    _block = [block copy];
+    return self;
+}
+
++ (instancetype)resizeToSize:(CGSize)size contentMode:(UIViewContentMode)contentMode {
+    NSString *identifier = [NSString stringWithFormat:@"resize(%gx%g,%d)", size.width, size.height, (int)contentMode];
+    return [[self alloc] _initWithIdentifier:identifier block:^UIImage *(UIImage *image) {
+        return [image imageByResizeToSize:size contentMode:contentMode];
+    }];
+}
+
++ (instancetype)cropToRect:(CGRect)rect {
+    NSString *identifier = [NSString stringWithFormat:@"crop(%g,%g,%gx%g)", rect.origin.x, rect.origin.y, rect.size.width, rect.size.height];
+    return [[self alloc] _initWithIdentifier:identifier block:^UIImage *(UIImage *image) {
+        return [image imageByCropToRect:rect];
+    }];
+}
+
++ (instancetype)roundCornerRadius:(CGFloat)radius {
+    return [self roundCornerRadius:radius borderWidth:0 borderColor:nil];
+}
+
++ (instancetype)roundCornerRadius:(CGFloat)radius borderWidth:(CGFloat)borderWidth borderColor:(UIColor *)borderColor {
+    NSString *color = borderColor ? [borderColor hexStringWithAlpha] : nil;
+    NSString *identifier = [NSString stringWithFormat:@"round(%g,%g,%@)", radius, borderWidth, color ? color : @"clear"];
+    return [[self alloc] _initWithIdentifier:identifier block:^UIImage *(UIImage *image) {
+        return [image imageByRoundCornerRadius:radius borderWidth:borderWidth borderColor:borderColor];
+    }];
+}
+
++ (instancetype)blurRadius:(CGFloat)radius {
+    NSString *identifier = [NSString stringWithFormat:@"blur(%g)", radius];
+    return [[self alloc] _initWithIdentifier:identifier block:^UIImage *(UIImage *image) {
+        return [image imageByBlurRadius:radius tintColor:nil tintMode:kCGBlendModeNormal saturation:1 maskImage:nil];
+    }];
+}
+
++ (instancetype)transformWithIdentifier:(NSString *)identifier block:(UIImage *(^)(UIImage *image))block {
+    if (!identifier || !block) return nil;
+    return [[self alloc] _initWithIdentifier:identifier block:block];
+}
+
+- (instancetype)transformByAppendingTransform:(YYWebImageTransform *)transform {
+    if (!transform) return self;
+    YYWebImageTransformImageBlock first = _block, second = transform->_block;
+    NSString *identifier = [NSString stringWithFormat:@"%@|%@", _identifier, transform.identifier];
+    return [[self.class alloc] _initWithIdentifier:identifier block:^UIImage *(UIImage *image) {
+        UIImage *result = first(image);
+        return result ? second(result) : nil;
+    }];
+}
+
+- (UIImage *)transformImage:(UIImage *)image {
+    if (!image) return nil;
+    return _block(image);
+}
+
+- (NSString *)cacheKeyForKey:(NSString *)key {
+    return [NSString stringWithFormat:@"%@#%@", key, _identifier];
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p> %@", self.class, self, _identifier];
+}
+
+@end
@@ -0,0 +1,141 @@
+//
+//  YYWebImageTransport.h
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol YYWebImageTransportTaskDelegate;
+
+/**
+ A running URL load created by a `YYWebImageTransport`.
+ */
+@protocol YYWebImageTransportTask <NSObject>
+
+/// The request of the task.
+@property (nonatomic, readonly) NSURLRequest *request;
+
+/**
+ Cancels the task. The delegate will not receive any message after this method
+ is called (except the messages which are already being invoked).
+ */
+- (void)cancel;
+
+@end
+
+
+/**
+ The delegate of a transport task, typically a `YYWebImageOperation`.
+
+ @discussion The required methods and the authentication challenge are invoked
+ serially on the delegate queue passed to the transport, in the order of the
+ response: a `didReceiveResponse:`, zero or more `didReceiveData:`, then one
+ `didCompleteWithError:`. The data passed to `didReceiveData:` is kept without
+ copying, so it should not be mutated later.
+ */
+@protocol YYWebImageTransportTaskDelegate <NSObject>
+@required
+- (void)transportTask:(id<YYWebImageTransportTask>)task didReceiveResponse:(NSURLResponse *)response;
+- (void)transportTask:(id<YYWebImageTransportTask>)task didReceiveData:(NSData *)data;
+- (void)transportTask:(id<YYWebImageTransportTask>)task didCompleteWithError:(nullable NSError *)error;
+
+@optional
+/// Invoked on the delegate queue, the `completionHandler` should be called once.
+- (void)transportTask:(id<YYWebImageTransportTask>)task
+  didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge
+    completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential * _Nullable credential))completionHandler;
+
+/// Invoked on the transport's thread, returns nil to avoid caching the response.
+- (nullable NSCachedURLResponse *)transportTask:(id<YYWebImageTransportTask>)task willCacheResponse:(NSCachedURLResponse *)cachedResponse;
+
+/// Invoked on the transport's thread, returns NO to avoid using the credential storage.
+- (BOOL)transportTaskShouldUseCredentialStorage:(id<YYWebImageTransportTask>)task;
+@end
+
+
+/**
+ A transport loads the URL request of `YYWebImageOperation`.
+
+ @discussion You may implement this protocol to load images with your own network
+ stack, and set it to `YYWebImageManager.transport`. The transport should be thread
+ safe, a task may be created and cancelled on any thread.
+ */
+@protocol YYWebImageTransport <NSObject>
+
+/**
+ Creates and starts a task to load the request.
+
+ @param request  The URL request.
+ @param delegate The task delegate, the task should not retain it.
+ @param queue    A serial queue on which the delegate is invoked.
+ @return A new task, or nil if an error occurs.
+ */
+- (nullable id<YYWebImageTransportTask>)startTaskWithRequest:(NSURLRequest *)request
+                                                    delegate:(id<YYWebImageTransportTaskDelegate>)delegate
+                                               delegateQueue:(dispatch_queue_t)queue;
+
+@end
+
+
+/**
+ The default transport, based on NSURLSession.
+
+ @discussion All tasks share one session, so the HTTP/1.1 connections are kept alive
+ and reused by the later requests of the same host, and the session limits the number
+ of connections for one host. The session's callbacks only forward the events to
+ the tasks' delegate queues, so the delegates of different tasks run concurrently
+ on different threads.
+ */
+@interface YYWebImageSessionTransport : NSObject <YYWebImageTransport>
+
+/**
+ Returns the global transport instance, which has 4 connections per host.
+ */
++ (instancetype)sharedTransport;
+
+/**
+ Creates a transport with a session configuration.
+
+ @param configuration The session configuration, the `HTTPMaximumConnectionsPerHost`
+    is the per-host concurrency limit. Pass nil to use the default configuration.
+ @return A new transport.
+ */
+- (instancetype)initWithSessionConfiguration:(nullable NSURLSessionConfiguration *)configuration NS_DESIGNATED_INITIALIZER;
+
+/// The session configuration (a copy).
+@property (nonatomic, readonly) NSURLSessionConfiguration *configuration;
+
+/**
+ Cancels all tasks and invalidates the session, the transport should not be used
+ after calling this method. The session retains the transport until this method is called.
+ */
+- (void)invalidateAndCancel;
+
+@end
+
+
+/**
+ A transport based on NSURLConnection, which was used by YYWebImageOperation before
+ the transport is introduced.
+
+ @discussion All connections are scheduled on one run-loop thread, the events are
+ forwarded to the tasks' delegate queues.
+ */
+@interface YYWebImageConnectionTransport : NSObject <YYWebImageTransport>
+
+/**
+ Returns the global transport instance.
+ */
++ (instancetype)sharedTransport;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,374 @@
+//
+//  YYWebImageTransport.m
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import "YYWebImageTransport.h"
+#import <pthread.h>
+
+typedef void (^YYWebImageTransportChallengeHandler)(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential *credential);
+
+#pragma mark - Session Transport
+
+@class YYWebImageSessionTransport;
+
+@interface _YYWebImageSessionTask : NSObject <YYWebImageTransportTask>
+@property (nonatomic, strong) NSURLRequest *request;
+@property (nonatomic, strong) NSURLSessionDataTask *dataTask;
+@property (nonatomic, weak) id<YYWebImageTransportTaskDelegate> delegate;
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, weak) YYWebImageSessionTransport *transport;
+@property (atomic) BOOL cancelled;
+@end
+
+@interface YYWebImageSessionTransport () <NSURLSessionDataDelegate>
+- (void)_removeTask:(_YYWebImageSessionTask *)task;
+@end
+
+@implementation _YYWebImageSessionTask
+
+/// Invokes the delegate on the delegate queue if the task is not cancelled.
+- (void)_performDelegateBlock:(void (^)(id<YYWebImageTransportTaskDelegate> delegate))block {
+    dispatch_async(_queue, ^{
+        if (self.cancelled) return;
+        id<YYWebImageTransportTaskDelegate> delegate = self.delegate;
+        if (delegate) block(delegate);
+    });
+}
+
+- (void)cancel {
+    if (self.cancelled) return;
+    self.cancelled = YES;
+    [_dataTask cancel];
+    [_transport _removeTask:self];
+}
+
+@end
+
+
+@implementation YYWebImageSessionTransport {
+    NSURLSession *_session;
+    NSOperationQueue *_sessionQueue;
+    pthread_mutex_t _lock;
+    NSMutableDictionary *_tasks; ///< taskIdentifier -> _YYWebImageSessionTask
+}
+
++ (instancetype)sharedTransport {
+    static YYWebImageSessionTransport *transport = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        transport = [[self alloc] initWithSessionConfiguration:nil];
+    });
+    return transport;
+}
+
+- (instancetype)init {
+    return [self initWithSessionConfiguration:nil];
+}
+
+- (instancetype)initWithSessionConfiguration:(NSURLSessionConfiguration *)configuration {
+    self = [super init];
+    if (!configuration) {
+        configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+        configuration.HTTPMaximumConnectionsPerHost = 4;
+    }
+    _configuration = configuration.copy;
+    pthread_mutex_init(&_lock, NULL);
+    _tasks = [NSMutableDictionary new];
+
+    // the session queue only forwards the events, the delegates run on their own queues
+    _sessionQueue = [NSOperationQueue new];
+    _sessionQueue.maxConcurrentOperationCount = 1;
+    _sessionQueue.name = @"com.ibireme.yykit.webimage.session";
+    _session = [NSURLSession sessionWithConfiguration:_configuration delegate:self delegateQueue:_sessionQueue];
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+- (void)invalidateAndCancel {
+    [_session invalidateAndCancel];
+}
+
+- (id<YYWebImageTransportTask>)startTaskWithRequest:(NSURLRequest *)request
+                                           delegate:(id<YYWebImageTransportTaskDelegate>)delegate
+                                      delegateQueue:(dispatch_queue_t)queue {
+    if (!request || !delegate || !queue) return nil;
+    NSURLSessionDataTask *dataTask = [_session dataTaskWithRequest:request];
+    if (!dataTask) return nil;
+    _YYWebImageSessionTask *task = [_YYWebImageSessionTask new];
+    task.request = request;
+    task.dataTask = dataTask;
+    task.delegate = delegate;
+    task.queue = queue;
+    task.transport = self;
+    pthread_mutex_lock(&_lock);
+    _tasks[@(dataTask.taskIdentifier)] = task;
+    pthread_mutex_unlock(&_lock);
+    [dataTask resume];
+    return task;
+}
+
+- (_YYWebImageSessionTask *)_taskForSessionTask:(NSURLSessionTask *)sessionTask {
+    pthread_mutex_lock(&_lock);
+    _YYWebImageSessionTask *task = _tasks[@(sessionTask.taskIdentifier)];
+    pthread_mutex_unlock(&_lock);
+    return task;
+}
+
+- (void)_removeTask:(_YYWebImageSessionTask *)task {
+    pthread_mutex_lock(&_lock);
+    [_tasks removeObjectForKey:@(task.dataTask.taskIdentifier)];
+    pthread_mutex_unlock(&_lock);
+}
+
+#pragma mark NSURLSessionDataDelegate runs in session queue
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveResponse:(NSURLResponse *)response completionHandler:(void (^)(NSURLSessionResponseDisposition))completionHandler {
+    _YYWebImageSessionTask *task = [self _taskForSessionTask:dataTask];
+    if (task) {
+        [task _performDelegateBlock:^(id<YYWebImageTransportTaskDelegate> delegate) {
+            [delegate transportTask:task didReceiveResponse:response];
+        }];
+        completionHandler(NSURLSessionResponseAllow);
+    } else {
+        completionHandler(NSURLSessionResponseCancel);
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    _YYWebImageSessionTask *task = [self _taskForSessionTask:dataTask];
+    [task _performDelegateBlock:^(id<YYWebImageTransportTaskDelegate> delegate) {
+        [delegate transportTask:task didReceiveData:data];
+    }];
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)sessionTask didCompleteWithError:(NSError *)error {
+    _YYWebImageSessionTask *task = [self _taskForSessionTask:sessionTask];
+    if (!task) return;
+    [self _removeTask:task];
+    [task _performDelegateBlock:^(id<YYWebImageTransportTaskDelegate> delegate) {
+        [delegate transportTask:task didCompleteWithError:error];
+    }];
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)sessionTask didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge completionHandler:(YYWebImageTransportChallengeHandler)completionHandler {
+    _YYWebImageSessionTask *task = [self _taskForSessionTask:sessionTask];
+    id<YYWebImageTransportTaskDelegate> delegate = task.delegate;
+    if (!task || ![delegate respondsToSelector:@selector(transportTask:didReceiveChallenge:completionHandler:)]) {
+        completionHandler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
+        return;
+    }
+    dispatch_async(task.queue, ^{
+        id<YYWebImageTransportTaskDelegate> delegate = task.delegate;
+        if (task.cancelled || !delegate) {
+            completionHandler(NSURLSessionAuthChallengeCancelAuthenticationChallenge, nil);
+        } else {
+            [delegate transportTask:task didReceiveChallenge:challenge completionHandler:completionHandler];
+        }
+    });
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask willCacheResponse:(NSCachedURLResponse *)proposedResponse completionHandler:(void (^)(NSCachedURLResponse *))completionHandler {
+    _YYWebImageSessionTask *task = [self _taskForSessionTask:dataTask];
+    id<YYWebImageTransportTaskDelegate> delegate = task.delegate;
+    if ([delegate respondsToSelector:@selector(transportTask:willCacheResponse:)]) {
+        completionHandler([delegate transportTask:task willCacheResponse:proposedResponse]);
+    } else {
+        completionHandler(proposedResponse);
+    }
+}
+
+@end
+
+
+
+#pragma mark - Connection Transport
+
+@interface YYWebImageConnectionTransport ()
++ (NSThread *)_networkThread;
+@end
+
+@interface _YYWebImageConnectionTask : NSObject <YYWebImageTransportTask, NSURLConnectionDataDelegate>
+@property (nonatomic, strong) NSURLRequest *request;
+@property (nonatomic, strong) NSURLConnection *connection; ///< accessed on network thread
+@property (nonatomic, weak) id<YYWebImageTransportTaskDelegate> delegate;
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (atomic) BOOL cancelled;
+@end
+
+@implementation _YYWebImageConnectionTask
+
+- (void)_performDelegateBlock:(void (^)(id<YYWebImageTransportTaskDelegate> delegate))block {
+    dispatch_async(_queue, ^{
+        if (self.cancelled) return;
+        id<YYWebImageTransportTaskDelegate> delegate = self.delegate;
+        if (delegate) block(delegate);
+    });
+}
+
+// runs on network thread
+- (void)_start {
+    if (self.cancelled) return;
+    // the connection retains the task until it finished or cancelled
+    _connection = [[NSURLConnection alloc] initWithRequest:_request delegate:self];
+}
+
+// runs on network thread
+- (void)_cancel {
+    [_connection cancel];
+    _connection = nil;
+}
+
+- (void)cancel {
+    if (self.cancelled) return;
+    self.cancelled = YES;
+    [self performSelector:@selector(_cancel) onThread:[YYWebImageConnectionTransport _networkThread] withObject:nil waitUntilDone:NO modes:@[NSDefaultRunLoopMode]];
+}
+
+#pragma mark NSURLConnectionDelegate runs in network thread
+
+- (BOOL)connectionShouldUseCredentialStorage:(NSURLConnection *)connection {
+    id<YYWebImageTransportTaskDelegate> delegate = self.delegate;
+    if ([delegate respondsToSelector:@selector(transportTaskShouldUseCredentialStorage:)]) {
+        return [delegate transportTaskShouldUseCredentialStorage:self];
+    }
+    return YES;
+}
+
+- (void)connection:(NSURLConnection *)connection willSendRequestForAuthenticationChallenge:(NSURLAuthenticationChallenge *)challenge {
+    id<YYWebImageTransportTaskDelegate> delegate = self.delegate;
+    id<NSURLAuthenticationChallengeSender> sender = challenge.sender;
+    YYWebImageTransportChallengeHandler handler = ^(NSURLSessionAuthChallengeDisposition disposition, NSURLCredential *credential) {
+        switch (disposition) {
+            case NSURLSessionAuthChallengeUseCredential: {
+                if (credential) [sender useCredential:credential forAuthenticationChallenge:challenge];
+                else [sender continueWithoutCredentialForAuthenticationChallenge:challenge];
+            } break;
+            case NSURLSessionAuthChallengeCancelAuthenticationChallenge: {
+                [sender cancelAuthenticationChallenge:challenge];
+            } break;
+            case NSURLSessionAuthChallengeRejectProtectionSpace: {
+                if ([sender respondsToSelector:@selector(rejectProtectionSpaceAndContinueWithChallenge:)]) {
+                    [sender rejectProtectionSpaceAndContinueWithChallenge:challenge];
+                } else {
+                    [sender continueWithoutCredentialForAuthenticationChallenge:challenge];
+                }
+            } break;
+            default: {
+                if ([sender respondsToSelector:@selector(performDefaultHandlingForAuthenticationChallenge:)]) {
+                    [sender performDefaultHandlingForAuthenticationChallenge:challenge];
+                } else {
+                    [sender continueWithoutCredentialForAuthenticationChallenge:challenge];
+                }
+            } break;
+        }
+    };
+    if (![delegate respondsToSelector:@selector(transportTask:didReceiveChallenge:completionHandler:)]) {
+        handler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
+        return;
+    }
+    // the delegate queue never waits for the network thread, so it's safe to wait here
+    dispatch_sync(_queue, ^{
+        id<YYWebImageTransportTaskDelegate> delegate = self.delegate;
+        if (self.cancelled || !delegate) {
+            handler(NSURLSessionAuthChallengeCancelAuthenticationChallenge, nil);
+        } else {
+            [delegate transportTask:self didReceiveChallenge:challenge completionHandler:handler];
+        }
+    });
+}
+
+- (NSCachedURLResponse *)connection:(NSURLConnection *)connection willCacheResponse:(NSCachedURLResponse *)cachedResponse {
+    id<YYWebImageTransportTaskDelegate> delegate = self.delegate;
+    if ([delegate respondsToSelector:@selector(transportTask:willCacheResponse:)]) {
+        return [delegate transportTask:self willCacheResponse:cachedResponse];
+    }
+    return cachedResponse;
+}
+
+- (void)connection:(NSURLConnection *)connection didReceiveResponse:(NSURLResponse *)response {
+    [self _performDelegateBlock:^(id<YYWebImageTransportTaskDelegate> delegate) {
+        [delegate transportTask:self didReceiveResponse:response];
+    }];
+}
+
+- (void)connection:(NSURLConnection *)connection didReceiveData:(NSData *)data {
+    [self _performDelegateBlock:^(id<YYWebImageTransportTaskDelegate> delegate) {
+        [delegate transportTask:self didReceiveData:data];
+    }];
+}
+
+- (void)connectionDidFinishLoading:(NSURLConnection *)connection {
+    _connection = nil;
+    [self _performDelegateBlock:^(id<YYWebImageTransportTaskDelegate> delegate) {
+        [delegate transportTask:self didCompleteWithError:nil];
+    }];
+}
+
+- (void)connection:(NSURLConnection *)connection didFailWithError:(NSError *)error {
+    _connection = nil;
+    [self _performDelegateBlock:^(id<YYWebImageTransportTaskDelegate> delegate) {
+        [delegate transportTask:self didCompleteWithError:error];
+    }];
+}
+
+@end
+
+
+@implementation YYWebImageConnectionTransport
+
+/// Network thread entry point.
++ (void)_networkThreadMain:(id)object {
+    @autoreleasepool {
+        [[NSThread currentThread] setName:@"com.ibireme.yykit.webimage.request"];
+        NSRunLoop *runLoop = [NSRunLoop currentRunLoop];
+        [runLoop addPort:[NSMachPort port] forMode:NSDefaultRunLoopMode];
+        [runLoop run];
+    }
+}
+
+/// Global image request network thread, used by NSURLConnection delegate.
++ (NSThread *)_networkThread {
+    static NSThread *thread = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        thread = [[NSThread alloc] initWithTarget:self selector:@selector(_networkThreadMain:) object:nil];
+        if ([thread respondsToSelector:@selector(setQualityOfService:)]) {
+            thread.qualityOfService = NSQualityOfServiceBackground;
+        }
+        [thread start];
+    });
+    return thread;
+}
+
++ (instancetype)sharedTransport {
+    static YYWebImageConnectionTransport *transport = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        transport = [self new];
+    });
+    return transport;
+}
+
+- (id<YYWebImageTransportTask>)startTaskWithRequest:(NSURLRequest *)request
+                                           delegate:(id<YYWebImageTransportTaskDelegate>)delegate
+                                      delegateQueue:(dispatch_queue_t)queue {
+    if (!request || !delegate || !queue) return nil;
+    _YYWebImageConnectionTask *task = [_YYWebImageConnectionTask new];
+    task.request = request;
+    task.delegate = delegate;
+    task.queue = queue;
+    [task performSelector:@selector(_start) onThread:[self.class _networkThread] withObject:nil waitUntilDone:NO modes:@[NSDefaultRunLoopMode]];
+    return task;
+}
+
+@end
@@ -0,0 +1,99 @@
+//
+//  YYWebImageURLBlacklist.h
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A persistent blacklist of the URLs which failed to load, used by `YYWebImageOperation`
+ with the `YYWebImageOptionIgnoreFailedURL` option.
+
+ @discussion A failed URL is blocked for a while, and the interval is doubled with
+ each failure of the URL (exponential backoff, from `initialBackoff` to `maxBackoff`).
+ The URL can be loaded again when the interval is passed, and it's removed from the
+ blacklist once it's loaded successfully.
+
+ The failure count and retry time of each URL are stored in a YYKVStorage (SQLite),
+ with the URL's hash as key, so the blacklist is kept across launches. A URL which
+ has not failed in `ageLimit` is forgotten, and the storage keeps at most `countLimit`
+ URLs which failed recently.
+
+ The lookup (`containsURL:`) is lock-free: the retry times are kept in a fixed size
+ in-memory table of atomic words, which is updated in background. When the table
+ is full, a URL may be forgotten (and loaded again) before its retry time.
+ The storage is opened and loaded into the table in background, so the URLs which
+ failed in previous launches are not blocked until it's loaded.
+ This class is thread safe.
+ */
+@interface YYWebImageURLBlacklist : NSObject
+
+/**
+ Returns the global blacklist, which is stored in the app's caches directory.
+ */
++ (instancetype)sharedBlacklist;
+
+- (instancetype)init UNAVAILABLE_ATTRIBUTE;
++ (instancetype)new UNAVAILABLE_ATTRIBUTE;
+
+/**
+ The designated initializer.
+
+ @param path Full path of a directory in which the blacklist will write data.
+    The storage is opened in background, if it can't be opened, the blacklist 
+    only works in memory.
+ @return A new blacklist, or nil if the path is empty.
+ */
+- (nullable instancetype)initWithPath:(NSString *)path NS_DESIGNATED_INITIALIZER;
+
+/** The path of the blacklist. */
+@property (nonatomic, readonly) NSString *path;
+
+/** The interval a URL is blocked after its first failure. Default is 60 seconds. */
+@property NSTimeInterval initialBackoff;
+
+/** The max interval a URL is blocked. Default is 1 day. */
+@property NSTimeInterval maxBackoff;
+
+/** A URL is forgotten if it has not failed in this interval. Default is 7 days. */
+@property NSTimeInterval ageLimit;
+
+/** The max number of the URLs in the storage. Default is 1000. */
+@property NSUInteger countLimit;
+
+/**
+ Whether a URL is blocked now. This method is lock-free and returns immediately.
+
+ @param url The URL.
+ @return YES if the URL failed recently and should not be loaded now.
+ */
+- (BOOL)containsURL:(NSURL *)url;
+
+/**
+ Records a failure of a URL, the URL is blocked for the next backoff interval.
+ This method returns immediately and writes the storage in background.
+ */
+- (void)addFailedURL:(NSURL *)url;
+
+/**
+ Removes a URL from the blacklist (for example, it's loaded successfully).
+ This method returns immediately and removes the URL from the storage in background.
+ */
+- (void)removeURL:(NSURL *)url;
+
+/**
+ Removes all URLs from the blacklist.
+ */
+- (void)removeAllURLs;
+
+@end
+
+NS_ASSUME_NONNULL_END
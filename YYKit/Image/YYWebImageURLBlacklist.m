@@ -0,0 +1,198 @@
+//
+//  YYWebImageURLBlacklist.m
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import "YYWebImageURLBlacklist.h"
+#import "YYKVStorage.h"
+#import <time.h>
+
+#define kBlacklistSetCount 1024 // power of 2
+#define kBlacklistSetWays 4
+
+/// The value stored for a URL.
+typedef struct {
+    uint32_t failureCount;
+    uint32_t retryTime; ///< seconds since 1970
+} yy_url_blacklist_entry;
+
+/// FNV-1a hash of the URL string.
+static uint64_t YYURLBlacklistHash(NSURL *url) {
+    const char *str = url.absoluteString.UTF8String;
+    if (!str) return 0;
+    uint64_t hash = 14695981039346656037ULL;
+    for (; *str; str++) {
+        hash ^= (uint8_t)*str;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// The tag of a URL in the table, 0 is an empty slot.
+static inline uint32_t YYURLBlacklistTag(uint64_t hash) {
+    return (uint32_t)(hash >> 32) | 1;
+}
+
+static inline NSString *YYURLBlacklistKey(uint64_t hash) {
+    return [NSString stringWithFormat:@"%016llx", hash];
+}
+
+
+@implementation YYWebImageURLBlacklist {
+    YYKVStorage *_kv; ///< opened in queue, nil if the storage can't be opened
+    dispatch_queue_t _queue; ///< serial queue to access the storage and write the table
+    uint64_t *_table; ///< sets of slots, each slot is (tag << 32 | retry time)
+    NSUInteger _saveCount;
+}
+
++ (instancetype)sharedBlacklist {
+    static YYWebImageURLBlacklist *blacklist = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString *path = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory,
+                                                              NSUserDomainMask, YES) firstObject];
+        path = [path stringByAppendingPathComponent:@"com.ibireme.yykit"];
+        path = [path stringByAppendingPathComponent:@"url_blacklist"];
+        blacklist = [[self alloc] initWithPath:path];
+    });
+    return blacklist;
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:@"YYWebImageURLBlacklist init error" reason:@"YYWebImageURLBlacklist must be initialized with a path. Use 'initWithPath:' instead." userInfo:nil];
+    return [self initWithPath:@""];
+}
+
+- (instancetype)initWithPath:(NSString *)path {
+    if (path.length == 0) return nil;
+    
+    self = [super init];
+    _path = path.copy;
+    _queue = dispatch_queue_create("com.ibireme.yykit.webimage.blacklist", DISPATCH_QUEUE_SERIAL);
+    _table = calloc(kBlacklistSetCount * kBlacklistSetWays, sizeof(uint64_t));
+    _initialBackoff = 60;
+    _maxBackoff = 24 * 60 * 60;
+    _ageLimit = 7 * 24 * 60 * 60;
+    _countLimit = 1000;
+    
+    // opening the database is slow, don't block the first lookup (often in main thread)
+    dispatch_async(_queue, ^{
+        _kv = [[YYKVStorage alloc] initWithPath:_path type:YYKVStorageTypeSQLite];
+        [self _load];
+    });
+    return self;
+}
+
+- (void)dealloc {
+    free(_table);
+}
+
+#pragma mark Private
+
+/// Returns the retry time of a URL in the table, or 0 if not found. Lock-free.
+- (uint32_t)_retryTimeForHash:(uint64_t)hash {
+    uint32_t tag = YYURLBlacklistTag(hash);
+    uint64_t *set = _table + (hash & (kBlacklistSetCount - 1)) * kBlacklistSetWays;
+    for (int i = 0; i < kBlacklistSetWays; i++) {
+        uint64_t slot = __atomic_load_n(set + i, __ATOMIC_RELAXED);
+        if ((uint32_t)(slot >> 32) == tag) return (uint32_t)slot;
+    }
+    return 0;
+}
+
+/// Sets the retry time of a URL in the table (0 to remove), runs in queue.
+- (void)_setRetryTime:(uint32_t)retryTime forHash:(uint64_t)hash {
+    uint32_t tag = YYURLBlacklistTag(hash);
+    uint64_t *set = _table + (hash & (kBlacklistSetCount - 1)) * kBlacklistSetWays;
+    int index = -1, victim = 0;
+    uint32_t minRetryTime = UINT32_MAX;
+    for (int i = 0; i < kBlacklistSetWays; i++) {
+        uint64_t slot = __atomic_load_n(set + i, __ATOMIC_RELAXED);
+        if ((uint32_t)(slot >> 32) == tag) {
+            index = i;
+            break;
+        }
+        if ((uint32_t)slot < minRetryTime) { // empty slot first, then the earliest to retry
+            minRetryTime = (uint32_t)slot;
+            victim = i;
+        }
+    }
+    if (index < 0) {
+        if (retryTime == 0) return;
+        index = victim;
+    }
+    uint64_t slot = retryTime ? ((uint64_t)tag << 32 | retryTime) : 0;
+    __atomic_store_n(set + index, slot, __ATOMIC_RELAXED);
+}
+
+/// Loads the storage into the table, runs in queue.
+- (void)_load {
+    if (!_kv) return;
+    uint32_t now = (uint32_t)time(NULL);
+    [_kv removeItemsEarlierThanTime:(int)(now - self.ageLimit)];
+    NSArray *items = [_kv getItemsWithLimit:(int)self.countLimit];
+    for (YYKVStorageItem *item in items.reverseObjectEnumerator) { // the recent failures win
+        yy_url_blacklist_entry entry;
+        if (item.value.length != sizeof(entry)) continue;
+        memcpy(&entry, item.value.bytes, sizeof(entry));
+        if (entry.retryTime <= now) continue;
+        uint64_t hash = strtoull(item.key.UTF8String, NULL, 16);
+        [self _setRetryTime:entry.retryTime forHash:hash];
+    }
+}
+
+#pragma mark Public
+
+- (BOOL)containsURL:(NSURL *)url {
+    if (!url || url == (id)[NSNull null]) return NO;
+    uint32_t retryTime = [self _retryTimeForHash:YYURLBlacklistHash(url)];
+    return retryTime > (uint32_t)time(NULL);
+}
+
+- (void)addFailedURL:(NSURL *)url {
+    if (!url || url == (id)[NSNull null]) return;
+    uint64_t hash = YYURLBlacklistHash(url);
+    dispatch_async(_queue, ^{
+        NSString *key = YYURLBlacklistKey(hash);
+        yy_url_blacklist_entry entry = {0};
+        NSData *value = [_kv getItemValueForKey:key];
+        if (value.length == sizeof(entry)) memcpy(&entry, value.bytes, sizeof(entry));
+        uint32_t now = (uint32_t)time(NULL);
+        if (entry.retryTime <= now) { // the concurrent failures before the retry time count once
+            entry.failureCount++;
+            double backoff = self.initialBackoff * pow(2, MIN(entry.failureCount - 1, 30));
+            backoff = MAX(1, MIN(backoff, self.maxBackoff));
+            entry.retryTime = now + (uint32_t)backoff;
+            [_kv saveItemWithKey:key value:[NSData dataWithBytes:&entry length:sizeof(entry)]];
+            if (++_saveCount % 32 == 0) [_kv removeItemsToFitCount:(int)self.countLimit];
+        }
+        [self _setRetryTime:entry.retryTime forHash:hash];
+    });
+}
+
+- (void)removeURL:(NSURL *)url {
+    if (!url || url == (id)[NSNull null]) return;
+    uint64_t hash = YYURLBlacklistHash(url);
+    // the URL may be in storage but not in the table (not loaded yet, or evicted), always remove it
+    dispatch_async(_queue, ^{
+        [_kv removeItemForKey:YYURLBlacklistKey(hash)];
+        [self _setRetryTime:0 forHash:hash];
+    });
+}
+
+- (void)removeAllURLs {
+    dispatch_async(_queue, ^{
+        [_kv removeAllItems];
+        for (int i = 0; i < kBlacklistSetCount * kBlacklistSetWays; i++) {
+            __atomic_store_n(_table + i, 0, __ATOMIC_RELAXED);
+        }
+    });
+}
+
+@end
@@ -80,6 +80,14 @@ NS_ASSUME_NONNULL_BEGIN
  
  @return A new instance created from the json, or nil if an error occurs.
  
+ @discussion If the json is `NSString` or `NSData` (UTF-8), the models are set while
+ parsing the json in a single pass, without creating the intermediate dictionary:
+ the values of unmapped keys are skipped, and the nested models (and model arrays)
+ are set directly. The dictionary passed to the custom methods in `YYModel` protocol
+ is parsed lazily on first access. If the data is not UTF-8 (or not a JSON object),
+ it falls back to `NSJSONSerialization`. Invalid JSON returns nil, even if the
+ custom methods have been called before the error is found.
+ 
  可以是字典、字符串、NSData
  */
 + (nullable instancetype)modelWithJSON:(id)json;
@@ -157,6 +165,10 @@ NS_ASSUME_NONNULL_BEGIN
  @discussion Any of the invalid property is ignored.
  If the reciver is `NSArray`, `NSDictionary` or `NSSet`, it will also convert the 
  inner object to json string.
+ 
+ The UTF-8 data is written directly from the properties, without creating the
+ intermediate json object. The result is same as `modelToJSONObject` serialized
+ with `NSJSONSerialization`, but the keys may be in different order.
  */
 - (nullable NSData *)modelToJSONData;
 
@@ -194,6 +206,44 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (id)modelInitWithCoder:(NSCoder *)aDecoder;
 
+/** 归档为紧凑的二进制数据
+ Archive the receiver's properties to a compact binary data, which is smaller and
+ faster than `NSKeyedArchiver`.
+
+ @discussion The properties are written with the varint or length-prefixed values,
+ tagged by the hash of the property name, and the nested models are written in the
+ same way. The properties can be added, removed or reordered after the data is
+ written: the unknown fields are ignored when unarchive. If the reciver is `NSArray`,
+ `NSDictionary` or `NSSet`, the inner models are archived too. The objects which are
+ not model (such as UIColor) are archived with `NSKeyedArchiver` if they conform to
+ `NSSecureCoding`, otherwise they are archived as nil. When unarchive, such an object
+ is decoded with secure coding, and only the common Foundation classes and the
+ property's class (and generic class) are allowed.
+
+ It can be used with YYDiskCache:
+
+     cache.customArchiveBlock = ^NSData *(id object) { return [object modelToArchiveData]; };
+     cache.customUnarchiveBlock = ^id(NSData *data) { return [NSObject modelWithArchiveData:data]; };
+
+ @return The archived data, or nil if an error occurs.
+ */
+- (nullable NSData *)modelToArchiveData;
+
+/** 从二进制数据解档
+ Creates and returns an object from the data created by `-modelToArchiveData`.
+
+ @discussion The class of each model is checked before it's created: the root model
+ (or the models in root container) must be kind of the receiver class, and a nested
+ model must be kind of the property's class (or generic class). Other models are
+ unarchived as nil. Use `NSObject` as the receiver to unarchive a container of models.
+
+ @param data  The archived data.
+
+ @return The unarchived object, or nil if an error occurs or the object is not
+ kind of the receiver class.
+ */
++ (nullable instancetype)modelWithArchiveData:(NSData *)data;
+
 /**
  Get a hash code with the receiver's properties.
  
@@ -235,6 +285,10 @@ NS_ASSUME_NONNULL_BEGIN
               Example: [{"name":"Mary"},{name:"Joe"}]
  
  @return A array, or nil if an error occurs.
+ 
+ @discussion The `NSString` or `NSData` json is parsed in a single pass,
+ see `+[NSObject modelWithJSON:]`. If the class returns YES in `+modelTransformConcurrently`,
+ the elements of a large array are transformed concurrently.
  */
 + (nullable NSArray *)modelArrayWithClass:(Class)cls json:(id)json;
 
@@ -256,6 +310,9 @@ NS_ASSUME_NONNULL_BEGIN
               Example: {"user1":{"name","Mary"}, "user2": {name:"Joe"}}
  
  @return A dictionary, or nil if an error occurs.
+ 
+ @discussion If the class returns YES in `+modelTransformConcurrently`, the values
+ of a large dictionary are transformed concurrently.
  */
 + (nullable NSDictionary *)modelDictionaryWithClass:(Class)cls json:(id)json;
 @end
@@ -395,6 +452,81 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (nullable NSArray<NSString *> *)modelPropertyWhitelist;
 
+/** 值需要驻留(共享同一实例)的属性
+ The values of these properties are interned: the same short string or number
+ in different models shares one instance, to reduce the memory of repeated values
+ (such as user names, URLs and enum-like strings in a timeline).
+ Returns nil to ignore this feature.
+ 
+ @discussion It's only applied to `NSString` and `NSNumber` properties. The interned
+ values are kept in a table shared by all models, with a memory limit of 512KB
+ counted from the string length. The table is split into 16 stripes by hash, each
+ with its own lock and an equal share of the limit (a stripe is emptied when its
+ share is exceeded). Strings longer than 64 characters are not interned.
+ 
+ @return An array of property's name.
+ */
++ (nullable NSArray<NSString *> *)modelPropertyInternList;
+
+/** 延迟创建的嵌套model属性
+ The nested models of these properties are created on first access of the getter,
+ instead of when the model is transformed from json. It reduces the transform time
+ if only a part of the models (such as the visible cells) are read deeply.
+ Returns nil to ignore this feature.
+ 
+ @discussion It's only applied to the properties of custom model class, and the
+ `NSArray`, `NSSet` and `NSDictionary` properties with generic class (see
+ `modelContainerPropertyGenericClass`). The raw json object (or a copy of the value's
+ bytes in the json data) is kept until the getter is called, the getter creates the
+ models once and it's thread-safe. A setter call discards the raw json. If the
+ property already has a value, the json is merged to it immediately.
+ 
+ The model's getter and setter of these properties are replaced at runtime. The ivars
+ of these properties are nil before the getter is called, so they should not be read
+ directly (for example, in `modelCustomTransformFromDictionary:`). The json of a lazy
+ property's value is validated when the model is transformed; if the models still
+ can't be created from it on first access, the property is set to nil.
+ 
+ @return An array of property's name.
+ */
++ (nullable NSArray<NSString *> *)modelPropertyLazyList;
+
+/** 直接读写ivar(不调用setter/getter)的属性
+ The model transform process reads and writes the backing ivars of these properties
+ directly, instead of calling the setters and getters.
+ Returns nil to ignore this feature.
+
+ @discussion The runtime can't tell the compiler-synthesized accessors from the
+ hand-written ones, so only list the properties whose getter and setter are both
+ synthesized. It's only applied to the nonatomic strong/copy object properties and
+ nonatomic C number properties whose ivars are synthesized (`copy` is still honored),
+ other properties are accessed with the accessors as before. A listed property is
+ accessed with the accessors too if its accessors are inherited, replaced by a category,
+ or overridden by subclass (including KVO).
+
+ @return An array of property's name.
+ */
++ (nullable NSArray<NSString *> *)modelPropertyDirectIvarList;
+
+/** 并发转换model数组/字典中的元素
+ If the method returns YES, the elements of a large container are transformed to
+ models concurrently by `+[NSArray modelArrayWithClass:json:]` and
+ `+[NSDictionary modelDictionaryWithClass:json:]`.
+
+ @discussion The elements are split into chunks and transformed on the global queue,
+ the order of the result array is same as the json array. Containers with less than
+ 128 elements are still transformed on the calling thread.
+ 
+ The json string/data is parsed with `NSJSONSerialization` before the transform,
+ instead of being parsed in a single pass.
+
+ Only return YES if the model's transform methods (such as `modelCustomTransformFromDictionary:`
+ and the setters) are thread-safe, as they will be called on other threads.
+
+ @return Whether to transform the elements concurrently. Default is NO.
+ */
++ (BOOL)modelTransformConcurrently;
+
 /** 在转换之前回调 - 此时可以改变dic的内容
  This method's behavior is similar to `- (BOOL)modelCustomTransformFromDictionary:(NSDictionary *)dic;`, 
  but be called before the model transform.
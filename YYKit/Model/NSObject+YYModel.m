@@ -11,7 +11,10 @@
 
 #import "NSObject+YYModel.h"
 #import "YYClassInfo.h"
+#import "_YYClassCache.h"
 #import <objc/message.h>
+#import <malloc/malloc.h>
+#import <pthread.h>
 
 // __attribute__((always_inline))的意思是强制内联，所有加了__attribute__((always_inline))的函数再被调用时不会被编译成函数调用而是直接扩展到调用函数体内，比如我定义了函数
 /**
@@ -154,6 +157,181 @@ static force_inline NSNumber *YYNSNumberCreateFromID(__unsafe_unretained id valu
     return nil;
 }
 
+/// Days since 1970-01-01 of a date in proleptic Gregorian calendar.
+static force_inline int64_t YYDaysFromCivil(int64_t year, int64_t month, int64_t day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yoe = year - era * 400;
+    int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+/// Date in proleptic Gregorian calendar of the days since 1970-01-01.
+static force_inline void YYCivilFromDays(int64_t days, int *year, int *month, int *day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    *day = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *year = (int)(yoe + era * 400 + (*month <= 2));
+}
+
+/// Read `count` decimal digits, returns -1 if there's non-digit character.
+static force_inline int YYDateReadDigits(const char *str, int count) {
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        char c = str[i];
+        if (c < '0' || c > '9') return -1;
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+/// Read "+0800" or "+08:00" (if `colon`), returns NO if it's invalid.
+static force_inline BOOL YYDateReadZone(const char *str, BOOL colon, int *offset) {
+    if (str[0] != '+' && str[0] != '-') return NO;
+    int hour = YYDateReadDigits(str + 1, 2);
+    if (colon && str[3] != ':') return NO;
+    int minute = YYDateReadDigits(str + (colon ? 4 : 3), 2);
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59) return NO;
+    *offset = (hour * 3600 + minute * 60) * (str[0] == '-' ? -1 : 1);
+    return YES;
+}
+
+/// Read "HH:mm:ss", returns the seconds of the day, or -1 if it's invalid.
+static force_inline int YYDateReadTime(const char *str) {
+    if (str[2] != ':' || str[5] != ':') return -1;
+    int hour = YYDateReadDigits(str, 2), minute = YYDateReadDigits(str + 3, 2), second = YYDateReadDigits(str + 6, 2);
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 59) return -1;
+    return hour * 3600 + minute * 60 + second;
+}
+
+/// Read month name "Jan"~"Dec", returns 1~12, or -1 if it's invalid.
+static force_inline int YYDateReadMonthName(const char *str) {
+    static const char *names = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    for (int i = 0; i < 12; i++) {
+        if (memcmp(str, names + i * 3, 3) == 0) return i + 1;
+    }
+    return -1;
+}
+
+static force_inline BOOL YYDateIsWeekdayName(const char *str) {
+    static const char *names = "MonTueWedThuFriSatSun";
+    for (int i = 0; i < 7; i++) {
+        if (memcmp(str, names + i * 3, 3) == 0) return YES;
+    }
+    return NO;
+}
+
+/**
+ Parse the date formats of `YYNSDateFromString()` without NSDateFormatter.
+ 
+ @discussion Only the valid dates in 1583~9999 (where the formatter's calendar is
+ same as proleptic Gregorian calendar) are parsed, so the result is same as the
+ formatter; other strings should be passed to the formatter.
+ 
+ @param str  ASCII string.
+ @param len  String length.
+ @param time Output time interval since 1970.
+ @return Whether the string is parsed.
+ */
+static BOOL YYDateParse(const char *str, size_t len, NSTimeInterval *time) {
+    int year, month, day, seconds, millisecond = 0, offset = 0;
+    size_t p;
+    
+    if (len >= 10 && str[4] == '-' && str[7] == '-') {
+        /*
+         2014-01-20
+         2014-01-20 12:24:48[.000]
+         2014-01-20T12:24:48[.000]
+         2014-01-20T12:24:48[.000]Z
+         2014-01-20T12:24:48[.000]+0800
+         2014-01-20T12:24:48[.000]+12:00
+         */
+        year = YYDateReadDigits(str, 4);
+        month = YYDateReadDigits(str + 5, 2);
+        day = YYDateReadDigits(str + 8, 2);
+        seconds = 0;
+        if (len > 10) {
+            if (len < 19 || (str[10] != 'T' && str[10] != ' ')) return NO;
+            seconds = YYDateReadTime(str + 11);
+            if (seconds < 0) return NO;
+            p = 19;
+            if (p < len && str[p] == '.') {
+                if (len < p + 4) return NO;
+                millisecond = YYDateReadDigits(str + p + 1, 3);
+                if (millisecond < 0) return NO;
+                p += 4;
+            }
+            if (p < len) { // time zone, only with 'T'
+                if (str[10] != 'T') return NO;
+                if (str[p] == 'Z') {
+                    if (len != p + 1) return NO;
+                } else if (len == p + 5) {
+                    if (!YYDateReadZone(str + p, NO, &offset)) return NO;
+                } else if (len == p + 6) {
+                    if (!YYDateReadZone(str + p, YES, &offset)) return NO;
+                } else {
+                    return NO;
+                }
+            }
+        }
+    } else if ((len == 30 || len == 34) && str[3] == ' ' && str[7] == ' ' && str[10] == ' ') {
+        /*
+         Fri Sep 04 00:12:21 +0800 2015
+         Fri Sep 04 00:12:21.000 +0800 2015
+         */
+        if (!YYDateIsWeekdayName(str)) return NO;
+        month = YYDateReadMonthName(str + 4);
+        day = YYDateReadDigits(str + 8, 2);
+        seconds = YYDateReadTime(str + 11);
+        if (seconds < 0) return NO;
+        p = 19;
+        if (len == 34) {
+            if (str[p] != '.') return NO;
+            millisecond = YYDateReadDigits(str + p + 1, 3);
+            if (millisecond < 0) return NO;
+            p += 4;
+        }
+        if (str[p] != ' ' || str[p + 6] != ' ') return NO;
+        if (!YYDateReadZone(str + p + 1, NO, &offset)) return NO;
+        year = YYDateReadDigits(str + p + 7, 4);
+    } else {
+        return NO;
+    }
+    
+    if (year < 1583 || month < 1 || month > 12 || day < 1) return NO;
+    static const int daysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    BOOL leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (day > daysInMonth[month - 1] + (month == 2 && leap)) return NO;
+    
+    int64_t secs = YYDaysFromCivil(year, month, day) * 86400 + seconds - offset;
+    *time = (secs * 1000 + millisecond) / 1000.0;
+    return YES;
+}
+
+/// Parse string to date without NSDateFormatter, returns nil if the string is not parsed.
+static force_inline NSDate *YYNSDateFromStringFast(__unsafe_unretained NSString *string) {
+    CFStringRef str = (__bridge CFStringRef)string;
+    CFIndex length = CFStringGetLength(str);
+    if (length < 10 || length > 34) return nil;
+    char buffer[36];
+    const char *chars = CFStringGetCStringPtr(str, kCFStringEncodingASCII);
+    if (!chars) {
+        CFIndex used = 0;
+        CFIndex count = CFStringGetBytes(str, CFRangeMake(0, length), kCFStringEncodingASCII, 0, false, (UInt8 *)buffer, sizeof(buffer), &used);
+        if (count != length || used != length) return nil;
+        chars = buffer;
+    }
+    NSTimeInterval time;
+    if (!YYDateParse(chars, (size_t)length, &time)) return nil;
+    return [NSDate dateWithTimeIntervalSince1970:time];
+}
+
 /// Parse string to date.
 static force_inline NSDate *YYNSDateFromString(__unsafe_unretained NSString *string) {
     typedef NSDate* (^YYNSDateParseBlock)(NSString *string);
@@ -259,6 +437,8 @@ static force_inline NSDate *YYNSDateFromString(__unsafe_unretained NSString *str
     });
     if (!string) return nil;
     if (string.length > kParserNum) return nil;
+    NSDate *date = YYNSDateFromStringFast(string);
+    if (date) return date;
     YYNSDateParseBlock parser = blocks[string.length];
     if (!parser) return nil;
     return parser(string);
@@ -303,6 +483,42 @@ static force_inline NSDateFormatter *YYISODateFormatter() {
     return formatter;
 }
 
+/**
+ Same as `[YYISODateFormatter() stringFromDate:date]`, but the dates in 1970~9999
+ are written without the formatter.
+ */
+static NSString *YYISOStringFromDate(__unsafe_unretained NSDate *date) {
+    NSDateFormatter *formatter = YYISODateFormatter();
+    NSTimeInterval time = date.timeIntervalSince1970;
+    NSInteger offset = [formatter.timeZone secondsFromGMTForDate:date];
+    if (time < 0 || time >= 253402300800.0 || offset % 60 != 0) { // 10000-01-01
+        return [formatter stringFromDate:date];
+    }
+    int64_t secs = (int64_t)floor(time) + offset;
+    int64_t days = secs / 86400, rest = secs % 86400;
+    if (rest < 0) { // negative offset before 1970-01-01 00:00 local
+        rest += 86400;
+        days -= 1;
+    }
+    int year, month, day;
+    YYCivilFromDays(days, &year, &month, &day);
+    if (year > 9999) return [formatter stringFromDate:date];
+    int hour = (int)(rest / 3600), minute = (int)(rest / 60 % 60), second = (int)(rest % 60);
+    int zone = (int)(offset < 0 ? -offset : offset) / 60;
+    
+    // yyyy-MM-dd'T'HH:mm:ssZ
+    char buf[24];
+    buf[0] = '0' + year / 1000; buf[1] = '0' + year / 100 % 10; buf[2] = '0' + year / 10 % 10; buf[3] = '0' + year % 10;
+    buf[4] = '-'; buf[5] = '0' + month / 10; buf[6] = '0' + month % 10;
+    buf[7] = '-'; buf[8] = '0' + day / 10; buf[9] = '0' + day % 10;
+    buf[10] = 'T'; buf[11] = '0' + hour / 10; buf[12] = '0' + hour % 10;
+    buf[13] = ':'; buf[14] = '0' + minute / 10; buf[15] = '0' + minute % 10;
+    buf[16] = ':'; buf[17] = '0' + second / 10; buf[18] = '0' + second % 10;
+    buf[19] = offset < 0 ? '-' : '+';
+    buf[20] = '0' + zone / 600; buf[21] = '0' + zone / 60 % 10; buf[22] = '0' + zone % 60 / 10; buf[23] = '0' + zone % 10;
+    return CFBridgingRelease(CFStringCreateWithBytes(kCFAllocatorDefault, (const UInt8 *)buf, sizeof(buf), kCFStringEncodingASCII, false));
+}
+
 /// Get the value with key paths from dictionary
 /// The dic should be NSDictionary, and the keyPath should not be nil.
 // 通过keypath从字典中取值
@@ -342,6 +558,8 @@ static force_inline id YYValueForMultiKeys(__unsafe_unretained NSDictionary *dic
 
 
 
+@class _YYModelLazyState;
+
 /// A property info in object model.
 //  model property的进一步分装
 @interface _YYModelPropertyMeta : NSObject {
@@ -384,9 +602,21 @@ static force_inline id YYValueForMultiKeys(__unsafe_unretained NSDictionary *dic
     YYClassPropertyInfo *_info;  ///< property's info
     //同个key的多个property的映射next指针
     _YYModelPropertyMeta *_next; ///< next meta if there are multiple properties mapped to the same key.
+    
+    // 直接读写ivar (see `+modelPropertyDirectIvarList`)
+    ptrdiff_t _ivarOffset;       ///< offset of the backing ivar if it's accessed directly, or 0
+    size_t _ivarSize;            ///< size of the backing ivar if it's accessed directly
+    BOOL _isCopy;                ///< the property has copy attribute
+    BOOL _intern;                ///< intern the string or number value (see `+modelPropertyInternList`)
+    BOOL _lazy;                  ///< keep the raw JSON until first access (see `+modelPropertyLazyList`)
+    _YYModelLazyState *_lazyState; ///< pending state of the lazy property, shared by the metas of the class
+    
+    uint32_t _archiveHash;       ///< hash of the name, field tag in model archive, or 0 if it collides
 }
 @end
 
+static _YYModelLazyState *ModelSetupLazyAccessors(Class cls, _YYModelPropertyMeta *meta);
+
 @implementation _YYModelPropertyMeta
 
 // 通过YYClassInfo，YYClassPropertyInfo，Class对象解析成_YYModelPropertyMeta
@@ -520,9 +750,128 @@ static force_inline id YYValueForMultiKeys(__unsafe_unretained NSDictionary *dic
     
     return meta;
 }
+
+/**
+ Whether the method is implemented in the class itself (not inherited), and only once.
+ A category which replaces a method adds another entry to the class's method list.
+ */
+static BOOL ModelClassImplementsMethodOnce(Class cls, SEL sel) {
+    unsigned int count = 0;
+    Method *methods = class_copyMethodList(cls, &count);
+    if (!methods) return NO;
+    unsigned int found = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        if (method_getName(methods[i]) == sel) found++;
+    }
+    free(methods);
+    return found == 1;
+}
+
+/**
+ Access the backing ivar directly instead of the accessors, if the property is
+ a nonatomic strong/copy object or a C number with synthesized ivar.
+ 
+ @param cls            The model class.
+ @param declaringClass The class which declares the property.
+ */
+- (void)_setupIvarAccessWithClass:(Class)cls declaringClass:(Class)declaringClass {
+    YYEncodingType type = _type;
+    if (!(type & YYEncodingTypePropertyNonatomic)) return;
+    if (type & (YYEncodingTypePropertyWeak | YYEncodingTypePropertyDynamic)) return;
+    if ((type & YYEncodingTypeMask) == YYEncodingTypeObject) {
+        if (!(type & (YYEncodingTypePropertyCopy | YYEncodingTypePropertyRetain))) return;
+    } else if (!_isCNumber) {
+        return;
+    }
+    if (!_info.ivarName || !_getter || !_setter) return;
+    
+    Ivar ivar = class_getInstanceVariable(declaringClass, _info.ivarName.UTF8String);
+    if (!ivar) return;
+    const char *ivarType = ivar_getTypeEncoding(ivar);
+    const char *propertyType = _info.typeEncoding.UTF8String;
+    if (!ivarType || !propertyType || strcmp(ivarType, propertyType) != 0) return;
+    
+    // the accessors may be inherited (the property is redeclared), or replaced by category
+    if (!ModelClassImplementsMethodOnce(declaringClass, _getter)) return;
+    if (!ModelClassImplementsMethodOnce(declaringClass, _setter)) return;
+    // the accessors may be overridden by subclass or KVO
+    if (cls != declaringClass) {
+        if (class_getMethodImplementation(cls, _setter) != class_getMethodImplementation(declaringClass, _setter)) return;
+        if (class_getMethodImplementation(cls, _getter) != class_getMethodImplementation(declaringClass, _getter)) return;
+    }
+    
+    NSUInteger size = 0;
+    NSGetSizeAndAlignment(ivarType, &size, NULL);
+    ptrdiff_t offset = ivar_getOffset(ivar);
+    if (offset <= 0 || size == 0) return;
+    _ivarOffset = offset;
+    _ivarSize = size;
+    _isCopy = (type & YYEncodingTypePropertyCopy) != 0;
+}
+
+/**
+ Keep the raw JSON of the property until first access, if the property is a model,
+ or a container of models.
+ 
+ @param cls The model class, the accessors of the property are replaced in this class.
+ */
+- (void)_setupLazyWithClass:(Class)cls {
+    if ((_type & YYEncodingTypeMask) != YYEncodingTypeObject) return;
+    if (_type & (YYEncodingTypePropertyWeak | YYEncodingTypePropertyDynamic)) return;
+    if (!_getter || !_setter) return;
+    switch (_nsType) {
+        case YYEncodingTypeNSUnknown: {
+            Class modelCls = _genericCls ?: _cls;
+            // a dictionary is set as is if the property is id or NSObject
+            if (!modelCls || [NSMutableDictionary isSubclassOfClass:modelCls]) return;
+        } break;
+        case YYEncodingTypeNSArray: case YYEncodingTypeNSMutableArray:
+        case YYEncodingTypeNSDictionary: case YYEncodingTypeNSMutableDictionary:
+        case YYEncodingTypeNSSet: case YYEncodingTypeNSMutableSet: {
+            if (!_genericCls) return;
+        } break;
+        default: return;
+    }
+    _lazy = YES;
+    _ivarOffset = 0; // the getter should be called
+    _lazyState = ModelSetupLazyAccessors(cls, self);
+}
 @end
 
 
+/// A mapped key in object model, used to match the keys when streaming JSON.
+typedef struct {
+    char *key;              ///< UTF-8 key, NULL if the slot is empty
+    size_t length;          ///< key length in bytes
+    uint32_t hash;          ///< key hash
+    BOOL isPathRoot;        ///< the first key of a key path or multi keys
+    void *propertyMeta;     ///< _YYModelPropertyMeta mapped to the key, or NULL
+} _YYModelKeyEntry;
+
+/// FNV-1a hash of the key bytes.
+static force_inline uint32_t YYModelKeyHash(const uint8_t *bytes, size_t length) {
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619U;
+    }
+    return hash;
+}
+
+static NSData *YYJSONKeyData(NSString *key);
+
+/// A key in the JSON object of model, used to write JSON data directly.
+@interface _YYModelJSONKey : NSObject {
+    @package
+    NSString *_name;                     ///< key name
+    NSData *_json;                       ///< UTF-8 escaped key with quotes and colon: "key":
+    _YYModelPropertyMeta *_propertyMeta; ///< the property written to this key, or nil if it's a key path node
+    NSMutableArray *_children;           ///< Array<_YYModelJSONKey>, the keys in key path node
+}
+@end
+
+@implementation _YYModelJSONKey
+@end
+
 /// A class info in object model.
 // model class的进一层封装
 @interface _YYModelMeta : NSObject {
@@ -541,6 +890,9 @@ static force_inline id YYValueForMultiKeys(__unsafe_unretained NSDictionary *dic
     /// Array<_YYModelPropertyMeta>, property meta which is mapped to multi keys.
     //  所有的多层映射property缓存
     NSArray *_multiKeysPropertyMetas;
+    /// Array<_YYModelPropertyMeta>, property meta which can be written to model archive.
+    //  可以写入model archive的property
+    NSArray *_archivePropertyMetas;
     
     /// The number of mapped key (and key path), same to _mapper.count.
     //key mapper数量
@@ -554,9 +906,23 @@ static force_inline id YYValueForMultiKeys(__unsafe_unretained NSDictionary *dic
     BOOL _hasCustomTransformFromDictionary; // dic2model完成后 是否要自定义转换
     BOOL _hasCustomTransformToDictionary; //与上个相反，当转成dictionary的时候，转换的方式
     BOOL _hasCustomClassFromDictionary; //是否有本地的类型的转换
+    BOOL _transformConcurrently; // 容器中的元素是否并发转换
+    
+    /// Open addressing hash table of the mapped keys (and the first keys of key paths),
+    /// used to match the JSON keys without creating strings.
+    _YYModelKeyEntry *_keyTable;
+    NSUInteger _keyTableMask;
+    
+    /// Array<_YYModelJSONKey>, the keys (and key path nodes) written by model to JSON,
+    /// or nil if the keys conflict (such as "a" and "a.b") and can not be written directly.
+    NSArray *_jsonKeys;
 }
 @end
 
+static BOOL ModelSetLazyValueForProperty(__unsafe_unretained id model,
+                                         __unsafe_unretained id value,
+                                         __unsafe_unretained _YYModelPropertyMeta *meta);
+
 @implementation _YYModelMeta
 - (instancetype)initWithClass:(Class)cls {
     
@@ -587,6 +953,33 @@ static force_inline id YYValueForMultiKeys(__unsafe_unretained NSDictionary *dic
         }
     }
     
+    // 值需要驻留(共享)的property
+    NSSet *internList = nil;
+    if ([cls respondsToSelector:@selector(modelPropertyInternList)]) {
+        NSArray *properties = [(id<YYModel>)cls modelPropertyInternList];
+        if (properties) {
+            internList = [NSSet setWithArray:properties];
+        }
+    }
+    
+    // 直接读写ivar的property
+    NSSet *directIvarList = nil;
+    if ([cls respondsToSelector:@selector(modelPropertyDirectIvarList)]) {
+        NSArray *properties = [(id<YYModel>)cls modelPropertyDirectIvarList];
+        if (properties) {
+            directIvarList = [NSSet setWithArray:properties];
+        }
+    }
+    
+    // 延迟创建的嵌套model属性
+    NSSet *lazyList = nil;
+    if ([cls respondsToSelector:@selector(modelPropertyLazyList)]) {
+        NSArray *properties = [(id<YYModel>)cls modelPropertyLazyList];
+        if (properties) {
+            lazyList = [NSSet setWithArray:properties];
+        }
+    }
+    
     // Get container property's generic class
     // 容器属性中的类型
     /**
@@ -651,6 +1044,13 @@ static force_inline id YYValueForMultiKeys(__unsafe_unretained NSDictionary *dic
             if (!meta || !meta->_name) continue;  //没有名字跳过
             if (!meta->_getter || !meta->_setter) continue; //没有getter或者setter方法跳过
             if (allPropertyMetas[meta->_name]) continue;  //已经解析过的跳过
+            if (directIvarList && [directIvarList containsObject:meta->_name]) {
+                [meta _setupIvarAccessWithClass:cls declaringClass:curClassInfo.cls];
+            }
+            if (internList && [internList containsObject:meta->_name]) {
+                meta->_intern = (meta->_nsType == YYEncodingTypeNSString || meta->_nsType == YYEncodingTypeNSNumber);
+            }
+            if (lazyList && [lazyList containsObject:meta->_name]) [meta _setupLazyWithClass:cls];
             allPropertyMetas[meta->_name] = meta;  //将解析通过dictionary缓存
         }
         curClassInfo = curClassInfo.superClassInfo; //递归super class
@@ -659,6 +1059,33 @@ static force_inline id YYValueForMultiKeys(__unsafe_unretained NSDictionary *dic
     //复制一份解析出来的所有allPropertyMetas -注意用的copy allPropertyMetas改变不会影响_allPropertyMetas
     if (allPropertyMetas.count) _allPropertyMetas = allPropertyMetas.allValues.copy;
     
+    // properties in model archive, tagged with name hash
+    NSMutableArray *archivePropertyMetas = [NSMutableArray new];
+    for (_YYModelPropertyMeta *propertyMeta in _allPropertyMetas) {
+        BOOL archivable = propertyMeta->_isCNumber;
+        switch (propertyMeta->_type & YYEncodingTypeMask) {
+            case YYEncodingTypeObject:
+            case YYEncodingTypeClass:
+            case YYEncodingTypeSEL: archivable = YES; break;
+            case YYEncodingTypeStruct:
+            case YYEncodingTypeUnion: archivable = propertyMeta->_isKVCCompatible && propertyMeta->_isStructAvailableForKeyedArchiver; break;
+            default: break;
+        }
+        if (!archivable) continue;
+        const char *name = propertyMeta->_name.UTF8String;
+        propertyMeta->_archiveHash = YYModelKeyHash((const uint8_t *)name, strlen(name));
+        [archivePropertyMetas addObject:propertyMeta];
+    }
+    // the colliding properties are tagged with name instead of hash (0)
+    NSCountedSet *archiveHashes = [NSCountedSet new];
+    for (_YYModelPropertyMeta *propertyMeta in archivePropertyMetas) {
+        [archiveHashes addObject:@(propertyMeta->_archiveHash)];
+    }
+    for (_YYModelPropertyMeta *propertyMeta in archivePropertyMetas) {
+        if ([archiveHashes countForObject:@(propertyMeta->_archiveHash)] > 1) propertyMeta->_archiveHash = 0;
+    }
+    if (archivePropertyMetas.count) _archivePropertyMetas = archivePropertyMetas.copy;
+    
     // create mapper
     // _mapper是包括了所有class和superclass的property的key value缓存，其中的key是所有已经映射过key-name和不需要映射的property-name组成。
     NSMutableDictionary *mapper = [NSMutableDictionary new];
@@ -788,35 +1215,120 @@ static force_inline id YYValueForMultiKeys(__unsafe_unretained NSDictionary *dic
     _hasCustomTransformFromDictionary = ([cls instancesRespondToSelector:@selector(modelCustomTransformFromDictionary:)]);
     _hasCustomTransformToDictionary = ([cls instancesRespondToSelector:@selector(modelCustomTransformToDictionary:)]);
     _hasCustomClassFromDictionary = ([cls respondsToSelector:@selector(modelCustomClassForDictionary:)]);
+    if ([cls respondsToSelector:@selector(modelTransformConcurrently)]) {
+        _transformConcurrently = [(id<YYModel>)cls modelTransformConcurrently];
+    }
+    [self _buildKeyTable];
+    [self _buildJSONKeys];
     
     return self;
 }
 
+- (void)dealloc {
+    if (_keyTable) {
+        for (NSUInteger i = 0; i <= _keyTableMask; i++) {
+            if (_keyTable[i].key) free(_keyTable[i].key);
+        }
+        free(_keyTable);
+    }
+}
+
+/// Build the key table from mapper, key paths and multi keys.
+- (void)_buildKeyTable {
+    NSMutableSet *roots = [NSMutableSet new];
+    for (_YYModelPropertyMeta *propertyMeta in _keyPathPropertyMetas) {
+        NSString *root = propertyMeta->_mappedToKeyPath.firstObject;
+        if (root) [roots addObject:root];
+    }
+    for (_YYModelPropertyMeta *propertyMeta in _multiKeysPropertyMetas) {
+        for (id oneKey in propertyMeta->_mappedToKeyArray) {
+            NSString *root = [oneKey isKindOfClass:[NSArray class]] ? ((NSArray *)oneKey).firstObject : oneKey;
+            if ([root isKindOfClass:[NSString class]]) [roots addObject:root];
+        }
+    }
+    NSMutableSet *keys = roots.mutableCopy;
+    for (id key in _mapper) {
+        if ([key isKindOfClass:[NSString class]]) [keys addObject:key];
+    }
+    if (keys.count == 0) return;
+    
+    NSUInteger capacity = 8;
+    while (capacity < keys.count * 2) capacity <<= 1;
+    _keyTable = calloc(capacity, sizeof(_YYModelKeyEntry));
+    if (!_keyTable) return;
+    _keyTableMask = capacity - 1;
+    for (NSString *key in keys) {
+        const char *str = key.UTF8String;
+        if (!str) continue;
+        size_t length = strlen(str);
+        uint32_t hash = YYModelKeyHash((const uint8_t *)str, length);
+        NSUInteger i = hash & _keyTableMask;
+        while (_keyTable[i].key) i = (i + 1) & _keyTableMask;
+        _YYModelKeyEntry *entry = _keyTable + i;
+        entry->key = malloc(length + 1);
+        if (!entry->key) continue;
+        memcpy(entry->key, str, length + 1);
+        entry->length = length;
+        entry->hash = hash;
+        entry->isPathRoot = [roots containsObject:key];
+        entry->propertyMeta = (__bridge void *)(_mapper[key]);
+    }
+}
+
+/// Build the JSON keys tree from mapper, same as the dictionary created by model.
+- (void)_buildJSONKeys {
+    NSMutableArray *jsonKeys = [NSMutableArray new];
+    for (_YYModelPropertyMeta *propertyMeta in _mapper.allValues) {
+        NSArray *keyPath = propertyMeta->_mappedToKeyPath;
+        if (!keyPath) keyPath = propertyMeta->_mappedToKey ? @[propertyMeta->_mappedToKey] : nil;
+        if (keyPath.count == 0) continue;
+        
+        NSMutableArray *keys = jsonKeys;
+        for (NSUInteger i = 0, max = keyPath.count; i < max; i++) {
+            NSString *name = keyPath[i];
+            BOOL isLeaf = (i + 1 == max);
+            _YYModelJSONKey *key = nil;
+            for (_YYModelJSONKey *one in keys) {
+                if ([one->_name isEqualToString:name]) {
+                    key = one;
+                    break;
+                }
+            }
+            if (key) {
+                // "a" and "a.b", or two properties mapped to same key
+                if (isLeaf || key->_propertyMeta) return;
+            } else {
+                key = [_YYModelJSONKey new];
+                key->_name = name;
+                key->_json = YYJSONKeyData(name);
+                if (!key->_json) return;
+                if (isLeaf) key->_propertyMeta = propertyMeta;
+                else key->_children = [NSMutableArray new];
+                [keys addObject:key];
+            }
+            keys = key->_children;
+        }
+    }
+    _jsonKeys = jsonKeys.copy;
+}
+
 /// Returns the cached model class meta
 /// 返回缓存model元数据信息
 + (instancetype)metaWithClass:(Class)cls {
     if (!cls) return nil;
-    static CFMutableDictionaryRef cache;  //class的_YYModelMeta缓存
+    static _YYClassCache *cache;  //class的_YYModelMeta缓存, 读取时不加锁
     static dispatch_once_t onceToken;
-    static dispatch_semaphore_t lock; // 使用GCD的信号量保证读写Dic时线程安全 锁
     dispatch_once(&onceToken, ^{
-        // 缓存字典
-        cache = CFDictionaryCreateMutable(CFAllocatorGetDefault(), 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
-        // 创建一个信号量 计数为1
-        lock = dispatch_semaphore_create(1);
+        cache = [_YYClassCache new];
     });
-    dispatch_semaphore_wait(lock, DISPATCH_TIME_FOREVER); // 等待信号
-    // 从cache字典中获取_YYModelMeta
-    _YYModelMeta *meta = CFDictionaryGetValue(cache, (__bridge const void *)(cls));
-    dispatch_semaphore_signal(lock); // 发送信号
-    if (!meta || meta->_classInfo.needUpdate) {
+    // 从cache中获取_YYModelMeta
+    _YYModelMeta *meta = [cache objectForClass:cls];
+    if (!meta) {
+        meta = [[_YYModelMeta alloc] initWithClass:cls]; //构造 _YYModelMeta缓存
+        if (meta) meta = [cache addObject:meta forClass:cls]; // 如果其他线程已经设置, 使用已缓存的
+    } else if (meta->_classInfo.needUpdate) {
         meta = [[_YYModelMeta alloc] initWithClass:cls]; //重新构造 _YYModelMeta缓存
-
-        if (meta) {  //设置缓存
-            dispatch_semaphore_wait(lock, DISPATCH_TIME_FOREVER);
-            CFDictionarySetValue(cache, (__bridge const void *)(cls), (__bridge const void *)(meta));
-            dispatch_semaphore_signal(lock);
-        }
+        if (meta) [cache setObject:meta forClass:cls];
     }
     return meta;
 }
@@ -824,6 +1336,36 @@ static force_inline id YYValueForMultiKeys(__unsafe_unretained NSDictionary *dic
 @end
 
 
+/// Returns the address of the property's backing ivar, meta->_ivarOffset should not be 0.
+static force_inline void *ModelPropertyIvar(__unsafe_unretained id model, __unsafe_unretained _YYModelPropertyMeta *meta) {
+    return (uint8_t *)(__bridge void *)model + meta->_ivarOffset;
+}
+
+/**
+ Get object from property, with the getter or the backing ivar.
+ @param meta Should not be nil, meta.type should be object, meta.getter should not be nil.
+ */
+static force_inline id ModelGetObjectFromProperty(__unsafe_unretained id model,
+                                                  __unsafe_unretained _YYModelPropertyMeta *meta) {
+    if (meta->_ivarOffset) return *(__strong id *)ModelPropertyIvar(model, meta);
+    return ((id (*)(id, SEL))(void *) objc_msgSend)((id)model, meta->_getter);
+}
+
+/**
+ Set object to property, with the setter or the backing ivar (retain or copy as the setter).
+ @param meta Should not be nil, meta.type should be object, meta.setter should not be nil.
+ */
+static force_inline void ModelSetObjectToProperty(__unsafe_unretained id model,
+                                                  __unsafe_unretained _YYModelPropertyMeta *meta,
+                                                  __unsafe_unretained id value) {
+    if (meta->_ivarOffset) {
+        __strong id *ivar = (__strong id *)ModelPropertyIvar(model, meta);
+        *ivar = meta->_isCopy ? [value copy] : value;
+    } else {
+        ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, value);
+    }
+}
+
 /**
  Get number from property.
  @discussion Caller should hold strong reference to the parameters before this function returns.
@@ -834,6 +1376,36 @@ static force_inline id YYValueForMultiKeys(__unsafe_unretained NSDictionary *dic
 // 从属性中获取NSNumber
 static force_inline NSNumber *ModelCreateNumberFromProperty(__unsafe_unretained id model,
                                                             __unsafe_unretained _YYModelPropertyMeta *meta) {
+    if (meta->_ivarOffset) {
+        void *ivar = ModelPropertyIvar(model, meta);
+        switch (meta->_type & YYEncodingTypeMask) {
+            case YYEncodingTypeBool: return @(*(bool *)ivar);
+            case YYEncodingTypeInt8: return @(*(int8_t *)ivar);
+            case YYEncodingTypeUInt8: return @(*(uint8_t *)ivar);
+            case YYEncodingTypeInt16: return @(*(int16_t *)ivar);
+            case YYEncodingTypeUInt16: return @(*(uint16_t *)ivar);
+            case YYEncodingTypeInt32: return @(*(int32_t *)ivar);
+            case YYEncodingTypeUInt32: return @(*(uint32_t *)ivar);
+            case YYEncodingTypeInt64: return @(*(int64_t *)ivar);
+            case YYEncodingTypeUInt64: return @(*(uint64_t *)ivar);
+            case YYEncodingTypeFloat: {
+                float num = *(float *)ivar;
+                if (isnan(num) || isinf(num)) return nil;
+                return @(num);
+            }
+            case YYEncodingTypeDouble: {
+                double num = *(double *)ivar;
+                if (isnan(num) || isinf(num)) return nil;
+                return @(num);
+            }
+            case YYEncodingTypeLongDouble: {
+                double num = *(long double *)ivar;
+                if (isnan(num) || isinf(num)) return nil;
+                return @(num);
+            }
+            default: return nil;
+        }
+    }
     switch (meta->_type & YYEncodingTypeMask) {
         case YYEncodingTypeBool: {
             return @(((bool (*)(id, SEL))(void *) objc_msgSend)((id)model, meta->_getter));
@@ -895,6 +1467,45 @@ static force_inline NSNumber *ModelCreateNumberFromProperty(__unsafe_unretained
 static force_inline void ModelSetNumberToProperty(__unsafe_unretained id model,
                                                   __unsafe_unretained NSNumber *num,
                                                   __unsafe_unretained _YYModelPropertyMeta *meta) {
+    if (meta->_ivarOffset) {
+        void *ivar = ModelPropertyIvar(model, meta);
+        switch (meta->_type & YYEncodingTypeMask) {
+            case YYEncodingTypeBool: *(bool *)ivar = num.boolValue; break;
+            case YYEncodingTypeInt8: *(int8_t *)ivar = (int8_t)num.charValue; break;
+            case YYEncodingTypeUInt8: *(uint8_t *)ivar = (uint8_t)num.unsignedCharValue; break;
+            case YYEncodingTypeInt16: *(int16_t *)ivar = (int16_t)num.shortValue; break;
+            case YYEncodingTypeUInt16: *(uint16_t *)ivar = (uint16_t)num.unsignedShortValue; break;
+            case YYEncodingTypeInt32: *(int32_t *)ivar = (int32_t)num.intValue; break;
+            case YYEncodingTypeUInt32: *(uint32_t *)ivar = (uint32_t)num.unsignedIntValue; break;
+            case YYEncodingTypeInt64:
+            case YYEncodingTypeUInt64: {
+                if ([num isKindOfClass:[NSDecimalNumber class]]) {
+                    *(int64_t *)ivar = (int64_t)num.stringValue.longLongValue;
+                } else if ((meta->_type & YYEncodingTypeMask) == YYEncodingTypeInt64) {
+                    *(int64_t *)ivar = (int64_t)num.longLongValue;
+                } else {
+                    *(uint64_t *)ivar = (uint64_t)num.unsignedLongLongValue;
+                }
+            } break;
+            case YYEncodingTypeFloat: {
+                float f = num.floatValue;
+                if (isnan(f) || isinf(f)) f = 0;
+                *(float *)ivar = f;
+            } break;
+            case YYEncodingTypeDouble: {
+                double d = num.doubleValue;
+                if (isnan(d) || isinf(d)) d = 0;
+                *(double *)ivar = d;
+            } break;
+            case YYEncodingTypeLongDouble: {
+                long double d = num.doubleValue;
+                if (isnan(d) || isinf(d)) d = 0;
+                *(long double *)ivar = d;
+            } break;
+            default: break;
+        }
+        return;
+    }
     switch (meta->_type & YYEncodingTypeMask) {
         case YYEncodingTypeBool: {
             ((void (*)(id, SEL, bool))(void *) objc_msgSend)((id)model, meta->_setter, num.boolValue);
@@ -950,6 +1561,79 @@ static force_inline void ModelSetNumberToProperty(__unsafe_unretained id model,
     }
 }
 
+/// Max length of the interned strings.
+#define YY_MODEL_INTERN_MAX_LENGTH 64
+/// Max memory cost in bytes of the interned values, each stripe is emptied when its share is exceeded.
+#define YY_MODEL_INTERN_COST_LIMIT (512 * 1024)
+/// Stripe count of the intern table (power of 2), each stripe has its own lock.
+#define YY_MODEL_INTERN_STRIPE_BITS 4
+#define YY_MODEL_INTERN_STRIPE_COUNT (1 << YY_MODEL_INTERN_STRIPE_BITS)
+
+typedef struct {
+    pthread_mutex_t lock;
+    CFMutableSetRef table;      ///< interned values with hash in this stripe
+    size_t cost;                ///< memory cost of the values in table
+} YYModelInternStripe;
+
+/**
+ Returns the shared instance which is equal to the string or number (see `+modelPropertyInternList`).
+ 
+ @discussion The values are kept in a table shared by all models, so the same short
+ string (such as user name or source label) in different models is one instance.
+ Long strings, booleans and tagged pointers are not interned and returned as is.
+ 
+ The table is split into stripes by the value's hash, so the models transformed
+ concurrently rarely wait for the same lock, and a full stripe is emptied alone.
+ 
+ @param value A NSString or NSNumber.
+ @return The shared instance, or the value itself.
+ */
+static id ModelInternValue(__unsafe_unretained id value) {
+    static YYModelInternStripe stripes[YY_MODEL_INTERN_STRIPE_COUNT];
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        for (int i = 0; i < YY_MODEL_INTERN_STRIPE_COUNT; i++) {
+            pthread_mutex_init(&stripes[i].lock, NULL);
+            stripes[i].table = CFSetCreateMutable(CFAllocatorGetDefault(), 0, &kCFTypeSetCallBacks);
+        }
+    });
+    
+    BOOL isString = [value isKindOfClass:[NSString class]];
+    NSUInteger length = 0;
+    if (isString) {
+        length = ((NSString *)value).length;
+        if (length > YY_MODEL_INTERN_MAX_LENGTH) return value;
+    } else {
+        // CFBoolean is singleton, and NSNumber(YES) is equal to NSNumber(1)
+        if (![value isKindOfClass:[NSNumber class]] || value == (id)kCFBooleanTrue || value == (id)kCFBooleanFalse) return value;
+    }
+    size_t size = malloc_size((__bridge const void *)value);
+    if (size == 0) return value; // tagged pointer
+    // the characters may be stored out of the object
+    size_t cost = isString ? MAX(size, sizeof(void *) * 2 + length * sizeof(unichar)) : size;
+    
+    uint64_t hash = (uint64_t)CFHash((__bridge CFTypeRef)value) * 0x9E3779B97F4A7C15ULL;
+    YYModelInternStripe *stripe = &stripes[hash >> (64 - YY_MODEL_INTERN_STRIPE_BITS)];
+    
+    id result = value;
+    pthread_mutex_lock(&stripe->lock);
+    id one = (__bridge id)CFSetGetValue(stripe->table, (__bridge const void *)value);
+    if (one) {
+        // NSNumber(1) is equal to NSNumber(1.0), keep the type
+        if (isString || strcmp([(NSNumber *)one objCType], [(NSNumber *)value objCType]) == 0) result = one;
+    } else {
+        if (stripe->cost + cost > YY_MODEL_INTERN_COST_LIMIT / YY_MODEL_INTERN_STRIPE_COUNT) {
+            CFSetRemoveAllValues(stripe->table);
+            stripe->cost = 0;
+        }
+        result = [value copy]; // may be mutable
+        CFSetAddValue(stripe->table, (__bridge const void *)result);
+        stripe->cost += cost;
+    }
+    pthread_mutex_unlock(&stripe->lock);
+    return result;
+}
+
 /**
  Set value to model with a property meta.
  
@@ -977,7 +1661,7 @@ static void ModelSetValueForProperty(__unsafe_unretained id model,
         
     } else if (meta->_nsType) { // 属性是Foundation类型
         if (value == (id)kCFNull) { // kCFNull是 NSNull的单例
-            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, (id)nil);
+            ModelSetObjectToProperty(model, meta, (id)nil);
         } else {
             switch (meta->_nsType) {  // 区分不同的Foundation Class类型设值
                 case YYEncodingTypeNSString: // 如果属性变量是NSString
@@ -986,31 +1670,24 @@ static void ModelSetValueForProperty(__unsafe_unretained id model,
                     if ([value isKindOfClass:[NSString class]]) {
                         if (meta->_nsType == YYEncodingTypeNSString) { // 属性类型是NSString
                             // 向model的setter发送value消息
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, value);
+                            ModelSetObjectToProperty(model, meta, meta->_intern ? ModelInternValue(value) : value);
                         } else {
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, ((NSString *)value).mutableCopy);
+                            ModelSetObjectToProperty(model, meta, ((NSString *)value).mutableCopy);
                         }
                     } else if ([value isKindOfClass:[NSNumber class]]) { // value类型为NSNumber
-                        ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model,
-                                                                       meta->_setter,
-                                                                       (meta->_nsType == YYEncodingTypeNSString) ?
-                                                                       ((NSNumber *)value).stringValue :
-                                                                       ((NSNumber *)value).stringValue.mutableCopy);
+                        if (meta->_nsType == YYEncodingTypeNSString) {
+                            NSString *string = ((NSNumber *)value).stringValue;
+                            ModelSetObjectToProperty(model, meta, meta->_intern ? ModelInternValue(string) : string);
+                        } else {
+                            ModelSetObjectToProperty(model, meta, ((NSNumber *)value).stringValue.mutableCopy);
+                        }
                     } else if ([value isKindOfClass:[NSData class]]) { // value类型为NSData
                         NSMutableString *string = [[NSMutableString alloc] initWithData:value encoding:NSUTF8StringEncoding];
-                        ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, string);
+                        ModelSetObjectToProperty(model, meta, string);
                     } else if ([value isKindOfClass:[NSURL class]]) {  // value类型为NSURL
-                        ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model,
-                                                                       meta->_setter,
-                                                                       (meta->_nsType == YYEncodingTypeNSString) ?
-                                                                       ((NSURL *)value).absoluteString :
-                                                                       ((NSURL *)value).absoluteString.mutableCopy);
+                        ModelSetObjectToProperty(model, meta, (meta->_nsType == YYEncodingTypeNSString) ? ((NSURL *)value).absoluteString : ((NSURL *)value).absoluteString.mutableCopy);
                     } else if ([value isKindOfClass:[NSAttributedString class]]) { // value类型为NSAttributedString
-                        ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model,
-                                                                       meta->_setter,
-                                                                       (meta->_nsType == YYEncodingTypeNSString) ?
-                                                                       ((NSAttributedString *)value).string :
-                                                                       ((NSAttributedString *)value).string.mutableCopy);
+                        ModelSetObjectToProperty(model, meta, (meta->_nsType == YYEncodingTypeNSString) ? ((NSAttributedString *)value).string : ((NSAttributedString *)value).string.mutableCopy);
                     }
                 } break;
                     
@@ -1018,24 +1695,25 @@ static void ModelSetValueForProperty(__unsafe_unretained id model,
                 case YYEncodingTypeNSNumber:
                 case YYEncodingTypeNSDecimalNumber: {
                     if (meta->_nsType == YYEncodingTypeNSNumber) {  // 属性变量类型是Foundation框架NSNumber
-                        ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, YYNSNumberCreateFromID(value));
+                        NSNumber *num = YYNSNumberCreateFromID(value);
+                        ModelSetObjectToProperty(model, meta, (meta->_intern && num) ? ModelInternValue(num) : num);
                     } else if (meta->_nsType == YYEncodingTypeNSDecimalNumber) { // 属性变量类型是Foundation框架NSDecimalNumber
                         if ([value isKindOfClass:[NSDecimalNumber class]]) {
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, value);
+                            ModelSetObjectToProperty(model, meta, value);
                         } else if ([value isKindOfClass:[NSNumber class]]) {
                             NSDecimalNumber *decNum = [NSDecimalNumber decimalNumberWithDecimal:[((NSNumber *)value) decimalValue]];
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, decNum);
+                            ModelSetObjectToProperty(model, meta, decNum);
                         } else if ([value isKindOfClass:[NSString class]]) {
                             NSDecimalNumber *decNum = [NSDecimalNumber decimalNumberWithString:value];
                             NSDecimal dec = decNum.decimalValue;
                             if (dec._length == 0 && dec._isNegative) {
                                 decNum = nil; // NaN
                             }
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, decNum);
+                            ModelSetObjectToProperty(model, meta, decNum);
                         }
                     } else { // YYEncodingTypeNSValue
                         if ([value isKindOfClass:[NSValue class]]) {
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, value);
+                            ModelSetObjectToProperty(model, meta, value);
                         }
                     }
                 } break;
@@ -1044,40 +1722,40 @@ static void ModelSetValueForProperty(__unsafe_unretained id model,
                 case YYEncodingTypeNSMutableData: {
                     if ([value isKindOfClass:[NSData class]]) {
                         if (meta->_nsType == YYEncodingTypeNSData) {
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, value);
+                            ModelSetObjectToProperty(model, meta, value);
                         } else {
                             NSMutableData *data = ((NSData *)value).mutableCopy;
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, data);
+                            ModelSetObjectToProperty(model, meta, data);
                         }
                     } else if ([value isKindOfClass:[NSString class]]) {
                         NSData *data = [(NSString *)value dataUsingEncoding:NSUTF8StringEncoding];
                         if (meta->_nsType == YYEncodingTypeNSMutableData) {
                             data = ((NSData *)data).mutableCopy;
                         }
-                        ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, data);
+                        ModelSetObjectToProperty(model, meta, data);
                     }
                 } break;
                 case YYEncodingTypeNSDate: { // 属性变量 NSDate
 
                     if ([value isKindOfClass:[NSDate class]]) {
-                        ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, value);
+                        ModelSetObjectToProperty(model, meta, value);
                     } else if ([value isKindOfClass:[NSString class]]) {
                         // YYNSDateFromString
-                        ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, YYNSDateFromString(value));
+                        ModelSetObjectToProperty(model, meta, YYNSDateFromString(value));
                     }
                 } break;
                     
                 case YYEncodingTypeNSURL: {
                     if ([value isKindOfClass:[NSURL class]]) {
-                        ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, value);
+                        ModelSetObjectToProperty(model, meta, value);
                     } else if ([value isKindOfClass:[NSString class]]) {  // value属性类型是NSString,NSString - > NSURL
                         // 字符串去掉多余的空格
                         NSCharacterSet *set = [NSCharacterSet whitespaceAndNewlineCharacterSet];
                         NSString *str = [value stringByTrimmingCharactersInSet:set];
                         if (str.length == 0) {
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, nil);
+                            ModelSetObjectToProperty(model, meta, nil);
                         } else {
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, [[NSURL alloc] initWithString:str]);
+                            ModelSetObjectToProperty(model, meta, [[NSURL alloc] initWithString:str]);
                         }
                     }
                 } break;
@@ -1112,24 +1790,20 @@ static void ModelSetValueForProperty(__unsafe_unretained id model,
                                 }
                             }
                             // 将转换好的数组设置给属性
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, objectArr);
+                            ModelSetObjectToProperty(model, meta, objectArr);
                         }
                     } else { // 没有数组元素Class配置
                         if ([value isKindOfClass:[NSArray class]]) {
                             if (meta->_nsType == YYEncodingTypeNSArray) {
-                                ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, value);
+                                ModelSetObjectToProperty(model, meta, value);
                             } else {
-                                ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model,
-                                                                               meta->_setter,
-                                                                               ((NSArray *)value).mutableCopy);
+                                ModelSetObjectToProperty(model, meta, ((NSArray *)value).mutableCopy);
                             }
                         } else if ([value isKindOfClass:[NSSet class]]) {
                             if (meta->_nsType == YYEncodingTypeNSArray) {
-                                ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, ((NSSet *)value).allObjects);
+                                ModelSetObjectToProperty(model, meta, ((NSSet *)value).allObjects);
                             } else {
-                                ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model,
-                                                                               meta->_setter,
-                                                                               ((NSSet *)value).allObjects.mutableCopy);
+                                ModelSetObjectToProperty(model, meta, ((NSSet *)value).allObjects.mutableCopy);
                             }
                         }
                     }
@@ -1152,14 +1826,12 @@ static void ModelSetValueForProperty(__unsafe_unretained id model,
                                     if (newOne) dic[oneKey] = newOne;
                                 }
                             }];
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, dic);
+                            ModelSetObjectToProperty(model, meta, dic);
                         } else {
                             if (meta->_nsType == YYEncodingTypeNSDictionary) {
-                                ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, value);
+                                ModelSetObjectToProperty(model, meta, value);
                             } else {
-                                ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model,
-                                                                               meta->_setter,
-                                                                               ((NSDictionary *)value).mutableCopy);
+                                ModelSetObjectToProperty(model, meta, ((NSDictionary *)value).mutableCopy);
                             }
                         }
                     }
@@ -1187,14 +1859,12 @@ static void ModelSetValueForProperty(__unsafe_unretained id model,
                                 if (newOne) [set addObject:newOne];
                             }
                         }
-                        ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, set);
+                        ModelSetObjectToProperty(model, meta, set);
                     } else {
                         if (meta->_nsType == YYEncodingTypeNSSet) {
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, valueSet);
+                            ModelSetObjectToProperty(model, meta, valueSet);
                         } else {
-                            ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model,
-                                                                           meta->_setter,
-                                                                           ((NSSet *)valueSet).mutableCopy);
+                            ModelSetObjectToProperty(model, meta, ((NSSet *)valueSet).mutableCopy);
                         }
                     }
                 } // break; commented for code coverage in next line
@@ -1208,13 +1878,13 @@ static void ModelSetValueForProperty(__unsafe_unretained id model,
             case YYEncodingTypeObject: { // 属性是自定义OC类型
                 Class cls = meta->_genericCls ?: meta->_cls;
                 if (isNull) {  // NSNull
-                    ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, (id)nil);
+                    ModelSetObjectToProperty(model, meta, (id)nil);
                 } else if ([value isKindOfClass:cls] || !cls) {
-                    ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, (id)value);
+                    ModelSetObjectToProperty(model, meta, (id)value);
                 } else if ([value isKindOfClass:[NSDictionary class]]) {
                     NSObject *one = nil;
                     if (meta->_getter) {
-                        one = ((id (*)(id, SEL))(void *) objc_msgSend)((id)model, meta->_getter);
+                        one = ModelGetObjectFromProperty(model, meta);
                     }
                     if (one) {
                         [one modelSetWithDictionary:value];
@@ -1224,7 +1894,7 @@ static void ModelSetValueForProperty(__unsafe_unretained id model,
                         }
                         one = [cls new];
                         [one modelSetWithDictionary:value];
-                        ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)model, meta->_setter, (id)one);
+                        ModelSetObjectToProperty(model, meta, (id)one);
                     }
                 }
             } break;
@@ -1330,7 +2000,10 @@ static void ModelSetWithDictionaryFunction(const void *_key, const void *_value,
         if (propertyMeta->_setter) {
             // 重要方法：给model的属性赋值
             // 根据属性描述，将value设置给实体类对象
-            ModelSetValueForProperty(model, (__bridge __unsafe_unretained id)_value, propertyMeta);
+            __unsafe_unretained id value = (__bridge __unsafe_unretained id)_value;
+            if (!propertyMeta->_lazy || !ModelSetLazyValueForProperty(model, value, propertyMeta)) {
+                ModelSetValueForProperty(model, value, propertyMeta);
+            }
         }
         propertyMeta = propertyMeta->_next;
     };
@@ -1360,50 +2033,1096 @@ static void ModelSetWithPropertyMetaArrayFunction(const void *_propertyMeta, voi
     if (value) {
         __unsafe_unretained id model = (__bridge id)(context->model);
         // 给属性赋值
-        ModelSetValueForProperty(model, value, propertyMeta);
+        if (!propertyMeta->_lazy || !ModelSetLazyValueForProperty(model, value, propertyMeta)) {
+            ModelSetValueForProperty(model, value, propertyMeta);
+        }
     }
 }
 
+
+#pragma mark - Streaming JSON
+
+/// Max nesting depth of JSON arrays and objects.
+#define YY_JSON_MAX_DEPTH 512
+
 /**
- Returns a valid JSON object (NSArray/NSDictionary/NSString/NSNumber/NSNull), 
- or nil if an error occurs.
- 
- @param model Model, can be nil.
- @return JSON object, nil if an error occurs.
+ A UTF-8 JSON reader, which sets the values to models while parsing,
+ so the intermediate Foundation objects are only created for the mapped values.
  */
-static id ModelToJSONObjectRecursive(NSObject *model) {
-    if (!model || model == (id)kCFNull) return model;
-    if ([model isKindOfClass:[NSString class]]) return model;
-    if ([model isKindOfClass:[NSNumber class]]) return model;
-    if ([model isKindOfClass:[NSDictionary class]]) {
-        if ([NSJSONSerialization isValidJSONObject:model]) return model;
-        NSMutableDictionary *newDic = [NSMutableDictionary new];
-        [((NSDictionary *)model) enumerateKeysAndObjectsUsingBlock:^(NSString *key, id obj, BOOL *stop) {
-            NSString *stringKey = [key isKindOfClass:[NSString class]] ? key : key.description;
-            if (!stringKey) return;
-            id jsonObj = ModelToJSONObjectRecursive(obj);
-            if (!jsonObj) jsonObj = (id)kCFNull;
-            newDic[stringKey] = jsonObj;
-        }];
-        return newDic;
+typedef struct {
+    const uint8_t *start;   ///< first byte of the JSON data
+    const uint8_t *cur;     ///< current position
+    const uint8_t *end;     ///< end of the JSON data
+    void *data;             ///< NSData (json), for the lazy dictionary
+    uint8_t *buffer;        ///< buffer for unescaped strings and numbers, or NULL
+    size_t bufferSize;      ///< buffer size
+    NSUInteger depth;       ///< current nesting depth
+} YYJSONReader;
+
+static id YYJSONReadValue(YYJSONReader *r);
+
+static force_inline void YYJSONSkipSpace(YYJSONReader *r) {
+    const uint8_t *cur = r->cur, *end = r->end;
+    while (cur < end && (*cur == ' ' || *cur == '\n' || *cur == '\r' || *cur == '\t')) cur++;
+    r->cur = cur;
+}
+
+/// Skip whitespace and consume the character, returns NO if it's not found.
+static force_inline BOOL YYJSONConsume(YYJSONReader *r, uint8_t c) {
+    YYJSONSkipSpace(r);
+    if (r->cur >= r->end || *r->cur != c) return NO;
+    r->cur++;
+    return YES;
+}
+
+static force_inline BOOL YYJSONReserve(YYJSONReader *r, size_t size) {
+    if (r->bufferSize >= size) return YES;
+    size_t newSize = r->bufferSize ? r->bufferSize : 256;
+    while (newSize < size) newSize *= 2;
+    uint8_t *buffer = realloc(r->buffer, newSize);
+    if (!buffer) return NO;
+    r->buffer = buffer;
+    r->bufferSize = newSize;
+    return YES;
+}
+
+static force_inline BOOL YYJSONReadHex4(const uint8_t *cur, const uint8_t *end, uint32_t *value) {
+    if (end - cur < 4) return NO;
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) {
+        uint8_t c = cur[i];
+        if (c >= '0' && c <= '9') v = (v << 4) | (c - '0');
+        else if (c >= 'a' && c <= 'f') v = (v << 4) | (c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v = (v << 4) | (c - 'A' + 10);
+        else return NO;
     }
-    if ([model isKindOfClass:[NSSet class]]) {
-        NSArray *array = ((NSSet *)model).allObjects;
-        if ([NSJSONSerialization isValidJSONObject:array]) return array;
-        NSMutableArray *newArray = [NSMutableArray new];
-        for (id obj in array) {
-            if ([obj isKindOfClass:[NSString class]] || [obj isKindOfClass:[NSNumber class]]) {
-                [newArray addObject:obj];
-            } else {
-                id jsonObj = ModelToJSONObjectRecursive(obj);
-                if (jsonObj && jsonObj != (id)kCFNull) [newArray addObject:jsonObj];
-            }
+    *value = v;
+    return YES;
+}
+
+/**
+ Read a string, the reader should be at '"'.
+ 
+ @discussion The returned bytes point to the JSON data if the string has no escape,
+ otherwise they point to the reader's buffer, which is overwritten by the next read.
+ The bytes are not validated as UTF-8 here.
+ */
+static BOOL YYJSONReadStringBytes(YYJSONReader *r, const uint8_t **bytes, size_t *length) {
+    const uint8_t *begin = r->cur + 1, *cur = begin, *end = r->end;
+    while (cur < end) {
+        uint8_t c = *cur;
+        if (c == '"') {
+            *bytes = begin;
+            *length = cur - begin;
+            r->cur = cur + 1;
+            return YES;
         }
-        return newArray;
+        if (c == '\\') break;
+        if (c < 0x20) return NO;
+        cur++;
     }
-    if ([model isKindOfClass:[NSArray class]]) {
-        if ([NSJSONSerialization isValidJSONObject:model]) return model;
-        NSMutableArray *newArray = [NSMutableArray new];
+    if (cur >= end) return NO;
+    
+    // find the closing quote, the unescaped string is not longer than the escaped one
+    const uint8_t *quote = cur;
+    while (quote < end && *quote != '"') {
+        if (*quote == '\\') quote++;
+        quote++;
+    }
+    if (quote >= end) return NO;
+    if (!YYJSONReserve(r, quote - begin)) return NO;
+    uint8_t *dst = r->buffer;
+    memcpy(dst, begin, cur - begin);
+    dst += cur - begin;
+    while (cur < quote) {
+        uint8_t c = *cur++;
+        if (c < 0x20) return NO;
+        if (c != '\\') {
+            *dst++ = c;
+            continue;
+        }
+        c = *cur++;
+        switch (c) {
+            case '"': *dst++ = '"'; break;
+            case '\\': *dst++ = '\\'; break;
+            case '/': *dst++ = '/'; break;
+            case 'b': *dst++ = '\b'; break;
+            case 'f': *dst++ = '\f'; break;
+            case 'n': *dst++ = '\n'; break;
+            case 'r': *dst++ = '\r'; break;
+            case 't': *dst++ = '\t'; break;
+            case 'u': {
+                uint32_t u, low;
+                if (!YYJSONReadHex4(cur, quote, &u)) return NO;
+                cur += 4;
+                if (u >= 0xD800 && u <= 0xDBFF) {
+                    if (quote - cur >= 6 && cur[0] == '\\' && cur[1] == 'u' &&
+                        YYJSONReadHex4(cur + 2, quote, &low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        u = 0x10000 + ((u - 0xD800) << 10) + (low - 0xDC00);
+                        cur += 6;
+                    } else {
+                        u = 0xFFFD; // unpaired surrogate
+                    }
+                } else if (u >= 0xDC00 && u <= 0xDFFF) {
+                    u = 0xFFFD;
+                }
+                if (u < 0x80) {
+                    *dst++ = u;
+                } else if (u < 0x800) {
+                    *dst++ = 0xC0 | (u >> 6);
+                    *dst++ = 0x80 | (u & 0x3F);
+                } else if (u < 0x10000) {
+                    *dst++ = 0xE0 | (u >> 12);
+                    *dst++ = 0x80 | ((u >> 6) & 0x3F);
+                    *dst++ = 0x80 | (u & 0x3F);
+                } else {
+                    *dst++ = 0xF0 | (u >> 18);
+                    *dst++ = 0x80 | ((u >> 12) & 0x3F);
+                    *dst++ = 0x80 | ((u >> 6) & 0x3F);
+                    *dst++ = 0x80 | (u & 0x3F);
+                }
+            } break;
+            default: return NO;
+        }
+    }
+    *bytes = r->buffer;
+    *length = dst - r->buffer;
+    r->cur = quote + 1;
+    return YES;
+}
+
+/// Read a string object, the reader should be at '"'. Returns nil if an error occurs.
+static force_inline NSString *YYJSONReadString(YYJSONReader *r) {
+    const uint8_t *bytes;
+    size_t length;
+    if (!YYJSONReadStringBytes(r, &bytes, &length)) return nil;
+    if (length == 0) return @"";
+    return CFBridgingRelease(CFStringCreateWithBytes(kCFAllocatorDefault, bytes, length, kCFStringEncodingUTF8, false));
+}
+
+/// Read a number object. Returns nil if an error occurs.
+static NSNumber *YYJSONReadNumber(YYJSONReader *r) {
+    const uint8_t *begin = r->cur, *cur = begin, *end = r->end;
+    BOOL negative = NO, integer = YES, overflow = NO;
+    uint64_t value = 0;
+    if (cur < end && *cur == '-') {
+        negative = YES;
+        cur++;
+    }
+    if (cur >= end || *cur < '0' || *cur > '9') return nil;
+    if (*cur == '0') {
+        cur++;
+    } else {
+        while (cur < end && *cur >= '0' && *cur <= '9') {
+            uint64_t digit = *cur++ - '0';
+            if (value > (UINT64_MAX - digit) / 10) overflow = YES;
+            value = value * 10 + digit;
+        }
+    }
+    if (cur < end && *cur == '.') {
+        integer = NO;
+        cur++;
+        if (cur >= end || *cur < '0' || *cur > '9') return nil;
+        while (cur < end && *cur >= '0' && *cur <= '9') cur++;
+    }
+    if (cur < end && (*cur == 'e' || *cur == 'E')) {
+        integer = NO;
+        cur++;
+        if (cur < end && (*cur == '+' || *cur == '-')) cur++;
+        if (cur >= end || *cur < '0' || *cur > '9') return nil;
+        while (cur < end && *cur >= '0' && *cur <= '9') cur++;
+    }
+    r->cur = cur;
+    
+    if (integer && !overflow) {
+        if (!negative) {
+            if (value <= LLONG_MAX) return @((long long)value);
+            return @((unsigned long long)value);
+        }
+        if (value <= (uint64_t)LLONG_MAX + 1) return @((long long)(0 - value));
+    }
+    size_t length = cur - begin;
+    if (!YYJSONReserve(r, length + 1)) return nil;
+    memcpy(r->buffer, begin, length);
+    r->buffer[length] = '\0';
+    if (integer) {
+        // out of 64-bit range, keep the digits (same as NSJSONSerialization)
+        NSString *string = [[NSString alloc] initWithBytes:r->buffer length:length encoding:NSASCIIStringEncoding];
+        return [NSDecimalNumber decimalNumberWithString:string];
+    }
+    return @(strtod((const char *)r->buffer, NULL));
+}
+
+/// Skip a number without creating object. Returns NO if it's not a valid number.
+static BOOL YYJSONSkipNumber(YYJSONReader *r) {
+    const uint8_t *cur = r->cur, *end = r->end;
+    if (cur < end && *cur == '-') cur++;
+    if (cur >= end || *cur < '0' || *cur > '9') return NO;
+    if (*cur == '0') {
+        cur++;
+    } else {
+        while (cur < end && *cur >= '0' && *cur <= '9') cur++;
+    }
+    if (cur < end && *cur == '.') {
+        cur++;
+        if (cur >= end || *cur < '0' || *cur > '9') return NO;
+        while (cur < end && *cur >= '0' && *cur <= '9') cur++;
+    }
+    if (cur < end && (*cur == 'e' || *cur == 'E')) {
+        cur++;
+        if (cur < end && (*cur == '+' || *cur == '-')) cur++;
+        if (cur >= end || *cur < '0' || *cur > '9') return NO;
+        while (cur < end && *cur >= '0' && *cur <= '9') cur++;
+    }
+    r->cur = cur;
+    return YES;
+}
+
+/// Whether the bytes are valid UTF-8 (no overlong form, surrogate or code point above U+10FFFF).
+static BOOL YYJSONValidateUTF8(const uint8_t *bytes, size_t length) {
+    const uint8_t *cur = bytes, *end = bytes + length;
+    while (cur < end) {
+        uint8_t c = *cur;
+        if (c < 0x80) {
+            cur++;
+            continue;
+        }
+        size_t count;
+        uint32_t u, min;
+        if ((c & 0xE0) == 0xC0) { count = 1; u = c & 0x1F; min = 0x80; }
+        else if ((c & 0xF0) == 0xE0) { count = 2; u = c & 0x0F; min = 0x800; }
+        else if ((c & 0xF8) == 0xF0) { count = 3; u = c & 0x07; min = 0x10000; }
+        else return NO;
+        if ((size_t)(end - cur) <= count) return NO;
+        for (size_t i = 1; i <= count; i++) {
+            if ((cur[i] & 0xC0) != 0x80) return NO;
+            u = (u << 6) | (cur[i] & 0x3F);
+        }
+        if (u < min || u > 0x10FFFF || (u >= 0xD800 && u <= 0xDFFF)) return NO;
+        cur += count + 1;
+    }
+    return YES;
+}
+
+/// Skip a string without creating object, the reader should be at '"'.
+static force_inline BOOL YYJSONSkipString(YYJSONReader *r) {
+    const uint8_t *bytes;
+    size_t length;
+    if (!YYJSONReadStringBytes(r, &bytes, &length)) return NO;
+    return YYJSONValidateUTF8(bytes, length);
+}
+
+/// Read an object, the reader should be at '{'. Returns nil if an error occurs.
+static NSMutableDictionary *YYJSONReadObject(YYJSONReader *r) {
+    if (++r->depth > YY_JSON_MAX_DEPTH) return nil;
+    r->cur++;
+    NSMutableDictionary *dic = [NSMutableDictionary new];
+    YYJSONSkipSpace(r);
+    if (r->cur < r->end && *r->cur == '}') {
+        r->cur++;
+        r->depth--;
+        return dic;
+    }
+    for (;;) {
+        YYJSONSkipSpace(r);
+        if (r->cur >= r->end || *r->cur != '"') return nil;
+        NSString *key = YYJSONReadString(r);
+        if (!key) return nil;
+        if (!YYJSONConsume(r, ':')) return nil;
+        id value = YYJSONReadValue(r);
+        if (!value) return nil;
+        dic[key] = value;
+        YYJSONSkipSpace(r);
+        if (r->cur >= r->end) return nil;
+        uint8_t c = *r->cur++;
+        if (c == '}') break;
+        if (c != ',') return nil;
+    }
+    r->depth--;
+    return dic;
+}
+
+/// Read an array, the reader should be at '['. Returns nil if an error occurs.
+static NSMutableArray *YYJSONReadArray(YYJSONReader *r) {
+    if (++r->depth > YY_JSON_MAX_DEPTH) return nil;
+    r->cur++;
+    NSMutableArray *arr = [NSMutableArray new];
+    YYJSONSkipSpace(r);
+    if (r->cur < r->end && *r->cur == ']') {
+        r->cur++;
+        r->depth--;
+        return arr;
+    }
+    for (;;) {
+        id value = YYJSONReadValue(r);
+        if (!value) return nil;
+        [arr addObject:value];
+        YYJSONSkipSpace(r);
+        if (r->cur >= r->end) return nil;
+        uint8_t c = *r->cur++;
+        if (c == ']') break;
+        if (c != ',') return nil;
+    }
+    r->depth--;
+    return arr;
+}
+
+static force_inline BOOL YYJSONReadLiteral(YYJSONReader *r, const char *literal, size_t length) {
+    if ((size_t)(r->end - r->cur) < length || memcmp(r->cur, literal, length) != 0) return NO;
+    r->cur += length;
+    return YES;
+}
+
+/// Read any value as Foundation object (NSNull for null). Returns nil if an error occurs.
+static id YYJSONReadValue(YYJSONReader *r) {
+    YYJSONSkipSpace(r);
+    if (r->cur >= r->end) return nil;
+    switch (*r->cur) {
+        case '{': return YYJSONReadObject(r);
+        case '[': return YYJSONReadArray(r);
+        case '"': return YYJSONReadString(r);
+        case 't': return YYJSONReadLiteral(r, "true", 4) ? @YES : nil;
+        case 'f': return YYJSONReadLiteral(r, "false", 5) ? @NO : nil;
+        case 'n': return YYJSONReadLiteral(r, "null", 4) ? (id)kCFNull : nil;
+        default: return YYJSONReadNumber(r);
+    }
+}
+
+/**
+ Skip a value without creating objects.
+ @discussion The value is fully validated (same as `YYJSONReadValue()`), so invalid
+ JSON is rejected even if it's in the values which are not mapped to the model.
+ */
+static BOOL YYJSONSkipValue(YYJSONReader *r) {
+    YYJSONSkipSpace(r);
+    if (r->cur >= r->end) return NO;
+    switch (*r->cur) {
+        case '{': {
+            if (++r->depth > YY_JSON_MAX_DEPTH) return NO;
+            r->cur++;
+            YYJSONSkipSpace(r);
+            if (r->cur < r->end && *r->cur == '}') {
+                r->cur++;
+                r->depth--;
+                return YES;
+            }
+            for (;;) {
+                YYJSONSkipSpace(r);
+                if (r->cur >= r->end || *r->cur != '"') return NO;
+                if (!YYJSONSkipString(r)) return NO;
+                if (!YYJSONConsume(r, ':')) return NO;
+                if (!YYJSONSkipValue(r)) return NO;
+                YYJSONSkipSpace(r);
+                if (r->cur >= r->end) return NO;
+                uint8_t c = *r->cur++;
+                if (c == '}') break;
+                if (c != ',') return NO;
+            }
+            r->depth--;
+            return YES;
+        }
+        case '[': {
+            if (++r->depth > YY_JSON_MAX_DEPTH) return NO;
+            r->cur++;
+            YYJSONSkipSpace(r);
+            if (r->cur < r->end && *r->cur == ']') {
+                r->cur++;
+                r->depth--;
+                return YES;
+            }
+            for (;;) {
+                if (!YYJSONSkipValue(r)) return NO;
+                YYJSONSkipSpace(r);
+                if (r->cur >= r->end) return NO;
+                uint8_t c = *r->cur++;
+                if (c == ']') break;
+                if (c != ',') return NO;
+            }
+            r->depth--;
+            return YES;
+        }
+        case '"': return YYJSONSkipString(r);
+        case 't': return YYJSONReadLiteral(r, "true", 4);
+        case 'f': return YYJSONReadLiteral(r, "false", 5);
+        case 'n': return YYJSONReadLiteral(r, "null", 4);
+        default: return YYJSONSkipNumber(r);
+    }
+}
+
+
+/**
+ An immutable dictionary of a JSON object, which is parsed on first access.
+ It's passed to the model's custom methods while streaming JSON, so the object
+ is not parsed twice if the methods don't use the dictionary.
+ */
+@interface _YYModelJSONDictionary : NSDictionary
+- (instancetype)initWithData:(NSData *)data offset:(NSUInteger)offset;
+@end
+
+@implementation _YYModelJSONDictionary {
+    NSData *_data;
+    NSUInteger _offset;
+    NSDictionary *_dictionary;
+    pthread_mutex_t _lock;
+}
+
+- (instancetype)initWithData:(NSData *)data offset:(NSUInteger)offset {
+    self = [super init];
+    _data = data;
+    _offset = offset;
+    pthread_mutex_init(&_lock, NULL);
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+- (NSDictionary *)_parsedDictionary {
+    pthread_mutex_lock(&_lock);
+    if (!_dictionary) {
+        YYJSONReader reader = {0};
+        reader.start = _data.bytes;
+        reader.cur = reader.start + _offset;
+        reader.end = reader.start + _data.length;
+        reader.data = (__bridge void *)(_data);
+        _dictionary = YYJSONReadObject(&reader) ?: @{};
+        if (reader.buffer) free(reader.buffer);
+    }
+    NSDictionary *dictionary = _dictionary;
+    pthread_mutex_unlock(&_lock);
+    return dictionary;
+}
+
+- (NSUInteger)count {
+    return [self _parsedDictionary].count;
+}
+
+- (id)objectForKey:(id)aKey {
+    return [[self _parsedDictionary] objectForKey:aKey];
+}
+
+- (NSEnumerator *)keyEnumerator {
+    return [[self _parsedDictionary] keyEnumerator];
+}
+
+@end
+
+/// Returns a lazy dictionary of the object at the reader's position.
+static force_inline NSDictionary *YYJSONLazyDictionary(YYJSONReader *r) {
+    return [[_YYModelJSONDictionary alloc] initWithData:(__bridge NSData *)(r->data) offset:r->cur - r->start];
+}
+
+static force_inline _YYModelKeyEntry *ModelMetaKeyEntry(__unsafe_unretained _YYModelMeta *meta, const uint8_t *key, size_t length) {
+    if (!meta->_keyTable) return NULL;
+    uint32_t hash = YYModelKeyHash(key, length);
+    NSUInteger mask = meta->_keyTableMask, i = hash & mask;
+    for (;;) {
+        _YYModelKeyEntry *entry = meta->_keyTable + i;
+        if (!entry->key) return NULL;
+        if (entry->hash == hash && entry->length == length && memcmp(entry->key, key, length) == 0) return entry;
+        i = (i + 1) & mask;
+    }
+}
+
+static BOOL ModelSetWithJSONReader(__unsafe_unretained id model, __unsafe_unretained _YYModelMeta *modelMeta, YYJSONReader *r, BOOL *result);
+static BOOL ModelSetLazyJSONForProperty(__unsafe_unretained id model, __unsafe_unretained _YYModelPropertyMeta *meta, YYJSONReader *r);
+
+/**
+ Read a JSON object as a new model, the reader should be at '{'.
+ Same as `+modelWithDictionary:`, the model is nil if it cannot be set with the object.
+ 
+ @return NO if a JSON error occurs.
+ */
+static BOOL ModelCreateWithJSONReader(Class cls, YYJSONReader *r, __autoreleasing id *model) {
+    _YYModelMeta *modelMeta = [_YYModelMeta metaWithClass:cls];
+    if (modelMeta->_hasCustomClassFromDictionary) {
+        cls = [cls modelCustomClassForDictionary:YYJSONLazyDictionary(r)] ?: cls;
+    }
+    NSObject *one = [cls new];
+    _YYModelMeta *oneMeta = [_YYModelMeta metaWithClass:object_getClass(one)];
+    BOOL result = NO;
+    if (!ModelSetWithJSONReader(one, oneMeta, r, &result)) return NO;
+    *model = result ? one : nil;
+    return YES;
+}
+
+/**
+ Read a JSON value and set it to the property, same as `ModelSetValueForProperty()`.
+ The nested models and the model arrays are streamed, other values are read as
+ Foundation objects.
+ 
+ @return NO if a JSON error occurs.
+ */
+static BOOL ModelSetPropertyWithJSONReader(__unsafe_unretained id model,
+                                           __unsafe_unretained _YYModelPropertyMeta *meta,
+                                           YYJSONReader *r) {
+    YYJSONSkipSpace(r);
+    if (r->cur >= r->end) return NO;
+    uint8_t c = *r->cur;
+    
+    if (c == '{' && !meta->_nsType && (meta->_type & YYEncodingTypeMask) == YYEncodingTypeObject) {
+        Class cls = meta->_genericCls ?: meta->_cls;
+        // a dictionary is set as is if the property is id or NSObject
+        if (cls && ![NSMutableDictionary isSubclassOfClass:cls]) {
+            NSObject *one = ModelGetObjectFromProperty(model, meta);
+            BOOL isNew = (one == nil);
+            if (isNew) {
+                if (meta->_hasCustomClassFromDictionary) {
+                    cls = [cls modelCustomClassForDictionary:YYJSONLazyDictionary(r)] ?: cls;
+                }
+                one = [cls new];
+            }
+            _YYModelMeta *oneMeta = [_YYModelMeta metaWithClass:object_getClass(one)];
+            BOOL result;
+            if (!ModelSetWithJSONReader(one, oneMeta, r, &result)) return NO;
+            if (isNew) ModelSetObjectToProperty(model, meta, (id)one);
+            return YES;
+        }
+    }
+    
+    if (c == '[' && meta->_genericCls &&
+        (meta->_nsType == YYEncodingTypeNSArray || meta->_nsType == YYEncodingTypeNSMutableArray) &&
+        ![NSMutableDictionary isSubclassOfClass:meta->_genericCls]) {
+        if (++r->depth > YY_JSON_MAX_DEPTH) return NO;
+        r->cur++;
+        NSMutableArray *objectArr = [NSMutableArray new];
+        YYJSONSkipSpace(r);
+        if (r->cur < r->end && *r->cur == ']') {
+            r->cur++;
+        } else {
+            for (;;) {
+                YYJSONSkipSpace(r);
+                if (r->cur >= r->end) return NO;
+                if (*r->cur == '{') {
+                    Class cls = meta->_genericCls;
+                    if (meta->_hasCustomClassFromDictionary) {
+                        cls = [cls modelCustomClassForDictionary:YYJSONLazyDictionary(r)] ?: meta->_genericCls;
+                    }
+                    NSObject *newOne = [cls new];
+                    _YYModelMeta *oneMeta = [_YYModelMeta metaWithClass:object_getClass(newOne)];
+                    BOOL result;
+                    if (!ModelSetWithJSONReader(newOne, oneMeta, r, &result)) return NO;
+                    if (newOne) [objectArr addObject:newOne];
+                } else {
+                    id one = YYJSONReadValue(r);
+                    if (!one) return NO;
+                    if ([one isKindOfClass:meta->_genericCls]) [objectArr addObject:one];
+                }
+                YYJSONSkipSpace(r);
+                if (r->cur >= r->end) return NO;
+                c = *r->cur++;
+                if (c == ']') break;
+                if (c != ',') return NO;
+            }
+        }
+        r->depth--;
+        ModelSetObjectToProperty(model, meta, objectArr);
+        return YES;
+    }
+    
+    id value = YYJSONReadValue(r);
+    if (!value) return NO;
+    ModelSetValueForProperty(model, value, meta);
+    return YES;
+}
+
+/**
+ Read a JSON object and set it to the model, same as `-modelSetWithDictionary:`.
+ The reader should be at '{'.
+ 
+ @discussion The values of the unmapped keys are skipped. The values of the keys
+ which are the first keys of key paths (or multi keys) are collected to a dictionary,
+ and set to the properties after the object is read.
+ 
+ @param result Same as the result of `-modelSetWithDictionary:`.
+ @return NO if a JSON error occurs.
+ */
+static BOOL ModelSetWithJSONReader(__unsafe_unretained id model,
+                                   __unsafe_unretained _YYModelMeta *modelMeta,
+                                   YYJSONReader *r,
+                                   BOOL *result) {
+    *result = NO;
+    if (modelMeta->_keyMappedCount == 0) return YYJSONSkipValue(r);
+    if (modelMeta->_hasCustomWillTransformFromDictionary) {
+        NSDictionary *dic = YYJSONReadObject(r);
+        if (!dic) return NO;
+        *result = [model modelSetWithDictionary:dic];
+        return YES;
+    }
+    
+    NSUInteger offset = r->cur - r->start;
+    if (++r->depth > YY_JSON_MAX_DEPTH) return NO;
+    r->cur++;
+    NSMutableDictionary *pathRoots = nil;
+    YYJSONSkipSpace(r);
+    if (r->cur < r->end && *r->cur == '}') {
+        r->cur++;
+    } else {
+        for (;;) {
+            YYJSONSkipSpace(r);
+            if (r->cur >= r->end || *r->cur != '"') return NO;
+            const uint8_t *key;
+            size_t keyLength;
+            if (!YYJSONReadStringBytes(r, &key, &keyLength)) return NO;
+            _YYModelKeyEntry *entry = ModelMetaKeyEntry(modelMeta, key, keyLength);
+            if (!entry && !YYJSONValidateUTF8(key, keyLength)) return NO; // a mapped key is valid UTF-8
+            NSString *rootKey = nil;
+            if (entry && entry->isPathRoot) {
+                rootKey = CFBridgingRelease(CFStringCreateWithBytes(kCFAllocatorDefault, key, keyLength, kCFStringEncodingUTF8, false));
+                if (!rootKey) return NO;
+            }
+            if (!YYJSONConsume(r, ':')) return NO;
+            
+            if (!entry) {
+                if (!YYJSONSkipValue(r)) return NO;
+            } else {
+                __unsafe_unretained _YYModelPropertyMeta *propertyMeta = (__bridge _YYModelPropertyMeta *)(entry->propertyMeta);
+                if (rootKey || (propertyMeta && propertyMeta->_next)) {
+                    // the value is shared, read it once
+                    id value = YYJSONReadValue(r);
+                    if (!value) return NO;
+                    if (rootKey) {
+                        if (!pathRoots) pathRoots = [NSMutableDictionary new];
+                        pathRoots[rootKey] = value;
+                    }
+                    while (propertyMeta) {
+                        if (propertyMeta->_setter) {
+                            if (!propertyMeta->_lazy || !ModelSetLazyValueForProperty(model, value, propertyMeta)) {
+                                ModelSetValueForProperty(model, value, propertyMeta);
+                            }
+                        }
+                        propertyMeta = propertyMeta->_next;
+                    }
+                } else if (propertyMeta && propertyMeta->_setter) {
+                    if (propertyMeta->_lazy) {
+                        if (!ModelSetLazyJSONForProperty(model, propertyMeta, r)) return NO;
+                    } else {
+                        if (!ModelSetPropertyWithJSONReader(model, propertyMeta, r)) return NO;
+                    }
+                } else {
+                    if (!YYJSONSkipValue(r)) return NO;
+                }
+            }
+            
+            YYJSONSkipSpace(r);
+            if (r->cur >= r->end) return NO;
+            uint8_t c = *r->cur++;
+            if (c == '}') break;
+            if (c != ',') return NO;
+        }
+    }
+    r->depth--;
+    
+    if (pathRoots) {
+        ModelSetContext context = {0};
+        context.modelMeta = (__bridge void *)(modelMeta);
+        context.model = (__bridge void *)(model);
+        context.dictionary = (__bridge void *)(pathRoots);
+        if (modelMeta->_keyPathPropertyMetas) {
+            CFArrayApplyFunction((CFArrayRef)modelMeta->_keyPathPropertyMetas,
+                                 CFRangeMake(0, CFArrayGetCount((CFArrayRef)modelMeta->_keyPathPropertyMetas)),
+                                 ModelSetWithPropertyMetaArrayFunction,
+                                 &context);
+        }
+        if (modelMeta->_multiKeysPropertyMetas) {
+            CFArrayApplyFunction((CFArrayRef)modelMeta->_multiKeysPropertyMetas,
+                                 CFRangeMake(0, CFArrayGetCount((CFArrayRef)modelMeta->_multiKeysPropertyMetas)),
+                                 ModelSetWithPropertyMetaArrayFunction,
+                                 &context);
+        }
+    }
+    
+    if (modelMeta->_hasCustomTransformFromDictionary) {
+        NSDictionary *dic = [[_YYModelJSONDictionary alloc] initWithData:(__bridge NSData *)(r->data) offset:offset];
+        *result = [((id<YYModel>)model) modelCustomTransformFromDictionary:dic];
+    } else {
+        *result = YES;
+    }
+    return YES;
+}
+
+/// Returns the UTF-8 JSON data which can be streamed, or nil.
+static NSData *YYJSONStreamingData(__unsafe_unretained id json) {
+    NSData *data = nil;
+    if ([json isKindOfClass:[NSString class]]) {
+        data = [(NSString *)json dataUsingEncoding:NSUTF8StringEncoding];
+    } else if ([json isKindOfClass:[NSData class]]) {
+        data = ((NSData *)json).copy;
+    }
+    // UTF-16 and UTF-32 JSON has zero byte in the first two bytes
+    if (data.length < 2) return nil;
+    const uint8_t *bytes = data.bytes;
+    if (bytes[0] == 0 || bytes[1] == 0) return nil;
+    return data;
+}
+
+/// Start reading the data, the reader is at the first non-whitespace character.
+static void YYJSONReaderStart(YYJSONReader *r, __unsafe_unretained NSData *data) {
+    memset(r, 0, sizeof(YYJSONReader));
+    r->start = data.bytes;
+    r->cur = r->start;
+    r->end = r->start + data.length;
+    r->data = (__bridge void *)(data);
+    if (r->end - r->cur >= 3 && r->cur[0] == 0xEF && r->cur[1] == 0xBB && r->cur[2] == 0xBF) r->cur += 3; // BOM
+    YYJSONSkipSpace(r);
+}
+
+/// Finish reading the data, returns NO if there's non-whitespace character after the value.
+static BOOL YYJSONReaderFinish(YYJSONReader *r, BOOL success) {
+    if (r->buffer) free(r->buffer);
+    r->buffer = NULL;
+    if (!success) return NO;
+    YYJSONSkipSpace(r);
+    return r->cur == r->end;
+}
+
+/**
+ Creates a model from the JSON object data in a single pass.
+ 
+ @discussion The model's custom methods may have been called when a JSON error is
+ found, so the data must not be parsed again: the model is nil if the data is not
+ valid JSON (NSJSONSerialization would fail too).
+ 
+ @return NO if the data is not a JSON object (nothing has been done), the caller
+    should fall back to NSJSONSerialization.
+ */
+static BOOL ModelCreateWithJSONData(Class cls, __unsafe_unretained NSData *data, __autoreleasing id *model) {
+    YYJSONReader reader;
+    YYJSONReaderStart(&reader, data);
+    if (reader.cur >= reader.end || *reader.cur != '{') return YYJSONReaderFinish(&reader, NO);
+    BOOL success = ModelCreateWithJSONReader(cls, &reader, model);
+    if (!YYJSONReaderFinish(&reader, success)) *model = nil;
+    return YES;
+}
+
+/// Read a JSON array as model array, the reader should be at '['. Returns nil if a JSON error occurs.
+static NSMutableArray *ModelArrayCreateWithJSONReader(Class cls, YYJSONReader *r) {
+    if (++r->depth > YY_JSON_MAX_DEPTH) return nil;
+    r->cur++;
+    NSMutableArray *result = [NSMutableArray new];
+    YYJSONSkipSpace(r);
+    if (r->cur < r->end && *r->cur == ']') {
+        r->cur++;
+        r->depth--;
+        return result;
+    }
+    for (;;) {
+        YYJSONSkipSpace(r);
+        if (r->cur >= r->end) return nil;
+        if (*r->cur == '{') {
+            id obj = nil;
+            if (!ModelCreateWithJSONReader(cls, r, &obj)) return nil;
+            if (obj) [result addObject:obj];
+        } else {
+            if (!YYJSONSkipValue(r)) return nil;
+        }
+        YYJSONSkipSpace(r);
+        if (r->cur >= r->end) return nil;
+        uint8_t c = *r->cur++;
+        if (c == ']') break;
+        if (c != ',') return nil;
+    }
+    r->depth--;
+    return result;
+}
+
+/**
+ Creates a model array from the JSON array data in a single pass.
+ Same as `ModelCreateWithJSONData()`, the array is nil if the data is not valid JSON.
+ 
+ @return NO if the data is not a JSON array (nothing has been done), the caller
+    should fall back to NSJSONSerialization.
+ */
+static BOOL ModelArrayCreateWithJSONData(Class cls, __unsafe_unretained NSData *data, __autoreleasing NSArray **array) {
+    YYJSONReader reader;
+    YYJSONReaderStart(&reader, data);
+    if (reader.cur >= reader.end || *reader.cur != '[') return YYJSONReaderFinish(&reader, NO);
+    NSArray *result = ModelArrayCreateWithJSONReader(cls, &reader);
+    *array = YYJSONReaderFinish(&reader, result != nil) ? result : nil;
+    return YES;
+}
+
+
+#pragma mark - Lazy Property
+
+/// The raw JSON value which is not parsed yet, copied from the JSON data.
+@interface _YYModelLazyJSON : NSObject {
+    @package
+    NSData *_data;       ///< the JSON bytes of the value
+}
+@end
+
+@implementation _YYModelLazyJSON
+@end
+
+/**
+ The raw values of a model's lazy properties (see `+modelPropertyLazyList`),
+ which are set to the properties on first access of the getters.
+ It's associated to the model while it has a raw value, and accessed with the
+ model's lazy lock held.
+ */
+@interface _YYModelLazyStorage : NSObject {
+    @package
+    NSMutableDictionary *_values;   ///< key: property name, value: NSDictionary/NSArray/NSSet or _YYModelLazyJSON
+    NSMutableDictionary *_states;   ///< key: property name, value: _YYModelLazyState
+}
+@end
+
+/**
+ The pending state of a lazy property in a model class. The getter and setter
+ check the count first, so the models don't look up the lazy storage or take
+ the lock if no model of the class has a raw value of the property.
+ */
+@interface _YYModelLazyState : NSObject {
+    @package
+    int32_t _pendingCount;  ///< count of the models which have a raw value of the property (atomic)
+}
+@end
+
+@implementation _YYModelLazyState
+@end
+
+@implementation _YYModelLazyStorage
+- (void)dealloc {
+    // the model is released before the getters are called
+    for (NSString *name in _values) {
+        _YYModelLazyState *state = _states[name];
+        __atomic_sub_fetch(&state->_pendingCount, 1, __ATOMIC_RELEASE);
+    }
+}
+@end
+
+static const int YYModelLazyStorageKey;
+
+/// Lock count (power of 2) of the lazy properties, the models are striped by address.
+#define YY_MODEL_LAZY_LOCK_BITS 4
+#define YY_MODEL_LAZY_LOCK_COUNT (1 << YY_MODEL_LAZY_LOCK_BITS)
+
+/// Returns the lock of the model's lazy properties, it's recursive because the accessors
+/// are called while setting the value.
+static pthread_mutex_t *ModelLazyLock(__unsafe_unretained id model) {
+    static pthread_mutex_t locks[YY_MODEL_LAZY_LOCK_COUNT];
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        for (int i = 0; i < YY_MODEL_LAZY_LOCK_COUNT; i++) {
+            pthread_mutex_init(&locks[i], &attr);
+        }
+        pthread_mutexattr_destroy(&attr);
+    });
+    uint64_t hash = (uint64_t)(uintptr_t)(__bridge void *)model * 0x9E3779B97F4A7C15ULL;
+    return &locks[hash >> (64 - YY_MODEL_LAZY_LOCK_BITS)];
+}
+
+/// Whether the lazy property may have a raw value which is not set yet, check it again with the lock held.
+static force_inline BOOL ModelLazyMayBePending(__unsafe_unretained id model, __unsafe_unretained _YYModelPropertyMeta *meta) {
+    if (__atomic_load_n(&meta->_lazyState->_pendingCount, __ATOMIC_ACQUIRE) == 0) return NO;
+    return objc_getAssociatedObject(model, &YYModelLazyStorageKey) != nil;
+}
+
+/// Removes and returns the raw value of the lazy property, or nil. The lock should be held.
+static id ModelLazyTakeValue(__unsafe_unretained id model, __unsafe_unretained _YYModelPropertyMeta *meta) {
+    _YYModelLazyStorage *storage = objc_getAssociatedObject(model, &YYModelLazyStorageKey);
+    id value = storage ? storage->_values[meta->_name] : nil;
+    if (value) [storage->_values removeObjectForKey:meta->_name];
+    return value;
+}
+
+/**
+ Called after the raw value taken by `ModelLazyTakeValue()` is set or discarded,
+ the storage is removed if it's empty. The lock should be held.
+ */
+static void ModelLazyDidSetValue(__unsafe_unretained id model, __unsafe_unretained _YYModelPropertyMeta *meta) {
+    _YYModelLazyStorage *storage = objc_getAssociatedObject(model, &YYModelLazyStorageKey);
+    if (storage && storage->_values.count == 0) {
+        objc_setAssociatedObject(model, &YYModelLazyStorageKey, nil, OBJC_ASSOCIATION_RETAIN);
+    }
+    __atomic_sub_fetch(&meta->_lazyState->_pendingCount, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ Set the raw value of the lazy property to the property, if it's not set yet.
+ The value is set only once, other threads wait until it's done.
+ If the raw JSON is invalid, the property is set to nil.
+ */
+static void ModelMaterializeLazyProperty(__unsafe_unretained id model, __unsafe_unretained _YYModelPropertyMeta *meta) {
+    pthread_mutex_t *lock = ModelLazyLock(model);
+    pthread_mutex_lock(lock);
+    // no value: it's set by other thread, or being set in this thread (the getter returns nil meanwhile)
+    id value = ModelLazyTakeValue(model, meta);
+    if (value) {
+        BOOL success = YES;
+        if ([value isKindOfClass:[_YYModelLazyJSON class]]) {
+            _YYModelLazyJSON *json = value;
+            YYJSONReader reader = {0};
+            reader.start = json->_data.bytes;
+            reader.cur = reader.start;
+            reader.end = reader.start + json->_data.length;
+            reader.data = (__bridge void *)(json->_data);
+            success = ModelSetPropertyWithJSONReader(model, meta, &reader);
+            if (reader.buffer) free(reader.buffer);
+        } else {
+            ModelSetValueForProperty(model, value, meta);
+        }
+        if (!success) ModelSetObjectToProperty(model, meta, (id)nil);
+        ModelLazyDidSetValue(model, meta);
+    }
+    pthread_mutex_unlock(lock);
+}
+
+/**
+ Whether the raw value can be kept for the lazy property: the property is nil.
+ A pending raw value is set to the property first (by the getter). Otherwise the
+ value is set immediately, so it's merged to the existing model same as a normal property.
+ */
+static force_inline BOOL ModelLazyCanKeepValue(__unsafe_unretained id model, __unsafe_unretained _YYModelPropertyMeta *meta) {
+    return ModelGetObjectFromProperty(model, meta) == nil;
+}
+
+/// Keep the raw value of the lazy property until the getter is called.
+static void ModelKeepLazyValue(__unsafe_unretained id model, __unsafe_unretained _YYModelPropertyMeta *meta, id value) {
+    pthread_mutex_t *lock = ModelLazyLock(model);
+    pthread_mutex_lock(lock);
+    _YYModelLazyStorage *storage = objc_getAssociatedObject(model, &YYModelLazyStorageKey);
+    if (!storage) {
+        storage = [_YYModelLazyStorage new];
+        storage->_values = [NSMutableDictionary new];
+        storage->_states = [NSMutableDictionary new];
+        objc_setAssociatedObject(model, &YYModelLazyStorageKey, storage, OBJC_ASSOCIATION_RETAIN);
+    }
+    if (!storage->_values[meta->_name]) __atomic_add_fetch(&meta->_lazyState->_pendingCount, 1, __ATOMIC_RELEASE);
+    storage->_values[meta->_name] = value;
+    storage->_states[meta->_name] = meta->_lazyState;
+    pthread_mutex_unlock(lock);
+}
+
+/**
+ Keep the value of the lazy property if it's a container (the raw JSON object of a
+ model, or the JSON array/object of models), instead of setting it immediately.
+ 
+ @return NO if the value should be set with `ModelSetValueForProperty()`.
+ */
+static BOOL ModelSetLazyValueForProperty(__unsafe_unretained id model,
+                                         __unsafe_unretained id value,
+                                         __unsafe_unretained _YYModelPropertyMeta *meta) {
+    if (![value isKindOfClass:[NSDictionary class]] &&
+        ![value isKindOfClass:[NSArray class]] &&
+        ![value isKindOfClass:[NSSet class]]) return NO;
+    if (!ModelLazyCanKeepValue(model, meta)) return NO;
+    ModelKeepLazyValue(model, meta, value);
+    return YES;
+}
+
+/**
+ Same as `ModelSetPropertyWithJSONReader()`, but a JSON object or array is validated
+ and copied as raw JSON for the lazy property, it's parsed on first access.
+ 
+ @return NO if a JSON error occurs.
+ */
+static BOOL ModelSetLazyJSONForProperty(__unsafe_unretained id model,
+                                        __unsafe_unretained _YYModelPropertyMeta *meta,
+                                        YYJSONReader *r) {
+    YYJSONSkipSpace(r);
+    if (r->cur >= r->end) return NO;
+    if (*r->cur != '{' && *r->cur != '[') return ModelSetPropertyWithJSONReader(model, meta, r);
+    if (!ModelLazyCanKeepValue(model, meta)) return ModelSetPropertyWithJSONReader(model, meta, r);
+    const uint8_t *start = r->cur;
+    if (!YYJSONSkipValue(r)) return NO;
+    // only the bytes of the value are kept, not the whole JSON data
+    _YYModelLazyJSON *json = [_YYModelLazyJSON new];
+    json->_data = [NSData dataWithBytes:start length:r->cur - start];
+    ModelKeepLazyValue(model, meta, json);
+    return YES;
+}
+
+/**
+ Replace the accessors of the lazy property in the model class: the getter sets the
+ raw value to the property before returning, and the setter discards the raw value.
+ 
+ @return The pending state of the property, it's same for all metas of the class.
+ */
+static _YYModelLazyState *ModelSetupLazyAccessors(Class cls, _YYModelPropertyMeta *meta) {
+    static NSMutableDictionary *installed; // key: "class getter", value: _YYModelLazyState, the accessors are replaced once
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    NSString *key = [NSString stringWithFormat:@"%p %@", cls, meta->_name];
+    pthread_mutex_lock(&lock);
+    if (!installed) installed = [NSMutableDictionary new];
+    _YYModelLazyState *state = installed[key];
+    if (!state) {
+        state = [_YYModelLazyState new];
+        installed[key] = state;
+        meta->_lazyState = state; // used by the accessors
+        SEL getter = meta->_getter, setter = meta->_setter;
+        IMP getterImp = class_getMethodImplementation(cls, getter);
+        IMP setterImp = class_getMethodImplementation(cls, setter);
+        const char *getterTypes = method_getTypeEncoding(class_getInstanceMethod(cls, getter));
+        const char *setterTypes = method_getTypeEncoding(class_getInstanceMethod(cls, setter));
+        class_replaceMethod(cls, getter, imp_implementationWithBlock(^id(__unsafe_unretained id model) {
+            if (ModelLazyMayBePending(model, meta)) ModelMaterializeLazyProperty(model, meta);
+            return ((id (*)(id, SEL))(void *) getterImp)(model, getter);
+        }), getterTypes);
+        class_replaceMethod(cls, setter, imp_implementationWithBlock(^(__unsafe_unretained id model, __unsafe_unretained id value) {
+            if (ModelLazyMayBePending(model, meta)) {
+                // discard the raw value, and set the value with the lock held
+                pthread_mutex_t *lazyLock = ModelLazyLock(model);
+                pthread_mutex_lock(lazyLock);
+                BOOL discarded = ModelLazyTakeValue(model, meta) != nil;
+                ((void (*)(id, SEL, id))(void *) setterImp)(model, setter, value);
+                if (discarded) ModelLazyDidSetValue(model, meta);
+                pthread_mutex_unlock(lazyLock);
+            } else {
+                ((void (*)(id, SEL, id))(void *) setterImp)(model, setter, value);
+            }
+        }), setterTypes);
+    }
+    pthread_mutex_unlock(&lock);
+    return state;
+}
+
+
+/**
+ Returns a valid JSON object (NSArray/NSDictionary/NSString/NSNumber/NSNull), 
+ or nil if an error occurs.
+ 
+ @param model Model, can be nil.
+ @return JSON object, nil if an error occurs.
+ */
+static id ModelToJSONObjectRecursive(NSObject *model) {
+    if (!model || model == (id)kCFNull) return model;
+    if ([model isKindOfClass:[NSString class]]) return model;
+    if ([model isKindOfClass:[NSNumber class]]) return model;
+    if ([model isKindOfClass:[NSDictionary class]]) {
+        if ([NSJSONSerialization isValidJSONObject:model]) return model;
+        NSMutableDictionary *newDic = [NSMutableDictionary new];
+        [((NSDictionary *)model) enumerateKeysAndObjectsUsingBlock:^(NSString *key, id obj, BOOL *stop) {
+            NSString *stringKey = [key isKindOfClass:[NSString class]] ? key : key.description;
+            if (!stringKey) return;
+            id jsonObj = ModelToJSONObjectRecursive(obj);
+            if (!jsonObj) jsonObj = (id)kCFNull;
+            newDic[stringKey] = jsonObj;
+        }];
+        return newDic;
+    }
+    if ([model isKindOfClass:[NSSet class]]) {
+        NSArray *array = ((NSSet *)model).allObjects;
+        if ([NSJSONSerialization isValidJSONObject:array]) return array;
+        NSMutableArray *newArray = [NSMutableArray new];
+        for (id obj in array) {
+            if ([obj isKindOfClass:[NSString class]] || [obj isKindOfClass:[NSNumber class]]) {
+                [newArray addObject:obj];
+            } else {
+                id jsonObj = ModelToJSONObjectRecursive(obj);
+                if (jsonObj && jsonObj != (id)kCFNull) [newArray addObject:jsonObj];
+            }
+        }
+        return newArray;
+    }
+    if ([model isKindOfClass:[NSArray class]]) {
+        if ([NSJSONSerialization isValidJSONObject:model]) return model;
+        NSMutableArray *newArray = [NSMutableArray new];
         for (id obj in (NSArray *)model) {
             if ([obj isKindOfClass:[NSString class]] || [obj isKindOfClass:[NSNumber class]]) {
                 [newArray addObject:obj];
@@ -1416,7 +3135,7 @@ static id ModelToJSONObjectRecursive(NSObject *model) {
     }
     if ([model isKindOfClass:[NSURL class]]) return ((NSURL *)model).absoluteString;
     if ([model isKindOfClass:[NSAttributedString class]]) return ((NSAttributedString *)model).string;
-    if ([model isKindOfClass:[NSDate class]]) return [YYISODateFormatter() stringFromDate:(id)model];
+    if ([model isKindOfClass:[NSDate class]]) return YYISOStringFromDate((id)model);
     if ([model isKindOfClass:[NSData class]]) return nil;
     
     
@@ -1431,12 +3150,12 @@ static id ModelToJSONObjectRecursive(NSObject *model) {
         if (propertyMeta->_isCNumber) {
             value = ModelCreateNumberFromProperty(model, propertyMeta);
         } else if (propertyMeta->_nsType) {
-            id v = ((id (*)(id, SEL))(void *) objc_msgSend)((id)model, propertyMeta->_getter);
+            id v = ModelGetObjectFromProperty(model, propertyMeta);
             value = ModelToJSONObjectRecursive(v);
         } else {
             switch (propertyMeta->_type & YYEncodingTypeMask) {
                 case YYEncodingTypeObject: {
-                    id v = ((id (*)(id, SEL))(void *) objc_msgSend)((id)model, propertyMeta->_getter);
+                    id v = ModelGetObjectFromProperty(model, propertyMeta);
                     value = ModelToJSONObjectRecursive(v);
                     if (value == (id)kCFNull) value = nil;
                 } break;
@@ -1483,15 +3202,501 @@ static id ModelToJSONObjectRecursive(NSObject *model) {
                 dic[propertyMeta->_mappedToKey] = value;
             }
         }
-    }];
-    
-    if (modelMeta->_hasCustomTransformToDictionary) {
-        BOOL suc = [((id<YYModel>)model) modelCustomTransformToDictionary:dic];
-        if (!suc) return nil;
+    }];
+    
+    if (modelMeta->_hasCustomTransformToDictionary) {
+        BOOL suc = [((id<YYModel>)model) modelCustomTransformToDictionary:dic];
+        if (!suc) return nil;
+    }
+    return result;
+}
+
+#pragma mark - JSON Writer
+
+/**
+ A UTF-8 JSON writer, which writes models (and Foundation objects) to JSON data
+ directly, without creating the intermediate dictionaries and arrays.
+ The output is same as `ModelToJSONObjectRecursive()` + `NSJSONSerialization`.
+ */
+typedef struct {
+    uint8_t *buffer;        ///< output buffer
+    size_t length;          ///< bytes written
+    size_t capacity;        ///< buffer size
+    uint8_t *scratch;       ///< buffer for the UTF-8 bytes of strings, or NULL
+    size_t scratchSize;     ///< scratch buffer size
+    NSUInteger depth;       ///< current nesting depth
+} YYJSONWriter;
+
+static int YYJSONWriteObject(YYJSONWriter *w, __unsafe_unretained id object, BOOL *valid);
+
+static force_inline BOOL YYJSONWriterReserve(YYJSONWriter *w, size_t size) {
+    if (w->capacity - w->length >= size) return YES;
+    size_t newCapacity = w->capacity ? w->capacity : 1024;
+    while (newCapacity - w->length < size) newCapacity *= 2;
+    uint8_t *buffer = realloc(w->buffer, newCapacity);
+    if (!buffer) return NO;
+    w->buffer = buffer;
+    w->capacity = newCapacity;
+    return YES;
+}
+
+static force_inline BOOL YYJSONWriteBytes(YYJSONWriter *w, const void *bytes, size_t length) {
+    if (!YYJSONWriterReserve(w, length)) return NO;
+    memcpy(w->buffer + w->length, bytes, length);
+    w->length += length;
+    return YES;
+}
+
+static force_inline BOOL YYJSONWriteByte(YYJSONWriter *w, uint8_t byte) {
+    if (!YYJSONWriterReserve(w, 1)) return NO;
+    w->buffer[w->length++] = byte;
+    return YES;
+}
+
+/// Whether any of the 8 bytes should be escaped: control character, '"', '\' or '/'.
+static force_inline BOOL YYJSONWordNeedsEscape(uint64_t x) {
+    const uint64_t ones = 0x0101010101010101ULL, highs = 0x8080808080808080ULL;
+    uint64_t quote = x ^ (ones * '"'), backslash = x ^ (ones * '\\'), slash = x ^ (ones * '/');
+    uint64_t t = ((x - ones * 0x20) & ~x) |
+                 ((quote - ones) & ~quote) |
+                 ((backslash - ones) & ~backslash) |
+                 ((slash - ones) & ~slash);
+    return (t & highs) != 0;
+}
+
+/// Write UTF-8 bytes as JSON string with quotes, escaped as NSJSONSerialization.
+static BOOL YYJSONWriteUTF8String(YYJSONWriter *w, const uint8_t *str, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    if (length > (SIZE_MAX - 2) / 6) return NO;
+    if (!YYJSONWriterReserve(w, length * 6 + 2)) return NO;
+    uint8_t *cur = w->buffer + w->length;
+    const uint8_t *end = str + length;
+    *cur++ = '"';
+    while (str < end) {
+        // 8 bytes at a time, most of the strings need no escape
+        if (end - str >= 8) {
+            uint64_t word;
+            memcpy(&word, str, 8);
+            if (!YYJSONWordNeedsEscape(word)) {
+                memcpy(cur, str, 8);
+                cur += 8;
+                str += 8;
+                continue;
+            }
+        }
+        const uint8_t *wordEnd = (end - str >= 8) ? str + 8 : end;
+        while (str < wordEnd) {
+            uint8_t c = *str++;
+            if (c >= 0x20 && c != '"' && c != '\\' && c != '/') {
+                *cur++ = c;
+                continue;
+            }
+            *cur++ = '\\';
+            switch (c) {
+                case '"': *cur++ = '"'; break;
+                case '\\': *cur++ = '\\'; break;
+                case '/': *cur++ = '/'; break;
+                case '\b': *cur++ = 'b'; break;
+                case '\f': *cur++ = 'f'; break;
+                case '\n': *cur++ = 'n'; break;
+                case '\r': *cur++ = 'r'; break;
+                case '\t': *cur++ = 't'; break;
+                default: {
+                    *cur++ = 'u'; *cur++ = '0'; *cur++ = '0';
+                    *cur++ = hex[c >> 4]; *cur++ = hex[c & 0xF];
+                } break;
+            }
+        }
+    }
+    *cur++ = '"';
+    w->length = cur - w->buffer;
+    return YES;
+}
+
+static BOOL YYJSONWriteString(YYJSONWriter *w, __unsafe_unretained NSString *string) {
+    CFStringRef str = (__bridge CFStringRef)string;
+    CFIndex length = CFStringGetLength(str);
+    const char *cstr = CFStringGetCStringPtr(str, kCFStringEncodingUTF8);
+    if (cstr && strlen(cstr) == (size_t)length) {
+        return YYJSONWriteUTF8String(w, (const uint8_t *)cstr, length);
+    }
+    CFIndex maxSize = CFStringGetMaximumSizeForEncoding(length, kCFStringEncodingUTF8);
+    if (maxSize == kCFNotFound) return NO;
+    if (w->scratchSize < (size_t)maxSize) {
+        size_t newSize = w->scratchSize ? w->scratchSize : 256;
+        while (newSize < (size_t)maxSize) newSize *= 2;
+        uint8_t *scratch = realloc(w->scratch, newSize);
+        if (!scratch) return NO;
+        w->scratch = scratch;
+        w->scratchSize = newSize;
+    }
+    CFIndex used = 0;
+    CFIndex converted = CFStringGetBytes(str, CFRangeMake(0, length), kCFStringEncodingUTF8, 0, false, w->scratch, maxSize, &used);
+    if (converted != length) return NO;
+    return YYJSONWriteUTF8String(w, w->scratch, used);
+}
+
+static const char YYJSONDigitPairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static force_inline BOOL YYJSONWriteUInt64(YYJSONWriter *w, uint64_t value, BOOL negative) {
+    char buf[24];
+    char *cur = buf + sizeof(buf);
+    while (value >= 100) {
+        unsigned pair = (unsigned)(value % 100);
+        value /= 100;
+        cur -= 2;
+        memcpy(cur, YYJSONDigitPairs + pair * 2, 2);
+    }
+    if (value < 10) {
+        *--cur = '0' + (char)value;
+    } else {
+        cur -= 2;
+        memcpy(cur, YYJSONDigitPairs + value * 2, 2);
+    }
+    if (negative) *--cur = '-';
+    return YYJSONWriteBytes(w, cur, buf + sizeof(buf) - cur);
+}
+
+static force_inline BOOL YYJSONWriteInt64(YYJSONWriter *w, int64_t value) {
+    if (value < 0) return YYJSONWriteUInt64(w, 0 - (uint64_t)value, YES);
+    return YYJSONWriteUInt64(w, value, NO);
+}
+
+/// Write the shortest string which is parsed to the same double, returns NO for NaN or infinity.
+static BOOL YYJSONWriteDouble(YYJSONWriter *w, double value) {
+    if (isnan(value) || isinf(value)) return NO;
+    if (fabs(value) < 9007199254740992.0 && value == (double)(int64_t)value) { // 2^53
+        return YYJSONWriteInt64(w, (int64_t)value);
+    }
+    char buf[32];
+    int length = 0;
+    for (int precision = 15; precision <= 17; precision++) {
+        length = snprintf(buf, sizeof(buf), "%.*g", precision, value);
+        if (precision == 17 || strtod(buf, NULL) == value) break;
+    }
+    if (length <= 0 || length >= (int)sizeof(buf)) return NO;
+    return YYJSONWriteBytes(w, buf, length);
+}
+
+/// Write number, returns NO for NaN or infinity (invalid JSON).
+static BOOL YYJSONWriteNumber(YYJSONWriter *w, __unsafe_unretained NSNumber *number) {
+    CFNumberRef num = (__bridge CFNumberRef)number;
+    if (num == (CFNumberRef)kCFBooleanTrue) return YYJSONWriteBytes(w, "true", 4);
+    if (num == (CFNumberRef)kCFBooleanFalse) return YYJSONWriteBytes(w, "false", 5);
+    if ([number isKindOfClass:[NSDecimalNumber class]]) {
+        const char *str = number.stringValue.UTF8String;
+        if (!str || !(str[0] == '-' || (str[0] >= '0' && str[0] <= '9'))) return NO; // NaN
+        return YYJSONWriteBytes(w, str, strlen(str));
+    }
+    const char *type = number.objCType;
+    switch (type ? type[0] : 0) {
+        case 'f':
+        case 'd': return YYJSONWriteDouble(w, number.doubleValue);
+        case 'Q':
+        case 'L':
+        case 'I':
+        case 'S':
+        case 'C': return YYJSONWriteUInt64(w, number.unsignedLongLongValue, NO);
+        default: return YYJSONWriteInt64(w, number.longLongValue);
+    }
+}
+
+/// Write a valid JSON object as is, returns NO if the object is not valid JSON
+/// (see [NSJSONSerialization isValidJSONObject:]).
+static BOOL YYJSONWriteValidObject(YYJSONWriter *w, __unsafe_unretained id object) {
+    if (object == (id)kCFNull) return YYJSONWriteBytes(w, "null", 4);
+    if ([object isKindOfClass:[NSString class]]) return YYJSONWriteString(w, object);
+    if ([object isKindOfClass:[NSNumber class]]) return YYJSONWriteNumber(w, object);
+    if (w->depth >= YY_JSON_MAX_DEPTH) return NO;
+    if ([object isKindOfClass:[NSArray class]]) {
+        if (!YYJSONWriteByte(w, '[')) return NO;
+        w->depth++;
+        BOOL first = YES;
+        for (id one in (NSArray *)object) {
+            if (!first && !YYJSONWriteByte(w, ',')) return NO;
+            first = NO;
+            if (!YYJSONWriteValidObject(w, one)) return NO;
+        }
+        w->depth--;
+        return YYJSONWriteByte(w, ']');
+    }
+    if ([object isKindOfClass:[NSDictionary class]]) {
+        if (!YYJSONWriteByte(w, '{')) return NO;
+        w->depth++;
+        BOOL first = YES;
+        for (id key in (NSDictionary *)object) {
+            if (![key isKindOfClass:[NSString class]]) return NO;
+            if (!first && !YYJSONWriteByte(w, ',')) return NO;
+            first = NO;
+            if (!YYJSONWriteString(w, key)) return NO;
+            if (!YYJSONWriteByte(w, ':')) return NO;
+            if (!YYJSONWriteValidObject(w, ((NSDictionary *)object)[key])) return NO;
+        }
+        w->depth--;
+        return YYJSONWriteByte(w, '}');
+    }
+    return NO;
+}
+
+/**
+ Write the array as `ModelToJSONObjectRecursive()`: a valid JSON array is written
+ as is, otherwise the elements are converted, and the nil and NSNull are removed.
+ */
+static int YYJSONWriteArray(YYJSONWriter *w, __unsafe_unretained NSArray *array, BOOL *valid) {
+    if (!YYJSONWriteByte(w, '[')) return -1;
+    size_t start = w->length;
+    BOOL isValid = YES, hasNull = NO;
+    NSUInteger i = 0, count = array.count;
+    for (; i < count; i++) {
+        __unsafe_unretained id one = array[i];
+        size_t mark = w->length;
+        if (mark != start && !YYJSONWriteByte(w, ',')) return -1;
+        BOOL oneValid = NO;
+        int result = YYJSONWriteObject(w, one, &oneValid);
+        if (result < 0) return -1;
+        if (oneValid) {
+            if (one == (id)kCFNull) hasNull = YES;
+            continue;
+        }
+        // not a valid JSON array, rewrite it if there's NSNull written
+        isValid = NO;
+        if (hasNull) {
+            w->length = start;
+            i = 0;
+        } else {
+            if (result == 0) w->length = mark;
+            i++;
+        }
+        break;
+    }
+    if (!isValid) {
+        for (; i < count; i++) {
+            __unsafe_unretained id one = array[i];
+            size_t mark = w->length;
+            if (mark != start && !YYJSONWriteByte(w, ',')) return -1;
+            BOOL oneValid = NO;
+            int result = YYJSONWriteObject(w, one, &oneValid);
+            if (result < 0) return -1;
+            if (result == 0 || one == (id)kCFNull) w->length = mark;
+        }
+    }
+    if (!YYJSONWriteByte(w, ']')) return -1;
+    *valid = isValid;
+    return 1;
+}
+
+typedef struct {
+    YYJSONWriter *writer;
+    size_t start;
+    BOOL valid;
+    BOOL failed;
+} YYJSONDictionaryContext;
+
+static BOOL YYJSONWriteDictionaryEntry(YYJSONDictionaryContext *context,
+                                       __unsafe_unretained id key,
+                                       __unsafe_unretained id value) {
+    YYJSONWriter *w = context->writer;
+    NSString *stringKey = key;
+    if (![key isKindOfClass:[NSString class]]) {
+        context->valid = NO;
+        stringKey = [key description];
+        if (!stringKey) return YES;
+    }
+    if (w->length != context->start && !YYJSONWriteByte(w, ',')) return NO;
+    if (!YYJSONWriteString(w, stringKey) || !YYJSONWriteByte(w, ':')) return NO;
+    BOOL valueValid = NO;
+    int result = YYJSONWriteObject(w, value, &valueValid);
+    if (result < 0) return NO;
+    if (result == 0 && !YYJSONWriteBytes(w, "null", 4)) return NO;
+    if (!valueValid) context->valid = NO;
+    return YES;
+}
+
+static void YYJSONWriteDictionaryFunction(const void *_key, const void *_value, void *_context) {
+    YYJSONDictionaryContext *context = _context;
+    if (context->failed) return;
+    if (!YYJSONWriteDictionaryEntry(context, (__bridge id)_key, (__bridge id)_value)) {
+        context->failed = YES;
+    }
+}
+
+/// Write the dictionary as `ModelToJSONObjectRecursive()`, the nil values are written as null.
+static int YYJSONWriteDictionary(YYJSONWriter *w, __unsafe_unretained NSDictionary *dic, BOOL *valid) {
+    if (!YYJSONWriteByte(w, '{')) return -1;
+    YYJSONDictionaryContext context = {0};
+    context.writer = w;
+    context.start = w->length;
+    context.valid = YES;
+    CFDictionaryApplyFunction((CFDictionaryRef)dic, YYJSONWriteDictionaryFunction, &context);
+    if (context.failed) return -1;
+    if (!YYJSONWriteByte(w, '}')) return -1;
+    *valid = context.valid;
+    return 1;
+}
+
+/// Write the value of property as `ModelToJSONObjectRecursive()`, returns 0 if the value is nil.
+static int YYJSONWriteProperty(YYJSONWriter *w,
+                               __unsafe_unretained id model,
+                               __unsafe_unretained _YYModelPropertyMeta *propertyMeta) {
+    if (propertyMeta->_isCNumber) {
+        NSNumber *num = ModelCreateNumberFromProperty(model, propertyMeta);
+        if (!num) return 0;
+        return YYJSONWriteNumber(w, num) ? 1 : -1;
+    }
+    BOOL valid = NO;
+    if (propertyMeta->_nsType) {
+        id v = ModelGetObjectFromProperty(model, propertyMeta);
+        return YYJSONWriteObject(w, v, &valid);
+    }
+    switch (propertyMeta->_type & YYEncodingTypeMask) {
+        case YYEncodingTypeObject: {
+            id v = ModelGetObjectFromProperty(model, propertyMeta);
+            if (v == (id)kCFNull) return 0;
+            return YYJSONWriteObject(w, v, &valid);
+        }
+        case YYEncodingTypeClass: {
+            Class v = ((Class (*)(id, SEL))(void *) objc_msgSend)((id)model, propertyMeta->_getter);
+            if (!v) return 0;
+            return YYJSONWriteString(w, NSStringFromClass(v)) ? 1 : -1;
+        }
+        case YYEncodingTypeSEL: {
+            SEL v = ((SEL (*)(id, SEL))(void *) objc_msgSend)((id)model, propertyMeta->_getter);
+            if (!v) return 0;
+            return YYJSONWriteString(w, NSStringFromSelector(v)) ? 1 : -1;
+        }
+        default: return 0;
+    }
+}
+
+/// Write the key and value, returns 0 (and nothing is written) if the value is nil,
+/// or the key path node has no value.
+static int YYJSONWriteModelKey(YYJSONWriter *w,
+                               __unsafe_unretained id model,
+                               __unsafe_unretained _YYModelJSONKey *key) {
+    size_t mark = w->length;
+    if (w->buffer[mark - 1] != '{' && !YYJSONWriteByte(w, ',')) return -1;
+    if (!YYJSONWriteBytes(w, key->_json.bytes, key->_json.length)) return -1;
+    int result = 0;
+    if (key->_propertyMeta) {
+        result = YYJSONWriteProperty(w, model, key->_propertyMeta);
+    } else {
+        if (!YYJSONWriteByte(w, '{')) return -1;
+        for (_YYModelJSONKey *child in key->_children) {
+            int childResult = YYJSONWriteModelKey(w, model, child);
+            if (childResult < 0) return -1;
+            if (childResult > 0) result = 1;
+        }
+        if (result > 0 && !YYJSONWriteByte(w, '}')) return -1;
+    }
+    if (result == 0) w->length = mark;
+    return result;
+}
+
+/// Write the model as `ModelToJSONObjectRecursive()`, returns 0 if the model creates nil.
+static int YYJSONWriteModel(YYJSONWriter *w, __unsafe_unretained id model) {
+    _YYModelMeta *modelMeta = [_YYModelMeta metaWithClass:[model class]];
+    if (!modelMeta || modelMeta->_keyMappedCount == 0) return 0;
+    if (modelMeta->_hasCustomTransformToDictionary || !modelMeta->_jsonKeys) {
+        // the dictionary should be created, it's checked by isValidJSONObject: as is
+        id json = ModelToJSONObjectRecursive(model);
+        if (!json) return 0;
+        return YYJSONWriteValidObject(w, json) ? 1 : -1;
+    }
+    if (!YYJSONWriteByte(w, '{')) return -1;
+    for (_YYModelJSONKey *key in modelMeta->_jsonKeys) {
+        if (YYJSONWriteModelKey(w, model, key) < 0) return -1;
+    }
+    if (!YYJSONWriteByte(w, '}')) return -1;
+    return 1;
+}
+
+/**
+ Write an object as `ModelToJSONObjectRecursive()`.
+
+ @param valid Output whether the object is valid JSON object (written as is).
+ @return 1 if written, 0 if the object is converted to nil (nothing is written),
+ or -1 if an error occurs or the result is invalid JSON.
+ */
+static int YYJSONWriteObject(YYJSONWriter *w, __unsafe_unretained id object, BOOL *valid) {
+    *valid = NO;
+    if (!object) return 0;
+    if (object == (id)kCFNull) {
+        *valid = YES;
+        return YYJSONWriteBytes(w, "null", 4) ? 1 : -1;
+    }
+    if ([object isKindOfClass:[NSString class]]) {
+        *valid = YES;
+        return YYJSONWriteString(w, object) ? 1 : -1;
+    }
+    if ([object isKindOfClass:[NSNumber class]]) {
+        *valid = YES;
+        return YYJSONWriteNumber(w, object) ? 1 : -1;
+    }
+    if (w->depth >= YY_JSON_MAX_DEPTH) return -1;
+    int result = 0;
+    w->depth++;
+    if ([object isKindOfClass:[NSDictionary class]]) {
+        result = YYJSONWriteDictionary(w, object, valid);
+    } else if ([object isKindOfClass:[NSSet class]]) {
+        result = YYJSONWriteArray(w, ((NSSet *)object).allObjects, valid);
+        *valid = NO;
+    } else if ([object isKindOfClass:[NSArray class]]) {
+        result = YYJSONWriteArray(w, object, valid);
+    } else if ([object isKindOfClass:[NSURL class]]) {
+        NSString *string = ((NSURL *)object).absoluteString;
+        result = string ? (YYJSONWriteString(w, string) ? 1 : -1) : 0;
+    } else if ([object isKindOfClass:[NSAttributedString class]]) {
+        NSString *string = ((NSAttributedString *)object).string;
+        result = string ? (YYJSONWriteString(w, string) ? 1 : -1) : 0;
+    } else if ([object isKindOfClass:[NSDate class]]) {
+        NSString *string = YYISOStringFromDate(object);
+        result = string ? (YYJSONWriteString(w, string) ? 1 : -1) : 0;
+    } else if ([object isKindOfClass:[NSData class]]) {
+        result = 0;
+    } else {
+        result = YYJSONWriteModel(w, object);
     }
+    w->depth--;
     return result;
 }
 
+/// Escaped key with quotes and colon, used by `_YYModelJSONKey`.
+static NSData *YYJSONKeyData(NSString *key) {
+    YYJSONWriter writer = {0};
+    NSData *data = nil;
+    if (YYJSONWriteString(&writer, key) && YYJSONWriteByte(&writer, ':')) {
+        data = [NSData dataWithBytes:writer.buffer length:writer.length];
+    }
+    if (writer.buffer) free(writer.buffer);
+    if (writer.scratch) free(writer.scratch);
+    return data;
+}
+
+/**
+ Write the object to JSON data directly, same as `ModelToJSONObjectRecursive()` +
+ `NSJSONSerialization`. Returns nil if an error occurs or the result is not JSON
+ array or object, the caller should use the previous way in this case.
+ */
+static NSData *ModelCreateJSONData(__unsafe_unretained id object) {
+    YYJSONWriter writer = {0};
+    YYJSONWriter *w = &writer;
+    BOOL valid = NO;
+    int result = YYJSONWriteObject(w, object, &valid);
+    if (w->scratch) free(w->scratch);
+    if (result <= 0 || (w->buffer[0] != '{' && w->buffer[0] != '[')) {
+        if (w->buffer) free(w->buffer);
+        return nil;
+    }
+    uint8_t *buffer = realloc(w->buffer, w->length);
+    if (buffer) w->buffer = buffer;
+    return [[NSData alloc] initWithBytesNoCopy:w->buffer length:w->length freeWhenDone:YES];
+}
+
 /// Add indent to string (exclude first line)
 static NSMutableString *ModelDescriptionAddIndent(NSMutableString *desc, NSUInteger indent) {
     for (NSUInteger i = 0, max = desc.length; i < max; i++) {
@@ -1642,6 +3847,730 @@ static NSString *ModelDescription(NSObject *model) {
 }
 
 
+#pragma mark - Model Archive
+
+/// Max nesting depth of the values in model archive.
+#define YY_ARCHIVE_MAX_DEPTH 512
+
+/// Model archive header: magic "YYMA" and format version.
+static const uint8_t YYModelArchiveMagic[4] = {'Y', 'Y', 'M', 'A'};
+static const uint8_t YYModelArchiveVersion = 2;
+
+/**
+ Value type in model archive, each value starts with a type byte.
+
+ A model is written as: class index (varint), the class schema if the class
+ is first written in the archive (class name, field count, and the name hash
+ of each field), then the non-nil fields (varint field index + 1, value),
+ and a zero at last. The fields are matched by name hash when reading, so
+ the properties can be added, removed or reordered after the data is written.
+ If the name hash collides with another property of the class, the field is
+ written as hash 0 and the name string, and matched by name.
+ */
+typedef NS_ENUM(uint8_t, YYArchiveType) {
+    YYArchiveTypeNull = 0,      ///< nil or NSNull
+    YYArchiveTypeFalse,         ///< @NO
+    YYArchiveTypeTrue,          ///< @YES
+    YYArchiveTypeInt,           ///< zigzag varint
+    YYArchiveTypeUInt,          ///< varint, larger than INT64_MAX
+    YYArchiveTypeFloat,         ///< 4 bytes float, little endian
+    YYArchiveTypeDouble,        ///< 8 bytes double, little endian
+    YYArchiveTypeDecimal,       ///< NSDecimalNumber, string
+    YYArchiveTypeString,        ///< varint length + UTF-8 bytes
+    YYArchiveTypeData,          ///< varint length + bytes
+    YYArchiveTypeDate,          ///< 8 bytes double (since reference date), little endian
+    YYArchiveTypeURL,           ///< absolute string
+    YYArchiveTypeArray,         ///< varint count + values
+    YYArchiveTypeSet,           ///< varint count + values
+    YYArchiveTypeDictionary,    ///< varint count + (key, value) pairs
+    YYArchiveTypeModel,         ///< see above
+    YYArchiveTypeClass,         ///< class name, string
+    YYArchiveTypeSEL,           ///< selector name, string
+    YYArchiveTypeKeyed,         ///< NSKeyedArchiver data, for other objects which conform to NSSecureCoding
+};
+
+typedef struct {
+    uint8_t *buffer;            ///< output buffer
+    size_t length;              ///< bytes written
+    size_t capacity;            ///< buffer size
+    CFMutableDictionaryRef classIndexes; ///< Class -> class index in archive
+    CFMutableArrayRef schemas;  ///< Array<_YYModelPropertyMeta> for each class index
+    NSUInteger depth;           ///< current nesting depth
+    BOOL failed;                ///< memory error
+} YYArchiveWriter;
+
+static void YYArchiveWriteObject(YYArchiveWriter *w, __unsafe_unretained id object);
+
+static force_inline BOOL YYArchiveReserve(YYArchiveWriter *w, size_t size) {
+    if (w->capacity - w->length >= size) return YES;
+    if (w->failed) return NO;
+    size_t newCapacity = w->capacity ? w->capacity : 256;
+    while (newCapacity - w->length < size) newCapacity *= 2;
+    uint8_t *buffer = realloc(w->buffer, newCapacity);
+    if (!buffer) {
+        w->failed = YES;
+        return NO;
+    }
+    w->buffer = buffer;
+    w->capacity = newCapacity;
+    return YES;
+}
+
+static force_inline void YYArchiveWriteByte(YYArchiveWriter *w, uint8_t byte) {
+    if (!YYArchiveReserve(w, 1)) return;
+    w->buffer[w->length++] = byte;
+}
+
+static force_inline void YYArchiveWriteVarint(YYArchiveWriter *w, uint64_t value) {
+    if (!YYArchiveReserve(w, 10)) return;
+    uint8_t *cur = w->buffer + w->length;
+    while (value >= 0x80) {
+        *cur++ = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    *cur++ = (uint8_t)value;
+    w->length = cur - w->buffer;
+}
+
+static force_inline void YYArchiveWriteBytes(YYArchiveWriter *w, const void *bytes, size_t length) {
+    if (!YYArchiveReserve(w, length)) return;
+    if (length) memcpy(w->buffer + w->length, bytes, length);
+    w->length += length;
+}
+
+static force_inline void YYArchiveWriteFixed32(YYArchiveWriter *w, uint32_t value) {
+    value = CFSwapInt32HostToLittle(value);
+    YYArchiveWriteBytes(w, &value, 4);
+}
+
+static force_inline void YYArchiveWriteFixed64(YYArchiveWriter *w, uint64_t value) {
+    value = CFSwapInt64HostToLittle(value);
+    YYArchiveWriteBytes(w, &value, 8);
+}
+
+/// Write varint length + UTF-8 bytes, returns NO if the string can not be converted to UTF-8.
+static BOOL YYArchiveWriteString(YYArchiveWriter *w, __unsafe_unretained NSString *string) {
+    CFStringRef str = (__bridge CFStringRef)string;
+    CFIndex length = CFStringGetLength(str);
+    CFIndex maxSize = CFStringGetMaximumSizeForEncoding(length, kCFStringEncodingUTF8);
+    if (maxSize == kCFNotFound) return NO;
+
+    // convert into buffer directly, the length prefix is 1 byte for short string
+    size_t prefix = maxSize < 0x80 ? 1 : 10;
+    if (!YYArchiveReserve(w, prefix + maxSize)) return YES;
+    uint8_t *bytes = w->buffer + w->length + prefix;
+    CFIndex used = 0;
+    CFIndex converted = CFStringGetBytes(str, CFRangeMake(0, length), kCFStringEncodingUTF8, 0, false, bytes, maxSize, &used);
+    if (converted != length) return NO;
+
+    uint8_t head[10];
+    size_t headLength = 0;
+    uint64_t value = used;
+    while (value >= 0x80) {
+        head[headLength++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    head[headLength++] = (uint8_t)value;
+    if (headLength != prefix) memmove(w->buffer + w->length + headLength, bytes, used);
+    memcpy(w->buffer + w->length, head, headLength);
+    w->length += headLength + used;
+    return YES;
+}
+
+static void YYArchiveWriteNumber(YYArchiveWriter *w, __unsafe_unretained NSNumber *number) {
+    CFNumberRef num = (__bridge CFNumberRef)number;
+    if (num == (CFNumberRef)kCFBooleanTrue) {
+        YYArchiveWriteByte(w, YYArchiveTypeTrue);
+    } else if (num == (CFNumberRef)kCFBooleanFalse) {
+        YYArchiveWriteByte(w, YYArchiveTypeFalse);
+    } else if (CFNumberIsFloatType(num)) {
+        CFNumberType type = CFNumberGetType(num);
+        if (type == kCFNumberFloat32Type || type == kCFNumberFloatType) {
+            float f = number.floatValue;
+            uint32_t bits;
+            memcpy(&bits, &f, 4);
+            YYArchiveWriteByte(w, YYArchiveTypeFloat);
+            YYArchiveWriteFixed32(w, bits);
+        } else {
+            double d = number.doubleValue;
+            uint64_t bits;
+            memcpy(&bits, &d, 8);
+            YYArchiveWriteByte(w, YYArchiveTypeDouble);
+            YYArchiveWriteFixed64(w, bits);
+        }
+    } else {
+        const char *objCType = number.objCType;
+        if (objCType && (objCType[0] == 'Q' || objCType[0] == 'L') && number.unsignedLongLongValue > INT64_MAX) {
+            YYArchiveWriteByte(w, YYArchiveTypeUInt);
+            YYArchiveWriteVarint(w, number.unsignedLongLongValue);
+        } else {
+            int64_t value = number.longLongValue;
+            YYArchiveWriteByte(w, YYArchiveTypeInt);
+            YYArchiveWriteVarint(w, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+        }
+    }
+}
+
+/// Write an object with NSKeyedArchiver (secure coding), or null if the object can not be archived.
+static void YYArchiveWriteKeyed(YYArchiveWriter *w, __unsafe_unretained id object) {
+    NSMutableData *data = nil;
+    if ([object conformsToProtocol:@protocol(NSSecureCoding)]) {
+        data = [NSMutableData new];
+        NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc] initForWritingWithMutableData:data];
+        archiver.requiresSecureCoding = YES;
+        @try {
+            [archiver encodeObject:object forKey:NSKeyedArchiveRootObjectKey];
+            [archiver finishEncoding];
+        } @catch (NSException *exception) {
+            data = nil;
+        }
+    }
+    if (data) {
+        YYArchiveWriteByte(w, YYArchiveTypeKeyed);
+        YYArchiveWriteVarint(w, data.length);
+        YYArchiveWriteBytes(w, data.bytes, data.length);
+    } else {
+        YYArchiveWriteByte(w, YYArchiveTypeNull);
+    }
+}
+
+static void YYArchiveWriteModel(YYArchiveWriter *w, __unsafe_unretained id model, __unsafe_unretained _YYModelMeta *modelMeta) {
+    Class cls = [model class];
+    YYArchiveWriteByte(w, YYArchiveTypeModel);
+
+    // class index, and the class schema if the class is new in archive
+    NSArray *properties = nil;
+    const void *index = NULL;
+    if (CFDictionaryGetValueIfPresent(w->classIndexes, (__bridge const void *)(cls), &index)) {
+        YYArchiveWriteVarint(w, (uintptr_t)index);
+        properties = (__bridge NSArray *)CFArrayGetValueAtIndex(w->schemas, (CFIndex)index);
+    } else {
+        index = (const void *)(uintptr_t)CFArrayGetCount(w->schemas);
+        properties = modelMeta->_archivePropertyMetas ?: @[];
+        CFDictionarySetValue(w->classIndexes, (__bridge const void *)(cls), index);
+        CFArrayAppendValue(w->schemas, (__bridge const void *)(properties));
+        YYArchiveWriteVarint(w, (uintptr_t)index);
+        YYArchiveWriteString(w, NSStringFromClass(cls));
+        YYArchiveWriteVarint(w, properties.count);
+        for (_YYModelPropertyMeta *propertyMeta in properties) {
+            YYArchiveWriteFixed32(w, propertyMeta->_archiveHash);
+            if (propertyMeta->_archiveHash == 0) YYArchiveWriteString(w, propertyMeta->_name);
+        }
+    }
+
+    // fields
+    NSUInteger field = 0;
+    for (_YYModelPropertyMeta *propertyMeta in properties) {
+        field++;
+        if (propertyMeta->_isCNumber) {
+            NSNumber *num = ModelCreateNumberFromProperty(model, propertyMeta);
+            if (!num) continue;
+            YYArchiveWriteVarint(w, field);
+            YYArchiveWriteNumber(w, num);
+            continue;
+        }
+        switch (propertyMeta->_type & YYEncodingTypeMask) {
+            case YYEncodingTypeObject: {
+                id value = ModelGetObjectFromProperty(model, propertyMeta);
+                if (!value) break;
+                YYArchiveWriteVarint(w, field);
+                YYArchiveWriteObject(w, value);
+            } break;
+            case YYEncodingTypeClass: {
+                Class value = ((Class (*)(id, SEL))(void *) objc_msgSend)((id)model, propertyMeta->_getter);
+                if (!value) break;
+                YYArchiveWriteVarint(w, field);
+                YYArchiveWriteByte(w, YYArchiveTypeClass);
+                YYArchiveWriteString(w, NSStringFromClass(value));
+            } break;
+            case YYEncodingTypeSEL: {
+                SEL value = ((SEL (*)(id, SEL))(void *) objc_msgSend)((id)model, propertyMeta->_getter);
+                if (!value) break;
+                YYArchiveWriteVarint(w, field);
+                YYArchiveWriteByte(w, YYArchiveTypeSEL);
+                YYArchiveWriteString(w, NSStringFromSelector(value));
+            } break;
+            case YYEncodingTypeStruct:
+            case YYEncodingTypeUnion: {
+                NSValue *value = nil;
+                @try {
+                    value = [model valueForKey:propertyMeta->_name];
+                } @catch (NSException *exception) {}
+                if (!value) break;
+                YYArchiveWriteVarint(w, field);
+                YYArchiveWriteKeyed(w, value);
+            } break;
+            default: break;
+        }
+    }
+    YYArchiveWriteVarint(w, 0);
+}
+
+static void YYArchiveWriteObject(YYArchiveWriter *w, __unsafe_unretained id object) {
+    if (!object || object == (id)kCFNull || w->depth >= YY_ARCHIVE_MAX_DEPTH) {
+        YYArchiveWriteByte(w, YYArchiveTypeNull);
+        return;
+    }
+    Class cls = object_getClass(object);
+    if (class_isMetaClass(cls)) {
+        YYArchiveWriteByte(w, YYArchiveTypeClass);
+        YYArchiveWriteString(w, NSStringFromClass(object));
+        return;
+    }
+
+    w->depth++;
+    switch (YYClassGetNSType(cls)) {
+        case YYEncodingTypeNSString:
+        case YYEncodingTypeNSMutableString: {
+            size_t length = w->length;
+            YYArchiveWriteByte(w, YYArchiveTypeString);
+            if (!YYArchiveWriteString(w, object)) {
+                w->length = length;
+                YYArchiveWriteKeyed(w, object);
+            }
+        } break;
+        case YYEncodingTypeNSNumber: {
+            YYArchiveWriteNumber(w, object);
+        } break;
+        case YYEncodingTypeNSDecimalNumber: {
+            YYArchiveWriteByte(w, YYArchiveTypeDecimal);
+            YYArchiveWriteString(w, ((NSDecimalNumber *)object).stringValue);
+        } break;
+        case YYEncodingTypeNSData:
+        case YYEncodingTypeNSMutableData: {
+            NSData *data = object;
+            YYArchiveWriteByte(w, YYArchiveTypeData);
+            YYArchiveWriteVarint(w, data.length);
+            YYArchiveWriteBytes(w, data.bytes, data.length);
+        } break;
+        case YYEncodingTypeNSDate: {
+            double time = ((NSDate *)object).timeIntervalSinceReferenceDate;
+            uint64_t bits;
+            memcpy(&bits, &time, 8);
+            YYArchiveWriteByte(w, YYArchiveTypeDate);
+            YYArchiveWriteFixed64(w, bits);
+        } break;
+        case YYEncodingTypeNSURL: {
+            NSString *string = ((NSURL *)object).absoluteString;
+            if (string) {
+                YYArchiveWriteByte(w, YYArchiveTypeURL);
+                YYArchiveWriteString(w, string);
+            } else {
+                YYArchiveWriteByte(w, YYArchiveTypeNull);
+            }
+        } break;
+        case YYEncodingTypeNSArray:
+        case YYEncodingTypeNSMutableArray:
+        case YYEncodingTypeNSSet:
+        case YYEncodingTypeNSMutableSet: {
+            BOOL isSet = [object isKindOfClass:[NSSet class]];
+            YYArchiveWriteByte(w, isSet ? YYArchiveTypeSet : YYArchiveTypeArray);
+            YYArchiveWriteVarint(w, [object count]);
+            for (id one in object) {
+                YYArchiveWriteObject(w, one);
+            }
+        } break;
+        case YYEncodingTypeNSDictionary:
+        case YYEncodingTypeNSMutableDictionary: {
+            YYArchiveWriteByte(w, YYArchiveTypeDictionary);
+            YYArchiveWriteVarint(w, [object count]);
+            [((NSDictionary *)object) enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+                YYArchiveWriteObject(w, key);
+                YYArchiveWriteObject(w, obj);
+            }];
+        } break;
+        case YYEncodingTypeNSValue: {
+            YYArchiveWriteKeyed(w, object);
+        } break;
+        default: {
+            if ([object isKindOfClass:YYNSBlockClass()]) {
+                YYArchiveWriteByte(w, YYArchiveTypeNull);
+                break;
+            }
+            // an object without archivable property is not a model, such as UIColor
+            _YYModelMeta *modelMeta = [_YYModelMeta metaWithClass:[object class]];
+            if (modelMeta && !modelMeta->_nsType && modelMeta->_archivePropertyMetas) {
+                YYArchiveWriteModel(w, object, modelMeta);
+            } else {
+                YYArchiveWriteKeyed(w, object);
+            }
+        } break;
+    }
+    w->depth--;
+}
+
+/// Archive an object (model, or Foundation object which contains models) to data.
+static NSData *YYModelArchiveCreateData(__unsafe_unretained id object) {
+    YYArchiveWriter writer = {0};
+    YYArchiveWriter *w = &writer;
+    w->classIndexes = CFDictionaryCreateMutable(CFAllocatorGetDefault(), 0, NULL, NULL);
+    w->schemas = CFArrayCreateMutable(CFAllocatorGetDefault(), 0, &kCFTypeArrayCallBacks);
+    YYArchiveWriteBytes(w, YYModelArchiveMagic, sizeof(YYModelArchiveMagic));
+    YYArchiveWriteByte(w, YYModelArchiveVersion);
+    YYArchiveWriteObject(w, object);
+    CFRelease(w->classIndexes);
+    CFRelease(w->schemas);
+    if (w->failed) {
+        if (w->buffer) free(w->buffer);
+        return nil;
+    }
+    return [[NSData alloc] initWithBytesNoCopy:w->buffer length:w->length freeWhenDone:YES];
+}
+
+
+/// A class schema read from model archive.
+@interface _YYModelArchiveSchema : NSObject {
+    @package
+    Class _cls;             ///< model class, or nil if the class is not found
+    NSUInteger _fieldCount; ///< field count
+    NSArray *_fields;       ///< _YYModelPropertyMeta of each field, or NSNull if it's not found in model
+}
+@end
+
+@implementation _YYModelArchiveSchema
+@end
+
+typedef struct {
+    const uint8_t *cur;         ///< current position
+    const uint8_t *end;         ///< end of the data
+    CFMutableArrayRef schemas;  ///< _YYModelArchiveSchema for each class index
+    NSUInteger depth;           ///< current nesting depth
+    NSUInteger modelDepth;      ///< current nesting depth of models
+    __unsafe_unretained Class rootClass; ///< the class which a root model must be kind of
+    __unsafe_unretained _YYModelPropertyMeta *property; ///< the property which is being read, or nil
+} YYArchiveReader;
+
+static id YYArchiveReadObject(YYArchiveReader *r);
+
+/// Whether the class is the superclass or a subclass of it (without sending message to the class).
+static force_inline BOOL YYClassIsKindOfClass(Class cls, Class superclass) {
+    if (!superclass) return NO;
+    for (; cls; cls = class_getSuperclass(cls)) {
+        if (cls == superclass) return YES;
+    }
+    return NO;
+}
+
+/**
+ Whether a model of the class can be created at current position: a root model
+ must be kind of the root class, and a nested model must be kind of the property's
+ class (or generic class). The model in an unknown field is not allowed.
+ */
+static force_inline BOOL YYArchiveModelClassIsAllowed(YYArchiveReader *r, Class cls) {
+    if (!cls) return NO;
+    __unsafe_unretained _YYModelPropertyMeta *property = r->property;
+    if (!property) return r->modelDepth == 0 && YYClassIsKindOfClass(cls, r->rootClass);
+    return YYClassIsKindOfClass(cls, property->_cls) || YYClassIsKindOfClass(cls, property->_genericCls);
+}
+
+/**
+ The classes which are allowed to be decoded from the NSKeyedArchiver data:
+ the common Foundation value classes, and the class (and generic class) of the
+ property which is being read.
+ */
+static NSSet *YYArchiveKeyedClasses(__unsafe_unretained _YYModelPropertyMeta *property) {
+    static NSSet *defaultClasses;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        defaultClasses = [NSSet setWithObjects:[NSString class], [NSAttributedString class], [NSNumber class],
+                          [NSValue class], [NSData class], [NSDate class], [NSURL class], [NSNull class],
+                          [NSArray class], [NSDictionary class], [NSSet class], [NSOrderedSet class],
+                          [NSIndexSet class], [NSUUID class], [NSLocale class], [NSTimeZone class], nil];
+    });
+    if (!property || (!property->_cls && !property->_genericCls)) return defaultClasses;
+    NSMutableSet *classes = defaultClasses.mutableCopy;
+    if (property->_cls) [classes addObject:property->_cls];
+    if (property->_genericCls) [classes addObject:property->_genericCls];
+    return classes;
+}
+
+static force_inline BOOL YYArchiveReadVarint(YYArchiveReader *r, uint64_t *value) {
+    const uint8_t *cur = r->cur, *end = r->end;
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64 && cur < end; shift += 7) {
+        uint8_t byte = *cur++;
+        v |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            r->cur = cur;
+            *value = v;
+            return YES;
+        }
+    }
+    return NO;
+}
+
+static force_inline BOOL YYArchiveReadFixed32(YYArchiveReader *r, uint32_t *value) {
+    if (r->end - r->cur < 4) return NO;
+    uint32_t v;
+    memcpy(&v, r->cur, 4);
+    r->cur += 4;
+    *value = CFSwapInt32LittleToHost(v);
+    return YES;
+}
+
+static force_inline BOOL YYArchiveReadFixed64(YYArchiveReader *r, uint64_t *value) {
+    if (r->end - r->cur < 8) return NO;
+    uint64_t v;
+    memcpy(&v, r->cur, 8);
+    r->cur += 8;
+    *value = CFSwapInt64LittleToHost(v);
+    return YES;
+}
+
+/// Read varint length + bytes, returns NO if the data is truncated.
+static force_inline BOOL YYArchiveReadBytes(YYArchiveReader *r, const uint8_t **bytes, size_t *length) {
+    uint64_t len;
+    if (!YYArchiveReadVarint(r, &len)) return NO;
+    if (len > (uint64_t)(r->end - r->cur)) return NO;
+    *bytes = r->cur;
+    *length = (size_t)len;
+    r->cur += len;
+    return YES;
+}
+
+/// Read a string, returns nil if an error occurs.
+static force_inline NSString *YYArchiveReadString(YYArchiveReader *r) {
+    const uint8_t *bytes;
+    size_t length;
+    if (!YYArchiveReadBytes(r, &bytes, &length)) return nil;
+    if (length == 0) return @"";
+    return CFBridgingRelease(CFStringCreateWithBytes(CFAllocatorGetDefault(), bytes, length, kCFStringEncodingUTF8, false));
+}
+
+/// Read a class schema, returns nil if an error occurs.
+static _YYModelArchiveSchema *YYArchiveReadSchema(YYArchiveReader *r) {
+    NSString *className = YYArchiveReadString(r);
+    uint64_t count;
+    if (!className || !YYArchiveReadVarint(r, &count)) return nil;
+    if (count > (uint64_t)(r->end - r->cur) / 4) return nil;
+
+    _YYModelArchiveSchema *schema = [_YYModelArchiveSchema new];
+    schema->_fieldCount = (NSUInteger)count;
+    Class cls = NSClassFromString(className);
+    if (!YYArchiveModelClassIsAllowed(r, cls)) cls = Nil;
+    _YYModelMeta *modelMeta = cls ? [_YYModelMeta metaWithClass:cls] : nil;
+    if (modelMeta && !modelMeta->_nsType) schema->_cls = cls;
+
+    NSArray *properties = schema->_cls ? modelMeta->_archivePropertyMetas : nil;
+    NSMutableArray *fields = [[NSMutableArray alloc] initWithCapacity:(NSUInteger)count];
+    for (uint64_t i = 0; i < count; i++) {
+        uint32_t hash;
+        if (!YYArchiveReadFixed32(r, &hash)) return nil;
+        NSString *name = nil;
+        if (hash == 0) {
+            name = YYArchiveReadString(r);
+            if (!name) return nil;
+        }
+        id field = (id)kCFNull;
+        for (_YYModelPropertyMeta *propertyMeta in properties) {
+            // a colliding property (hash 0) is only matched by name
+            if (name ? [propertyMeta->_name isEqualToString:name] : propertyMeta->_archiveHash == hash) {
+                field = propertyMeta;
+                break;
+            }
+        }
+        [fields addObject:field];
+    }
+    schema->_fields = fields;
+    return schema;
+}
+
+/// Read a model (after the type byte), returns NSNull if the class is not found or not allowed, or nil if an error occurs.
+static id YYArchiveReadModel(YYArchiveReader *r) {
+    uint64_t index;
+    if (!YYArchiveReadVarint(r, &index)) return nil;
+    CFIndex schemaCount = CFArrayGetCount(r->schemas);
+    if (index > (uint64_t)schemaCount) return nil;
+    _YYModelArchiveSchema *schema = nil;
+    if (index == (uint64_t)schemaCount) {
+        schema = YYArchiveReadSchema(r);
+        if (!schema) return nil;
+        CFArrayAppendValue(r->schemas, (__bridge const void *)(schema));
+    } else {
+        schema = (__bridge _YYModelArchiveSchema *)CFArrayGetValueAtIndex(r->schemas, (CFIndex)index);
+    }
+
+    // the schema is shared by all models of the class index, check the class of each model
+    Class cls = YYArchiveModelClassIsAllowed(r, schema->_cls) ? schema->_cls : Nil;
+    NSObject *model = [cls new];
+    r->modelDepth++;
+    for (;;) {
+        uint64_t field;
+        if (!YYArchiveReadVarint(r, &field)) return nil;
+        if (field == 0) break;
+        if (field > schema->_fieldCount) return nil;
+        _YYModelPropertyMeta *propertyMeta = schema->_fields[(NSUInteger)field - 1];
+        __unsafe_unretained _YYModelPropertyMeta *outerProperty = r->property;
+        r->property = propertyMeta != (id)kCFNull ? propertyMeta : nil;
+        id value = YYArchiveReadObject(r);
+        r->property = outerProperty;
+        if (!value) return nil;
+        if (model && propertyMeta != (id)kCFNull) {
+            if (propertyMeta->_genericCls &&
+                (propertyMeta->_nsType == YYEncodingTypeNSDictionary || propertyMeta->_nsType == YYEncodingTypeNSMutableDictionary) &&
+                [value isKindOfClass:[NSDictionary class]]) {
+                // the generic models in dictionary are already unarchived
+                NSMutableDictionary *dic = [NSMutableDictionary new];
+                [((NSDictionary *)value) enumerateKeysAndObjectsUsingBlock:^(id oneKey, id oneValue, BOOL *stop) {
+                    if ([oneValue isKindOfClass:propertyMeta->_genericCls]) dic[oneKey] = oneValue;
+                }];
+                ModelSetObjectToProperty(model, propertyMeta, dic);
+            } else {
+                ModelSetValueForProperty(model, value, propertyMeta);
+            }
+        }
+    }
+    r->modelDepth--;
+    return model ?: (id)kCFNull;
+}
+
+/// Read any value, returns NSNull for null, or nil if an error occurs.
+static id YYArchiveReadObject(YYArchiveReader *r) {
+    if (r->cur >= r->end) return nil;
+    if (r->depth >= YY_ARCHIVE_MAX_DEPTH) return nil;
+    uint8_t type = *r->cur++;
+    id result = nil;
+    r->depth++;
+    switch (type) {
+        case YYArchiveTypeNull: result = (id)kCFNull; break;
+        case YYArchiveTypeFalse: result = (id)kCFBooleanFalse; break;
+        case YYArchiveTypeTrue: result = (id)kCFBooleanTrue; break;
+        case YYArchiveTypeInt: {
+            uint64_t v;
+            if (!YYArchiveReadVarint(r, &v)) break;
+            result = @((int64_t)(v >> 1) ^ -(int64_t)(v & 1));
+        } break;
+        case YYArchiveTypeUInt: {
+            uint64_t v;
+            if (!YYArchiveReadVarint(r, &v)) break;
+            result = @(v);
+        } break;
+        case YYArchiveTypeFloat: {
+            uint32_t bits;
+            if (!YYArchiveReadFixed32(r, &bits)) break;
+            float f;
+            memcpy(&f, &bits, 4);
+            result = @(f);
+        } break;
+        case YYArchiveTypeDouble: {
+            uint64_t bits;
+            if (!YYArchiveReadFixed64(r, &bits)) break;
+            double d;
+            memcpy(&d, &bits, 8);
+            result = @(d);
+        } break;
+        case YYArchiveTypeDecimal: {
+            NSString *string = YYArchiveReadString(r);
+            if (string) result = [NSDecimalNumber decimalNumberWithString:string locale:nil];
+        } break;
+        case YYArchiveTypeString: {
+            result = YYArchiveReadString(r);
+        } break;
+        case YYArchiveTypeData: {
+            const uint8_t *bytes;
+            size_t length;
+            if (!YYArchiveReadBytes(r, &bytes, &length)) break;
+            result = [NSData dataWithBytes:bytes length:length];
+        } break;
+        case YYArchiveTypeDate: {
+            uint64_t bits;
+            if (!YYArchiveReadFixed64(r, &bits)) break;
+            double time;
+            memcpy(&time, &bits, 8);
+            result = [NSDate dateWithTimeIntervalSinceReferenceDate:time];
+        } break;
+        case YYArchiveTypeURL: {
+            NSString *string = YYArchiveReadString(r);
+            if (string) result = [NSURL URLWithString:string] ?: (id)kCFNull;
+        } break;
+        case YYArchiveTypeArray:
+        case YYArchiveTypeSet: {
+            uint64_t count;
+            if (!YYArchiveReadVarint(r, &count)) break;
+            if (count > (uint64_t)(r->end - r->cur)) break; // each value has 1 byte at least
+            id container = (type == YYArchiveTypeSet) ? [[NSMutableSet alloc] initWithCapacity:(NSUInteger)count] :
+                                                       [[NSMutableArray alloc] initWithCapacity:(NSUInteger)count];
+            BOOL success = YES;
+            for (uint64_t i = 0; i < count; i++) {
+                id one = YYArchiveReadObject(r);
+                if (!one) {
+                    success = NO;
+                    break;
+                }
+                [container addObject:one];
+            }
+            if (success) result = container;
+        } break;
+        case YYArchiveTypeDictionary: {
+            uint64_t count;
+            if (!YYArchiveReadVarint(r, &count)) break;
+            if (count > (uint64_t)(r->end - r->cur) / 2) break;
+            NSMutableDictionary *dic = [[NSMutableDictionary alloc] initWithCapacity:(NSUInteger)count];
+            BOOL success = YES;
+            for (uint64_t i = 0; i < count; i++) {
+                id key = YYArchiveReadObject(r);
+                id value = key ? YYArchiveReadObject(r) : nil;
+                if (!value || ![key conformsToProtocol:@protocol(NSCopying)]) {
+                    success = NO;
+                    break;
+                }
+                dic[key] = value;
+            }
+            if (success) result = dic;
+        } break;
+        case YYArchiveTypeModel: {
+            result = YYArchiveReadModel(r);
+        } break;
+        case YYArchiveTypeClass: {
+            NSString *string = YYArchiveReadString(r);
+            if (string) result = NSClassFromString(string) ?: (id)kCFNull;
+        } break;
+        case YYArchiveTypeSEL: {
+            result = YYArchiveReadString(r);
+        } break;
+        case YYArchiveTypeKeyed: {
+            const uint8_t *bytes;
+            size_t length;
+            if (!YYArchiveReadBytes(r, &bytes, &length)) break;
+            NSData *data = [NSData dataWithBytesNoCopy:(void *)bytes length:length freeWhenDone:NO];
+            NSSet *classes = YYArchiveKeyedClasses(r->property);
+            @try {
+                NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+                unarchiver.requiresSecureCoding = YES;
+                result = [unarchiver decodeObjectOfClasses:classes forKey:NSKeyedArchiveRootObjectKey];
+                [unarchiver finishDecoding];
+            } @catch (NSException *exception) {
+                result = nil;
+            }
+            if (!result) result = (id)kCFNull;
+        } break;
+        default: break;
+    }
+    r->depth--;
+    return result;
+}
+
+/// Unarchive the object from model archive data, returns nil if an error occurs.
+/// The root model (or the models in root container) must be kind of `rootClass`.
+static id YYModelArchiveCreateObject(__unsafe_unretained NSData *data, __unsafe_unretained Class rootClass) {
+    if (data.length < sizeof(YYModelArchiveMagic) + 1) return nil;
+    const uint8_t *bytes = data.bytes;
+    if (memcmp(bytes, YYModelArchiveMagic, sizeof(YYModelArchiveMagic)) != 0) return nil;
+    if (bytes[sizeof(YYModelArchiveMagic)] != YYModelArchiveVersion) return nil;
+
+    YYArchiveReader reader = {0};
+    YYArchiveReader *r = &reader;
+    r->cur = bytes + sizeof(YYModelArchiveMagic) + 1;
+    r->end = bytes + data.length;
+    r->rootClass = rootClass;
+    r->schemas = CFArrayCreateMutable(CFAllocatorGetDefault(), 0, &kCFTypeArrayCallBacks);
+    id object = YYArchiveReadObject(r);
+    CFRelease(r->schemas);
+    if (r->cur != r->end) return nil;
+    return object;
+}
+
+
 @implementation NSObject (YYModel)
 //id json对象转化为 dictioanry的方法
 + (NSDictionary *)_yy_dictionaryWithJSON:(id)json {
@@ -1676,6 +4605,12 @@ static NSString *ModelDescription(NSObject *model) {
  */
 // 先转化json对象到dictionary，再调用modelWithDictionary
 + (instancetype)modelWithJSON:(id)json {
+    // 单次解析: 直接从JSON数据设置model, 不是UTF-8的JSON对象时使用NSJSONSerialization
+    NSData *data = YYJSONStreamingData(json);
+    if (data) {
+        id model = nil;
+        if (ModelCreateWithJSONData([self class], data, &model)) return model;
+    }
     // json转为dic
     NSDictionary *dic = [self _yy_dictionaryWithJSON:json];
     // dic转为model
@@ -1777,6 +4712,8 @@ static NSString *ModelDescription(NSObject *model) {
 }
 
 - (NSData *)modelToJSONData {
+    NSData *data = ModelCreateJSONData(self);
+    if (data) return data;
     id jsonObject = [self modelToJSONObject];
     if (!jsonObject) return nil;
     return [NSJSONSerialization dataWithJSONObject:jsonObject options:0 error:NULL];
@@ -1797,7 +4734,9 @@ static NSString *ModelDescription(NSObject *model) {
     for (_YYModelPropertyMeta *propertyMeta in modelMeta->_allPropertyMetas) {
         if (!propertyMeta->_getter || !propertyMeta->_setter) continue;
         
-        if (propertyMeta->_isCNumber) {
+        if (propertyMeta->_isCNumber && propertyMeta->_ivarOffset) {
+            memcpy(ModelPropertyIvar(one, propertyMeta), ModelPropertyIvar(self, propertyMeta), propertyMeta->_ivarSize);
+        } else if (propertyMeta->_isCNumber) {
             switch (propertyMeta->_type & YYEncodingTypeMask) {
                 case YYEncodingTypeBool: {
                     bool num = ((bool (*)(id, SEL))(void *) objc_msgSend)((id)self, propertyMeta->_getter);
@@ -1839,7 +4778,10 @@ static NSString *ModelDescription(NSObject *model) {
             }
         } else {
             switch (propertyMeta->_type & YYEncodingTypeMask) {
-                case YYEncodingTypeObject:
+                case YYEncodingTypeObject: {
+                    id value = ModelGetObjectFromProperty(self, propertyMeta);
+                    ModelSetObjectToProperty(one, propertyMeta, value);
+                } break;
                 case YYEncodingTypeClass:
                 case YYEncodingTypeBlock: {
                     id value = ((id (*)(id, SEL))(void *) objc_msgSend)((id)self, propertyMeta->_getter);
@@ -1889,7 +4831,7 @@ static NSString *ModelDescription(NSObject *model) {
         } else {
             switch (propertyMeta->_type & YYEncodingTypeMask) {
                 case YYEncodingTypeObject: {
-                    id value = ((id (*)(id, SEL))(void *)objc_msgSend)((id)self, propertyMeta->_getter);
+                    id value = ModelGetObjectFromProperty(self, propertyMeta);
                     if (value && (propertyMeta->_nsType || [value respondsToSelector:@selector(encodeWithCoder:)])) {
                         if ([value isKindOfClass:[NSValue class]]) {
                             if ([value isKindOfClass:[NSNumber class]]) {
@@ -1944,7 +4886,7 @@ static NSString *ModelDescription(NSObject *model) {
             switch (type) {
                 case YYEncodingTypeObject: {
                     id value = [aDecoder decodeObjectForKey:propertyMeta->_name];
-                    ((void (*)(id, SEL, id))(void *) objc_msgSend)((id)self, propertyMeta->_setter, value);
+                    ModelSetObjectToProperty(self, propertyMeta, value);
                 } break;
                 case YYEncodingTypeSEL: {
                     NSString *str = [aDecoder decodeObjectForKey:propertyMeta->_name];
@@ -1971,6 +4913,17 @@ static NSString *ModelDescription(NSObject *model) {
     return self;
 }
 
+- (NSData *)modelToArchiveData {
+    return YYModelArchiveCreateData(self);
+}
+
++ (instancetype)modelWithArchiveData:(NSData *)data {
+    if (![data isKindOfClass:[NSData class]]) return nil;
+    id object = YYModelArchiveCreateObject(data, self);
+    if (object == (id)kCFNull || ![object isKindOfClass:self]) return nil;
+    return object;
+}
+
 - (NSUInteger)modelHash {
     if (self == (id)kCFNull) return [self hash];
     _YYModelMeta *modelMeta = [_YYModelMeta metaWithClass:self.class];
@@ -2013,10 +4966,65 @@ static NSString *ModelDescription(NSObject *model) {
 
 
 
+#pragma mark - Concurrent Transform
+
+/// The minimum count of elements to be transformed concurrently.
+#define YY_MODEL_CONCURRENT_MIN_COUNT 128
+/// The minimum count of elements in a chunk.
+#define YY_MODEL_CONCURRENT_MIN_CHUNK 8
+
+/// Whether the model class is opted in to the concurrent transform (see `+modelTransformConcurrently`).
+static force_inline BOOL ModelClassTransformConcurrently(Class cls) {
+    _YYModelMeta *meta = [_YYModelMeta metaWithClass:cls];
+    return meta && meta->_transformConcurrently;
+}
+
+/// Whether the elements of a container should be transformed to the class concurrently.
+static BOOL ModelShouldTransformConcurrently(Class cls, NSUInteger count) {
+    if (count < YY_MODEL_CONCURRENT_MIN_COUNT) return NO;
+    if (!ModelClassTransformConcurrently(cls)) return NO;
+    return [NSProcessInfo processInfo].activeProcessorCount > 1;
+}
+
+/**
+ Creates models with the dictionaries concurrently.
+ 
+ @discussion The dictionaries are split into chunks (more than the CPU count, so
+ the threads which finish early can take the remaining chunks), and transformed
+ on the global queue. The model metas are cached and can be read concurrently.
+ 
+ @param dics   The dictionaries, the other objects (or NULL) are skipped.
+ @param models Output, the retained model (or NULL) at the same index of the dictionary.
+ @param count  The count of dictionaries.
+ */
+static void ModelCreateConcurrently(Class cls, const void **dics, void **models, NSUInteger count) {
+    NSUInteger chunkCount = [NSProcessInfo processInfo].activeProcessorCount * 4;
+    NSUInteger chunkSize = MAX((count + chunkCount - 1) / chunkCount, YY_MODEL_CONCURRENT_MIN_CHUNK);
+    chunkCount = (count + chunkSize - 1) / chunkSize;
+    
+    dispatch_apply(chunkCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk) {
+        @autoreleasepool {
+            NSUInteger start = chunk * chunkSize, end = MIN(start + chunkSize, count);
+            for (NSUInteger i = start; i < end; i++) {
+                __unsafe_unretained id dic = (__bridge id)dics[i];
+                if (![dic isKindOfClass:[NSDictionary class]]) continue;
+                NSObject *obj = [cls modelWithDictionary:dic];
+                if (obj) models[i] = (__bridge_retained void *)obj;
+            }
+        }
+    });
+}
+
 @implementation NSArray (YYModel)
 
 + (NSArray *)modelArrayWithClass:(Class)cls json:(id)json {
     if (!json) return nil;
+    // the concurrent transform needs the parsed array
+    NSData *streamingData = (cls && !ModelClassTransformConcurrently(cls)) ? YYJSONStreamingData(json) : nil;
+    if (streamingData) {
+        NSArray *result = nil;
+        if (ModelArrayCreateWithJSONData(cls, streamingData, &result)) return result;
+    }
     NSArray *arr = nil;
     NSData *jsonData = nil;
     if ([json isKindOfClass:[NSArray class]]) {
@@ -2035,6 +5043,24 @@ static NSString *ModelDescription(NSObject *model) {
 
 + (NSArray *)modelArrayWithClass:(Class)cls array:(NSArray *)arr {
     if (!cls || !arr) return nil;
+    NSUInteger count = arr.count;
+    if (ModelShouldTransformConcurrently(cls, count)) {
+        const void **dics = malloc(count * sizeof(void *));
+        void **models = calloc(count, sizeof(void *));
+        if (dics && models) {
+            CFArrayGetValues((CFArrayRef)arr, CFRangeMake(0, count), dics);
+            ModelCreateConcurrently(cls, dics, models, count);
+            NSMutableArray *result = [NSMutableArray arrayWithCapacity:count];
+            for (NSUInteger i = 0; i < count; i++) {
+                if (models[i]) [result addObject:(__bridge_transfer id)models[i]];
+            }
+            free(dics);
+            free(models);
+            return result;
+        }
+        if (dics) free(dics);
+        if (models) free(models);
+    }
     NSMutableArray *result = [NSMutableArray new];
     for (NSDictionary *dic in arr) {
         if (![dic isKindOfClass:[NSDictionary class]]) continue;
@@ -2069,6 +5095,30 @@ static NSString *ModelDescription(NSObject *model) {
 
 + (NSDictionary *)modelDictionaryWithClass:(Class)cls dictionary:(NSDictionary *)dic {
     if (!cls || !dic) return nil;
+    NSUInteger count = dic.count;
+    if (ModelShouldTransformConcurrently(cls, count)) {
+        const void **keys = malloc(count * sizeof(void *));
+        const void **values = malloc(count * sizeof(void *));
+        void **models = calloc(count, sizeof(void *));
+        if (keys && values && models) {
+            CFDictionaryGetKeysAndValues((CFDictionaryRef)dic, keys, values);
+            for (NSUInteger i = 0; i < count; i++) {
+                if (![(__bridge id)keys[i] isKindOfClass:[NSString class]]) values[i] = NULL;
+            }
+            ModelCreateConcurrently(cls, values, models, count);
+            NSMutableDictionary *result = [NSMutableDictionary dictionaryWithCapacity:count];
+            for (NSUInteger i = 0; i < count; i++) {
+                if (models[i]) result[(__bridge id)keys[i]] = (__bridge_transfer id)models[i];
+            }
+            free(keys);
+            free(values);
+            free(models);
+            return result;
+        }
+        if (keys) free(keys);
+        if (values) free(values);
+        if (models) free(models);
+    }
     NSMutableDictionary *result = [NSMutableDictionary new];
     for (NSString *key in dic.allKeys) {
         if (![key isKindOfClass:[NSString class]]) continue;
@@ -10,6 +10,7 @@
 //
 
 #import "YYClassInfo.h"
+#import "_YYClassCache.h"
 #import <objc/runtime.h>
 /** 这里涉及到typeEncodind的知识 https://developer.apple.com/library/content/documentation/Cocoa/Conceptual/ObjCRuntimeGuide/Articles/ocrtTypeEncodings.html
     YY这里把typeEncoding 转为自定义的枚举类型，方便管理和使用
@@ -477,28 +478,21 @@ YYEncodingType YYEncodingGetType(const char *typeEncoding) {
 
 
 /**
- classInfoWithClass方法中主要调用了两个方法- (instancetype)initWithClass:(Class)cls（初始化class）和- (void)_update（更新class
+ classInfoWithClass方法中主要调用了- (instancetype)initWithClass:(Class)cls（初始化class, 需要更新时也会创建新的class info）
  */
 + (instancetype)classInfoWithClass:(Class)cls {
     if (!cls) return nil;
-    //  全局的缓存
+    //  全局的缓存, 读取时不加锁 (see _YYClassCache)
      // class缓存
-    static CFMutableDictionaryRef classCache;
+    static _YYClassCache *classCache;
      // meta class缓存
-    static CFMutableDictionaryRef metaCache;
+    static _YYClassCache *metaCache;
     static dispatch_once_t onceToken;
-    // 锁  CGD的信号量
-    static dispatch_semaphore_t lock;
     dispatch_once(&onceToken, ^{
         //初始化两种缓存
-    
-        classCache = CFDictionaryCreateMutable(CFAllocatorGetDefault(), 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
- 
-        metaCache = CFDictionaryCreateMutable(CFAllocatorGetDefault(), 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
-        lock = dispatch_semaphore_create(1);
+        classCache = [_YYClassCache new];
+        metaCache = [_YYClassCache new];
     });
-    // 只允许同时1个线程
-    dispatch_semaphore_wait(lock, DISPATCH_TIME_FOREVER);
     // 获取曾经解析过的缓存
     /**
      关于metaClass
@@ -506,22 +500,21 @@ YYEncodingType YYEncodingGetType(const char *typeEncoding) {
      Class currentClass1 = object_getClass(view); // 获取的UIView这个类对象
      Class currentClass2 = object_getClass(view.class); // UIView的meta-class
      */
-    YYClassInfo *info = CFDictionaryGetValue(class_isMetaClass(cls) ? metaCache : classCache, (__bridge const void *)(cls));
+    _YYClassCache *cache = class_isMetaClass(cls) ? metaCache : classCache;
+    YYClassInfo *info = [cache objectForClass:cls];
     if (info && info->_needUpdate) {
-        // 如果存在且需要更新，则重新解析class并更新结构体
-        // 主要方法1
-        [info _update];
+        // 如果存在且需要更新，则重新解析class, 创建新的class info并替换缓存
+        // 不能直接更新缓存的info, 其他线程可能正在无锁读取它
+        YYClassInfo *newInfo = [[YYClassInfo alloc] initWithClass:cls];
+        if (newInfo) [cache setObject:newInfo forClass:cls];
+        return newInfo;
     }
-     //释放锁
-    dispatch_semaphore_signal(lock);
     if (!info) { //如果没有缓存，则第一次解析class
          // 主要方法2
         info = [[YYClassInfo alloc] initWithClass:cls];
         if (info) {
-             //解析完毕设置缓存
-            dispatch_semaphore_wait(lock, DISPATCH_TIME_FOREVER);
-            CFDictionarySetValue(info.isMeta ? metaCache : classCache, (__bridge const void *)(cls), (__bridge const void *)(info));
-            dispatch_semaphore_signal(lock);
+             //解析完毕设置缓存, 如果其他线程已经设置, 使用已缓存的
+            info = [cache addObject:info forClass:cls];
         }
     }
     return info;
@@ -0,0 +1,47 @@
+//
+//  _YYClassCache.h
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A map from class to object, used by the class metadata caches
+ (`YYClassInfo` and the model meta).
+ 
+ @discussion The lookup is lock-free: the map is an open addressing hash table,
+ the entries are never removed, and the table is replaced by a larger copy when
+ it's half full. Only the writers take a lock. The replaced tables and objects
+ are kept alive, as a reader may still use them; this is cheap since the number
+ of classes is limited and an object is only replaced when its class is updated.
+ */
+@interface _YYClassCache : NSObject
+
+/**
+ Returns the object of the class, or nil. This method is lock-free.
+ */
+- (nullable id)objectForClass:(Class)cls;
+
+/**
+ Adds the object for the class if the class has no object.
+ 
+ @return The object of the class in the cache (the existing one or the added one).
+ */
+- (id)addObject:(id)object forClass:(Class)cls;
+
+/**
+ Sets the object for the class, replacing the existing one.
+ */
+- (void)setObject:(id)object forClass:(Class)cls;
+
+@end
+
+NS_ASSUME_NONNULL_END
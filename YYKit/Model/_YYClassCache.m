@@ -0,0 +1,135 @@
+//
+//  _YYClassCache.m
+//  YYKit <https://github.com/ibireme/YYKit>
+//
+//  Created by agent on 26/10/19.
+//  Copyright (c) 2026 agent.
+//
+//  This source code is licensed under the MIT-style license found in the
+//  LICENSE file in the root directory of this source tree.
+//
+
+#import "_YYClassCache.h"
+#import <pthread.h>
+
+typedef struct {
+    void *cls;      ///< Class, NULL if the slot is empty (written once)
+    void *object;   ///< retained object
+} _YYClassCacheSlot;
+
+typedef struct _YYClassCacheTable {
+    NSUInteger mask;                        ///< capacity - 1
+    struct _YYClassCacheTable *retired;     ///< the previous table, which may be used by readers
+    _YYClassCacheSlot slots[];
+} _YYClassCacheTable;
+
+static inline NSUInteger _YYClassCacheHash(void *cls) {
+    uintptr_t h = (uintptr_t)cls >> 3; // objects are aligned
+    h ^= h >> 16;
+    h *= 0x45d9f3b;
+    h ^= h >> 16;
+    return (NSUInteger)h;
+}
+
+static _YYClassCacheTable *_YYClassCacheTableCreate(NSUInteger capacity) {
+    _YYClassCacheTable *table = calloc(1, sizeof(_YYClassCacheTable) + capacity * sizeof(_YYClassCacheSlot));
+    if (table) table->mask = capacity - 1;
+    return table;
+}
+
+/// Returns the slot of the class, or the empty slot where the class should be inserted.
+static inline _YYClassCacheSlot *_YYClassCacheTableFind(_YYClassCacheTable *table, void *cls) {
+    NSUInteger mask = table->mask, i = _YYClassCacheHash(cls) & mask;
+    for (;;) {
+        _YYClassCacheSlot *slot = table->slots + i;
+        void *key = __atomic_load_n(&slot->cls, __ATOMIC_ACQUIRE);
+        if (key == cls || key == NULL) return slot;
+        i = (i + 1) & mask;
+    }
+}
+
+@implementation _YYClassCache {
+    _YYClassCacheTable *_table;
+    NSUInteger _count;
+    NSMutableArray *_retiredObjects;
+    pthread_mutex_t _lock;
+}
+
+- (instancetype)init {
+    self = [super init];
+    _table = _YYClassCacheTableCreate(64);
+    if (!_table) return nil;
+    _retiredObjects = [NSMutableArray new];
+    pthread_mutex_init(&_lock, NULL);
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i <= _table->mask; i++) {
+        if (_table->slots[i].object) CFRelease(_table->slots[i].object);
+    }
+    _YYClassCacheTable *table = _table;
+    while (table) {
+        _YYClassCacheTable *retired = table->retired;
+        free(table);
+        table = retired;
+    }
+    pthread_mutex_destroy(&_lock);
+}
+
+- (id)objectForClass:(Class)cls {
+    if (!cls) return nil;
+    _YYClassCacheTable *table = __atomic_load_n(&_table, __ATOMIC_ACQUIRE);
+    _YYClassCacheSlot *slot = _YYClassCacheTableFind(table, (__bridge void *)cls);
+    if (!slot->cls) return nil;
+    return (__bridge id)__atomic_load_n(&slot->object, __ATOMIC_ACQUIRE);
+}
+
+/// Should be called with the lock held.
+- (BOOL)_growIfNeeded {
+    NSUInteger capacity = _table->mask + 1;
+    if ((_count + 1) * 2 <= capacity) return YES;
+    _YYClassCacheTable *table = _YYClassCacheTableCreate(capacity * 2);
+    if (!table) return NO;
+    for (NSUInteger i = 0; i < capacity; i++) {
+        _YYClassCacheSlot *old = _table->slots + i;
+        if (!old->cls) continue;
+        _YYClassCacheSlot *slot = _YYClassCacheTableFind(table, old->cls);
+        *slot = *old;
+    }
+    table->retired = _table;
+    __atomic_store_n(&_table, table, __ATOMIC_RELEASE);
+    return YES;
+}
+
+- (id)_setObject:(id)object forClass:(Class)cls replace:(BOOL)replace {
+    if (!object || !cls) return object;
+    pthread_mutex_lock(&_lock);
+    _YYClassCacheSlot *slot = _YYClassCacheTableFind(_table, (__bridge void *)cls);
+    if (slot->cls) {
+        if (replace) {
+            void *old = slot->object;
+            __atomic_store_n(&slot->object, (void *)CFBridgingRetain(object), __ATOMIC_RELEASE);
+            [_retiredObjects addObject:CFBridgingRelease(old)];
+        } else {
+            object = (__bridge id)(slot->object);
+        }
+    } else if ([self _growIfNeeded]) {
+        slot = _YYClassCacheTableFind(_table, (__bridge void *)cls);
+        slot->object = (void *)CFBridgingRetain(object);
+        __atomic_store_n(&slot->cls, (__bridge void *)cls, __ATOMIC_RELEASE);
+        _count++;
+    }
+    pthread_mutex_unlock(&_lock);
+    return object;
+}
+
+- (id)addObject:(id)object forClass:(Class)cls {
+    return [self _setObject:object forClass:cls replace:NO];
+}
+
+- (void)setObject:(id)object forClass:(Class)cls {
+    [self _setObject:object forClass:cls replace:YES];
+}
+
+@end
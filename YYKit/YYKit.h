@@ -63,9 +63,15 @@ FOUNDATION_EXPORT const unsigned char YYKitVersionString[];
 #import <YYKit/YYSpriteSheetImage.h>
 #import <YYKit/YYAnimatedImageView.h>
 #import <YYKit/YYImageCoder.h>
+#import <YYKit/YYBitmapBufferPool.h>
 #import <YYKit/YYImageCache.h>
+#import <YYKit/YYImagePersistencePolicy.h>
+#import <YYKit/YYImageTileCache.h>
 #import <YYKit/YYWebImageOperation.h>
 #import <YYKit/YYWebImageManager.h>
+#import <YYKit/YYWebImageTransport.h>
+#import <YYKit/YYWebImageURLBlacklist.h>
+#import <YYKit/YYWebImageTransform.h>
 #import <YYKit/UIImageView+YYWebImage.h>
 #import <YYKit/UIButton+YYWebImage.h>
 #import <YYKit/MKAnnotationView+YYWebImage.h>
@@ -154,9 +160,15 @@ FOUNDATION_EXPORT const unsigned char YYKitVersionString[];
 #import "YYSpriteSheetImage.h"
 #import "YYAnimatedImageView.h"
 #import "YYImageCoder.h"
+#import "YYBitmapBufferPool.h"
 #import "YYImageCache.h"
+#import "YYImagePersistencePolicy.h"
+#import "YYImageTileCache.h"
 #import "YYWebImageOperation.h"
 #import "YYWebImageManager.h"
+#import "YYWebImageTransport.h"
+#import "YYWebImageURLBlacklist.h"
+#import "YYWebImageTransform.h"
 #import "UIImageView+YYWebImage.h"
 #import "UIButton+YYWebImage.h"
 #import "MKAnnotationView+YYWebImage.h"